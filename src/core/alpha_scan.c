@@ -0,0 +1,323 @@
+// alpha_scan.c
+
+#include "alpha_scan.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)) && !defined(ALPHA_SCAN_NO_SIMD)
+#define ALPHA_SCAN_HAS_SSE2 1
+#include <emmintrin.h>
+#if defined(__GNUC__)
+#define ALPHA_SCAN_HAS_AVX2 1 // Compiled with a target attribute, selected at runtime
+#include <immintrin.h>
+#endif
+#endif
+
+// Per-row kernels over `count` consecutive RGBA8 pixels
+typedef int (*CountRowFunc)(const unsigned char *pixels, int count);
+typedef bool (*AnyRowFunc)(const unsigned char *pixels, int count);
+
+static CountRowFunc countRow;
+static AnyRowFunc anyRow;
+static AlphaScanPath activePath;
+static pthread_once_t scanInitOnce = PTHREAD_ONCE_INIT;
+
+static int CountRowScalar(const unsigned char *pixels, int count)
+{
+    int visible = 0;
+    for (int i = 0; i < count; i++)
+    {
+        visible += pixels[i * 4 + 3] != 0;
+    }
+    return visible;
+}
+
+static bool AnyRowScalar(const unsigned char *pixels, int count)
+{
+    // Eight bytes (two pixels) at a time; alpha is the top byte of each little-endian 32-bit pixel
+    int i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+        uint64_t two;
+        memcpy(&two, pixels + i * 4, sizeof(two));
+        if (two & 0xFF000000FF000000ull)
+            return true;
+    }
+    return i < count && pixels[i * 4 + 3] != 0;
+}
+
+#if defined(ALPHA_SCAN_HAS_SSE2)
+static int CountRowSSE2(const unsigned char *pixels, int count)
+{
+    const __m128i alphaMask = _mm_set1_epi32((int)0xFF000000);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i transparent = _mm_setzero_si128(); // Per-lane count of alpha == 0 pixels
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(pixels + i * 4));
+        transparent = _mm_sub_epi32(transparent, _mm_cmpeq_epi32(_mm_and_si128(v, alphaMask), zero));
+    }
+
+    int32_t lanes[4];
+    _mm_storeu_si128((__m128i *)lanes, transparent);
+    int visible = i - (lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+    return visible + CountRowScalar(pixels + i * 4, count - i);
+}
+
+static bool AnyRowSSE2(const unsigned char *pixels, int count)
+{
+    const __m128i alphaMask = _mm_set1_epi32((int)0xFF000000);
+    const __m128i zero = _mm_setzero_si128();
+
+    int i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        const __m128i *p = (const __m128i *)(pixels + i * 4);
+        __m128i any = _mm_or_si128(_mm_or_si128(_mm_loadu_si128(p), _mm_loadu_si128(p + 1)),
+                                   _mm_or_si128(_mm_loadu_si128(p + 2), _mm_loadu_si128(p + 3)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(any, alphaMask), zero)) != 0xFFFF)
+            return true;
+    }
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(pixels + i * 4));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(v, alphaMask), zero)) != 0xFFFF)
+            return true;
+    }
+    return AnyRowScalar(pixels + i * 4, count - i);
+}
+#endif
+
+#if defined(ALPHA_SCAN_HAS_AVX2)
+__attribute__((target("avx2"))) static int CountRowAVX2(const unsigned char *pixels, int count)
+{
+    const __m256i alphaMask = _mm256_set1_epi32((int)0xFF000000);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i transparent = _mm256_setzero_si256();
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(pixels + i * 4));
+        transparent = _mm256_sub_epi32(transparent, _mm256_cmpeq_epi32(_mm256_and_si256(v, alphaMask), zero));
+    }
+
+    int32_t lanes[8];
+    _mm256_storeu_si256((__m256i *)lanes, transparent);
+    int transparentCount = 0;
+    for (int lane = 0; lane < 8; lane++)
+        transparentCount += lanes[lane];
+    return (i - transparentCount) + CountRowSSE2(pixels + i * 4, count - i);
+}
+
+__attribute__((target("avx2"))) static bool AnyRowAVX2(const unsigned char *pixels, int count)
+{
+    const __m256i alphaMask = _mm256_set1_epi32((int)0xFF000000);
+
+    int i = 0;
+    for (; i + 32 <= count; i += 32)
+    {
+        const __m256i *p = (const __m256i *)(pixels + i * 4);
+        __m256i any = _mm256_or_si256(_mm256_or_si256(_mm256_loadu_si256(p), _mm256_loadu_si256(p + 1)),
+                                      _mm256_or_si256(_mm256_loadu_si256(p + 2), _mm256_loadu_si256(p + 3)));
+        if (!_mm256_testz_si256(any, alphaMask))
+            return true;
+    }
+    for (; i + 8 <= count; i += 8)
+    {
+        if (!_mm256_testz_si256(_mm256_loadu_si256((const __m256i *)(pixels + i * 4)), alphaMask))
+            return true;
+    }
+    return AnyRowSSE2(pixels + i * 4, count - i);
+}
+#endif
+
+static bool IsPathSupported(AlphaScanPath path)
+{
+    switch (path)
+    {
+    case ALPHA_SCAN_SCALAR:
+        return true;
+#if defined(ALPHA_SCAN_HAS_SSE2)
+    case ALPHA_SCAN_SSE2:
+        return true;
+#endif
+#if defined(ALPHA_SCAN_HAS_AVX2)
+    case ALPHA_SCAN_AVX2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+static void SelectPath(AlphaScanPath path)
+{
+    activePath = path;
+    switch (path)
+    {
+#if defined(ALPHA_SCAN_HAS_AVX2)
+    case ALPHA_SCAN_AVX2:
+        countRow = CountRowAVX2;
+        anyRow = AnyRowAVX2;
+        break;
+#endif
+#if defined(ALPHA_SCAN_HAS_SSE2)
+    case ALPHA_SCAN_SSE2:
+        countRow = CountRowSSE2;
+        anyRow = AnyRowSSE2;
+        break;
+#endif
+    default:
+        activePath = ALPHA_SCAN_SCALAR;
+        countRow = CountRowScalar;
+        anyRow = AnyRowScalar;
+        break;
+    }
+}
+
+static void SelectBestPath(void)
+{
+    if (IsPathSupported(ALPHA_SCAN_AVX2))
+        SelectPath(ALPHA_SCAN_AVX2);
+    else if (IsPathSupported(ALPHA_SCAN_SSE2))
+        SelectPath(ALPHA_SCAN_SSE2);
+    else
+        SelectPath(ALPHA_SCAN_SCALAR);
+}
+
+// Loader threads scan concurrently, so the first-use selection must happen exactly once
+static void EnsureScanPath(void)
+{
+    pthread_once(&scanInitOnce, SelectBestPath);
+}
+
+AlphaScanPath GetAlphaScanPath(void)
+{
+    EnsureScanPath();
+    return activePath;
+}
+
+// Not thread-safe against running scans; call it before loading starts
+bool SetAlphaScanPath(AlphaScanPath path)
+{
+    EnsureScanPath();
+    if (path == ALPHA_SCAN_AUTO)
+    {
+        SelectBestPath();
+        return true;
+    }
+    if (!IsPathSupported(path))
+        return false;
+    SelectPath(path);
+    return true;
+}
+
+const char *GetAlphaScanPathName(AlphaScanPath path)
+{
+    switch (path)
+    {
+    case ALPHA_SCAN_SCALAR:
+        return "scalar";
+    case ALPHA_SCAN_SSE2:
+        return "SSE2";
+    case ALPHA_SCAN_AVX2:
+        return "AVX2";
+    default:
+        return "auto";
+    }
+}
+
+// Clips the region to the image; false if nothing is left
+static bool ClipRegion(Image image, Rectangle region, int *x, int *y, int *width, int *height)
+{
+    int x0 = (int)region.x, y0 = (int)region.y;
+    int x1 = (int)(region.x + region.width), y1 = (int)(region.y + region.height);
+    if (x0 < 0)
+        x0 = 0;
+    if (y0 < 0)
+        y0 = 0;
+    if (x1 > image.width)
+        x1 = image.width;
+    if (y1 > image.height)
+        y1 = image.height;
+
+    *x = x0;
+    *y = y0;
+    *width = x1 - x0;
+    *height = y1 - y0;
+    return image.data != NULL && *width > 0 && *height > 0;
+}
+
+int CountAlphaCoverage(Image image, Rectangle region)
+{
+    int x, y, width, height;
+    if (!ClipRegion(image, region, &x, &y, &width, &height))
+        return 0;
+    EnsureScanPath();
+
+    const unsigned char *pixels = image.data;
+    size_t stride = (size_t)image.width * 4;
+    int visible = 0;
+    for (int row = y; row < y + height; row++)
+    {
+        visible += countRow(pixels + row * stride + x * 4, width);
+    }
+    return visible;
+}
+
+bool IsRegionTransparent(Image image, Rectangle region)
+{
+    int x, y, width, height;
+    if (!ClipRegion(image, region, &x, &y, &width, &height))
+        return true;
+    EnsureScanPath();
+
+    const unsigned char *pixels = image.data;
+    size_t stride = (size_t)image.width * 4;
+    for (int row = y; row < y + height; row++)
+    {
+        if (anyRow(pixels + row * stride + x * 4, width))
+            return false;
+    }
+    return true;
+}
+
+int ScanSheetCoverage(Image image, int cellWidth, int cellHeight, int columns, int rows, int *coverage)
+{
+    memset(coverage, 0, (size_t)columns * rows * sizeof(int));
+    if (image.data == NULL || cellWidth <= 0 || cellHeight <= 0)
+        return 0;
+    EnsureScanPath();
+
+    // Only whole cells that fit inside the image are scanned
+    int fitColumns = image.width / cellWidth < columns ? image.width / cellWidth : columns;
+    int fitRows = image.height / cellHeight < rows ? image.height / cellHeight : rows;
+
+    // Walk the sheet one pixel row at a time so memory is read front to back
+    const unsigned char *pixels = image.data;
+    size_t stride = (size_t)image.width * 4;
+    for (int cellRow = 0; cellRow < fitRows; cellRow++)
+    {
+        int *rowCoverage = coverage + cellRow * columns;
+        for (int y = cellRow * cellHeight; y < (cellRow + 1) * cellHeight; y++)
+        {
+            const unsigned char *line = pixels + y * stride;
+            for (int column = 0; column < fitColumns; column++)
+            {
+                rowCoverage[column] += countRow(line + (size_t)column * cellWidth * 4, cellWidth);
+            }
+        }
+    }
+
+    int visibleCells = 0;
+    for (int i = 0; i < columns * rows; i++)
+    {
+        visibleCells += coverage[i] > 0;
+    }
+    return visibleCells;
+}
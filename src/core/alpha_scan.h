@@ -0,0 +1,34 @@
+// alpha_scan.h
+
+#pragma once
+
+#include "raylib.h"
+#include <stdbool.h>
+
+// Implementations of the alpha scan. The best one the CPU supports is picked on first use;
+// SetAlphaScanPath exists so benchmarks can compare them.
+typedef enum AlphaScanPath
+{
+    ALPHA_SCAN_AUTO,
+    ALPHA_SCAN_SCALAR,
+    ALPHA_SCAN_SSE2,
+    ALPHA_SCAN_AVX2
+} AlphaScanPath;
+
+// All functions scan an RGBA8 image in place: no sub-images, no colour arrays, no allocation.
+// Rectangles are clipped to the image.
+
+// Number of pixels in the region with alpha > 0
+int CountAlphaCoverage(Image image, Rectangle region);
+
+// True if every pixel in the region has alpha == 0; stops at the first visible pixel
+bool IsRegionTransparent(Image image, Rectangle region);
+
+// Scans a sheet laid out as rows x columns cells of cellWidth x cellHeight. Writes each
+// cell's coverage to coverage[row * columns + column] (0 = blank; cells outside the image
+// count as blank) and returns the number of non-blank cells.
+int ScanSheetCoverage(Image image, int cellWidth, int cellHeight, int columns, int rows, int *coverage);
+
+AlphaScanPath GetAlphaScanPath(void);
+bool SetAlphaScanPath(AlphaScanPath path); // False if the CPU lacks the requested path
+const char *GetAlphaScanPathName(AlphaScanPath path);
@@ -0,0 +1,118 @@
+// animation_player.c
+
+#include "animation_player.h"
+
+static AnimationPlayer players[MAX_ANIMATION_PLAYERS];   // Live players in [0, playerCount)
+static AnimationPlayerId slotOwners[MAX_ANIMATION_PLAYERS]; // Handle of the player in each slot
+static int handleSlots[MAX_ANIMATION_PLAYERS];           // Slot of each handle, -1 when free
+static AnimationPlayerId freeHandles[MAX_ANIMATION_PLAYERS];
+static int freeHandleCount = 0;
+static int handleCount = 0; // Handles ever issued since the last reset
+static int playerCount = 0;
+
+AnimationPlayerId CreateAnimationPlayer(AnimationClipId clip, bool playing)
+{
+    if (playerCount >= MAX_ANIMATION_PLAYERS)
+    {
+        printf("Max animation players reached!\n");
+        return INVALID_ANIMATION_PLAYER;
+    }
+
+    AnimationPlayerId id = freeHandleCount > 0 ? freeHandles[--freeHandleCount] : handleCount++;
+    int slot = playerCount++;
+    players[slot] = (AnimationPlayer){clip, 0.0f, 0, playing};
+    slotOwners[slot] = id;
+    handleSlots[id] = slot;
+    return id;
+}
+
+void ReleaseAnimationPlayer(AnimationPlayerId id)
+{
+    if (id < 0 || id >= handleCount || handleSlots[id] < 0)
+        return;
+
+    // Move the last player into the hole so the array stays packed
+    int slot = handleSlots[id];
+    int last = --playerCount;
+    players[slot] = players[last];
+    slotOwners[slot] = slotOwners[last];
+    handleSlots[slotOwners[slot]] = slot;
+
+    handleSlots[id] = -1;
+    freeHandles[freeHandleCount++] = id;
+}
+
+void ResetAnimationPlayers(void)
+{
+    playerCount = 0;
+    handleCount = 0;
+    freeHandleCount = 0;
+}
+
+int GetAnimationPlayerCount(void)
+{
+    return playerCount;
+}
+
+AnimationPlayer *GetAnimationPlayer(AnimationPlayerId id)
+{
+    if (id < 0 || id >= handleCount || handleSlots[id] < 0)
+        return NULL;
+    return &players[handleSlots[id]];
+}
+
+void PlayAnimationClip(AnimationPlayerId id, AnimationClipId clip)
+{
+    AnimationPlayer *player = GetAnimationPlayer(id);
+    if (player == NULL || player->clip == clip)
+        return;
+    player->clip = clip;
+    player->frame = 0;
+    player->elapsed = 0.0f;
+}
+
+void SetAnimationPlaying(AnimationPlayerId id, bool playing)
+{
+    AnimationPlayer *player = GetAnimationPlayer(id);
+    if (player)
+        player->playing = playing;
+}
+
+AnimationClip *GetPlayerClip(AssetManager *manager, AnimationPlayerId id)
+{
+    AnimationPlayer *player = GetAnimationPlayer(id);
+    return player ? GetAnimationById(manager, player->clip) : NULL;
+}
+
+void TickAnimationPlayers(const AssetManager *manager, float deltaTime)
+{
+    for (int i = 0; i < playerCount; i++)
+    {
+        AnimationPlayer *player = &players[i];
+        if (!player->playing || player->clip < 0 || player->clip >= manager->animationCount)
+            continue;
+
+        const AnimationClip *clip = &manager->animations[player->clip];
+        if (clip->frameCount <= 0 || clip->frameTime <= 0.0f)
+            continue;
+
+        int frame = player->frame;
+        player->elapsed += deltaTime;
+        if (player->elapsed >= clip->frameTime)
+        {
+            // Long frames (a hitch, fast-forward) skip ahead instead of looping once per frame
+            int steps = (int)(player->elapsed / clip->frameTime);
+            player->elapsed -= steps * clip->frameTime;
+            frame += steps;
+        }
+        player->frame = (unsigned short)(frame % clip->frameCount); // Also wraps after a hot reload shrank the clip
+    }
+}
+
+void DrawAnimationPlayer(AssetManager *manager, AnimationPlayerId id, Vector2 position, Color tint)
+{
+    AnimationPlayer *player = GetAnimationPlayer(id);
+    AnimationClip *clip = player ? GetAnimationById(manager, player->clip) : NULL;
+    if (clip)
+        DrawAnimationFrame(clip, player->frame, position, tint);
+}
@@ -0,0 +1,41 @@
+// animation_player.h
+
+#pragma once
+
+#include <stdbool.h>
+#include "asset_manager.h"
+
+#ifndef MAX_ANIMATION_PLAYERS
+#define MAX_ANIMATION_PLAYERS 32768
+#endif
+
+// Playback state of one animated instance; the frames themselves live in the shared AnimationClip
+typedef struct AnimationPlayer
+{
+    AnimationClipId clip;
+    float elapsed;        // Seconds into the current frame
+    unsigned short frame; // Current frame within the clip
+    bool playing;         // Paused players keep their frame and are skipped by the tick
+} AnimationPlayer;
+
+// Stable handle to a player. Players are kept packed in one array so TickAnimationPlayers
+// walks only the live ones, contiguously.
+typedef int AnimationPlayerId;
+#define INVALID_ANIMATION_PLAYER (-1)
+
+AnimationPlayerId CreateAnimationPlayer(AnimationClipId clip, bool playing);
+void ReleaseAnimationPlayer(AnimationPlayerId id);
+void ResetAnimationPlayers(void);
+int GetAnimationPlayerCount(void);
+AnimationPlayer *GetAnimationPlayer(AnimationPlayerId id);
+
+// Switches the clip and restarts it; does nothing if the player already shows that clip
+void PlayAnimationClip(AnimationPlayerId id, AnimationClipId clip);
+void SetAnimationPlaying(AnimationPlayerId id, bool playing);
+
+// Clip shown by a player, or NULL if the player or its clip is gone
+AnimationClip *GetPlayerClip(AssetManager *manager, AnimationPlayerId id);
+
+// Advances every playing player by deltaTime in one pass
+void TickAnimationPlayers(const AssetManager *manager, float deltaTime);
+void DrawAnimationPlayer(AssetManager *manager, AnimationPlayerId id, Vector2 position, Color tint);
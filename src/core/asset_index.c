@@ -0,0 +1,171 @@
+// asset_index.c
+
+#include "asset_index.h"
+#include "asset_manager.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MIN_INDEX_CAPACITY 64
+
+static unsigned long HashAssetKey(AssetKind kind, const char *name)
+{
+    // Mix the kind into the string hash so equal names of different kinds spread apart,
+    // then scramble the bits: djb2 alone clusters badly in the low bits used for the slot
+    unsigned long hash = HashString(name) ^ ((unsigned long)kind * 0x9E3779B9UL);
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6BUL;
+    hash ^= hash >> 13;
+    hash *= 0xC2B2AE35UL;
+    hash ^= hash >> 16;
+    return hash ? hash : 1;
+}
+
+static int CapacityFor(int count)
+{
+    int capacity = MIN_INDEX_CAPACITY;
+    while (capacity < count * 2)
+    {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+// Places an entry without checking for duplicates; returns the probe length used
+static int PlaceEntry(AssetIndexEntry *entries, int capacity, AssetIndexEntry entry)
+{
+    int mask = capacity - 1;
+    int slot = (int)(entry.hash & mask);
+    int probes = 0;
+
+    while (entries[slot].kind != ASSET_KIND_NONE)
+    {
+        slot = (slot + 1) & mask;
+        probes++;
+    }
+    entries[slot] = entry;
+    return probes;
+}
+
+static void GrowAssetIndex(AssetIndex *index, int newCapacity)
+{
+    AssetIndexEntry *entries = calloc(newCapacity, sizeof(AssetIndexEntry));
+    if (!entries)
+    {
+        fprintf(stderr, "Failed to allocate asset index (%d slots).\n", newCapacity);
+        exit(EXIT_FAILURE);
+    }
+
+    // Re-place everything and recompute the statistics for the new layout
+    index->collisions = 0;
+    index->maxProbeLength = 0;
+    for (int i = 0; i < index->capacity; i++)
+    {
+        if (index->entries[i].kind != ASSET_KIND_NONE)
+        {
+            int probes = PlaceEntry(entries, newCapacity, index->entries[i]);
+            if (probes > 0)
+                index->collisions++;
+            if (probes > index->maxProbeLength)
+                index->maxProbeLength = probes;
+        }
+    }
+
+    free(index->entries);
+    index->entries = entries;
+    index->capacity = newCapacity;
+}
+
+void InitAssetIndex(AssetIndex *index, int expectedCount)
+{
+    FreeAssetIndex(index);
+    index->capacity = CapacityFor(expectedCount);
+    index->entries = calloc(index->capacity, sizeof(AssetIndexEntry));
+    if (!index->entries)
+    {
+        fprintf(stderr, "Failed to allocate asset index (%d slots).\n", index->capacity);
+        exit(EXIT_FAILURE);
+    }
+}
+
+void FreeAssetIndex(AssetIndex *index)
+{
+    free(index->entries);
+    memset(index, 0, sizeof(AssetIndex));
+}
+
+// Returns the slot holding (kind, name), or -1; probeCount receives the slots inspected
+static int FindSlot(const AssetIndex *index, AssetKind kind, const char *name, long long *probeCount)
+{
+    unsigned long hash = HashAssetKey(kind, name);
+    int mask = index->capacity - 1;
+    int slot = (int)(hash & mask);
+
+    while (index->entries[slot].kind != ASSET_KIND_NONE)
+    {
+        const AssetIndexEntry *entry = &index->entries[slot];
+        (*probeCount)++;
+        if (entry->hash == hash && entry->kind == kind && strcmp(entry->name, name) == 0)
+        {
+            return slot;
+        }
+        slot = (slot + 1) & mask;
+    }
+    (*probeCount)++; // The empty slot that ended the search
+    return -1;
+}
+
+// Returns false if an asset of the same kind and name is already indexed; the first
+// registration wins, matching the old linear scan which returned the first match.
+bool AssetIndexInsert(AssetIndex *index, AssetKind kind, AssetId id, const char *name)
+{
+    if (index->entries == NULL)
+    {
+        InitAssetIndex(index, 0);
+    }
+    long long probes = 0;
+    if (FindSlot(index, kind, name, &probes) >= 0)
+    {
+        index->duplicates++;
+        return false;
+    }
+    if ((index->count + 1) * 2 > index->capacity)
+    {
+        GrowAssetIndex(index, index->capacity * 2);
+    }
+
+    AssetIndexEntry entry = {name, HashAssetKey(kind, name), kind, id};
+    int probeLength = PlaceEntry(index->entries, index->capacity, entry);
+    if (probeLength > 0)
+        index->collisions++;
+    if (probeLength > index->maxProbeLength)
+        index->maxProbeLength = probeLength;
+    index->count++;
+    return true;
+}
+
+AssetId AssetIndexFind(AssetIndex *index, AssetKind kind, const char *name)
+{
+    if (index->entries == NULL || name == NULL)
+    {
+        return INVALID_ASSET_ID;
+    }
+
+    index->lookups++;
+    int slot = FindSlot(index, kind, name, &index->lookupProbes);
+    return slot >= 0 ? index->entries[slot].id : INVALID_ASSET_ID;
+}
+
+void PrintAssetIndexStats(const AssetIndex *index)
+{
+    printf("Asset index: %d entries in %d slots (load %.2f)\n",
+           index->count, index->capacity,
+           index->capacity > 0 ? (float)index->count / index->capacity : 0.0f);
+    printf("  collisions: %d, longest probe: %d, duplicate names: %d\n",
+           index->collisions, index->maxProbeLength, index->duplicates);
+    if (index->lookups > 0)
+    {
+        printf("  lookups: %lld, average probes per lookup: %.2f\n",
+               index->lookups, (double)index->lookupProbes / index->lookups);
+    }
+}
@@ -0,0 +1,49 @@
+// asset_index.h
+
+#pragma once
+
+#include <stdbool.h>
+
+// Kind of asset an index entry refers to. Sprites and animations live in separate
+// namespaces, so "Foam" the sprite and "Foam" the animation never collide.
+typedef enum AssetKind
+{
+    ASSET_KIND_NONE,
+    ASSET_KIND_SPRITE,
+    ASSET_KIND_ANIMATION,
+    ASSET_KIND_TILEMAP
+} AssetKind;
+
+// Small integer handle to an asset: the slot in the manager's sprites/animations array
+typedef int AssetId;
+#define INVALID_ASSET_ID (-1)
+
+typedef struct AssetIndexEntry
+{
+    const char *name;   // Points at the name stored in the owning asset (not copied)
+    unsigned long hash; // Cached full hash of (kind, name)
+    AssetKind kind;     // ASSET_KIND_NONE marks an empty slot
+    AssetId id;
+} AssetIndexEntry;
+
+// Open-addressing (linear probing) name -> handle table. Capacity is a power of two
+// and grows with the asset count so the load factor stays at or below 50%.
+typedef struct AssetIndex
+{
+    AssetIndexEntry *entries;
+    int capacity;
+    int count;
+
+    // Collision statistics
+    int collisions;          // Inserts that could not use their home slot
+    int maxProbeLength;      // Longest probe sequence seen by an insert
+    int duplicates;          // Inserts rejected because (kind, name) was already present
+    long long lookups;       // Number of AssetIndexFind calls
+    long long lookupProbes;  // Total slots inspected by those calls
+} AssetIndex;
+
+void InitAssetIndex(AssetIndex *index, int expectedCount);
+void FreeAssetIndex(AssetIndex *index);
+bool AssetIndexInsert(AssetIndex *index, AssetKind kind, AssetId id, const char *name);
+AssetId AssetIndexFind(AssetIndex *index, AssetKind kind, const char *name);
+void PrintAssetIndexStats(const AssetIndex *index);
@@ -0,0 +1,387 @@
+// asset_loader.c
+
+#include "asset_loader.h"
+#include "asset_manager.h"
+#include "alpha_scan.h"
+#include "sim_clock.h"
+#include "tilemap.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+#define MAX_LOADER_THREADS 16
+
+typedef struct DecodeSlot
+{
+    DecodedAsset asset;
+    bool done;
+} DecodeSlot;
+
+typedef struct DecodePipeline
+{
+    char **filePaths;
+    int fileCount;
+    DecodeSlot *slots;
+    int nextToDecode;  // Next file a worker claims
+    int nextToConsume; // Next file handed to the handler, strictly in order
+    int window;        // Bounds decoded-but-unconsumed files, and with them peak memory
+
+    pthread_mutex_t lock;
+    pthread_cond_t decoded;
+    pthread_cond_t consumed;
+
+    double decodeSeconds;
+    long long pixelBytes;
+} DecodePipeline;
+
+int GetDefaultLoaderThreadCount(void)
+{
+#if defined(_WIN32)
+    int cpuCount = 4;
+#else
+    int cpuCount = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if (cpuCount < 1)
+        cpuCount = 1;
+    return cpuCount > MAX_LOADER_THREADS ? MAX_LOADER_THREADS : cpuCount;
+}
+
+// Reads, decodes and analyses one file. Touches no GPU state, so it is safe on any thread.
+bool DecodeAssetFile(const char *filePath, DecodedAsset *asset)
+{
+    return DecodeAssetFileAs(filePath, ClassifyAssetFile(filePath), asset);
+}
+
+// Same as DecodeAssetFile, for callers that already know what the file should be loaded as
+bool DecodeAssetFileAs(const char *filePath, AssetKind kind, DecodedAsset *asset)
+{
+    double startTime = GetMonotonicSeconds();
+
+    memset(asset, 0, sizeof(DecodedAsset));
+    asset->filePath = filePath;
+    asset->kind = kind;
+
+    asset->image = LoadImage(filePath);
+    if (asset->image.data == NULL)
+    {
+        asset->decodeSeconds = GetMonotonicSeconds() - startTime;
+        return false;
+    }
+    if (asset->image.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8)
+    {
+        ImageFormat(&asset->image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    }
+
+    ParseAnimationInfoFromFilename(filePath, asset->name, &asset->rows, &asset->framesPerRow,
+                                   &asset->frameWidth, &asset->frameHeight);
+
+    if (asset->kind == ASSET_KIND_ANIMATION && (asset->rows <= 0 || asset->framesPerRow <= 0))
+    {
+        asset->rows = 0; // No usable layout in the file name; nothing to register
+    }
+    else if (asset->kind == ASSET_KIND_ANIMATION)
+    {
+        asset->rowFrameCounts = calloc(asset->rows, sizeof(int));
+        asset->frames = malloc(asset->rows * asset->framesPerRow * sizeof(Rectangle));
+
+        int frameCount = 0;
+        for (int row = 0; row < asset->rows; row++)
+        {
+            for (int x = 0; x < asset->framesPerRow; x++)
+            {
+                Rectangle frame = (Rectangle){x * asset->frameWidth, row * asset->frameHeight, asset->frameWidth, asset->frameHeight};
+                // In-place SIMD scan that stops at the first visible pixel
+                if (frame.x + frame.width <= asset->image.width && frame.y + frame.height <= asset->image.height &&
+                    !IsRegionTransparent(asset->image, frame))
+                {
+                    asset->frames[frameCount++] = frame;
+                    asset->rowFrameCounts[row]++;
+                }
+            }
+        }
+    }
+    else if (asset->kind == ASSET_KIND_TILEMAP)
+    {
+        asset->tileRects = SliceTilemap(asset->image.width, asset->image.height, TILEMAP_TILE_SIZE,
+                                        &asset->tileCountX, &asset->tileCountY);
+    }
+
+    asset->decodeSeconds = GetMonotonicSeconds() - startTime;
+    return true;
+}
+
+void FreeDecodedAsset(DecodedAsset *asset)
+{
+    if (asset->image.data != NULL)
+    {
+        UnloadImage(asset->image);
+        asset->image.data = NULL;
+    }
+    free(asset->rowFrameCounts);
+    free(asset->frames);
+    free(asset->tileRects);
+    asset->rowFrameCounts = NULL;
+    asset->frames = NULL;
+    asset->tileRects = NULL;
+}
+
+static void *DecodeWorker(void *arg)
+{
+    DecodePipeline *pipeline = arg;
+
+    pthread_mutex_lock(&pipeline->lock);
+    for (;;)
+    {
+        while (pipeline->nextToDecode < pipeline->fileCount &&
+               pipeline->nextToDecode >= pipeline->nextToConsume + pipeline->window)
+        {
+            pthread_cond_wait(&pipeline->consumed, &pipeline->lock);
+        }
+        if (pipeline->nextToDecode >= pipeline->fileCount)
+            break;
+
+        int i = pipeline->nextToDecode++;
+        pthread_mutex_unlock(&pipeline->lock);
+
+        DecodeSlot *slot = &pipeline->slots[i];
+        DecodeAssetFile(pipeline->filePaths[i], &slot->asset);
+
+        pthread_mutex_lock(&pipeline->lock);
+        slot->done = true;
+        pipeline->decodeSeconds += slot->asset.decodeSeconds;
+        pipeline->pixelBytes += (long long)slot->asset.image.width * slot->asset.image.height * 4;
+        pthread_cond_broadcast(&pipeline->decoded);
+    }
+    pthread_mutex_unlock(&pipeline->lock);
+    return NULL;
+}
+
+// Decodes the files on threadCount workers and hands each result to the handler on the
+// calling thread in file order, so asset indices never depend on which worker finished
+// first. threadCount <= 1 decodes serially on the calling thread.
+AssetDecodeStats DecodeAssetFiles(char **filePaths, int fileCount, int threadCount, DecodedAssetHandler handler, void *userData)
+{
+    AssetDecodeStats stats = {0};
+    stats.fileCount = fileCount;
+    double startTime = GetMonotonicSeconds();
+
+    if (threadCount > MAX_LOADER_THREADS)
+        threadCount = MAX_LOADER_THREADS;
+    if (threadCount > fileCount)
+        threadCount = fileCount;
+
+    if (threadCount <= 1)
+    {
+        stats.threadCount = 1;
+        for (int i = 0; i < fileCount; i++)
+        {
+            DecodedAsset asset;
+            DecodeAssetFile(filePaths[i], &asset);
+            stats.decodeSeconds += asset.decodeSeconds;
+            stats.pixelBytes += (long long)asset.image.width * asset.image.height * 4;
+            if (handler)
+                handler(&asset, userData);
+            FreeDecodedAsset(&asset);
+        }
+        stats.wallSeconds = GetMonotonicSeconds() - startTime;
+        return stats;
+    }
+
+    DecodePipeline pipeline = {0};
+    pipeline.filePaths = filePaths;
+    pipeline.fileCount = fileCount;
+    pipeline.window = threadCount * 2;
+    pipeline.slots = calloc(fileCount, sizeof(DecodeSlot));
+    pthread_mutex_init(&pipeline.lock, NULL);
+    pthread_cond_init(&pipeline.decoded, NULL);
+    pthread_cond_init(&pipeline.consumed, NULL);
+
+    pthread_t workers[MAX_LOADER_THREADS];
+    int workerCount = 0;
+    for (int i = 0; i < threadCount; i++)
+    {
+        if (pthread_create(&workers[workerCount], NULL, DecodeWorker, &pipeline) == 0)
+            workerCount++;
+    }
+    if (workerCount == 0)
+    {
+        // No threads available; fall back to the serial path
+        pthread_cond_destroy(&pipeline.consumed);
+        pthread_cond_destroy(&pipeline.decoded);
+        pthread_mutex_destroy(&pipeline.lock);
+        free(pipeline.slots);
+        return DecodeAssetFiles(filePaths, fileCount, 1, handler, userData);
+    }
+    stats.threadCount = workerCount;
+
+    for (int i = 0; i < fileCount; i++)
+    {
+        pthread_mutex_lock(&pipeline.lock);
+        while (!pipeline.slots[i].done)
+        {
+            pthread_cond_wait(&pipeline.decoded, &pipeline.lock);
+        }
+        pthread_mutex_unlock(&pipeline.lock);
+
+        if (handler)
+            handler(&pipeline.slots[i].asset, userData);
+        FreeDecodedAsset(&pipeline.slots[i].asset);
+
+        pthread_mutex_lock(&pipeline.lock);
+        pipeline.nextToConsume = i + 1;
+        pthread_cond_broadcast(&pipeline.consumed);
+        pthread_mutex_unlock(&pipeline.lock);
+    }
+
+    for (int i = 0; i < workerCount; i++)
+    {
+        pthread_join(workers[i], NULL);
+    }
+
+    stats.decodeSeconds = pipeline.decodeSeconds;
+    stats.pixelBytes = pipeline.pixelBytes;
+    stats.wallSeconds = GetMonotonicSeconds() - startTime;
+
+    pthread_cond_destroy(&pipeline.consumed);
+    pthread_cond_destroy(&pipeline.decoded);
+    pthread_mutex_destroy(&pipeline.lock);
+    free(pipeline.slots);
+    return stats;
+}
+
+// Runs only the CPU stages (read, decode, blank-frame analysis, slicing) and discards
+// the results. Needs no window or GPU, so it can be benchmarked on a headless machine.
+AssetDecodeStats DecodeAssetsHeadless(const char *directory, int threadCount)
+{
+    char **filePaths;
+    int fileCount = CollectAssetFiles(directory, &filePaths);
+    AssetDecodeStats stats = DecodeAssetFiles(filePaths, fileCount, threadCount, NULL, NULL);
+    FreeAssetFileList(filePaths, fileCount);
+    return stats;
+}
+
+AssetLoadRecord *BeginAssetLoadRecord(AssetLoadReport *report, const char *filePath, AssetKind kind, Image image, double decodeSeconds)
+{
+    if (report->count == report->capacity)
+    {
+        int capacity = report->capacity ? report->capacity * 2 : 256;
+        AssetLoadRecord *records = realloc(report->records, capacity * sizeof(AssetLoadRecord));
+        if (!records)
+            return NULL;
+        report->records = records;
+        report->capacity = capacity;
+    }
+
+    const char *fileName = strrchr(filePath, '/');
+    fileName = fileName ? fileName + 1 : filePath;
+
+    AssetLoadRecord *record = &report->records[report->count++];
+    memset(record, 0, sizeof(AssetLoadRecord));
+    strncpy(record->fileName, fileName, sizeof(record->fileName) - 1);
+    record->kind = kind;
+    record->pixelBytes = GetPixelDataSize(image.width, image.height, image.format);
+    record->decodeSeconds = decodeSeconds;
+    return record;
+}
+
+// The single place load paths create textures, so every upload is counted
+Texture2D UploadAssetTexture(Image image, AssetLoadRecord *record)
+{
+    double startTime = GetMonotonicSeconds();
+    Texture2D texture = LoadTextureFromImage(image);
+    if (record && texture.id != 0)
+    {
+        record->textureCount++;
+        record->uploadBytes += GetPixelDataSize(image.width, image.height, image.format);
+        record->uploadSeconds += GetMonotonicSeconds() - startTime;
+    }
+    return texture;
+}
+
+static const char *AssetKindName(AssetKind kind)
+{
+    switch (kind)
+    {
+    case ASSET_KIND_SPRITE:
+        return "sprite";
+    case ASSET_KIND_ANIMATION:
+        return "animation";
+    case ASSET_KIND_TILEMAP:
+        return "tilemap";
+    default:
+        return "other";
+    }
+}
+
+// What the old LoadTexture + LoadImageFromTexture path transferred for the same file: every
+// sheet was uploaded whole, animations and tilemaps were read straight back, and tilemaps
+// then uploaded every tile again on top of the discarded sheet texture. Atlas pages
+// (ASSET_KIND_NONE) did not exist.
+static void GetLegacyTransferBytes(const AssetLoadRecord *record, long long *uploadBytes, long long *readbackBytes)
+{
+    *uploadBytes = 0;
+    *readbackBytes = 0;
+    if (record->kind == ASSET_KIND_NONE)
+        return;
+
+    *uploadBytes = record->pixelBytes;
+    if (record->kind == ASSET_KIND_ANIMATION || record->kind == ASSET_KIND_TILEMAP)
+        *readbackBytes = record->pixelBytes;
+    if (record->kind == ASSET_KIND_TILEMAP)
+        *uploadBytes += record->pixelBytes;
+}
+
+void PrintAssetLoadReport(const AssetLoadReport *report, FILE *out, bool perAsset)
+{
+    const double MB = 1024.0 * 1024.0;
+    long long uploadBytes = 0, readbackBytes = 0, legacyUploadBytes = 0, legacyReadbackBytes = 0;
+    double decodeSeconds = 0.0, uploadSeconds = 0.0;
+    int textureCount = 0, fileCount = 0;
+
+    if (perAsset)
+    {
+        fprintf(out, "%-40s %-9s %9s %9s %5s %11s %11s %11s %11s\n", "file", "kind", "decode ms", "upload ms", "tex",
+                "upload KB", "readback KB", "was upload", "was readbk");
+    }
+    for (int i = 0; i < report->count; i++)
+    {
+        const AssetLoadRecord *record = &report->records[i];
+        long long legacyUpload, legacyReadback;
+        GetLegacyTransferBytes(record, &legacyUpload, &legacyReadback);
+
+        uploadBytes += record->uploadBytes;
+        readbackBytes += record->readbackBytes;
+        legacyUploadBytes += legacyUpload;
+        legacyReadbackBytes += legacyReadback;
+        decodeSeconds += record->decodeSeconds;
+        uploadSeconds += record->uploadSeconds;
+        textureCount += record->textureCount;
+        fileCount += record->kind != ASSET_KIND_NONE;
+
+        if (perAsset)
+        {
+            fprintf(out, "%-40.40s %-9s %9.2f %9.2f %5d %11.1f %11.1f %11.1f %11.1f\n", record->fileName,
+                    AssetKindName(record->kind), record->decodeSeconds * 1000.0, record->uploadSeconds * 1000.0,
+                    record->textureCount, record->uploadBytes / 1024.0, record->readbackBytes / 1024.0,
+                    legacyUpload / 1024.0, legacyReadback / 1024.0);
+        }
+    }
+
+    fprintf(out, "Asset load: %d files, %d textures, decode %.1f ms (CPU), upload %.1f ms\n", fileCount, textureCount,
+            decodeSeconds * 1000.0, uploadSeconds * 1000.0);
+    fprintf(out, "  GPU traffic: %.1f MB uploaded, %.1f MB read back (readback path: %.1f MB uploaded, %.1f MB read back)\n",
+            uploadBytes / MB, readbackBytes / MB, legacyUploadBytes / MB, legacyReadbackBytes / MB);
+}
+
+void FreeAssetLoadReport(AssetLoadReport *report)
+{
+    free(report->records);
+    report->records = NULL;
+    report->count = 0;
+    report->capacity = 0;
+}
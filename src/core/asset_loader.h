@@ -0,0 +1,79 @@
+// asset_loader.h
+
+#pragma once
+
+#include "raylib.h"
+#include "asset_index.h"
+#include <stdbool.h>
+#include <stdio.h>
+
+// Everything the CPU stages produce for one asset file. Built on a worker thread,
+// consumed (uploaded, baked or discarded) on the thread that started the pipeline.
+typedef struct DecodedAsset
+{
+    const char *filePath;
+    AssetKind kind;
+    char name[64];      // Base name parsed from the file name
+    Image image;        // RGBA8 pixels; image.data is NULL if decoding failed
+
+    // Animations: layout parsed from the file name
+    int rows;
+    int framesPerRow;
+    int frameWidth;
+    int frameHeight;
+    int *rowFrameCounts; // Non-blank frames in each row
+    Rectangle *frames;   // Non-blank frames of every row, row after row
+
+    // Tilemaps: pre-sliced tile rectangles
+    int tileCountX;
+    int tileCountY;
+    Rectangle *tileRects;
+
+    double decodeSeconds; // Time spent reading, decoding and analysing this file
+} DecodedAsset;
+
+// Called on the pipeline's calling thread, once per file, in file order. The pipeline
+// frees the asset afterwards; set asset->image.data to NULL to keep the pixels.
+typedef void (*DecodedAssetHandler)(DecodedAsset *asset, void *userData);
+
+typedef struct AssetDecodeStats
+{
+    int fileCount;
+    int threadCount;
+    double wallSeconds;   // Start of the first decode to the last handler call
+    double decodeSeconds; // Sum of per-file decode time over all workers
+    long long pixelBytes; // Decoded RGBA8 bytes
+} AssetDecodeStats;
+
+// Per-file load cost, filled in as the asset is uploaded on the main thread
+typedef struct AssetLoadRecord
+{
+    char fileName[64];
+    AssetKind kind;
+    long long pixelBytes;    // Decoded RGBA8 size of the source sheet
+    int textureCount;        // Textures created for this file
+    long long uploadBytes;   // Bytes sent to the GPU
+    long long readbackBytes; // Bytes read back from the GPU; the load paths no longer do this
+    double decodeSeconds;
+    double uploadSeconds;
+} AssetLoadRecord;
+
+typedef struct AssetLoadReport
+{
+    AssetLoadRecord *records;
+    int count;
+    int capacity;
+} AssetLoadReport;
+
+int GetDefaultLoaderThreadCount(void);
+bool DecodeAssetFile(const char *filePath, DecodedAsset *asset);
+bool DecodeAssetFileAs(const char *filePath, AssetKind kind, DecodedAsset *asset);
+void FreeDecodedAsset(DecodedAsset *asset);
+AssetDecodeStats DecodeAssetFiles(char **filePaths, int fileCount, int threadCount, DecodedAssetHandler handler, void *userData);
+AssetDecodeStats DecodeAssetsHeadless(const char *directory, int threadCount);
+
+// The returned record stays valid until the next BeginAssetLoadRecord on the same report
+AssetLoadRecord *BeginAssetLoadRecord(AssetLoadReport *report, const char *filePath, AssetKind kind, Image image, double decodeSeconds);
+Texture2D UploadAssetTexture(Image image, AssetLoadRecord *record);
+void PrintAssetLoadReport(const AssetLoadReport *report, FILE *out, bool perAsset);
+void FreeAssetLoadReport(AssetLoadReport *report);
@@ -10,52 +10,48 @@
 #include <stdlib.h>
 #include "tilemap.h"
 #include "asset_manager.h"
+#include "asset_loader.h"
+#include "alpha_scan.h"
 #include "raylib_utils.h"
 
-void AddAssetToHashTable(AssetManager *manager, const char *name, Sprite sprite)
+AssetId FindSpriteId(AssetManager *manager, const char *name)
 {
-    unsigned long hash = HashString(name) % HASH_TABLE_SIZE;
-
-    AssetNode *newNode = (AssetNode *)malloc(sizeof(AssetNode));
-    strncpy(newNode->name, name, 64);
-    newNode->sprite = sprite; // Store the sprite directly
-    newNode->next = manager->hashTable[hash];
-    manager->hashTable[hash] = newNode;
+    return AssetIndexFind(&manager->index, ASSET_KIND_SPRITE, name);
 }
 
-void AddAnimationToHashTable(AssetManager *manager, const char *name, Animation animation)
+AssetId FindAnimationId(AssetManager *manager, const char *name)
 {
-    unsigned long hash = HashString(name) % HASH_TABLE_SIZE;
-
-    AssetNode *newNode = (AssetNode *)malloc(sizeof(AssetNode));
-    strncpy(newNode->name, name, 64);
-    newNode->animation = animation; // Store the animation directly
-    newNode->next = manager->hashTable[hash];
-    manager->hashTable[hash] = newNode;
+    return AssetIndexFind(&manager->index, ASSET_KIND_ANIMATION, name);
 }
 
-Sprite GetSprite(AssetManager *manager, const char *name)
+Sprite *GetSpriteById(AssetManager *manager, AssetId id)
 {
-    for (int i = 0; i < manager->spriteCount; i++)
+    if (id < 0 || id >= manager->spriteCount)
     {
-        if (strcmp(manager->sprites[i].name, name) == 0)
-        {
-            return manager->sprites[i]; // Return the sprite directly from the array
-        }
+        return NULL;
     }
-    return (Sprite){0}; // Return a default sprite if not found
+    return &manager->sprites[id];
 }
 
-Animation GetAnimation(AssetManager *manager, const char *name)
+AnimationClip *GetAnimationById(AssetManager *manager, AssetId id)
 {
-    for (int i = 0; i < manager->animationCount; i++)
+    if (id < 0 || id >= manager->animationCount)
     {
-        if (strcmp(manager->animations[i].name, name) == 0)
-        {
-            return manager->animations[i]; // Return the animation directly from the array
-        }
+        return NULL;
     }
-    return (Animation){0}; // Return a default animation if not found
+    return &manager->animations[id];
+}
+
+Sprite GetSprite(AssetManager *manager, const char *name)
+{
+    Sprite *sprite = GetSpriteById(manager, FindSpriteId(manager, name));
+    return sprite ? *sprite : (Sprite){0}; // Return a default sprite if not found
+}
+
+AnimationClip GetAnimation(AssetManager *manager, const char *name)
+{
+    AnimationClip *animation = GetAnimationById(manager, FindAnimationId(manager, name));
+    return animation ? *animation : (AnimationClip){0}; // Return a default animation if not found
 }
 
 void PrintAllAnimationNames(AssetManager *manager)
@@ -67,6 +63,27 @@ void PrintAllAnimationNames(AssetManager *manager)
     }
 }
 
+// strtok-style split on '_' that keeps its state in the caller, so loader threads can parse in parallel
+static char *NextFilenameToken(char **cursor)
+{
+    char *start = *cursor;
+    while (*start == '_')
+        start++;
+    if (*start == '\0')
+    {
+        *cursor = start;
+        return NULL;
+    }
+
+    char *end = start;
+    while (*end != '\0' && *end != '_')
+        end++;
+    if (*end != '\0')
+        *end++ = '\0';
+    *cursor = end;
+    return start;
+}
+
 // Function to parse the filename and extract animation data
 // Modified function to parse filename and extract name, rows, framesPerRow, frameWidth, frameHeight
 void ParseAnimationInfoFromFilename(const char *filePath, char *name, int *rows, int *framesPerRow, int *frameWidth, int *frameHeight)
@@ -96,24 +113,25 @@ void ParseAnimationInfoFromFilename(const char *filePath, char *name, int *rows,
     }
 
     // Tokenize the filename using '_' as a delimiter
-    char *token = strtok(nameWithoutExtension, "_");
+    char *cursor = nameWithoutExtension;
+    char *token = NextFilenameToken(&cursor);
     if (token)
     {
         strncpy(name, token, 64); // Extract the name (first part of the filename)
         name[63] = '\0';          // Ensure the name is null-terminated
     }
 
-    token = strtok(NULL, "_");
-    if (token)
+    token = NextFilenameToken(&cursor);
+    if (token && rows)
         *rows = atoi(token); // Extract the number of rows
-    token = strtok(NULL, "_");
-    if (token)
+    token = NextFilenameToken(&cursor);
+    if (token && framesPerRow)
         *framesPerRow = atoi(token); // Extract the number of frames per row
-    token = strtok(NULL, "_");
-    if (token)
+    token = NextFilenameToken(&cursor);
+    if (token && frameWidth)
         *frameWidth = atoi(token); // Extract the frame width
-    token = strtok(NULL, "_");
-    if (token)
+    token = NextFilenameToken(&cursor);
+    if (token && frameHeight)
         *frameHeight = atoi(token); // Extract the frame height
 }
 
@@ -124,19 +142,29 @@ void InitAssetManager(AssetManager *manager)
     manager->spriteCount = 0;
     manager->animationCount = 0;
     manager->tilemapCount = 0;
+    manager->loadReport = (AssetLoadReport){0};
+    manager->useAtlas = true;
+    manager->atlasBuilding = false;
+    manager->generation = 0;
+    manager->animationTime = 0.0;
+    InitTextureAtlas(&manager->atlas);
+    InitAssetIndex(&manager->index, 0);
 }
 
 bool IsFrameBlank(Image fullImage, Rectangle frame)
 {
-    // Extract the frame as a sub-image
-    Image frameImage = ImageFromImage(fullImage, frame);
+    // Decoded sheets are RGBA8: scan the frame in place
+    if (fullImage.format == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8)
+    {
+        return IsRegionTransparent(fullImage, frame);
+    }
 
-    // Load pixel colors
+    // Other formats: extract the frame as a sub-image and convert it to colors
+    Image frameImage = ImageFromImage(fullImage, frame);
     Color *pixels = LoadImageColors(frameImage);
     int totalPixels = frameImage.width * frameImage.height;
 
     bool isBlank = true;
-
     for (int i = 0; i < totalPixels; i++)
     {
         if (pixels[i].a > 0)
@@ -145,67 +173,128 @@ bool IsFrameBlank(Image fullImage, Rectangle frame)
             break; // Exit early as we found a non-transparent pixel
         }
     }
-        
-    // Free image data
+
     UnloadImageColors(pixels);
     UnloadImage(frameImage);
-
     return isBlank;
 }
 
-void LoadSprite(AssetManager *manager, const char *filePath)
+AssetId AddSprite(AssetManager *manager, Texture2D texture, const char *name)
 {
-    if (manager->spriteCount < MAX_SPRITES)
-    {
-        manager->sprites[manager->spriteCount].texture = LoadTexture(filePath);
-
-        // Extract the name from the filename
-        char name[64];
-        ParseAnimationInfoFromFilename(filePath, name, NULL, NULL, NULL, NULL); // We only need the name part here
-        strncpy(manager->sprites[manager->spriteCount].name, name, 64);
-        manager->sprites[manager->spriteCount].drawName = true; // Set this flag as needed
-
-        // Add the loaded sprite to the hash table for fast lookup
-        AddAssetToHashTable(manager, name, manager->sprites[manager->spriteCount]);
-
-        manager->spriteCount++;
-    }
-    else
+    if (manager->spriteCount >= MAX_SPRITES)
     {
         printf("Max sprites loaded!\n");
+        return INVALID_ASSET_ID;
     }
+
+    AssetId id = manager->spriteCount;
+    Sprite *sprite = &manager->sprites[id];
+    sprite->texture = texture;
+    sprite->source = (Rectangle){0, 0, texture.width, texture.height};
+    sprite->offset = (Vector2){0, 0};
+    sprite->width = texture.width;
+    sprite->height = texture.height;
+    sprite->atlasPage = -1;
+    strncpy(sprite->name, name, sizeof(sprite->name));
+    sprite->name[sizeof(sprite->name) - 1] = '\0';
+    sprite->drawName = true; // Set this flag as needed
+    sprite->generation = manager->generation;
+
+    // Index the sprite by name for fast lookup
+    AssetIndexInsert(&manager->index, ASSET_KIND_SPRITE, id, sprite->name);
+
+    manager->spriteCount++;
+    return id;
 }
 
-void LoadAnimation(AssetManager *manager, const char *filePath)
+AssetId AddAnimation(AssetManager *manager, Texture2D texture, const char *name, const Rectangle *frames, int frameCount,
+                     int frameWidth, int frameHeight, int framesPerRow)
 {
     if (manager->animationCount >= MAX_ANIMATIONS)
     {
         printf("Max animations loaded!\n");
-        return;
+        return INVALID_ASSET_ID;
     }
 
-    Texture2D texture = LoadTexture(filePath);
-    if (texture.id == 0)
+    AssetId id = manager->animationCount;
+    AnimationClip *animation = &manager->animations[id];
+    animation->texture = texture;
+    strncpy(animation->name, name, sizeof(animation->name));
+    animation->name[sizeof(animation->name) - 1] = '\0';
+    animation->drawName = true;
+
+    // Set frame details
+    animation->frameWidth = frameWidth;
+    animation->frameHeight = frameHeight;
+    animation->rows = 1; // Each row is treated as its own "single-row" animation
+    animation->framesPerRow = framesPerRow;
+    animation->frameCount = frameCount;
+    animation->frameTime = 0.1f; // 100 ms
+    animation->frameOffsets = NULL;
+    animation->atlasPage = -1;
+
+    // Allocate memory for frames and copy each valid frame's rectangle
+    animation->frames = malloc(frameCount * sizeof(Rectangle));
+    if (!animation->frames)
     {
-        printf("Failed to load texture: %s\n", filePath);
-        return;
+        printf("Memory allocation failed for frames of animation '%s'. Skipping.\n", name);
+        return INVALID_ASSET_ID;
     }
+    memcpy(animation->frames, frames, frameCount * sizeof(Rectangle));
 
-    // Variables to hold parsed information
-    int rows, framesPerRow, frameWidth, frameHeight;
-    char baseName[64];
+    // Index this animation by its unique name
+    AssetIndexInsert(&manager->index, ASSET_KIND_ANIMATION, id, animation->name);
+
+    manager->animationCount++;
+    return id;
+}
+
+// Registers a decoded sprite: packed into the atlas while one is being built, otherwise
+// uploaded as a texture of its own
+AssetId RegisterSpriteImage(AssetManager *manager, Image image, const char *name, AssetLoadRecord *record)
+{
+    AtlasRegion region;
+    Rectangle whole = {0, 0, image.width, image.height};
+    if (!manager->atlasBuilding || !AtlasPackGroup(&manager->atlas, image, &whole, 1, true, &region))
+    {
+        return AddSprite(manager, UploadAssetTexture(image, record), name);
+    }
 
-    // Parse the filename to get name, rows, framesPerRow, frameWidth, frameHeight
-    ParseAnimationInfoFromFilename(filePath, baseName, &rows, &framesPerRow, &frameWidth, &frameHeight);
+    AssetId id = AddSprite(manager, (Texture2D){0}, name); // Texture assigned by FinishAssetAtlas
+    if (id != INVALID_ASSET_ID)
+    {
+        Sprite *sprite = &manager->sprites[id];
+        sprite->source = region.source;
+        sprite->offset = region.offset;
+        sprite->width = image.width;
+        sprite->height = image.height;
+        sprite->atlasPage = region.page;
+    }
+    return id;
+}
 
-    // Load the full image once to optimize frame checks
-    Image fullImage = LoadImageFromTexture(texture);
-    if (fullImage.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8)
+// Registers one animation per sheet row ("<baseName>_<row>"), skipping rows without frames.
+// frames holds the non-blank frames of every row, row after row.
+void RegisterAnimationSheet(AssetManager *manager, Image image, const char *baseName, int rows, const int *rowFrameCounts,
+                            const Rectangle *frames, int frameWidth, int frameHeight, int framesPerRow, AssetLoadRecord *record)
+{
+    Texture2D texture = {0};
+    const Rectangle *rowFrames = frames;
+    AtlasRegion *regions = NULL;
+    Rectangle *packedFrames = NULL;
+    if (manager->atlasBuilding && framesPerRow > 0)
     {
-        ImageFormat(&fullImage, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+        regions = malloc(framesPerRow * sizeof(AtlasRegion));
+        packedFrames = malloc(framesPerRow * sizeof(Rectangle));
+        if (!regions || !packedFrames)
+        {
+            free(regions);
+            free(packedFrames);
+            regions = NULL;
+            packedFrames = NULL;
+        }
     }
 
-    // Loop through each row to create a separate animation
     for (int row = 0; row < rows; row++)
     {
         if (manager->animationCount >= MAX_ANIMATIONS)
@@ -218,68 +307,318 @@ void LoadAnimation(AssetManager *manager, const char *filePath)
         char animationName[64];
         snprintf(animationName, sizeof(animationName), "%s_%d", baseName, row + 1);
 
-        // Temporary list to store non-blank frames
-        Rectangle *validFrames = malloc(framesPerRow * sizeof(Rectangle));
-        if (!validFrames)
+        int validFrameCount = rowFrameCounts[row];
+        if (validFrameCount == 0)
         {
-            printf("Memory allocation failed for frames of animation '%s'. Skipping.\n", animationName);
+            printf("All frames in animation '%s' are blank. Skipping.\n", animationName);
             continue;
         }
-        int validFrameCount = 0;
 
-        // Iterate through each frame in the row
-        for (int x = 0; x < framesPerRow; x++)
+        // Atlas: each row's frames are trimmed and packed together onto one page
+        if (regions && validFrameCount <= framesPerRow &&
+            AtlasPackGroup(&manager->atlas, image, rowFrames, validFrameCount, true, regions))
+        {
+            for (int i = 0; i < validFrameCount; i++)
+            {
+                packedFrames[i] = regions[i].source;
+            }
+
+            AssetId id = AddAnimation(manager, (Texture2D){0}, animationName, packedFrames, validFrameCount,
+                                      frameWidth, frameHeight, framesPerRow);
+            AnimationClip *animation = GetAnimationById(manager, id);
+            if (animation)
+            {
+                animation->atlasPage = regions[0].page;
+                animation->frameOffsets = malloc(validFrameCount * sizeof(Vector2));
+                for (int i = 0; animation->frameOffsets && i < validFrameCount; i++)
+                {
+                    // Offset of the trimmed pixels within the frame's cell
+                    animation->frameOffsets[i] = regions[i].offset;
+                }
+            }
+        }
+        else
         {
-            Rectangle frame = (Rectangle){x * frameWidth, row * frameHeight, frameWidth, frameHeight};
-            if (!IsFrameBlank(fullImage, frame))
+            // Upload the sheet once, on its first row that needs it
+            if (texture.id == 0)
             {
-                validFrames[validFrameCount++] = frame;
+                texture = UploadAssetTexture(image, record);
             }
+            AddAnimation(manager, texture, animationName, rowFrames, validFrameCount, frameWidth, frameHeight, framesPerRow);
         }
+        rowFrames += validFrameCount;
+    }
+    free(regions);
+    free(packedFrames);
+}
+
+static bool IsTextureInUse(const AssetManager *manager, unsigned int textureId)
+{
+    for (int i = 0; i < manager->animationCount; i++)
+    {
+        if (manager->animations[i].texture.id == textureId)
+            return true;
+    }
+    return false;
+}
+
+// Swaps a re-decoded sheet in behind the animations registered under its rows' names
+static void ReloadAnimationSheet(AssetManager *manager, const DecodedAsset *asset, AssetLoadRecord *record)
+{
+    Texture2D texture = UploadAssetTexture(asset->image, record);
+    Texture2D oldTextures[16]; // Distinct standalone textures the rows used before; normally one sheet
+    int oldTextureCount = 0;
+    const Rectangle *rowFrames = asset->frames;
 
-        // If no valid frames, skip this animation
+    for (int row = 0; row < asset->rows; row++)
+    {
+        int validFrameCount = asset->rowFrameCounts[row];
         if (validFrameCount == 0)
+            continue; // A row that went blank keeps its old frames
+
+        char animationName[64];
+        snprintf(animationName, sizeof(animationName), "%s_%d", asset->name, row + 1);
+        AnimationClip *animation = GetAnimationById(manager, FindAnimationId(manager, animationName));
+        if (animation == NULL)
         {
-            printf("All frames in animation '%s' are blank. Skipping.\n", animationName);
-            free(validFrames);
+            AddAnimation(manager, texture, animationName, rowFrames, validFrameCount, asset->frameWidth,
+                         asset->frameHeight, asset->framesPerRow);
+            rowFrames += validFrameCount;
+            continue;
+        }
+
+        Rectangle *frames = malloc(validFrameCount * sizeof(Rectangle));
+        if (!frames)
+        {
+            rowFrames += validFrameCount;
             continue;
         }
+        memcpy(frames, rowFrames, validFrameCount * sizeof(Rectangle));
 
-        // Initialize the animation struct for this row
-        Animation *animation = &manager->animations[manager->animationCount];
+        bool seen = animation->atlasPage >= 0;
+        for (int i = 0; i < oldTextureCount && !seen; i++)
+        {
+            seen = oldTextures[i].id == animation->texture.id;
+        }
+        if (!seen && oldTextureCount < 16)
+            oldTextures[oldTextureCount++] = animation->texture;
+        free(animation->frames);
+        free(animation->frameOffsets);
         animation->texture = texture;
-        strncpy(animation->name, animationName, sizeof(animation->name));
-        animation->drawName = true;
-
-        // Set frame details
-        animation->frameWidth = frameWidth;
-        animation->frameHeight = frameHeight;
-        animation->rows = 1; // Each row is treated as its own "single-row" animation
-        animation->framesPerRow = framesPerRow;
+        animation->frames = frames;
+        animation->frameOffsets = NULL;
         animation->frameCount = validFrameCount;
-        animation->currentFrame = 0;
-        animation->frameTime = 0.1f; // 100 ms
-        animation->elapsedTime = 0.0f;
+        animation->frameWidth = asset->frameWidth;
+        animation->frameHeight = asset->frameHeight;
+        animation->framesPerRow = asset->framesPerRow;
+        animation->atlasPage = -1; // Players past the new frame count wrap on their next tick
+        rowFrames += validFrameCount;
+    }
+
+    // The old sheet texture may still back rows the new file no longer has
+    for (int i = 0; i < oldTextureCount; i++)
+    {
+        if (oldTextures[i].id != 0 && !IsTextureInUse(manager, oldTextures[i].id))
+            UnloadTexture(oldTextures[i]);
+    }
+    if (!IsTextureInUse(manager, texture.id))
+        UnloadTexture(texture); // Every row was blank
+}
+
+// Hot reload: swaps a re-decoded file in behind the handles already registered under its name, so
+// AssetIds stay valid. Reloaded assets get textures of their own; their old atlas regions go unused.
+// Names seen for the first time are added. Main thread only, between frames.
+bool ReloadDecodedAsset(AssetManager *manager, const DecodedAsset *asset)
+{
+    if (asset->image.data == NULL)
+        return false;
 
-        // Allocate memory for frames and assign each valid frame's rectangle
-        animation->frames = malloc(validFrameCount * sizeof(Rectangle));
-        if (!animation->frames)
+    AssetLoadRecord *record = BeginAssetLoadRecord(&manager->loadReport, asset->filePath, asset->kind, asset->image,
+                                                   asset->decodeSeconds);
+    switch (asset->kind)
+    {
+    case ASSET_KIND_TILEMAP:
+        if (!asset->tileRects)
+            return false;
+        ReloadTilemapFromImage(asset->name, asset->image, asset->tileRects, asset->tileCountX, asset->tileCountY, record);
+        break;
+    case ASSET_KIND_SPRITE:
+    {
+        Sprite *sprite = GetSpriteById(manager, FindSpriteId(manager, asset->name));
+        if (sprite == NULL)
         {
-            printf("Memory allocation failed for frames of animation '%s'. Skipping.\n", animationName);
-            free(validFrames);
-            continue;
+            RegisterSpriteImage(manager, asset->image, asset->name, record);
+            break;
+        }
+        if (sprite->atlasPage < 0)
+            UnloadTexture(sprite->texture);
+        sprite->texture = UploadAssetTexture(asset->image, record);
+        sprite->source = (Rectangle){0, 0, asset->image.width, asset->image.height};
+        sprite->offset = (Vector2){0, 0};
+        sprite->width = asset->image.width;
+        sprite->height = asset->image.height;
+        sprite->atlasPage = -1;
+        break;
+    }
+    case ASSET_KIND_ANIMATION:
+        if (asset->rows <= 0)
+            return false;
+        ReloadAnimationSheet(manager, asset, record);
+        break;
+    default:
+        return false;
+    }
+
+    // Sprite copies held by buildings and the cursor resync on their next use
+    manager->generation++;
+    return true;
+}
+
+// Refreshes a by-value copy of a sprite after a hot reload; cheap when nothing was reloaded
+void SyncSpriteCopy(AssetManager *manager, Sprite *copy)
+{
+    if (copy->generation == manager->generation)
+        return;
+
+    Sprite *source = GetSpriteById(manager, FindSpriteId(manager, copy->name));
+    if (source)
+    {
+        bool drawName = copy->drawName;
+        *copy = *source;
+        copy->drawName = drawName;
+    }
+    copy->generation = manager->generation;
+}
+
+void BeginAssetAtlas(AssetManager *manager)
+{
+    manager->atlasBuilding = manager->useAtlas;
+}
+
+// Uploads the pages packed since BeginAssetAtlas and points every atlas asset at its page
+void FinishAssetAtlas(AssetManager *manager)
+{
+    if (!manager->atlasBuilding)
+        return;
+    manager->atlasBuilding = false;
+
+    int uploaded = UploadAtlasPages(&manager->atlas, &manager->loadReport);
+    if (uploaded == 0)
+        return;
+
+    for (int i = 0; i < manager->spriteCount; i++)
+    {
+        Sprite *sprite = &manager->sprites[i];
+        if (sprite->atlasPage >= 0)
+            sprite->texture = manager->atlas.pages[sprite->atlasPage].texture;
+    }
+    for (int i = 0; i < manager->animationCount; i++)
+    {
+        AnimationClip *animation = &manager->animations[i];
+        if (animation->atlasPage >= 0)
+            animation->texture = manager->atlas.pages[animation->atlasPage].texture;
+    }
+    for (int i = 0; i < manager->tilemapCount; i++)
+    {
+        Tilemap *tilemap = &manager->tilemap[i];
+        if (tilemap->atlasPage >= 0)
+            tilemap->texture = manager->atlas.pages[tilemap->atlasPage].texture;
+    }
+    printf("Texture atlas: %d regions on %d pages (%d new)\n", manager->atlas.regionCount, manager->atlas.pageCount, uploaded);
+}
+
+// Draws a sprite with its untrimmed top-left corner at position
+void DrawSprite(const Sprite *sprite, Vector2 position, Color tint)
+{
+    Vector2 drawPosition = {position.x + sprite->offset.x, position.y + sprite->offset.y};
+    DrawTextureRec(sprite->texture, sprite->source, drawPosition, tint);
+}
+
+// Draws one frame of a clip with its untrimmed cell's top-left corner at position
+void DrawAnimationFrame(const AnimationClip *clip, int frame, Vector2 position, Color tint)
+{
+    if (clip->frameCount <= 0)
+        return;
+    if (frame < 0 || frame >= clip->frameCount)
+        frame = 0; // A hot reload can leave a player past the end until its next tick
+
+    if (clip->frameOffsets)
+    {
+        position.x += clip->frameOffsets[frame].x;
+        position.y += clip->frameOffsets[frame].y;
+    }
+    DrawTextureRec(clip->texture, clip->frames[frame], position, tint);
+}
+
+// Frame of a clip on the manager's shared clock: every placed copy of a clip shows the same frame
+int GetSharedAnimationFrame(const AssetManager *manager, const AnimationClip *clip)
+{
+    if (clip->frameCount <= 0 || clip->frameTime <= 0.0f)
+        return 0;
+    return (int)(manager->animationTime / clip->frameTime) % clip->frameCount;
+}
+
+// Main-thread half of the loader pipeline: at most one upload per file, none while packing an atlas
+static void UploadDecodedAsset(DecodedAsset *asset, void *userData)
+{
+    AssetManager *manager = userData;
+
+    if (asset->image.data == NULL)
+    {
+        printf("Failed to load texture: %s\n", asset->filePath);
+        return;
+    }
+
+    AssetLoadRecord *record = BeginAssetLoadRecord(&manager->loadReport, asset->filePath, asset->kind, asset->image,
+                                                   asset->decodeSeconds);
+    switch (asset->kind)
+    {
+    case ASSET_KIND_TILEMAP:
+        if (asset->tileRects)
+        {
+            LoadTilemapFromImage(asset->name, asset->image, asset->tileRects, asset->tileCountX, asset->tileCountY, record);
         }
-        memcpy(animation->frames, validFrames, validFrameCount * sizeof(Rectangle));
-        free(validFrames);
+        break;
+    case ASSET_KIND_SPRITE:
+        RegisterSpriteImage(manager, asset->image, asset->name, record);
+        break;
+    case ASSET_KIND_ANIMATION:
+        RegisterAnimationSheet(manager, asset->image, asset->name, asset->rows, asset->rowFrameCounts, asset->frames,
+                               asset->frameWidth, asset->frameHeight, asset->framesPerRow, record);
+        break;
+    default:
+        break;
+    }
+}
+
+void LoadSprite(AssetManager *manager, const char *filePath)
+{
+    if (manager->spriteCount >= MAX_SPRITES)
+    {
+        printf("Max sprites loaded!\n");
+        return;
+    }
 
-        // Add this animation to the hash table with its unique name
-        AddAnimationToHashTable(manager, animationName, *animation);
+    DecodedAsset asset;
+    DecodeAssetFileAs(filePath, ASSET_KIND_SPRITE, &asset);
+    UploadDecodedAsset(&asset, manager);
+    FreeDecodedAsset(&asset);
+}
 
-        manager->animationCount++;
+// Decodes the sheet on the CPU, finds blank frames in the decoded pixels and uploads it
+// once; nothing is read back from the GPU
+void LoadAnimation(AssetManager *manager, const char *filePath)
+{
+    if (manager->animationCount >= MAX_ANIMATIONS)
+    {
+        printf("Max animations loaded!\n");
+        return;
     }
 
-    // Free the full image data after processing all frames
-    UnloadImage(fullImage);
+    DecodedAsset asset;
+    DecodeAssetFileAs(filePath, ASSET_KIND_ANIMATION, &asset);
+    UploadDecodedAsset(&asset, manager);
+    FreeDecodedAsset(&asset);
 }
 
 int CompareEntries(const void *a, const void *b)
@@ -287,68 +626,122 @@ int CompareEntries(const void *a, const void *b)
     return strcmp(*(const char **)a, *(const char **)b);
 }
 
-void LoadAssetsFromDirectory(AssetManager *manager, const char *directory)
+AssetKind ClassifyAssetFile(const char *filePath)
+{
+    // Only the file name decides the kind; directories such as "Wood_Tower" contain underscores too
+    const char *fileName = strrchr(filePath, '/');
+    fileName = fileName ? fileName + 1 : filePath;
+
+    if (strstr(fileName, ".png") == NULL)
+        return ASSET_KIND_NONE;
+    if (strstr(fileName, "Tilemap") != NULL)
+        return ASSET_KIND_TILEMAP;
+    if (strstr(fileName, "_") != NULL)
+        return ASSET_KIND_ANIMATION;
+    return ASSET_KIND_SPRITE;
+}
+
+static void CollectAssetFilesRecursive(const char *directory, char ***filePaths, int *fileCount)
 {
     DIR *dir;
     struct dirent *ent;
     char **entries = NULL;
     size_t entryCount = 0;
 
-    if ((dir = opendir(directory)) != NULL)
+    if ((dir = opendir(directory)) == NULL)
     {
-        while ((ent = readdir(dir)) != NULL)
-        {
-            if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0)
-                continue;
+        perror("Could not open assets directory");
+        return;
+    }
 
-            // Skip the "new" folder during the main load
-            if (strcmp(ent->d_name, "new") == 0)
-                continue;
+    while ((ent = readdir(dir)) != NULL)
+    {
+        if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0)
+            continue;
 
-            entries = realloc(entries, sizeof(char *) * (entryCount + 1));
-            entries[entryCount] = malloc(strlen(ent->d_name) + 1);
-            strcpy(entries[entryCount], ent->d_name);
-            entryCount++;
-        }
-        closedir(dir);
+        // Skip the "new" folder during the main load
+        if (strcmp(ent->d_name, "new") == 0)
+            continue;
 
-        // Sort entries alphabetically to ensure consistent loading order
-        qsort(entries, entryCount, sizeof(char *), CompareEntries);
+        entries = realloc(entries, sizeof(char *) * (entryCount + 1));
+        entries[entryCount] = malloc(strlen(ent->d_name) + 1);
+        strcpy(entries[entryCount], ent->d_name);
+        entryCount++;
+    }
+    closedir(dir);
 
-        for (size_t i = 0; i < entryCount; i++)
-        {
-            char filePath[512];
-            snprintf(filePath, sizeof(filePath), "%s/%s", directory, entries[i]);
+    // Sort entries alphabetically to ensure consistent loading order
+    qsort(entries, entryCount, sizeof(char *), CompareEntries);
 
-            struct stat pathStat;
-            stat(filePath, &pathStat);
+    for (size_t i = 0; i < entryCount; i++)
+    {
+        char filePath[512];
+        snprintf(filePath, sizeof(filePath), "%s/%s", directory, entries[i]);
 
-            if (S_ISDIR(pathStat.st_mode))
-            {
-                LoadAssetsFromDirectory(manager, filePath); // Recursively load subdirectories
-            }
-            else if (strstr(entries[i], ".png") != NULL)
-            {
-                if (strstr(entries[i], "Tilemap") != NULL)
-                {
-                    LoadTilemap(filePath, 64);
-                }
-                else if (strstr(entries[i], "_") != NULL)
-                {
-                    LoadAnimation(manager, filePath);
-                }
-                else
-                {
-                    LoadSprite(manager, filePath);
-                }
-            }
-            free(entries[i]);
+        struct stat pathStat;
+        stat(filePath, &pathStat);
+
+        if (S_ISDIR(pathStat.st_mode))
+        {
+            CollectAssetFilesRecursive(filePath, filePaths, fileCount); // Recursively collect subdirectories
         }
-        free(entries);
+        else if (ClassifyAssetFile(entries[i]) != ASSET_KIND_NONE)
+        {
+            *filePaths = realloc(*filePaths, sizeof(char *) * (*fileCount + 1));
+            (*filePaths)[*fileCount] = strdup(filePath);
+            (*fileCount)++;
+        }
+        free(entries[i]);
     }
-    else
+    free(entries);
+}
+
+int CollectAssetFiles(const char *directory, char ***filePaths)
+{
+    int fileCount = 0;
+    *filePaths = NULL;
+    CollectAssetFilesRecursive(directory, filePaths, &fileCount);
+    return fileCount;
+}
+
+void FreeAssetFileList(char **filePaths, int fileCount)
+{
+    for (int i = 0; i < fileCount; i++)
     {
-        perror("Could not open assets directory");
+        free(filePaths[i]);
+    }
+    free(filePaths);
+}
+
+void LoadAssetsFromDirectory(AssetManager *manager, const char *directory)
+{
+    char **filePaths;
+    int fileCount = CollectAssetFiles(directory, &filePaths);
+
+    // Workers decode and analyse; this thread packs or uploads in sorted file order
+    BeginAssetAtlas(manager);
+    AssetDecodeStats stats = DecodeAssetFiles(filePaths, fileCount, GetDefaultLoaderThreadCount(), UploadDecodedAsset, manager);
+    FreeAssetFileList(filePaths, fileCount);
+    FinishAssetAtlas(manager);
+
+    printf("Loaded %d asset files from %s in %.1f ms (%d decode threads, %.1f ms decode CPU time)\n",
+           fileCount, directory, stats.wallSeconds * 1000.0, stats.threadCount, stats.decodeSeconds * 1000.0);
+}
+
+void LoadGameAssets(AssetManager *manager)
+{
+    // Prefer the baked pack unless the PNGs changed since it was baked; else decode them
+    if (!LoadAssetPack(manager, ASSET_PACK_PATH, ASSET_PATH))
+    {
+        LoadAssetsFromDirectory(manager, ASSET_PATH);
+    }
+
+    PrintAssetLoadReport(&manager->loadReport, stdout, false);
+    FILE *reportFile = fopen(ASSET_LOAD_REPORT_PATH, "w");
+    if (reportFile)
+    {
+        PrintAssetLoadReport(&manager->loadReport, reportFile, true);
+        fclose(reportFile);
     }
 }
 
@@ -366,33 +759,27 @@ void LoadNewAssets(AssetManager *manager, const char *directory)
     }
 }
 
+// Advances the shared clock behind GetSharedAnimationFrame. Clips hold no playback state, so
+// nothing is ticked per clip; instances with their own timing use TickAnimationPlayers.
 void UpdateAnimations(AssetManager *manager, float deltaTime)
 {
-    for (int i = 0; i < manager->animationCount; i++)
-    {
-        Animation *anim = &manager->animations[i];
-        anim->elapsedTime += deltaTime;
-        if (anim->elapsedTime >= anim->frameTime)
-        {
-            anim->elapsedTime -= anim->frameTime;
-            anim->currentFrame++;
-            if (anim->currentFrame >= anim->frameCount)
-            {
-                anim->currentFrame = 0; // Loop the animation
-            }
-        }
-    }
+    manager->animationTime += deltaTime;
 }
 
 void UnloadAssets(AssetManager *manager)
 {
     for (int i = 0; i < manager->spriteCount; i++)
     {
-        UnloadTexture(manager->sprites[i].texture);
+        if (manager->sprites[i].atlasPage < 0)
+            UnloadTexture(manager->sprites[i].texture);
     }
     for (int i = 0; i < manager->animationCount; i++)
     {
-        UnloadTexture(manager->animations[i].texture);
+        if (manager->animations[i].atlasPage < 0)
+            UnloadTexture(manager->animations[i].texture);
         free(manager->animations[i].frames); // Free the frames array
+        free(manager->animations[i].frameOffsets);
     }
+    UnloadTextureAtlas(&manager->atlas); // Atlas pages back every packed asset
+    FreeAssetLoadReport(&manager->loadReport);
 }
\ No newline at end of file
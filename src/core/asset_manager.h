@@ -8,6 +8,9 @@
 #include <sys/stat.h>
 #include <stdbool.h>
 #include "tilemap.h"
+#include "asset_index.h"
+#include "asset_loader.h"
+#include "texture_atlas.h"
 
 #define TRANSPARENCY_THRESHOLD 0.99f
 #define MAX_TRANSPARENT_PIXELS 0.9f
@@ -17,16 +20,17 @@
 #define MAX_SPRITES 1000
 #define MAX_TILEMAPS 1000
 #define ASSET_PATH "../assets/" // Adjust to your asset directory
+#define ASSET_PACK_PATH "assets.pack" // Written by asset_baker, read from the working directory
+#define ASSET_LOAD_REPORT_PATH "asset_load_report.txt" // Per-asset table written by LoadGameAssets
 
-#define HASH_TABLE_SIZE 1024 // Adjust as needed
-
-typedef struct Animation
+// Immutable frame data of one animation, shared by everything that plays it. Playback position
+// lives in an AnimationPlayer per instance (animation_player.h), or in the manager's clock for
+// clips drawn without one.
+typedef struct AnimationClip
 {
     Texture2D texture;
     int frameCount;
-    int currentFrame;
-    float frameTime;
-    float elapsedTime;
+    float frameTime;   // Seconds per frame
     Rectangle *frames; // Array of rectangles for each frame
     int frameWidth;    // Frame width parsed from filename
     int frameHeight;   // Frame height parsed from filename
@@ -34,35 +38,39 @@ typedef struct Animation
     int framesPerRow;  // Frames per row parsed from filename
     char name[64];     // Sprite name extracted from the filename
     bool drawName;     // Flag to determine if the name should be drawn
-} Animation;
+    Vector2 *frameOffsets; // Trimmed frame's offset within its frameWidth x frameHeight cell; NULL if untrimmed
+    int atlasPage;         // Atlas page holding the frames, or -1 if the animation has its own texture
+} AnimationClip;
+
+typedef AssetId AnimationClipId; // Slot in manager->animations
 
 typedef struct Sprite
 {
     Texture2D texture;
-    char name[64]; // Sprite name extracted from the filename
-    bool drawName; // Flag to determine if the name should be drawn
+    Rectangle source; // Region of texture holding the sprite
+    Vector2 offset;   // Top-left of source within the untrimmed image
+    int width;        // Untrimmed size; use these rather than texture.width/height
+    int height;
+    int atlasPage;    // Atlas page holding the sprite, or -1 if it has its own texture
+    char name[64];    // Sprite name extracted from the filename
+    bool drawName;    // Flag to determine if the name should be drawn
+    unsigned int generation; // Manager reload generation this copy was taken at; see SyncSpriteCopy
 } Sprite;
 
-typedef struct AssetNode
-{
-    char name[64]; // Asset name (key)
-    union
-    {
-        Sprite sprite; // Store either a sprite or animation
-        Animation animation;
-        Tilemap tilemap;
-    };
-    struct AssetNode *next; // Linked list to handle hash collisions
-} AssetNode;
-
 typedef struct AssetManager
 {
-    AssetNode *hashTable[HASH_TABLE_SIZE]; // Hashmap to store assets
+    AssetIndex index; // Name -> AssetId lookup for sprites and animations
+    AssetLoadReport loadReport; // Per-file decode/upload cost of the last load
+    TextureAtlas atlas;         // Pages shared by sprites, animation frames and tiles
+    bool useAtlas;              // Pack directory/pack loads into the atlas (default true)
+    bool atlasBuilding;         // Between BeginAssetAtlas and FinishAssetAtlas
+    unsigned int generation;    // Bumped whenever hot reload swaps assets in
+    double animationTime;       // Clock for clips drawn without a player (placed tiles, previews)
     int spriteCount;
     int animationCount;
     int tilemapCount;
     Sprite sprites[MAX_SPRITES];
-    Animation animations[MAX_ANIMATIONS];
+    AnimationClip animations[MAX_ANIMATIONS];
     Tilemap tilemap[MAX_TILEMAPS];
 } AssetManager;
 
@@ -71,16 +79,40 @@ extern AssetManager manager;
 // Function prototypes
 void InitAssetManager(AssetManager *manager);
 void LoadAssetsFromDirectory(AssetManager *manager, const char *directory);
+bool LoadAssetPack(AssetManager *manager, const char *packPath, const char *sourceDirectory);
+void LoadGameAssets(AssetManager *manager);
+int CollectAssetFiles(const char *directory, char ***filePaths);
+void FreeAssetFileList(char **filePaths, int fileCount);
+AssetKind ClassifyAssetFile(const char *filePath);
 void LoadSprite(AssetManager *manager, const char *filePath);
 void LoadAnimation(AssetManager *manager, const char *filePath);
+AssetId AddSprite(AssetManager *manager, Texture2D texture, const char *name);
+AssetId RegisterSpriteImage(AssetManager *manager, Image image, const char *name, AssetLoadRecord *record);
+void RegisterAnimationSheet(AssetManager *manager, Image image, const char *baseName, int rows, const int *rowFrameCounts,
+                            const Rectangle *frames, int frameWidth, int frameHeight, int framesPerRow, AssetLoadRecord *record);
+void BeginAssetAtlas(AssetManager *manager);
+void FinishAssetAtlas(AssetManager *manager);
+bool ReloadDecodedAsset(AssetManager *manager, const DecodedAsset *asset);
+void SyncSpriteCopy(AssetManager *manager, Sprite *copy);
+void DrawSprite(const Sprite *sprite, Vector2 position, Color tint);
+void DrawAnimationFrame(const AnimationClip *clip, int frame, Vector2 position, Color tint);
+int GetSharedAnimationFrame(const AssetManager *manager, const AnimationClip *clip);
+AssetId AddAnimation(AssetManager *manager, Texture2D texture, const char *name, const Rectangle *frames, int frameCount,
+                     int frameWidth, int frameHeight, int framesPerRow);
 void UpdateAnimations(AssetManager *manager, float deltaTime);
 void UnloadAssets(AssetManager *manager);
 void LoadNewAssets(AssetManager *manager, const char *directory);
 bool IsFrameBlank(Image texture, Rectangle frame);
 void ParseAnimationInfoFromFilename(const char *filePath, char *name, int *rows, int *framesPerRow, int *frameWidth, int *frameHeight);
-void AddAssetToHashTable(AssetManager *manager, const char *name, Sprite sprite);
 unsigned long HashString(const char *str);
-void AddAnimationToHashTable(AssetManager *manager, const char *name, Animation animation);
+
+// Resolve a name to a handle once, then use the O(1) *ById accessors on hot paths
+AssetId FindSpriteId(AssetManager *manager, const char *name);
+AssetId FindAnimationId(AssetManager *manager, const char *name);
+Sprite *GetSpriteById(AssetManager *manager, AssetId id);
+AnimationClip *GetAnimationById(AssetManager *manager, AssetId id);
+
+// By-value lookups kept for existing callers; both go through the index
 Sprite GetSprite(AssetManager *manager, const char *name);
-Animation GetAnimation(AssetManager *manager, const char *name);
+AnimationClip GetAnimation(AssetManager *manager, const char *name);
 void PrintAllAnimationNames(AssetManager *manager);
\ No newline at end of file
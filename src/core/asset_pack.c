@@ -0,0 +1,291 @@
+// asset_pack.c
+
+#include "asset_pack.h"
+#include "asset_manager.h"
+#include "tilemap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Maps (or, without mmap, reads) the whole pack into memory
+static unsigned char *MapPackFile(const char *packPath, size_t *size)
+{
+#if defined(_WIN32)
+    int dataSize = 0;
+    unsigned char *data = LoadFileData(packPath, &dataSize);
+    *size = dataSize;
+    return data;
+#else
+    int fd = open(packPath, O_RDONLY);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size < (off_t)sizeof(AssetPackHeader))
+    {
+        close(fd);
+        return NULL;
+    }
+
+    void *data = mmap(NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping keeps the file alive
+    if (data == MAP_FAILED)
+    {
+        return NULL;
+    }
+    *size = fileStat.st_size;
+    return data;
+#endif
+}
+
+static void UnmapPackFile(unsigned char *data, size_t size)
+{
+#if defined(_WIN32)
+    UnloadFileData(data);
+#else
+    munmap(data, size);
+#endif
+}
+
+void StampAssetSources(const char *directory, AssetSourceStamp *stamp)
+{
+    memset(stamp, 0, sizeof(AssetSourceStamp));
+    char **filePaths;
+    int fileCount = CollectAssetFiles(directory, &filePaths);
+    for (int i = 0; i < fileCount; i++)
+    {
+        struct stat fileStat;
+        if (stat(filePaths[i], &fileStat) != 0)
+            continue;
+        stamp->fileCount++;
+        stamp->bytes += (uint64_t)fileStat.st_size;
+        if ((int64_t)fileStat.st_mtime > stamp->newest)
+            stamp->newest = (int64_t)fileStat.st_mtime;
+    }
+    FreeAssetFileList(filePaths, fileCount);
+}
+
+// False if the files under sourceDirectory are no longer the ones the pack was baked from. A
+// directory without asset files (a shipped build may only have the pack) never makes it stale.
+static bool IsPackCurrent(const AssetPackHeader *header, const char *packPath, const char *sourceDirectory)
+{
+    AssetSourceStamp stamp;
+    StampAssetSources(sourceDirectory, &stamp);
+    if (stamp.fileCount == 0 || (stamp.fileCount == header->sourceFileCount && stamp.bytes == header->sourceBytes &&
+                                 stamp.newest == header->sourceNewest))
+        return true;
+    fprintf(stderr, "Asset pack %s is stale: the files under %s changed since it was baked (%u files, %.1f MB now; "
+                    "%u files, %.1f MB then). Loading the files instead; rebake it with asset_baker.\n",
+            packPath, sourceDirectory, stamp.fileCount, stamp.bytes / (1024.0 * 1024.0), header->sourceFileCount,
+            header->sourceBytes / (1024.0 * 1024.0));
+    return false;
+}
+
+static bool ValidatePack(const unsigned char *data, size_t size, const char *packPath)
+{
+    const AssetPackHeader *header = (const AssetPackHeader *)data;
+    if (size < sizeof(AssetPackHeader) || header->magic != ASSET_PACK_MAGIC)
+    {
+        fprintf(stderr, "Asset pack %s: bad magic, rebake it with asset_baker.\n", packPath);
+        return false;
+    }
+    if (header->version != ASSET_PACK_VERSION)
+    {
+        fprintf(stderr, "Asset pack %s: version %u, expected %d. Rebake it with asset_baker.\n",
+                packPath, header->version, ASSET_PACK_VERSION);
+        return false;
+    }
+    if (header->fileSize != size ||
+        header->entryOffset + (uint64_t)header->entryCount * sizeof(AssetPackEntry) > size ||
+        header->rowOffset + (uint64_t)header->rowCount * sizeof(AssetPackRow) > size ||
+        header->rectOffset + (uint64_t)header->rectCount * sizeof(Rectangle) > size)
+    {
+        fprintf(stderr, "Asset pack %s is truncated or corrupt.\n", packPath);
+        return false;
+    }
+
+    const AssetPackRow *rows = (const AssetPackRow *)(data + header->rowOffset);
+    for (uint32_t i = 0; i < header->rowCount; i++)
+    {
+        if ((uint64_t)rows[i].firstRect + rows[i].rectCount > header->rectCount)
+        {
+            fprintf(stderr, "Asset pack %s has an out of range frame table.\n", packPath);
+            return false;
+        }
+    }
+    return true;
+}
+
+#define ASSET_PACK_MAX_SIDE 16384 // Larger images are treated as corrupt rather than allocated
+
+// Every rect of the entry's rows must lie inside its image, or packing and uploading read
+// outside the pixels
+static bool PackRectsFitImage(const AssetPackEntry *entry, const AssetPackRow *rows, const Rectangle *rects)
+{
+    for (uint32_t row = 0; row < entry->rowCount; row++)
+    {
+        const AssetPackRow *packRow = &rows[entry->firstRow + row];
+        for (uint32_t i = 0; i < packRow->rectCount; i++)
+        {
+            Rectangle rect = rects[packRow->firstRect + i];
+            if (!(rect.x >= 0 && rect.y >= 0 && rect.width >= 0 && rect.height >= 0 &&
+                  rect.x + rect.width <= entry->width && rect.y + rect.height <= entry->height))
+                return false;
+        }
+    }
+    return true;
+}
+
+// Checks an entry against the pack before any of it is used: payload and rows in range, pixel
+// size matching the image, and (for tilemaps) a row of tiles. Prints why and returns false if not.
+static bool ValidatePackEntry(const AssetPackHeader *header, const AssetPackEntry *entry, size_t size,
+                              const AssetPackRow *rows, const Rectangle *rects)
+{
+    // name is not necessarily NUL-terminated in a corrupt pack
+    int nameLength = (int)sizeof(entry->name);
+    if (entry->payloadOffset > size || entry->payloadSize > size - entry->payloadOffset ||
+        (uint64_t)entry->firstRow + entry->rowCount > header->rowCount)
+    {
+        fprintf(stderr, "Asset pack: entry '%.*s' is out of range, skipping.\n", nameLength, entry->name);
+        return false;
+    }
+    uint64_t pixelSize = (uint64_t)entry->width * entry->height * 4;
+    if (entry->width == 0 || entry->height == 0 || entry->width > ASSET_PACK_MAX_SIDE ||
+        entry->height > ASSET_PACK_MAX_SIDE || entry->pixelSize != pixelSize ||
+        (!entry->compressed && entry->payloadSize != pixelSize))
+    {
+        fprintf(stderr, "Asset pack: entry '%.*s' has %ux%u pixels but %u bytes, skipping.\n", nameLength, entry->name,
+                entry->width, entry->height, entry->compressed ? entry->pixelSize : entry->payloadSize);
+        return false;
+    }
+    if (entry->kind == ASSET_KIND_TILEMAP && entry->rowCount == 0)
+    {
+        fprintf(stderr, "Asset pack: tilemap '%.*s' has no tile row, skipping.\n", nameLength, entry->name);
+        return false;
+    }
+    if (!PackRectsFitImage(entry, rows, rects))
+    {
+        fprintf(stderr, "Asset pack: entry '%.*s' has frames outside its image, skipping.\n", nameLength, entry->name);
+        return false;
+    }
+    return true;
+}
+
+// entry must have passed ValidatePackEntry; name is its NUL-terminated name
+static void LoadPackEntry(AssetManager *manager, const AssetPackEntry *entry, const char *name, const unsigned char *data,
+                          const AssetPackRow *rows, const Rectangle *rects)
+{
+    // Point the image straight at the mapped pixels unless they have to be inflated first
+    double startTime = GetTime();
+    unsigned char *inflated = NULL;
+    const unsigned char *pixels = data + entry->payloadOffset;
+    if (entry->compressed)
+    {
+        int inflatedSize = 0;
+        inflated = DecompressData(pixels, entry->payloadSize, &inflatedSize);
+        if (inflated == NULL || inflatedSize != (int)entry->pixelSize)
+        {
+            fprintf(stderr, "Asset pack: failed to inflate '%s'.\n", name);
+            MemFree(inflated);
+            return;
+        }
+        pixels = inflated;
+    }
+
+    Image image = {
+        .data = (void *)pixels,
+        .width = entry->width,
+        .height = entry->height,
+        .mipmaps = 1,
+        .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+    AssetLoadRecord *record = BeginAssetLoadRecord(&manager->loadReport, name, entry->kind, image, GetTime() - startTime);
+
+    switch (entry->kind)
+    {
+    case ASSET_KIND_SPRITE:
+        RegisterSpriteImage(manager, image, name, record);
+        break;
+    case ASSET_KIND_ANIMATION:
+    {
+        // Rows of one entry are stored back to back, so their rects are contiguous
+        int *rowFrameCounts = malloc((entry->rowCount > 0 ? entry->rowCount : 1) * sizeof(int));
+        if (!rowFrameCounts)
+            break;
+        for (uint32_t row = 0; row < entry->rowCount; row++)
+        {
+            rowFrameCounts[row] = rows[entry->firstRow + row].rectCount;
+        }
+        const Rectangle *frames = entry->rowCount > 0 ? &rects[rows[entry->firstRow].firstRect] : rects;
+        RegisterAnimationSheet(manager, image, name, entry->rowCount, rowFrameCounts, frames,
+                               entry->frameWidth, entry->frameHeight, entry->framesPerRow, record);
+        free(rowFrameCounts);
+        break;
+    }
+    case ASSET_KIND_TILEMAP:
+    {
+        const AssetPackRow *packRow = &rows[entry->firstRow];
+        int tileCountX = entry->framesPerRow;
+        int tileCountY = tileCountX > 0 ? packRow->rectCount / tileCountX : 0;
+        LoadTilemapFromImage(name, image, &rects[packRow->firstRect], tileCountX, tileCountY, record);
+        break;
+    }
+    default:
+        break;
+    }
+
+    MemFree(inflated);
+}
+
+// Loads every asset from a pack written by asset_baker. Returns false (and loads nothing)
+// if the pack is missing, unusable or older than the files under sourceDirectory (NULL skips
+// that check), so callers can fall back to LoadAssetsFromDirectory.
+bool LoadAssetPack(AssetManager *manager, const char *packPath, const char *sourceDirectory)
+{
+    double startTime = GetTime();
+
+    size_t size = 0;
+    unsigned char *data = MapPackFile(packPath, &size);
+    if (data == NULL)
+    {
+        return false;
+    }
+    if (!ValidatePack(data, size, packPath) ||
+        (sourceDirectory != NULL && !IsPackCurrent((const AssetPackHeader *)data, packPath, sourceDirectory)))
+    {
+        UnmapPackFile(data, size);
+        return false;
+    }
+
+    const AssetPackHeader *header = (const AssetPackHeader *)data;
+    const AssetPackEntry *entries = (const AssetPackEntry *)(data + header->entryOffset);
+    const AssetPackRow *rows = (const AssetPackRow *)(data + header->rowOffset);
+    const Rectangle *rects = (const Rectangle *)(data + header->rectOffset);
+
+    BeginAssetAtlas(manager);
+    for (uint32_t i = 0; i < header->entryCount; i++)
+    {
+        const AssetPackEntry *entry = &entries[i];
+        if (!ValidatePackEntry(header, entry, size, rows, rects))
+            continue;
+        char name[sizeof(entry->name) + 1];
+        memcpy(name, entry->name, sizeof(entry->name));
+        name[sizeof(entry->name)] = '\0';
+        LoadPackEntry(manager, entry, name, data, rows, rects);
+    }
+    FinishAssetAtlas(manager);
+
+    printf("Loaded asset pack %s (%u entries, %.1f MB) in %.1f ms\n", packPath, header->entryCount,
+           size / (1024.0 * 1024.0), (GetTime() - startTime) * 1000.0);
+
+    UnmapPackFile(data, size);
+    return true;
+}
@@ -0,0 +1,73 @@
+// asset_pack.h
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Binary asset pack written by asset_baker and read by LoadAssetPack.
+//
+// Layout (native byte order; the magic doubles as an endianness check):
+//   AssetPackHeader
+//   AssetPackEntry[entryCount]   table of contents, in the order LoadAssetsFromDirectory loads
+//   AssetPackRow[rowCount]       per-entry ranges into the rectangle table
+//   Rectangle[rectCount]         valid animation frames / pre-sliced tilemap tiles
+//   payloads                     RGBA8 pixels, raw or DEFLATE-compressed, 16-byte aligned
+//
+// The header also stamps the asset files the pack was baked from, so the game can tell when
+// art was edited after baking and load the files instead of stale pixels.
+
+#define ASSET_PACK_MAGIC 0x4B505052u // "RPPK"
+#define ASSET_PACK_VERSION 2
+#define ASSET_PACK_ALIGNMENT 16
+
+typedef struct AssetPackHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t rowCount;
+    uint32_t rectCount;
+    uint32_t sourceFileCount; // AssetSourceStamp of the baked directory
+    uint64_t entryOffset;
+    uint64_t rowOffset;
+    uint64_t rectOffset;
+    uint64_t fileSize; // Guards against truncated packs
+    uint64_t sourceBytes;
+    int64_t sourceNewest;
+} AssetPackHeader;
+
+typedef struct AssetPackEntry
+{
+    char name[64];         // Base name parsed from the file name
+    uint32_t kind;         // AssetKind
+    uint32_t width;        // Image size in pixels
+    uint32_t height;
+    uint32_t framesPerRow; // Animation layout from the file name, tiles per row for tilemaps
+    uint32_t frameWidth;
+    uint32_t frameHeight;
+    uint32_t firstRow;     // Animations: one row per sheet row (blank rows have no rects)
+    uint32_t rowCount;     // Tilemaps: a single row holding every tile
+    uint64_t payloadOffset;
+    uint32_t payloadSize;  // Bytes stored in the pack
+    uint32_t pixelSize;    // Bytes once decompressed (width * height * 4)
+    uint32_t compressed;   // Non-zero when the payload is DEFLATE-compressed
+    uint32_t reserved;
+} AssetPackEntry;
+
+typedef struct AssetPackRow
+{
+    uint32_t firstRect;
+    uint32_t rectCount;
+} AssetPackRow;
+
+// Asset files CollectAssetFiles finds under a directory: how many, their total size and the
+// latest modification time among them. Editing, adding or removing art changes it.
+typedef struct AssetSourceStamp
+{
+    uint32_t fileCount;
+    uint64_t bytes;
+    int64_t newest;
+} AssetSourceStamp;
+
+void StampAssetSources(const char *directory, AssetSourceStamp *stamp);
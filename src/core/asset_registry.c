@@ -0,0 +1,153 @@
+// asset_registry.c
+
+#include "asset_registry.h"
+#include "asset_watch.h"
+
+static AssetBundleStats bundles[ASSET_BUNDLE_COUNT];
+static bool managerReady = false; // manager has been through InitAssetManager
+
+static const char *bundleNames[ASSET_BUNDLE_COUNT] = {"game", "new"};
+
+static bool IsValidBundle(AssetBundle bundle)
+{
+    return bundle >= 0 && bundle < ASSET_BUNDLE_COUNT;
+}
+
+static void LoadBundle(AssetBundle bundle)
+{
+    AssetBundleStats *stats = &bundles[bundle];
+    int firstRecord = manager.loadReport.count;
+    double startTime = GetTime();
+
+    switch (bundle)
+    {
+    case ASSET_BUNDLE_GAME:
+        LoadGameAssets(&manager);
+        StartAssetWatch(ASSET_PATH); // Watches the "new" folder too; edits swap in without a reload
+        break;
+    case ASSET_BUNDLE_NEW:
+        LoadNewAssets(&manager, ASSET_NEW_BUNDLE_PATH);
+        break;
+    default:
+        break;
+    }
+
+    // Everything this load added to the report belongs to the bundle
+    stats->files = 0;
+    stats->textures = 0;
+    stats->uploadBytes = 0;
+    for (int i = firstRecord; i < manager.loadReport.count; i++)
+    {
+        const AssetLoadRecord *record = &manager.loadReport.records[i];
+        if (record->kind != ASSET_KIND_NONE)
+            stats->files++;
+        stats->textures += record->textureCount;
+        stats->uploadBytes += record->uploadBytes;
+    }
+    stats->loadSeconds = GetTime() - startTime;
+    stats->loads++;
+    stats->resident = true;
+}
+
+AssetManager *AcquireAssets(AssetBundle bundle)
+{
+    if (!managerReady)
+    {
+        InitAssetManager(&manager);
+        managerReady = true;
+    }
+    if (!IsValidBundle(bundle))
+        return &manager;
+
+    AssetBundleStats *stats = &bundles[bundle];
+    stats->acquires++;
+    stats->refCount++;
+    if (stats->resident)
+    {
+        stats->cacheHits++;
+    }
+    else
+    {
+        LoadBundle(bundle);
+    }
+    return &manager;
+}
+
+void ReleaseAssets(AssetBundle bundle)
+{
+    if (!IsValidBundle(bundle))
+        return;
+
+    AssetBundleStats *stats = &bundles[bundle];
+    if (stats->refCount <= 0)
+    {
+        TraceLog(LOG_WARNING, "ASSETS: Release of unheld bundle '%s'", bundleNames[bundle]);
+        return;
+    }
+    stats->releases++;
+    stats->refCount--; // Stays resident; see TrimAssetRegistry
+}
+
+bool IsAssetBundleResident(AssetBundle bundle)
+{
+    return IsValidBundle(bundle) && bundles[bundle].resident;
+}
+
+bool TrimAssetRegistry(void)
+{
+    // Bundles share atlas pages and the name index, so they can only be dropped together
+    for (int i = 0; i < ASSET_BUNDLE_COUNT; i++)
+    {
+        if (bundles[i].refCount > 0)
+            return false;
+    }
+    if (!managerReady)
+        return true;
+
+    StopAssetWatch();
+    UnloadTilemap();
+    UnloadAssets(&manager);
+    FreeAssetIndex(&manager.index);
+    InitAssetManager(&manager);
+    for (int i = 0; i < ASSET_BUNDLE_COUNT; i++)
+    {
+        bundles[i].resident = false;
+    }
+    return true;
+}
+
+void ShutdownAssetRegistry(void)
+{
+    for (int i = 0; i < ASSET_BUNDLE_COUNT; i++)
+    {
+        bundles[i].refCount = 0;
+    }
+    TrimAssetRegistry();
+    FreeAssetIndex(&manager.index);
+    managerReady = false;
+}
+
+const AssetBundleStats *GetAssetBundleStats(AssetBundle bundle)
+{
+    return IsValidBundle(bundle) ? &bundles[bundle] : NULL;
+}
+
+const char *GetAssetBundleName(AssetBundle bundle)
+{
+    return IsValidBundle(bundle) ? bundleNames[bundle] : "unknown";
+}
+
+void PrintAssetRegistryStats(FILE *out)
+{
+    fprintf(out, "Asset registry:\n");
+    fprintf(out, "  %-6s %4s %8s %8s %5s %5s %6s %8s %10s %9s\n",
+            "bundle", "refs", "acquires", "releases", "loads", "hits", "files", "textures", "upload MB", "load ms");
+    for (int i = 0; i < ASSET_BUNDLE_COUNT; i++)
+    {
+        const AssetBundleStats *stats = &bundles[i];
+        fprintf(out, "  %-6s %4d %8d %8d %5d %5d %6d %8d %10.1f %9.1f\n",
+                bundleNames[i], stats->refCount, stats->acquires, stats->releases, stats->loads, stats->cacheHits,
+                stats->files, stats->textures, stats->uploadBytes / (1024.0 * 1024.0), stats->loadSeconds * 1000.0);
+    }
+    fprintf(out, "  duplicate names rejected by the index: %d\n", manager.index.duplicates);
+}
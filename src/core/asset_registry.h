@@ -0,0 +1,43 @@
+// asset_registry.h
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "asset_manager.h"
+
+#define ASSET_NEW_BUNDLE_PATH "../assets/Tiny Swords (Update 010)/" // LoadNewAssets loads its "new" subfolder
+
+// Groups of assets a scene can ask for. Each bundle is loaded into the shared manager at most once.
+typedef enum AssetBundle
+{
+    ASSET_BUNDLE_GAME, // The baked pack, or ASSET_PATH when there is none
+    ASSET_BUNDLE_NEW,  // The "new" folder under ASSET_NEW_BUNDLE_PATH
+    ASSET_BUNDLE_COUNT
+} AssetBundle;
+
+typedef struct AssetBundleStats
+{
+    int refCount;         // Scenes currently holding the bundle
+    int acquires;         // AcquireAssets calls
+    int releases;         // ReleaseAssets calls
+    int loads;            // Times the bundle was actually decoded and uploaded; 1 while resident
+    int cacheHits;        // Acquires served from memory
+    int files;            // Files decoded by the last load
+    int textures;         // Textures uploaded by the last load, atlas pages included
+    long long uploadBytes;
+    double loadSeconds;   // Wall time of the last load
+    bool resident;
+} AssetBundleStats;
+
+// Scenes acquire the bundles they need in Init and release them in Unload. Bundles stay resident
+// when their count drops to zero, so moving between scenes never reloads anything; memory is only
+// given back by TrimAssetRegistry once no scene holds a bundle.
+AssetManager *AcquireAssets(AssetBundle bundle);
+void ReleaseAssets(AssetBundle bundle);
+bool IsAssetBundleResident(AssetBundle bundle);
+bool TrimAssetRegistry(void);
+void ShutdownAssetRegistry(void);
+const AssetBundleStats *GetAssetBundleStats(AssetBundle bundle);
+const char *GetAssetBundleName(AssetBundle bundle);
+void PrintAssetRegistryStats(FILE *out);
@@ -0,0 +1,346 @@
+// asset_watch.c
+
+#include "asset_watch.h"
+
+#ifdef __linux__
+
+#include <pthread.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+#define WATCH_EVENT_BUFFER 8192
+#define WATCH_POLL_MS 250    // How often the thread checks for StopAssetWatch
+#define WATCH_SETTLE_MS 50   // Extra wait after an event so a burst of writes decodes once
+#define WATCH_MAX_PENDING 64 // Distinct files gathered per burst
+
+typedef struct WatchedDirectory
+{
+    int wd;
+    char path[512];
+} WatchedDirectory;
+
+typedef struct ReloadEntry
+{
+    char path[512];
+    DecodedAsset asset; // asset.filePath points at path
+    struct ReloadEntry *next;
+} ReloadEntry;
+
+static struct
+{
+    int fd;
+    pthread_t thread;
+    bool running;
+    bool stopRequested;
+    WatchedDirectory directories[ASSET_WATCH_MAX_DIRECTORIES]; // Watch thread only
+    int directoryCount;
+
+    pthread_mutex_t lock; // Guards the queue, stopRequested and stats
+    ReloadEntry *head;
+    ReloadEntry *tail;
+    AssetWatchStats stats;
+} watch = {.fd = -1, .lock = PTHREAD_MUTEX_INITIALIZER};
+
+static void WatchDirectoryTree(const char *directory)
+{
+    if (watch.directoryCount >= ASSET_WATCH_MAX_DIRECTORIES)
+    {
+        TraceLog(LOG_WARNING, "ASSETS: Hot reload watches at most %d folders; '%s' is not watched",
+                 ASSET_WATCH_MAX_DIRECTORIES, directory);
+        return;
+    }
+
+    int wd = inotify_add_watch(watch.fd, directory, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR);
+    if (wd < 0)
+        return;
+    WatchedDirectory *watched = &watch.directories[watch.directoryCount++];
+    watched->wd = wd;
+    snprintf(watched->path, sizeof(watched->path), "%s", directory);
+
+    DIR *dir = opendir(directory);
+    if (dir == NULL)
+        return;
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL)
+    {
+        if (ent->d_name[0] == '.')
+            continue;
+        char path[512];
+        if (snprintf(path, sizeof(path), "%s/%s", directory, ent->d_name) >= (int)sizeof(path))
+        {
+            TraceLog(LOG_WARNING, "ASSETS: Path under '%s' is too long to watch: '%s'", directory, ent->d_name);
+            continue;
+        }
+        struct stat info;
+        if (stat(path, &info) == 0 && S_ISDIR(info.st_mode))
+            WatchDirectoryTree(path);
+    }
+    closedir(dir);
+}
+
+static const char *FindWatchedDirectory(int wd)
+{
+    for (int i = 0; i < watch.directoryCount; i++)
+    {
+        if (watch.directories[i].wd == wd)
+            return watch.directories[i].path;
+    }
+    return NULL;
+}
+
+static bool IsStopRequested(void)
+{
+    pthread_mutex_lock(&watch.lock);
+    bool stop = watch.stopRequested;
+    pthread_mutex_unlock(&watch.lock);
+    return stop;
+}
+
+// Reads one buffer of events, adding new folders to the watch and PNG paths to pending
+static void ReadWatchEvents(char pending[][512], int *pendingCount)
+{
+    char buffer[WATCH_EVENT_BUFFER] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t length = read(watch.fd, buffer, sizeof(buffer));
+
+    for (char *cursor = buffer; length > 0 && cursor < buffer + length;)
+    {
+        const struct inotify_event *event = (const struct inotify_event *)cursor;
+        cursor += sizeof(struct inotify_event) + event->len;
+
+        const char *directory = FindWatchedDirectory(event->wd);
+        if (directory == NULL || event->len == 0)
+            continue;
+        char path[512];
+        if (snprintf(path, sizeof(path), "%s/%s", directory, event->name) >= (int)sizeof(path))
+        {
+            // A truncated path would be classified and reloaded under the wrong name
+            TraceLog(LOG_WARNING, "ASSETS: Path under '%s' is too long to reload: '%s'", directory, event->name);
+            continue;
+        }
+
+        if (event->mask & IN_ISDIR)
+        {
+            if (event->mask & (IN_CREATE | IN_MOVED_TO))
+                WatchDirectoryTree(path); // Files copied in with the folder arrive as their own events
+            continue;
+        }
+        // IN_CREATE alone means the file is still being written; wait for its close
+        if (!(event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) || ClassifyAssetFile(path) == ASSET_KIND_NONE)
+            continue;
+
+        pthread_mutex_lock(&watch.lock);
+        watch.stats.events++;
+        pthread_mutex_unlock(&watch.lock);
+
+        bool seen = false;
+        for (int i = 0; i < *pendingCount && !seen; i++)
+        {
+            seen = strcmp(pending[i], path) == 0;
+        }
+        if (!seen && *pendingCount < WATCH_MAX_PENDING)
+        {
+            snprintf(pending[(*pendingCount)++], 512, "%s", path);
+        }
+    }
+}
+
+static void DecodeAndQueue(const char *path)
+{
+    ReloadEntry *entry = calloc(1, sizeof(ReloadEntry));
+    if (!entry)
+        return;
+    if (snprintf(entry->path, sizeof(entry->path), "%s", path) >= (int)sizeof(entry->path))
+    {
+        TraceLog(LOG_WARNING, "ASSETS: Path is too long to reload: '%s'", path);
+        free(entry);
+        return;
+    }
+
+    bool decoded = DecodeAssetFile(entry->path, &entry->asset);
+    pthread_mutex_lock(&watch.lock);
+    watch.stats.decodeSeconds += entry->asset.decodeSeconds;
+    if (!decoded)
+    {
+        watch.stats.failed++;
+        pthread_mutex_unlock(&watch.lock);
+        FreeDecodedAsset(&entry->asset);
+        free(entry);
+        return;
+    }
+    watch.stats.decoded++;
+    if (watch.tail)
+        watch.tail->next = entry;
+    else
+        watch.head = entry;
+    watch.tail = entry;
+    pthread_mutex_unlock(&watch.lock);
+}
+
+static void *WatchThread(void *arg)
+{
+    (void)arg;
+    static char pending[WATCH_MAX_PENDING][512];
+    struct pollfd pfd = {.fd = watch.fd, .events = POLLIN};
+
+    while (!IsStopRequested())
+    {
+        if (poll(&pfd, 1, WATCH_POLL_MS) <= 0)
+            continue;
+
+        // Gather the whole burst (editors often write, truncate and rename) before decoding
+        int pendingCount = 0;
+        do
+        {
+            ReadWatchEvents(pending, &pendingCount);
+        } while (poll(&pfd, 1, WATCH_SETTLE_MS) > 0);
+
+        for (int i = 0; i < pendingCount && !IsStopRequested(); i++)
+        {
+            DecodeAndQueue(pending[i]);
+        }
+    }
+    return NULL;
+}
+
+bool StartAssetWatch(const char *directory)
+{
+    if (watch.running)
+        return true;
+
+    watch.fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watch.fd < 0)
+    {
+        TraceLog(LOG_WARNING, "ASSETS: inotify unavailable, hot reload disabled");
+        return false;
+    }
+
+    // Trim the trailing '/' of ASSET_PATH so joined paths stay tidy
+    char root[512];
+    snprintf(root, sizeof(root), "%s", directory);
+    size_t rootLength = strlen(root);
+    while (rootLength > 1 && root[rootLength - 1] == '/')
+        root[--rootLength] = '\0';
+
+    watch.directoryCount = 0;
+    WatchDirectoryTree(root);
+    if (watch.directoryCount == 0)
+    {
+        close(watch.fd);
+        watch.fd = -1;
+        return false;
+    }
+
+    watch.stopRequested = false;
+    if (pthread_create(&watch.thread, NULL, WatchThread, NULL) != 0)
+    {
+        close(watch.fd);
+        watch.fd = -1;
+        return false;
+    }
+    watch.running = true;
+    TraceLog(LOG_INFO, "ASSETS: Hot reload watching %d folders under '%s'", watch.directoryCount, root);
+    return true;
+}
+
+void StopAssetWatch(void)
+{
+    if (!watch.running)
+        return;
+
+    pthread_mutex_lock(&watch.lock);
+    watch.stopRequested = true;
+    pthread_mutex_unlock(&watch.lock);
+    pthread_join(watch.thread, NULL);
+    close(watch.fd);
+    watch.fd = -1;
+    watch.running = false;
+
+    // Drop reloads that were never applied
+    ReloadEntry *entry = watch.head;
+    while (entry)
+    {
+        ReloadEntry *next = entry->next;
+        FreeDecodedAsset(&entry->asset);
+        free(entry);
+        entry = next;
+    }
+    watch.head = watch.tail = NULL;
+}
+
+bool IsAssetWatchRunning(void)
+{
+    return watch.running;
+}
+
+// Main thread, between frames: nothing is drawing, so textures can be swapped and freed safely
+int ApplyAssetReloads(AssetManager *manager)
+{
+    if (!watch.running)
+        return 0;
+
+    pthread_mutex_lock(&watch.lock);
+    ReloadEntry *entry = watch.head;
+    watch.head = watch.tail = NULL;
+    pthread_mutex_unlock(&watch.lock);
+
+    int applied = 0;
+    while (entry)
+    {
+        ReloadEntry *next = entry->next;
+        if (ReloadDecodedAsset(manager, &entry->asset))
+        {
+            TraceLog(LOG_INFO, "ASSETS: Reloaded '%s'", entry->path);
+            applied++;
+        }
+        FreeDecodedAsset(&entry->asset);
+        free(entry);
+        entry = next;
+    }
+
+    if (applied > 0)
+    {
+        pthread_mutex_lock(&watch.lock);
+        watch.stats.applied += applied;
+        pthread_mutex_unlock(&watch.lock);
+    }
+    return applied;
+}
+
+AssetWatchStats GetAssetWatchStats(void)
+{
+    pthread_mutex_lock(&watch.lock);
+    AssetWatchStats stats = watch.stats;
+    pthread_mutex_unlock(&watch.lock);
+    return stats;
+}
+
+#else // No inotify: hot reload is unavailable
+
+bool StartAssetWatch(const char *directory)
+{
+    (void)directory;
+    return false;
+}
+
+void StopAssetWatch(void)
+{
+}
+
+bool IsAssetWatchRunning(void)
+{
+    return false;
+}
+
+int ApplyAssetReloads(AssetManager *manager)
+{
+    (void)manager;
+    return 0;
+}
+
+AssetWatchStats GetAssetWatchStats(void)
+{
+    return (AssetWatchStats){0};
+}
+
+#endif
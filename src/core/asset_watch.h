@@ -0,0 +1,27 @@
+// asset_watch.h
+
+#pragma once
+
+#include <stdbool.h>
+#include "asset_manager.h"
+
+#define ASSET_WATCH_MAX_DIRECTORIES 512
+
+typedef struct AssetWatchStats
+{
+    int events;        // PNG create/write/rename notifications received
+    int decoded;       // Files re-decoded on the watch thread
+    int failed;        // Files that could not be decoded (often caught mid-write; the next save retries)
+    int applied;       // Reloads swapped in by ApplyAssetReloads
+    double decodeSeconds;
+} AssetWatchStats;
+
+// Hot reload (Linux, inotify): a background thread watches directory and every folder below it,
+// re-decodes PNGs that are written or moved in, and queues them. ApplyAssetReloads swaps the queued
+// images in behind the existing handles on the main thread, once per frame. Elsewhere these are
+// no-ops and StartAssetWatch returns false.
+bool StartAssetWatch(const char *directory);
+void StopAssetWatch(void);
+bool IsAssetWatchRunning(void);
+int ApplyAssetReloads(AssetManager *manager);
+AssetWatchStats GetAssetWatchStats(void);
@@ -3,6 +3,7 @@
 #include "raymath.h"
 #include "asset_manager.h"
 #include "buildings.h"
+#include "pick_index.h"
 #include <stdbool.h>
 
 #define FACTION_COUNT 3
@@ -58,20 +59,32 @@ void InitBuilding(Building *building, Vector2 position, BuildingType type, Asset
     building->unitTypeToSpawn = NULL;
 
     // Assign sprites based on the configuration
-    building->constructionSprite = GetSprite(manager, config->constructionSpriteName);
+    Sprite *constructionSprite = GetSpriteById(manager, FindSpriteId(manager, config->constructionSpriteName));
+    Sprite *destroyedSprite = GetSpriteById(manager, FindSpriteId(manager, config->destroyedSpriteName));
+    building->constructionSprite = constructionSprite ? *constructionSprite : (Sprite){0};
+    building->completedAnimation = INVALID_ANIMATION_PLAYER;
     if (config->animation)
     {
-        building->completedAnimation = GetAnimation(manager, config->completedSpriteName);
+        AnimationClipId clipId = FindAnimationId(manager, config->completedSpriteName);
+        if (GetAnimationById(manager, clipId))
+            building->completedAnimation = CreateAnimationPlayer(clipId, true);
     }
     else
     {
-        building->completedSprite = GetSprite(manager, config->completedSpriteName);
+        Sprite *completedSprite = GetSpriteById(manager, FindSpriteId(manager, config->completedSpriteName));
+        building->completedSprite = completedSprite ? *completedSprite : (Sprite){0};
     }
-    building->destroyedSprite = GetSprite(manager, config->destroyedSpriteName);
+    building->destroyedSprite = destroyedSprite ? *destroyedSprite : (Sprite){0};
 
-    // Initialize collision box
-    float width = building->completedSprite.texture.width;
-    float height = building->completedSprite.texture.height;
+    // Initialize collision box from the completed look, sprite or animation frame
+    float width = building->completedSprite.width;
+    float height = building->completedSprite.height;
+    AnimationClip *clip = GetPlayerClip(manager, building->completedAnimation);
+    if (clip)
+    {
+        width = clip->frameWidth;
+        height = clip->frameHeight;
+    }
     building->collisionBox = (Rectangle){
         position.x - width / 2,
         position.y - height / 2,
@@ -79,7 +92,7 @@ void InitBuilding(Building *building, Vector2 position, BuildingType type, Asset
         height};
 }
 
-void UpdateBuilding(Building *building, NPC *npcs, int *npcCount, AssetManager *manager, float deltaTime)
+void UpdateBuilding(Building *building, NPCStore *npcs, AssetManager *manager, float deltaTime)
 {
     switch (building->state)
     {
@@ -93,7 +106,7 @@ void UpdateBuilding(Building *building, NPC *npcs, int *npcCount, AssetManager *
     case BUILDING_STATE_COMPLETED:
         if (building->unitTypeToSpawn != NULL)
         { // Condition to produce unit if a type is selected
-            ProduceUnit(building, npcs, npcCount, manager);
+            ProduceUnit(building, npcs, manager);
             building->unitTypeToSpawn = NULL; // Reset after producing
         }
         break;
@@ -105,9 +118,9 @@ void UpdateBuilding(Building *building, NPC *npcs, int *npcCount, AssetManager *
     }
 }
 
-void ProduceUnit(Building *building, NPC *npcs, int *npcCount, AssetManager *manager)
+void ProduceUnit(Building *building, NPCStore *npcs, AssetManager *manager)
 {
-    if (*npcCount >= MAX_NPCS)
+    if (npcs->count >= MAX_NPCS)
     {
         printf("Max NPC limit reached, cannot spawn more units.\n");
         return;
@@ -117,22 +130,25 @@ void ProduceUnit(Building *building, NPC *npcs, int *npcCount, AssetManager *man
     // Adjust the spawn offset distance and direction to be directly in front of the building
     float spawnOffset = -150.0f;                                                        // Adjust the offset distance as needed
     Vector2 spawnPosition = Vector2Add(building->position, (Vector2){0, -spawnOffset}); // Place above the building
-    InitNPC(&npcs[*npcCount], manager, spawnPosition, 100.0f, npcType);
-    npcs[*npcCount].drawName = true;
-    npcs[*npcCount].unitType = npcType; // Persist unit type in NPC struct
+    NPC npc;
+    InitNPC(&npc, manager, spawnPosition, 100.0f, npcType);
+    npc.drawName = true;
+    npc.unitType = npcType; // Persist unit type in NPC struct
+    if (AddNPCToStore(npcs, &npc) < 0)
+    {
+        ReleaseAnimationPlayer(npc.animation);
+        return;
+    }
 
     printf("NPC Spawned: Type=%s, Health=%.1f, Strength=%d, Defense=%d\n",
-           npcs[*npcCount].unitType, npcs[*npcCount].health,
-           npcs[*npcCount].strength, npcs[*npcCount].defense);
-
-    (*npcCount)++;
+           npc.unitType, npc.health, npc.strength, npc.defense);
 }
 
-void HandleBuildingClick(Building *buildings, int buildingCount, NPC *npcs, int npcCount, Vector2 mousePosition, bool mousePressed)
+void HandleBuildingClick(Building *buildings, int buildingCount, NPCStore *npcs, PickIndex *picks, Vector2 mousePosition,
+                         bool mousePressed)
 {
     if (mousePressed)
     {
-        bool clickedOnBuilding = false;
         bool clickedOnUI = false;
 
         // Check for clicks on the building UI first
@@ -154,44 +170,19 @@ void HandleBuildingClick(Building *buildings, int buildingCount, NPC *npcs, int
         // If the click is not on the UI, check buildings
         if (!clickedOnUI)
         {
-            for (int i = buildingCount - 1; i >= 0; i--)
+            int topmost = PickTopmost(picks, mousePosition, PICK_BUILDING);
+            for (int i = 0; i < buildingCount; i++)
             {
-                Building *building = &buildings[i];
-
-                float width = building->completedSprite.texture.width;
-                float height = building->completedSprite.texture.height;
-                Rectangle buildingRect = {
-                    building->position.x - width / 2,
-                    building->position.y - height / 2,
-                    width,
-                    height};
-
-                if (CheckCollisionPointRec(mousePosition, buildingRect))
-                {
-                    building->isSelected = true;
-                    clickedOnBuilding = true;
-                    printf("Building selected!\n");
-
-                    // Deselect all NPCs
-                    for (int j = 0; j < npcCount; j++)
-                    {
-                        npcs[j].isSelected = false;
-                    }
-
-                    break; // Stop after selecting the topmost building
-                }
-                else
-                {
-                    building->isSelected = false;
-                }
+                buildings[i].isSelected = i == topmost;
             }
-
-            // Deselect buildings only if the click was not on any building or UI
-            if (!clickedOnBuilding)
+            if (topmost >= 0)
             {
-                for (int i = 0; i < buildingCount; i++)
+                printf("Building selected!\n");
+
+                // Deselect all NPCs
+                for (int j = 0; j < npcs->count; j++)
                 {
-                    buildings[i].isSelected = false;
+                    npcs->cold[j].isSelected = false;
                 }
             }
         }
@@ -237,6 +228,11 @@ void RenderUnitSelectionUI(Building *building)
 
 void DrawBuilding(Building *building)
 {
+    // Pick up hot-reloaded art before taking the copy below
+    SyncSpriteCopy(&manager, &building->constructionSprite);
+    SyncSpriteCopy(&manager, &building->completedSprite);
+    SyncSpriteCopy(&manager, &building->destroyedSprite);
+
     Sprite currentSprite;
     switch (building->state)
     {
@@ -254,32 +250,33 @@ void DrawBuilding(Building *building)
     }
 
     // Draw the current frame of the animation at the NPC's position
-    if (building->completedAnimation.frameCount > 0 && building->completedAnimation.texture.id != 0)
+    AnimationClip *completedClip = GetPlayerClip(&manager, building->completedAnimation);
+    if (completedClip && completedClip->frameCount > 0 && completedClip->texture.id != 0)
     { // Check if animation is valid
-        Rectangle frame = building->completedAnimation.frames[building->completedAnimation.currentFrame];
-        // Center the texture on the NPC's position
-        Vector2 drawPosition = Vector2Subtract(building->position, (Vector2){frame.width / 2, frame.height / 2});
-        DrawTextureRec(building->completedAnimation.texture, frame, drawPosition, WHITE);
+        // Center the frame's cell on the building's position
+        Vector2 drawPosition = Vector2Subtract(building->position, (Vector2){completedClip->frameWidth / 2.0f,
+                                                                            completedClip->frameHeight / 2.0f});
+        DrawAnimationPlayer(&manager, building->completedAnimation, drawPosition, WHITE);
     }
 
     // Draw a smaller selection circle if the building is selected
     if (building->isSelected)
     {
-        float horizontalRadius = currentSprite.texture.width / 2.0f; // Half the width of the building sprite
-        float verticalRadius = currentSprite.texture.height / 3.0f;  // Adjust as needed for the vertical size
+        float horizontalRadius = currentSprite.width / 2.0f; // Half the width of the building sprite
+        float verticalRadius = currentSprite.height / 3.0f;  // Adjust as needed for the vertical size
 
         // Draw the ellipse slightly below the building (adjust the Y offset as needed)
         for (int offset = 1; offset <= 3; offset++)
         {
-            DrawEllipseLines(building->position.x, building->position.y + currentSprite.texture.height / 5,
+            DrawEllipseLines(building->position.x, building->position.y + currentSprite.height / 5,
                              horizontalRadius + offset, verticalRadius + offset, GREEN);
         }
     }
 
     // Center the drawing of the sprite texture
     Vector2 drawPosition = {
-        building->position.x - currentSprite.texture.width / 2,
-        building->position.y - currentSprite.texture.height / 2};
+        building->position.x - currentSprite.width / 2,
+        building->position.y - currentSprite.height / 2};
 
-    DrawTexture(currentSprite.texture, drawPosition.x, drawPosition.y, WHITE);
+    DrawSprite(&currentSprite, drawPosition, WHITE);
 }
@@ -2,7 +2,9 @@
 
 #include "raylib.h"
 #include "asset_manager.h"
-#include "npc.h"
+#include "npc_store.h"
+
+typedef struct PickIndex PickIndex; // pick_index.h
 
 // Building states to represent construction progress, completion, and destruction.
 typedef enum {
@@ -42,7 +44,7 @@ typedef struct {
     Sprite constructionSprite;        // Sprite displayed during construction
     Sprite completedSprite;           // Sprite displayed upon completion
     Sprite destroyedSprite;           // Sprite displayed when destroyed
-    Animation completedAnimation;
+    AnimationPlayerId completedAnimation; // Animated completed look, or INVALID_ANIMATION_PLAYER
     Rectangle collisionBox;
 } Building;
 
@@ -50,10 +52,10 @@ typedef struct {
 void InitBuilding(Building *building, Vector2 position, BuildingType type, AssetManager *manager, int faction);
 
 // Updates the building's state based on its progress and manages unit production if applicable.
-void UpdateBuilding(Building *building, NPC *npcs, int *npcCount, AssetManager *manager, float deltaTime);
+void UpdateBuilding(Building *building, NPCStore *npcs, AssetManager *manager, float deltaTime);
 
 // Produces a unit based on the building's selected unit type.
-void ProduceUnit(Building *building, NPC *npcs, int *npcCount, AssetManager *manager);
+void ProduceUnit(Building *building, NPCStore *npcs, AssetManager *manager);
 
 // Draws the building based on its current state.
 void DrawBuilding(Building *building);
@@ -61,4 +63,6 @@ void DrawBuilding(Building *building);
 // Renders the UI for selecting the unit type to spawn from the building.
 void RenderUnitSelectionUI(Building *building);
 
-void HandleBuildingClick(Building *buildings, int buildingCount, NPC *npcs, int npcCount, Vector2 mousePosition, bool mousePressed);
\ No newline at end of file
+// Selects the topmost building under a click (from picks, built this frame) and deselects the rest
+void HandleBuildingClick(Building *buildings, int buildingCount, NPCStore *npcs, PickIndex *picks, Vector2 mousePosition,
+                         bool mousePressed);
\ No newline at end of file
@@ -0,0 +1,266 @@
+// collision_map.c
+
+#include "collision_map.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+bool InitCollisionMap(CollisionMap *map, int width, int height, float cellSize)
+{
+    memset(map, 0, sizeof(CollisionMap));
+    map->cellSize = cellSize;
+    if (width <= 0 || height <= 0)
+        return true;
+    int wordsPerRow = (width + 63) / 64;
+    map->bits = calloc((size_t)wordsPerRow * height, sizeof(uint64_t));
+    if (map->bits == NULL)
+    {
+        fprintf(stderr, "Failed to allocate collision map for %dx%d tiles.\n", width, height);
+        return false;
+    }
+    map->width = width;
+    map->height = height;
+    map->wordsPerRow = wordsPerRow;
+    return true;
+}
+
+void FreeCollisionMap(CollisionMap *map)
+{
+    free(map->bits);
+    float cellSize = map->cellSize;
+    memset(map, 0, sizeof(CollisionMap));
+    map->cellSize = cellSize;
+}
+
+void SetCollisionCell(CollisionMap *map, int x, int y, bool blocked)
+{
+    if (x < 0 || y < 0 || x >= map->width || y >= map->height)
+        return;
+    uint64_t *word = &map->bits[y * map->wordsPerRow + (x >> 6)];
+    uint64_t bit = 1ull << (x & 63);
+    if (((*word & bit) != 0) == blocked)
+        return;
+    *word ^= bit;
+    map->blockedCount += blocked ? 1 : -1;
+}
+
+bool IsCollisionCellBlocked(const CollisionMap *map, int x, int y)
+{
+    if (x < 0 || y < 0 || x >= map->width || y >= map->height)
+        return false;
+    return (map->bits[y * map->wordsPerRow + (x >> 6)] >> (x & 63)) & 1;
+}
+
+// Cells a rectangle overlaps, clipped to the map; false if none are on it. Edges that only
+// touch a cell do not count, as in CheckCollisionRecs.
+static bool GetCoveredCells(const CollisionMap *map, Rectangle rec, int *x0, int *y0, int *x1, int *y1)
+{
+    *x0 = (int)floorf(rec.x / map->cellSize);
+    *y0 = (int)floorf(rec.y / map->cellSize);
+    *x1 = (int)ceilf((rec.x + rec.width) / map->cellSize) - 1;
+    *y1 = (int)ceilf((rec.y + rec.height) / map->cellSize) - 1;
+    if (*x1 < *x0)
+        *x1 = *x0;
+    if (*y1 < *y0)
+        *y1 = *y0;
+    if (*x0 < 0)
+        *x0 = 0;
+    if (*y0 < 0)
+        *y0 = 0;
+    if (*x1 >= map->width)
+        *x1 = map->width - 1;
+    if (*y1 >= map->height)
+        *y1 = map->height - 1;
+    return *x0 <= *x1 && *y0 <= *y1;
+}
+
+// Blocked bits of row y in [x0, x1] within word w, shifted so bit 0 is tile w * 64
+static uint64_t GetRowWord(const CollisionMap *map, int y, int w, int x0, int x1)
+{
+    uint64_t word = map->bits[y * map->wordsPerRow + w];
+    if (w == x0 >> 6)
+        word &= ~0ull << (x0 & 63);
+    if (w == x1 >> 6)
+        word &= ~0ull >> (63 - (x1 & 63));
+    return word;
+}
+
+bool CheckCollisionMapRec(const CollisionMap *map, Rectangle rec)
+{
+    int x0, y0, x1, y1;
+    if (map->blockedCount == 0 || !GetCoveredCells(map, rec, &x0, &y0, &x1, &y1))
+        return false;
+    for (int y = y0; y <= y1; y++)
+    {
+        for (int w = x0 >> 6; w <= x1 >> 6; w++)
+        {
+            // Covered cells can still only touch the rectangle along its edges; test those strictly
+            uint64_t word = GetRowWord(map, y, w, x0, x1);
+            while (word)
+            {
+                int x = w * 64 + __builtin_ctzll(word);
+                word &= word - 1;
+                Rectangle cell = {x * map->cellSize, y * map->cellSize, map->cellSize, map->cellSize};
+                if (CheckCollisionRecs(rec, cell))
+                    return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Slab test of a box moving by motion against one cell: entry and exit times along each axis
+static bool SweepCell(Rectangle rec, Vector2 motion, Rectangle cell, float *entry, Vector2 *normal)
+{
+    float entryX = -INFINITY, exitX = INFINITY, entryY = -INFINITY, exitY = INFINITY;
+    if (motion.x > 0.0f)
+    {
+        entryX = (cell.x - (rec.x + rec.width)) / motion.x;
+        exitX = (cell.x + cell.width - rec.x) / motion.x;
+    }
+    else if (motion.x < 0.0f)
+    {
+        entryX = (cell.x + cell.width - rec.x) / motion.x;
+        exitX = (cell.x - (rec.x + rec.width)) / motion.x;
+    }
+    else if (rec.x >= cell.x + cell.width || rec.x + rec.width <= cell.x)
+    {
+        return false;
+    }
+    if (motion.y > 0.0f)
+    {
+        entryY = (cell.y - (rec.y + rec.height)) / motion.y;
+        exitY = (cell.y + cell.height - rec.y) / motion.y;
+    }
+    else if (motion.y < 0.0f)
+    {
+        entryY = (cell.y + cell.height - rec.y) / motion.y;
+        exitY = (cell.y - (rec.y + rec.height)) / motion.y;
+    }
+    else if (rec.y >= cell.y + cell.height || rec.y + rec.height <= cell.y)
+    {
+        return false;
+    }
+
+    float enter = fmaxf(entryX, entryY), exit = fminf(exitX, exitY);
+    if (enter >= exit || enter < 0.0f || enter > 1.0f)
+        return false; // Missed, already overlapping, or out of reach this move
+    *entry = enter;
+    if (entryX > entryY)
+        *normal = (Vector2){motion.x > 0.0f ? -1.0f : 1.0f, 0.0f};
+    else
+        *normal = (Vector2){0.0f, motion.y > 0.0f ? -1.0f : 1.0f};
+    return true;
+}
+
+bool SweepCollisionMapRec(const CollisionMap *map, Rectangle rec, Vector2 motion, CollisionHit *hit)
+{
+    Rectangle swept = {fminf(rec.x, rec.x + motion.x), fminf(rec.y, rec.y + motion.y), rec.width + fabsf(motion.x),
+                       rec.height + fabsf(motion.y)};
+    int x0, y0, x1, y1;
+    if (map->blockedCount == 0 || (motion.x == 0.0f && motion.y == 0.0f) ||
+        !GetCoveredCells(map, swept, &x0, &y0, &x1, &y1))
+        return false;
+
+    bool found = false;
+    for (int y = y0; y <= y1; y++)
+    {
+        for (int w = x0 >> 6; w <= x1 >> 6; w++)
+        {
+            uint64_t word = GetRowWord(map, y, w, x0, x1);
+            while (word)
+            {
+                int x = w * 64 + __builtin_ctzll(word);
+                word &= word - 1;
+                Rectangle cell = {x * map->cellSize, y * map->cellSize, map->cellSize, map->cellSize};
+                float entry;
+                Vector2 normal;
+                if (SweepCell(rec, motion, cell, &entry, &normal) && (!found || entry < hit->time))
+                {
+                    *hit = (CollisionHit){entry, normal, x, y};
+                    found = true;
+                }
+            }
+        }
+    }
+    return found;
+}
+
+Vector2 SlideCollisionMapRec(const CollisionMap *map, Rectangle rec, Vector2 motion)
+{
+    Vector2 moved = {0.0f, 0.0f};
+    for (int pass = 0; pass < 3 && (motion.x != 0.0f || motion.y != 0.0f); pass++)
+    {
+        CollisionHit hit;
+        if (!SweepCollisionMapRec(map, rec, motion, &hit))
+        {
+            moved.x += motion.x;
+            moved.y += motion.y;
+            break;
+        }
+        Vector2 step = {motion.x * hit.time + hit.normal.x * COLLISION_SKIN, motion.y * hit.time + hit.normal.y * COLLISION_SKIN};
+        moved.x += step.x;
+        moved.y += step.y;
+        rec.x += step.x;
+        rec.y += step.y;
+        // Keep the part of the rest that runs along the face
+        float remaining = 1.0f - hit.time;
+        motion = hit.normal.x != 0.0f ? (Vector2){0.0f, motion.y * remaining} : (Vector2){motion.x * remaining, 0.0f};
+    }
+    return moved;
+}
+
+// Amanatides-Woo traversal: step to whichever cell boundary the ray reaches first
+bool RaycastCollisionMap(const CollisionMap *map, Vector2 origin, Vector2 direction, float maxDistance, CollisionHit *hit)
+{
+    float length = sqrtf(direction.x * direction.x + direction.y * direction.y);
+    if (map->blockedCount == 0 || length == 0.0f)
+        return false;
+    direction.x /= length;
+    direction.y /= length;
+
+    float cellSize = map->cellSize;
+    int x = (int)floorf(origin.x / cellSize), y = (int)floorf(origin.y / cellSize);
+    int stepX = direction.x > 0.0f ? 1 : -1, stepY = direction.y > 0.0f ? 1 : -1;
+    float deltaX = direction.x != 0.0f ? fabsf(cellSize / direction.x) : INFINITY;
+    float deltaY = direction.y != 0.0f ? fabsf(cellSize / direction.y) : INFINITY;
+    float nextX = direction.x != 0.0f ? ((x + (stepX > 0)) * cellSize - origin.x) / direction.x : INFINITY;
+    float nextY = direction.y != 0.0f ? ((y + (stepY > 0)) * cellSize - origin.y) / direction.y : INFINITY;
+
+    if (IsCollisionCellBlocked(map, x, y))
+    {
+        *hit = (CollisionHit){0.0f, {0.0f, 0.0f}, x, y};
+        return true;
+    }
+    for (;;)
+    {
+        float distance;
+        Vector2 normal;
+        if (nextX < nextY)
+        {
+            distance = nextX;
+            nextX += deltaX;
+            x += stepX;
+            normal = (Vector2){(float)-stepX, 0.0f};
+        }
+        else
+        {
+            distance = nextY;
+            nextY += deltaY;
+            y += stepY;
+            normal = (Vector2){0.0f, (float)-stepY};
+        }
+        if (distance > maxDistance)
+            return false;
+        // Past the map edge and heading away from it: nothing more to hit
+        if ((x < 0 && stepX < 0) || (y < 0 && stepY < 0) || (x >= map->width && stepX > 0) ||
+            (y >= map->height && stepY > 0))
+            return false;
+        if (IsCollisionCellBlocked(map, x, y))
+        {
+            *hit = (CollisionHit){distance, normal, x, y};
+            return true;
+        }
+    }
+}
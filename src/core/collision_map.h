@@ -0,0 +1,45 @@
+// collision_map.h
+
+#pragma once
+
+#include "raylib.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define COLLISION_SKIN 0.01f // Gap left between a swept box and the face it stopped at
+
+// One bit per tile, set where the tile is collidable, packed 64 tiles to a word along each
+// row. Queries take world-space shapes and read only the words of the cells they cover, so
+// their cost follows the size of the shape, not of the map. Cells outside the map are open.
+typedef struct CollisionMap
+{
+    uint64_t *bits;
+    int width; // Tiles
+    int height;
+    int wordsPerRow;
+    float cellSize; // World units per tile
+    int blockedCount;
+} CollisionMap;
+
+typedef struct CollisionHit
+{
+    float time;     // Sweeps: fraction of the motion before contact. Rays: distance travelled
+    Vector2 normal; // Outward normal of the face that was hit; zero if the ray started inside
+    int cellX;
+    int cellY;
+} CollisionHit;
+
+bool InitCollisionMap(CollisionMap *map, int width, int height, float cellSize);
+void FreeCollisionMap(CollisionMap *map);
+void SetCollisionCell(CollisionMap *map, int x, int y, bool blocked);
+bool IsCollisionCellBlocked(const CollisionMap *map, int x, int y);
+
+// True if rec overlaps a blocked cell, with the same strict edges as CheckCollisionRecs
+bool CheckCollisionMapRec(const CollisionMap *map, Rectangle rec);
+// Earliest contact of rec moving by motion. Cells it already overlaps are ignored, so a box
+// pushed into a wall can always leave it.
+bool SweepCollisionMapRec(const CollisionMap *map, Rectangle rec, Vector2 motion, CollisionHit *hit);
+// Motion rec can make: stops at the first face hit and slides along it with what is left
+Vector2 SlideCollisionMapRec(const CollisionMap *map, Rectangle rec, Vector2 motion);
+// First blocked cell along the ray within maxDistance, visiting cells in order
+bool RaycastCollisionMap(const CollisionMap *map, Vector2 origin, Vector2 direction, float maxDistance, CollisionHit *hit);
@@ -2,57 +2,27 @@
 
 #include "custom_cursor.h"
 
-// Global variables for cursor textures and state
-static Texture2D cursorDefault;
-static Texture2D cursorHover;
-static Texture2D *currentCursor;  // Pointer to the current cursor texture
+// Global variables for cursor sprites and state
+static Sprite cursorDefault;
+static Sprite cursorHover;
+static Sprite *currentCursor;  // Pointer to the current cursor sprite
 
 void InitCustomCursor(AssetManager *manager)
 {
-    cursorDefault = GetSprite(manager, "mouse").texture;  // Default pointer
-    cursorHover = GetSprite(manager, "select").texture;    // Hover pointer
+    Sprite *mouseSprite = GetSpriteById(manager, FindSpriteId(manager, "mouse"));
+    Sprite *selectSprite = GetSpriteById(manager, FindSpriteId(manager, "select"));
+    cursorDefault = mouseSprite ? *mouseSprite : (Sprite){0};   // Default pointer
+    cursorHover = selectSprite ? *selectSprite : (Sprite){0};   // Hover pointer
     currentCursor = &cursorDefault;                    // Start with the default cursor
 
     HideCursor(); // Hide the system cursor
 }
 
-void UpdateCustomCursor(NPC *npcs, int npcCount, Building *buildings, int buildingCount)
+void UpdateCustomCursor(PickIndex *picks)
 {
-    Vector2 mousePosition = GetMousePosition();
-    bool isHovering = false;
-
-    // Check if the mouse is hovering over any NPC
-    for (int i = 0; i < npcCount; i++)
-    {
-        float radius = npcs[i].animation.frameWidth / 2.0f; // Assuming circular NPCs
-        if (CheckCollisionPointCircle(mousePosition, npcs[i].position, radius))
-        {
-            isHovering = true;
-            break;
-        }
-    }
-
-    // Check if the mouse is hovering over any building
-    if (!isHovering)
-    {
-        for (int i = 0; i < buildingCount; i++)
-        {
-            float width = buildings[i].completedSprite.texture.width;
-            float height = buildings[i].completedSprite.texture.height;
-            Rectangle buildingRect = {
-                buildings[i].position.x - width / 2,
-                buildings[i].position.y - height / 2,
-                width,
-                height
-            };
-
-            if (CheckCollisionPointRec(mousePosition, buildingRect))
-            {
-                isHovering = true;
-                break;
-            }
-        }
-    }
+    // Hover over exactly what a click would pick
+    const PickHit *hits;
+    bool isHovering = QueryPickPoint(picks, GetMousePosition(), PICK_ANY, &hits) > 0;
 
     // Change the cursor based on hover status
     currentCursor = isHovering ? &cursorHover : &cursorDefault;
@@ -61,11 +31,12 @@ void UpdateCustomCursor(NPC *npcs, int npcCount, Building *buildings, int buildi
 void DrawCustomCursor()
 {
     Vector2 mousePosition = GetMousePosition();
+    SyncSpriteCopy(&manager, currentCursor); // currentCursor points at one of the copies above
 
     // Adjust the cursor position so the pointer's "hotspot" is at its center
     int offsetX = currentCursor->width / 2;
     int offsetY = currentCursor->height / 2;
-    DrawTexture(*currentCursor, mousePosition.x - offsetX, mousePosition.y - offsetY, WHITE);
+    DrawSprite(currentCursor, (Vector2){mousePosition.x - offsetX, mousePosition.y - offsetY}, WHITE);
 }
 
 void UnloadCustomCursor()
@@ -4,10 +4,11 @@
 
 #include "raylib.h"
 #include "asset_manager.h"
-#include "npc.h"
+#include "npc_store.h"
 #include "buildings.h"
+#include "pick_index.h"
 
 void InitCustomCursor(AssetManager *manager);
-void UpdateCustomCursor(NPC *npcs, int npcCount, Building *buildings, int buildingCount);
+void UpdateCustomCursor(PickIndex *picks); // Hover cursor over any NPC or building box
 void DrawCustomCursor();
 void UnloadCustomCursor();
\ No newline at end of file
@@ -0,0 +1,306 @@
+// flow_field.c
+
+#include "flow_field.h"
+#include "min_heap.h"
+#include "sim_clock.h"
+#include "tile_placement_data.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const int flowDirectionX[8] = {1, 1, 0, -1, -1, -1, 0, 1};
+const int flowDirectionY[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+
+static FlowField *fields = NULL;
+static int fieldCount = 0; // Slots in use or free; occupied marks the live ones
+static int fieldCapacity = 0;
+static unsigned long long useClock = 0;
+static FlowFieldStats stats;
+
+// Collidable tiles, flattened from tileStore once per collision revision
+static unsigned char *blockedTiles = NULL;
+static int blockedWidth = 0;
+static int blockedHeight = 0;
+static unsigned int blockedRevision = 0;
+static bool blockedValid = false;
+
+static Heap openList; // (cost, tile) for Dijkstra; stale entries are skipped when popped
+
+static bool RefreshBlockedTiles(void)
+{
+    if (blockedValid && blockedRevision == tileCollisionRevision && blockedWidth == mapTilesX && blockedHeight == mapTilesY)
+        return true;
+
+    int count = mapTilesX * mapTilesY;
+    unsigned char *grown = realloc(blockedTiles, count > 0 ? count : 1);
+    if (grown == NULL)
+    {
+        fprintf(stderr, "Failed to allocate flow field collision map for %dx%d tiles.\n", mapTilesX, mapTilesY);
+        return false;
+    }
+    blockedTiles = grown;
+    memset(blockedTiles, 0, count);
+    for (int y = 0; tileCollisionMap.blockedCount > 0 && y < mapTilesY; y++)
+    {
+        for (int x = 0; x < mapTilesX; x++)
+            blockedTiles[y * mapTilesX + x] = IsCollisionCellBlocked(&tileCollisionMap, x, y);
+    }
+    blockedWidth = mapTilesX;
+    blockedHeight = mapTilesY;
+    blockedRevision = tileCollisionRevision;
+    blockedValid = true;
+    return true;
+}
+
+static bool IsBlocked(int x, int y)
+{
+    return x < 0 || y < 0 || x >= blockedWidth || y >= blockedHeight || blockedTiles[y * blockedWidth + x];
+}
+
+// Diagonal steps need both tiles they squeeze between to be open
+static bool CanStep(int x, int y, int direction)
+{
+    int nx = x + flowDirectionX[direction];
+    int ny = y + flowDirectionY[direction];
+    if (IsBlocked(nx, ny))
+        return false;
+    if (direction & 1)
+        return !IsBlocked(nx, y) && !IsBlocked(x, ny);
+    return true;
+}
+
+// Dijkstra outwards from the goal. The direction of each tile is set when its cost improves, to
+// point back at the tile that improved it, so the direction field comes out of the same pass.
+static bool BuildFlowField(FlowField *field)
+{
+    double startTime = GetMonotonicSeconds();
+    int width = blockedWidth, height = blockedHeight;
+    int count = width * height;
+    if (field->width != width || field->height != height || field->integration == NULL)
+    {
+        float *integration = realloc(field->integration, (count > 0 ? count : 1) * sizeof(float));
+        if (integration)
+            field->integration = integration;
+        unsigned char *direction = realloc(field->direction, count > 0 ? count : 1);
+        if (direction)
+            field->direction = direction;
+        if (!integration || !direction)
+        {
+            fprintf(stderr, "Failed to allocate flow field for %dx%d tiles.\n", width, height);
+            return false;
+        }
+        field->width = width;
+        field->height = height;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        field->integration[i] = FLOW_UNREACHABLE;
+    }
+    memset(field->direction, FLOW_DIRECTION_NONE, count);
+    field->revision = blockedRevision;
+
+    int goal = field->goalY * width + field->goalX;
+    field->integration[goal] = 0.0f;
+    field->direction[goal] = FLOW_DIRECTION_GOAL;
+    openList.count = 0;
+    PushHeap(&openList, 0.0f, goal);
+    while (openList.count > 0)
+    {
+        float cost = openList.entries[0].key;
+        int tile = PopHeap(&openList);
+        if (cost > field->integration[tile])
+            continue; // Already settled through a cheaper entry
+
+        int x = tile % width, y = tile / width;
+        for (int d = 0; d < 8; d++)
+        {
+            if (!CanStep(x, y, d))
+                continue;
+            int next = (y + flowDirectionY[d]) * width + x + flowDirectionX[d];
+            float nextCost = cost + ((d & 1) ? 1.41421356f : 1.0f);
+            if (nextCost < field->integration[next])
+            {
+                field->integration[next] = nextCost;
+                field->direction[next] = (unsigned char)((d + 4) & 7);
+                if (!PushHeap(&openList, nextCost, next))
+                {
+                    fprintf(stderr, "Failed to grow the flow field queue.\n");
+                    return false;
+                }
+            }
+        }
+    }
+
+    stats.builds++;
+    stats.buildSeconds += GetMonotonicSeconds() - startTime;
+    return true;
+}
+
+static void FreeFieldBuffers(FlowField *field)
+{
+    free(field->integration);
+    free(field->direction);
+    field->integration = NULL;
+    field->direction = NULL;
+    field->width = field->height = 0;
+}
+
+// A free slot, reusing the least recently used unreferenced field once FLOW_FIELD_CACHE_SIZE
+// of them are cached
+static int ClaimFieldSlot(void)
+{
+    int unused = 0, oldest = -1, freeSlot = -1;
+    for (int i = 0; i < fieldCount; i++)
+    {
+        if (!fields[i].occupied)
+        {
+            if (freeSlot < 0)
+                freeSlot = i;
+            continue;
+        }
+        if (fields[i].refCount > 0)
+            continue;
+        unused++;
+        if (oldest < 0 || fields[i].lastUsed < fields[oldest].lastUsed)
+            oldest = i;
+    }
+    if (unused >= FLOW_FIELD_CACHE_SIZE)
+    {
+        fields[oldest].occupied = false; // Keeps its buffers for the next build
+        stats.evictions++;
+        stats.liveFields--;
+        return oldest;
+    }
+    if (freeSlot >= 0)
+        return freeSlot;
+
+    if (fieldCount >= fieldCapacity)
+    {
+        int newCapacity = fieldCapacity > 0 ? fieldCapacity * 2 : 16;
+        FlowField *grown = realloc(fields, newCapacity * sizeof(FlowField));
+        if (grown == NULL)
+            return -1;
+        fields = grown;
+        fieldCapacity = newCapacity;
+    }
+    memset(&fields[fieldCount], 0, sizeof(FlowField));
+    return fieldCount++;
+}
+
+FlowFieldId AcquireFlowField(int goalX, int goalY)
+{
+    if (!RefreshBlockedTiles() || IsBlocked(goalX, goalY))
+        return INVALID_FLOW_FIELD;
+
+    for (int i = 0; i < fieldCount; i++)
+    {
+        FlowField *field = &fields[i];
+        if (field->occupied && field->goalX == goalX && field->goalY == goalY)
+        {
+            if (field->revision != blockedRevision || field->width != blockedWidth || field->height != blockedHeight)
+            {
+                stats.rebuilds++;
+                if (!BuildFlowField(field))
+                    return INVALID_FLOW_FIELD;
+            }
+            else
+            {
+                stats.cacheHits++;
+            }
+            field->refCount++;
+            field->lastUsed = ++useClock;
+            return i;
+        }
+    }
+
+    int slot = ClaimFieldSlot();
+    if (slot < 0)
+        return INVALID_FLOW_FIELD;
+    FlowField *field = &fields[slot];
+    field->goalX = goalX;
+    field->goalY = goalY;
+    if (!BuildFlowField(field))
+    {
+        FreeFieldBuffers(field);
+        return INVALID_FLOW_FIELD;
+    }
+    field->occupied = true;
+    field->refCount = 1;
+    field->lastUsed = ++useClock;
+    stats.liveFields++;
+    return slot;
+}
+
+void RetainFlowField(FlowFieldId id)
+{
+    if (id >= 0 && id < fieldCount && fields[id].occupied)
+        fields[id].refCount++;
+}
+
+void ReleaseFlowField(FlowFieldId id)
+{
+    if (id >= 0 && id < fieldCount && fields[id].occupied && fields[id].refCount > 0)
+        fields[id].refCount--;
+}
+
+const FlowField *GetFlowField(FlowFieldId id)
+{
+    if (id < 0 || id >= fieldCount || !fields[id].occupied)
+        return NULL;
+    return &fields[id];
+}
+
+bool GetFlowFieldStep(const FlowField *field, int cellX, int cellY, int *nextX, int *nextY)
+{
+    if (cellX < 0 || cellY < 0 || cellX >= field->width || cellY >= field->height)
+        return false;
+    unsigned char direction = field->direction[cellY * field->width + cellX];
+    if (direction >= 8)
+        return false;
+    *nextX = cellX + flowDirectionX[direction];
+    *nextY = cellY + flowDirectionY[direction];
+    return true;
+}
+
+void RefreshFlowFields(void)
+{
+    bool checked = false;
+    for (int i = 0; i < fieldCount; i++)
+    {
+        FlowField *field = &fields[i];
+        if (!field->occupied || field->refCount == 0)
+            continue;
+        if (!checked)
+        {
+            if (!RefreshBlockedTiles())
+                return;
+            checked = true;
+        }
+        if (field->revision != blockedRevision || field->width != blockedWidth || field->height != blockedHeight)
+        {
+            stats.rebuilds++;
+            BuildFlowField(field);
+        }
+    }
+}
+
+void ResetFlowFields(void)
+{
+    for (int i = 0; i < fieldCount; i++)
+    {
+        FreeFieldBuffers(&fields[i]);
+    }
+    free(fields);
+    fields = NULL;
+    fieldCount = fieldCapacity = 0;
+    free(blockedTiles);
+    blockedTiles = NULL;
+    blockedValid = false;
+    FreeHeap(&openList);
+    stats.liveFields = 0;
+}
+
+FlowFieldStats GetFlowFieldStats(void)
+{
+    return stats;
+}
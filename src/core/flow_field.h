@@ -0,0 +1,62 @@
+// flow_field.h
+
+#pragma once
+
+#include "raylib.h"
+#include <stdbool.h>
+
+#define FLOW_FIELD_CACHE_SIZE 8  // Unused fields kept around for later orders to the same cell
+#define FLOW_DIRECTION_GOAL 8    // direction[] of the goal cell
+#define FLOW_DIRECTION_NONE 255  // direction[] of blocked cells and cells with no path to the goal
+#define FLOW_UNREACHABLE 1e30f   // integration[] of the same cells
+
+// Shortest paths from every tile to one goal tile over the placed-tile collision map, so any
+// number of units ordered to the same place share a single Dijkstra pass. Movement is
+// 8-connected; diagonal steps cost sqrt(2) and may not cut the corner of a collidable tile.
+typedef struct FlowField
+{
+    int goalX;
+    int goalY;
+    int width; // Tiles, as mapTilesX/mapTilesY when built
+    int height;
+    unsigned int revision;    // tileCollisionRevision the field was built from
+    float *integration;       // Path cost from each tile to the goal, row-major
+    unsigned char *direction; // Step towards the goal from each tile: index into flowDirectionX/Y
+    int refCount;             // Units following the field
+    unsigned long long lastUsed;
+    bool occupied;
+} FlowField;
+
+typedef int FlowFieldId;
+#define INVALID_FLOW_FIELD (-1)
+
+typedef struct FlowFieldStats
+{
+    int builds;     // Dijkstra passes, including rebuilds
+    int rebuilds;   // Builds of a cached field whose collision data had changed
+    int cacheHits;  // Acquires answered by an existing field
+    int evictions;
+    int liveFields; // Fields currently allocated
+    double buildSeconds;
+} FlowFieldStats;
+
+// Tile offsets of the 8 directions; direction d and (d + 4) & 7 are opposite
+extern const int flowDirectionX[8];
+extern const int flowDirectionY[8];
+
+// Returns a field towards the goal tile with one reference held by the caller, building it
+// only if no cached field has that goal. INVALID_FLOW_FIELD if the goal is off the map or
+// collidable.
+FlowFieldId AcquireFlowField(int goalX, int goalY);
+void RetainFlowField(FlowFieldId id);
+void ReleaseFlowField(FlowFieldId id);
+const FlowField *GetFlowField(FlowFieldId id);
+
+// Tile to step to from (cellX, cellY); false at the goal, off the field, or with no path
+bool GetFlowFieldStep(const FlowField *field, int cellX, int cellY, int *nextX, int *nextY);
+
+// Rebuilds referenced fields built from older collision data. Unreferenced ones rebuild when
+// next acquired. Call from the thread that owns the fields, between updates.
+void RefreshFlowFields(void);
+void ResetFlowFields(void); // Frees every field; outstanding ids become invalid
+FlowFieldStats GetFlowFieldStats(void);
@@ -0,0 +1,674 @@
+// map_file.c
+
+#include "map_file.h"
+#include "worker_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define MAP_FILE_V1_HEADER_SIZE 12
+#define MAP_FILE_MAX_VARINT 10 // Bytes in the longest 64-bit varint
+
+typedef struct MapBuffer
+{
+    unsigned char *data;
+    size_t size;
+    size_t capacity;
+} MapBuffer;
+
+typedef struct MapChunkJob
+{
+    TileStore *store;
+    int width;
+    int height;
+    int chunksX;
+    int chunkCount;
+
+    // Encoding: each worker appends its range of chunks to its own buffer, writing cells'
+    // stacks by their index in the file's palette
+    MapBuffer buffers[MAX_POOL_WORKERS];
+    uint32_t *chunkSizes;
+    const uint32_t *fileStacks;
+
+    // Decoding: the store's stack for each stack of the file's palette
+    const unsigned char *data;
+    size_t size;
+    const uint16_t *storeStacks;
+    int paletteCount;
+    bool failed[MAX_POOL_WORKERS];
+} MapChunkJob;
+
+static uint32_t ReadBigEndian32(const unsigned char *bytes)
+{
+    return (uint32_t)bytes[0] << 24 | (uint32_t)bytes[1] << 16 | (uint32_t)bytes[2] << 8 | bytes[3];
+}
+
+// The header's version word holds these bytes whatever the host byte order
+static uint32_t BigEndianWord(uint32_t value)
+{
+    unsigned char bytes[4] = {(unsigned char)(value >> 24), (unsigned char)(value >> 16), (unsigned char)(value >> 8),
+                              (unsigned char)value};
+    uint32_t word;
+    memcpy(&word, bytes, sizeof(word));
+    return word;
+}
+
+static void GetChunkRange(int count, int worker, int workerCount, int *begin, int *end)
+{
+    *begin = (int)((long long)count * worker / workerCount);
+    *end = (int)((long long)count * (worker + 1) / workerCount);
+}
+
+// Cells of chunk c, clipped to the map
+static void GetChunkCells(const MapChunkJob *job, int chunk, int *x0, int *y0, int *x1, int *y1)
+{
+    *x0 = chunk % job->chunksX * MAP_CHUNK_SIZE;
+    *y0 = chunk / job->chunksX * MAP_CHUNK_SIZE;
+    *x1 = *x0 + MAP_CHUNK_SIZE < job->width ? *x0 + MAP_CHUNK_SIZE : job->width;
+    *y1 = *y0 + MAP_CHUNK_SIZE < job->height ? *y0 + MAP_CHUNK_SIZE : job->height;
+}
+
+// Runs job on up to one worker per chunk. A pool is started per call; that costs far less than
+// the file I/O around it.
+static void RunMapChunkJob(MapChunkJob *job, WorkerJob run)
+{
+    int workerCount = GetDefaultWorkerCount();
+    if (workerCount > job->chunkCount)
+        workerCount = job->chunkCount;
+    if (workerCount <= 1)
+    {
+        run(job, 0, 1);
+        return;
+    }
+    WorkerPool pool;
+    InitWorkerPool(&pool, workerCount);
+    RunWorkerPool(&pool, run, job);
+    FreeWorkerPool(&pool);
+}
+
+static bool ReserveMapBuffer(MapBuffer *buffer, size_t extra)
+{
+    if (buffer->size + extra <= buffer->capacity)
+        return true;
+    size_t capacity = buffer->capacity > 0 ? buffer->capacity : 4096;
+    while (capacity < buffer->size + extra)
+        capacity *= 2;
+    unsigned char *data = realloc(buffer->data, capacity);
+    if (data == NULL)
+        return false;
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return true;
+}
+
+static void PutVarint(MapBuffer *buffer, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        buffer->data[buffer->size++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    buffer->data[buffer->size++] = (unsigned char)value;
+}
+
+// Reads a varint at *cursor, stopping at end; false if it runs past end or over 64 bits
+static bool GetVarint(const unsigned char **cursor, const unsigned char *end, uint64_t *value)
+{
+    *value = 0;
+    for (int shift = 0; shift < 64 && *cursor < end; shift += 7)
+    {
+        unsigned char byte = *(*cursor)++;
+        *value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+static uint64_t EncodeTile(uint32_t entry)
+{
+    uint32_t zigzag = (uint32_t)GetTileEntryRef(entry) << 1; // Store entries are never negative
+    return (uint64_t)zigzag << 1 | IsTileEntryCollidable(entry);
+}
+
+// False for tiles the store cannot hold: negative ones, or ones that reach the collision bit
+static bool DecodeTile(uint64_t value, uint32_t *entry)
+{
+    uint64_t zigzag = value >> 1;
+    if ((zigzag & 1) || zigzag >> 1 >= TILE_ENTRY_COLLIDABLE)
+        return false;
+    *entry = (uint32_t)(zigzag >> 1) | ((value & 1) ? TILE_ENTRY_COLLIDABLE : 0);
+    return true;
+}
+
+static bool PutStack(MapBuffer *buffer, TileSpan span)
+{
+    if (!ReserveMapBuffer(buffer, (size_t)(1 + span.count) * MAP_FILE_MAX_VARINT))
+        return false;
+    PutVarint(buffer, (uint64_t)span.count);
+    for (int i = 0; i < span.count; i++)
+    {
+        PutVarint(buffer, EncodeTile(span.entries[i]));
+    }
+    return true;
+}
+
+static bool PutRun(MapBuffer *buffer, int length, uint32_t stack)
+{
+    if (!ReserveMapBuffer(buffer, 2 * MAP_FILE_MAX_VARINT))
+        return false;
+    PutVarint(buffer, (uint64_t)length);
+    PutVarint(buffer, stack);
+    return true;
+}
+
+static bool EncodeChunk(MapChunkJob *job, int chunk, MapBuffer *buffer)
+{
+    int x0, y0, x1, y1;
+    GetChunkCells(job, chunk, &x0, &y0, &x1, &y1);
+    const uint16_t *cells = job->store->cells;
+    int run = cells[(size_t)y0 * job->width + x0], length = 0;
+    for (int y = y0; y < y1; y++)
+    {
+        for (int x = x0; x < x1; x++)
+        {
+            int stack = cells[(size_t)y * job->width + x];
+            if (stack == run)
+            {
+                length++;
+                continue;
+            }
+            if (!PutRun(buffer, length, job->fileStacks[run]))
+                return false;
+            run = stack;
+            length = 1;
+        }
+    }
+    return PutRun(buffer, length, job->fileStacks[run]);
+}
+
+static void EncodeChunksJob(void *data, int worker, int workerCount)
+{
+    MapChunkJob *job = data;
+    MapBuffer *buffer = &job->buffers[worker];
+    int begin, end;
+    GetChunkRange(job->chunkCount, worker, workerCount, &begin, &end);
+    for (int chunk = begin; chunk < end; chunk++)
+    {
+        size_t start = buffer->size;
+        if (!EncodeChunk(job, chunk, buffer))
+        {
+            job->failed[worker] = true;
+            return;
+        }
+        job->chunkSizes[chunk] = (uint32_t)(buffer->size - start);
+    }
+}
+
+// Numbers the stacks some cell holds, the empty one first, and writes them as the palette
+static bool EncodePalette(const TileStore *store, uint32_t *fileStacks, MapBuffer *palette)
+{
+    uint32_t count = 0;
+    for (int i = 0; i < store->stackCount; i++)
+    {
+        bool used = i == 0 || (store->stacks[i].refs != TILE_STACK_FREED && store->stacks[i].refs > 0);
+        fileStacks[i] = used ? count++ : 0;
+    }
+    if (!ReserveMapBuffer(palette, MAP_FILE_MAX_VARINT))
+        return false;
+    PutVarint(palette, count);
+    for (int i = 0; i < store->stackCount; i++)
+    {
+        if ((i == 0 || fileStacks[i] != 0) && !PutStack(palette, GetPaletteSpan(store, i)))
+            return false;
+    }
+    return true;
+}
+
+static bool EncodeNameTable(const MapNameTable *names, MapBuffer *tables)
+{
+    for (int kind = 0; kind < TILE_REF_KINDS; kind++)
+    {
+        if (!ReserveMapBuffer(tables, MAP_FILE_MAX_VARINT))
+            return false;
+        PutVarint(tables, (uint64_t)names->counts[kind]);
+        for (int i = 0; i < names->counts[kind]; i++)
+        {
+            size_t length = strlen(names->names[kind][i]);
+            if (length > MAP_NAME_MAX || !ReserveMapBuffer(tables, MAP_FILE_MAX_VARINT + length))
+                return false;
+            PutVarint(tables, length);
+            memcpy(tables->data + tables->size, names->names[kind][i], length);
+            tables->size += length;
+        }
+    }
+    return true;
+}
+
+// Header, chunk table, name table and palette, and the workers' payloads in one buffer
+static unsigned char *AssembleMapFile(const MapChunkJob *job, const MapBuffer *tables, size_t *size)
+{
+    size_t payloadSize = 0;
+    for (int w = 0; w < MAX_POOL_WORKERS; w++)
+    {
+        if (job->failed[w])
+            return NULL;
+        payloadSize += job->buffers[w].size;
+    }
+    size_t tableOffset = sizeof(MapFileHeader);
+    size_t tablesOffset = tableOffset + (size_t)job->chunkCount * sizeof(MapChunkEntry);
+    size_t payloadOffset = tablesOffset + tables->size;
+    *size = payloadOffset + payloadSize;
+    unsigned char *image = malloc(*size);
+    if (image == NULL)
+        return NULL;
+
+    MapFileHeader header = {BigEndianWord(MAP_FILE_VERSION), MAP_FILE_MAGIC, (uint32_t)job->width, (uint32_t)job->height,
+                            MAP_CHUNK_SIZE, (uint32_t)job->chunkCount, (uint64_t)*size};
+    memcpy(image, &header, sizeof(header));
+    uint64_t offset = payloadOffset;
+    for (int chunk = 0; chunk < job->chunkCount; chunk++)
+    {
+        MapChunkEntry entry = {offset, job->chunkSizes[chunk], 0};
+        memcpy(image + tableOffset + (size_t)chunk * sizeof(MapChunkEntry), &entry, sizeof(entry));
+        offset += job->chunkSizes[chunk];
+    }
+    memcpy(image + tablesOffset, tables->data, tables->size);
+    // Workers took consecutive ranges of chunks, so their buffers concatenate in chunk order
+    for (int w = 0; w < MAX_POOL_WORKERS; w++)
+    {
+        if (job->buffers[w].size > 0)
+            memcpy(image + payloadOffset, job->buffers[w].data, job->buffers[w].size);
+        payloadOffset += job->buffers[w].size;
+    }
+    return image;
+}
+
+unsigned char *EncodeMapFile(const TileStore *store, const MapNameTable *names, size_t *size)
+{
+    MapChunkJob job = {0};
+    job.store = (TileStore *)store;
+    job.width = store->width;
+    job.height = store->height;
+    job.chunksX = (job.width + MAP_CHUNK_SIZE - 1) / MAP_CHUNK_SIZE;
+    job.chunkCount = job.chunksX * ((job.height + MAP_CHUNK_SIZE - 1) / MAP_CHUNK_SIZE);
+    job.chunkSizes = malloc((job.chunkCount > 0 ? job.chunkCount : 1) * sizeof(uint32_t));
+    uint32_t *fileStacks = malloc(store->stackCount * sizeof(uint32_t));
+    job.fileStacks = fileStacks;
+    MapBuffer tables = {0};
+
+    unsigned char *image = NULL;
+    bool named = EncodeNameTable(names, &tables);
+    if (named && job.chunkSizes != NULL && fileStacks != NULL && EncodePalette(store, fileStacks, &tables))
+    {
+        if (job.chunkCount > 0)
+            RunMapChunkJob(&job, EncodeChunksJob);
+        image = AssembleMapFile(&job, &tables, size);
+    }
+    if (!named)
+        fprintf(stderr, "Failed to encode the map's asset names.\n");
+    else if (image == NULL)
+        fprintf(stderr, "Failed to allocate map file buffers for %dx%d tiles.\n", job.width, job.height);
+    for (int w = 0; w < MAX_POOL_WORKERS; w++)
+    {
+        free(job.buffers[w].data);
+    }
+    free(tables.data);
+    free(fileStacks);
+    free(job.chunkSizes);
+    return image;
+}
+
+bool ReadMapFileInfo(const unsigned char *data, size_t size, int *version, int *width, int *height)
+{
+    if (size < MAP_FILE_V1_HEADER_SIZE)
+        return false;
+    *version = (int)ReadBigEndian32(data);
+    if (*version == 1)
+    {
+        *width = (int)ReadBigEndian32(data + 4);
+        *height = (int)ReadBigEndian32(data + 8);
+    }
+    else if (*version >= 2 && *version <= MAP_FILE_VERSION)
+    {
+        MapFileHeader header;
+        if (size < sizeof(header))
+            return false;
+        memcpy(&header, data, sizeof(header));
+        if (header.magic != MAP_FILE_MAGIC)
+            return false;
+        *width = (int)header.width;
+        *height = (int)header.height;
+    }
+    else
+    {
+        return false;
+    }
+    return *width > 0 && *height > 0 && *width <= MAP_FILE_MAX_SIDE && *height <= MAP_FILE_MAX_SIDE;
+}
+
+// Reads a stack written by PutStack into scratch (TILE_STACK_MAX entries) and interns it
+static bool GetStack(const unsigned char **cursor, const unsigned char *end, TileStore *store, uint32_t *scratch,
+                     int *stack)
+{
+    uint64_t count;
+    if (!GetVarint(cursor, end, &count) || count > (uint64_t)(end - *cursor) || count > TILE_STACK_MAX)
+        return false;
+    for (int i = 0; i < (int)count; i++)
+    {
+        uint64_t value;
+        if (!GetVarint(cursor, end, &value) || !DecodeTile(value, &scratch[i]))
+            return false;
+    }
+    if ((*stack = InternTileStack(store, scratch, (int)count)) < 0)
+    {
+        fprintf(stderr, "Map holds more than %d distinct tile stacks.\n", TILE_PALETTE_MAX);
+        return false;
+    }
+    return true;
+}
+
+// Version 1 stores every cell's stack in full, row by row
+static bool ParseMapFileV1(const unsigned char *data, size_t size, TileStore *store, uint32_t *scratch)
+{
+    const unsigned char *cursor = data + MAP_FILE_V1_HEADER_SIZE, *end = data + size;
+    uint16_t *cells = store->cells;
+    for (int y = 0; y < store->height; y++)
+    {
+        for (int x = 0; x < store->width; x++, cells++)
+        {
+            if (end - cursor < 4)
+                return false;
+            int count = (int)ReadBigEndian32(cursor);
+            cursor += 4;
+            if (count <= 0)
+                continue;
+            if ((end - cursor) / 5 < count || count > TILE_STACK_MAX)
+                return false;
+            for (int i = 0; i < count; i++, cursor += 5)
+            {
+                int tile = (int)ReadBigEndian32(cursor);
+                if (tile < 0)
+                    return false;
+                scratch[i] = (uint32_t)tile | (cursor[4] ? TILE_ENTRY_COLLIDABLE : 0);
+            }
+            int stack = InternTileStack(store, scratch, count);
+            if (stack < 0)
+            {
+                fprintf(stderr, "Map holds more than %d distinct tile stacks.\n", TILE_PALETTE_MAX);
+                return false;
+            }
+            *cells = (uint16_t)stack;
+        }
+    }
+    return true;
+}
+
+// Bounds of chunk c's payload; false if the table points outside the file
+static bool GetChunkPayload(const MapChunkJob *job, int chunk, const unsigned char **cursor, const unsigned char **end)
+{
+    MapChunkEntry entry;
+    memcpy(&entry, job->data + sizeof(MapFileHeader) + (size_t)chunk * sizeof(MapChunkEntry), sizeof(entry));
+    if (entry.offset > job->size || entry.size > job->size - entry.offset)
+        return false;
+    *cursor = job->data + entry.offset;
+    *end = *cursor + entry.size;
+    return true;
+}
+
+// Store cell of the n-th cell of chunk c, counting row by row within the chunk
+static uint16_t *GetChunkCell(const MapChunkJob *job, int x0, int y0, int chunkWidth, int n)
+{
+    return &job->store->cells[(size_t)(y0 + n / chunkWidth) * job->width + x0 + n % chunkWidth];
+}
+
+// Version 2 chunks hold their runs' stacks in full, so they are interned one run at a time
+static bool ParseChunkV2(MapChunkJob *job, int chunk, uint32_t *scratch)
+{
+    const unsigned char *cursor, *end;
+    if (!GetChunkPayload(job, chunk, &cursor, &end))
+        return false;
+    int x0, y0, x1, y1;
+    GetChunkCells(job, chunk, &x0, &y0, &x1, &y1);
+    int chunkWidth = x1 - x0, cells = chunkWidth * (y1 - y0);
+    for (int cell = 0; cell < cells;)
+    {
+        uint64_t length;
+        int stack;
+        if (!GetVarint(&cursor, end, &length) || length == 0 || length > (uint64_t)(cells - cell) ||
+            !GetStack(&cursor, end, job->store, scratch, &stack))
+            return false;
+        for (int n = 0; n < (int)length; n++, cell++)
+            *GetChunkCell(job, x0, y0, chunkWidth, cell) = (uint16_t)stack;
+    }
+    return cursor == end;
+}
+
+// Chunks from version 3 on only name palette entries, so they decode on every worker at once
+static bool ParseChunkV3(MapChunkJob *job, int chunk)
+{
+    const unsigned char *cursor, *end;
+    if (!GetChunkPayload(job, chunk, &cursor, &end))
+        return false;
+    int x0, y0, x1, y1;
+    GetChunkCells(job, chunk, &x0, &y0, &x1, &y1);
+    int chunkWidth = x1 - x0, cells = chunkWidth * (y1 - y0);
+    for (int cell = 0; cell < cells;)
+    {
+        uint64_t length, stack;
+        if (!GetVarint(&cursor, end, &length) || !GetVarint(&cursor, end, &stack) || length == 0 ||
+            length > (uint64_t)(cells - cell) || stack >= (uint64_t)job->paletteCount)
+            return false;
+        uint16_t storeStack = job->storeStacks[stack];
+        for (int n = 0; n < (int)length; n++, cell++)
+            *GetChunkCell(job, x0, y0, chunkWidth, cell) = storeStack;
+    }
+    return cursor == end;
+}
+
+static void ParseChunksJob(void *data, int worker, int workerCount)
+{
+    MapChunkJob *job = data;
+    int begin, end;
+    GetChunkRange(job->chunkCount, worker, workerCount, &begin, &end);
+    for (int chunk = begin; chunk < end && !job->failed[worker]; chunk++)
+    {
+        job->failed[worker] = !ParseChunkV3(job, chunk);
+    }
+}
+
+void FreeMapNameTable(MapNameTable *table)
+{
+    for (int kind = 0; kind < TILE_REF_KINDS; kind++)
+        free(table->names[kind]);
+    free(table->text);
+    memset(table, 0, sizeof(MapNameTable));
+}
+
+// Reads the name table at *cursor in two passes: one to check it and size the text, one to
+// copy the names out
+static bool GetNameTable(const unsigned char **cursor, const unsigned char *end, MapNameTable *names)
+{
+    const unsigned char *start = *cursor;
+    size_t textSize = 0;
+    for (int kind = 0; kind < TILE_REF_KINDS; kind++)
+    {
+        uint64_t count, length;
+        if (!GetVarint(cursor, end, &count) || count > TILE_REF_MAX_SOURCES || count > (uint64_t)(end - *cursor))
+            return false;
+        for (uint64_t i = 0; i < count; i++)
+        {
+            if (!GetVarint(cursor, end, &length) || length > MAP_NAME_MAX || length > (uint64_t)(end - *cursor))
+                return false;
+            *cursor += length;
+            textSize += length + 1;
+        }
+        names->counts[kind] = (int)count;
+        names->names[kind] = malloc((count > 0 ? count : 1) * sizeof(const char *));
+        if (names->names[kind] == NULL)
+            return false;
+    }
+    char *text = names->text = malloc(textSize > 0 ? textSize : 1);
+    if (text == NULL)
+        return false;
+    *cursor = start;
+    for (int kind = 0; kind < TILE_REF_KINDS; kind++)
+    {
+        uint64_t count, length;
+        GetVarint(cursor, end, &count);
+        for (uint64_t i = 0; i < count; i++)
+        {
+            GetVarint(cursor, end, &length);
+            memcpy(text, *cursor, length);
+            text[length] = '\0';
+            names->names[kind][i] = text;
+            text += length + 1;
+            *cursor += length;
+        }
+    }
+    return true;
+}
+
+// Interns the palette at cursor, then decodes the chunks in parallel
+static bool DecodePaletteAndChunks(MapChunkJob *job, const unsigned char *cursor, uint32_t *scratch)
+{
+    const unsigned char *end = job->data + job->size;
+    uint64_t count;
+    if (!GetVarint(&cursor, end, &count) || count == 0 || count > TILE_PALETTE_MAX)
+        return false;
+    uint16_t *storeStacks = malloc(count * sizeof(uint16_t));
+    if (storeStacks == NULL)
+        return false;
+    bool decoded = true;
+    for (uint64_t i = 0; i < count && decoded; i++)
+    {
+        int stack;
+        decoded = GetStack(&cursor, end, job->store, scratch, &stack);
+        storeStacks[i] = (uint16_t)stack;
+    }
+    job->storeStacks = storeStacks;
+    job->paletteCount = (int)count;
+    if (decoded && job->chunkCount > 0)
+    {
+        RunMapChunkJob(job, ParseChunksJob);
+        for (int w = 0; w < MAX_POOL_WORKERS; w++)
+            decoded = decoded && !job->failed[w];
+    }
+    free(storeStacks);
+    return decoded;
+}
+
+static bool DecodeMapFileBody(const unsigned char *data, size_t size, int version, TileStore *store, uint32_t *scratch,
+                              MapNameTable *names)
+{
+    if (version == 1)
+        return ParseMapFileV1(data, size, store, scratch);
+
+    MapFileHeader header;
+    memcpy(&header, data, sizeof(header));
+    MapChunkJob job = {0};
+    job.store = store;
+    job.width = store->width;
+    job.height = store->height;
+    job.chunksX = (job.width + MAP_CHUNK_SIZE - 1) / MAP_CHUNK_SIZE;
+    job.chunkCount = job.chunksX * ((job.height + MAP_CHUNK_SIZE - 1) / MAP_CHUNK_SIZE);
+    job.data = data;
+    job.size = size;
+    if (header.fileSize != size || header.chunkSize != MAP_CHUNK_SIZE || header.chunkCount != (uint32_t)job.chunkCount ||
+        (size - sizeof(header)) / sizeof(MapChunkEntry) < (size_t)job.chunkCount)
+        return false;
+    if (version >= 3)
+    {
+        const unsigned char *cursor = data + sizeof(MapFileHeader) + (size_t)job.chunkCount * sizeof(MapChunkEntry);
+        if (version >= 4 && !GetNameTable(&cursor, data + size, names))
+            return false;
+        return DecodePaletteAndChunks(&job, cursor, scratch);
+    }
+    for (int chunk = 0; chunk < job.chunkCount; chunk++)
+    {
+        if (!ParseChunkV2(&job, chunk, scratch))
+            return false;
+    }
+    return true;
+}
+
+bool DecodeMapFile(const unsigned char *data, size_t size, TileStore *store, MapNameTable *names)
+{
+    memset(names, 0, sizeof(MapNameTable));
+    int version, width, height;
+    if (!ReadMapFileInfo(data, size, &version, &width, &height) || width != store->width || height != store->height)
+        return false;
+    uint32_t *scratch = malloc(TILE_STACK_MAX * sizeof(uint32_t));
+    if (scratch == NULL)
+        return false;
+    bool decoded = DecodeMapFileBody(data, size, version, store, scratch, names);
+    free(scratch);
+    if (decoded)
+        RecountTileStoreRefs(store);
+    else
+        FreeMapNameTable(names);
+    return decoded;
+}
+
+// Reads the whole file with one fread; for systems without mmap, or files it refuses
+static bool ReadMapFileView(const char *filename, MapFileView *view)
+{
+    FILE *file = fopen(filename, "rb");
+    if (!file)
+        return false;
+    unsigned char *data = NULL;
+    long length = fseek(file, 0, SEEK_END) == 0 ? ftell(file) : -1;
+    if (length > 0 && fseek(file, 0, SEEK_SET) == 0 && (data = malloc(length)) != NULL &&
+        fread(data, 1, length, file) != (size_t)length)
+    {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+    view->data = data;
+    view->size = data ? (size_t)length : 0;
+    return data != NULL;
+}
+
+bool OpenMapFileView(const char *filename, MapFileView *view)
+{
+    memset(view, 0, sizeof(MapFileView));
+#if !defined(_WIN32)
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0)
+    {
+        void *data = mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED)
+        {
+            madvise(data, (size_t)fileStat.st_size, MADV_SEQUENTIAL);
+            view->data = data;
+            view->size = (size_t)fileStat.st_size;
+            view->mapped = true;
+        }
+    }
+    close(fd);
+    if (view->mapped)
+        return true;
+#endif
+    return ReadMapFileView(filename, view);
+}
+
+void CloseMapFileView(MapFileView *view)
+{
+#if !defined(_WIN32)
+    if (view->mapped)
+        munmap((void *)view->data, view->size);
+    else
+#endif
+        free((void *)view->data);
+    memset(view, 0, sizeof(MapFileView));
+}
@@ -0,0 +1,99 @@
+// map_file.h
+
+#pragma once
+
+#include "tile_store.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Tile map files written by SaveTilePlacement and read by LoadTilePlacement. The first four
+// bytes are the format version, big-endian in every version, so the loader can tell them apart.
+//
+// Version 1 (read only; every value big-endian):
+//   int32 version, width, height
+//   per cell, row by row: int32 tile count, then per tile int32 tile and one bool byte
+//
+// Version 2 (read only; native byte order after the version; the magic doubles as an
+// endianness check):
+//   MapFileHeader
+//   MapChunkEntry[chunkCount]   chunks of MAP_CHUNK_SIZE x MAP_CHUNK_SIZE cells (clipped at the
+//                               map edges), row by row
+//   chunk payloads
+// A chunk payload lists its cells row by row as runs of identical stacks: varint run length,
+// then the stack: varint tile count, then per tile varint (zigzag(tile) << 1 | collidable).
+//
+// Version 3 is version 2 with the distinct stacks written once, in a palette:
+//   MapFileHeader
+//   MapChunkEntry[chunkCount]
+//   palette                     varint stack count, then each stack as in version 2; stack 0
+//                               is the empty one
+//   chunk payloads              runs of cells: varint run length, varint palette index
+// Chunks are encoded and decoded independently, so both run on every worker.
+//
+// Up to version 3 a tile is tilemapIndex * 1000 + i, where i counts the tilemap's tiles, then
+// every sprite, then every animation, so it only means something with the assets loaded as
+// they were when it was saved. Version 4 is version 3 with TileRef tiles and, between the chunk
+// table and the palette, the names their sources stand for:
+//   name table                  per TileRefKind: varint name count, then per source number
+//                               varint length and the name's bytes
+// The loader looks each name up once and remaps the palette onto the current handles.
+
+#define MAP_FILE_MAGIC 0x504D5052u // "RPMP"
+#define MAP_FILE_VERSION 4
+#define MAP_CHUNK_SIZE 32
+#define MAP_FILE_MAX_SIDE 16384 // Larger sizes are treated as corrupt rather than allocated
+#define MAP_NAME_MAX 255        // Bytes of one name in a name table
+
+typedef struct MapFileHeader
+{
+    uint32_t version; // Big-endian
+    uint32_t magic;
+    uint32_t width; // Tiles
+    uint32_t height;
+    uint32_t chunkSize;
+    uint32_t chunkCount;
+    uint64_t fileSize; // Guards against truncated files
+} MapFileHeader;
+
+typedef struct MapChunkEntry
+{
+    uint64_t offset; // From the start of the file
+    uint32_t size;   // Payload bytes
+    uint32_t reserved;
+} MapChunkEntry;
+
+// Names of a version 4 file: names[kind][source] is the asset a TileRef of that kind and source
+// stands for
+typedef struct MapNameTable
+{
+    const char **names[TILE_REF_KINDS];
+    int counts[TILE_REF_KINDS];
+    char *text; // Names DecodeMapFile read, back to back
+} MapNameTable;
+
+// Frees the name arrays, and the names if DecodeMapFile read them
+void FreeMapNameTable(MapNameTable *table);
+
+// Encodes the store and the names of its refs' sources as a version 4 file image, with only the
+// stacks some cell holds in its palette. Returns a malloc'd buffer and sets *size, or NULL if out
+// of memory or a name is longer than MAP_NAME_MAX.
+unsigned char *EncodeMapFile(const TileStore *store, const MapNameTable *names, size_t *size);
+// Version and map size of a version 1 to 4 image; false if it is none or its header is cut short
+bool ReadMapFileInfo(const unsigned char *data, size_t size, int *version, int *width, int *height);
+// Fills an empty store of the size ReadMapFileInfo reported, interning every stack into its
+// palette, and fills names from a version 4 image; older ones leave it empty and their tiles as
+// saved. False if the image is corrupt, holds more than TILE_PALETTE_MAX distinct stacks or
+// memory ran out; the store may then be partly filled and names is left empty.
+bool DecodeMapFile(const unsigned char *data, size_t size, TileStore *store, MapNameTable *names);
+
+// A whole map file in memory: mapped read-only where mmap is available, read with one fread
+// elsewhere. Decoding copies out of it, so it can be closed as soon as the map is loaded.
+typedef struct MapFileView
+{
+    const unsigned char *data;
+    size_t size;
+    bool mapped;
+} MapFileView;
+
+bool OpenMapFileView(const char *filename, MapFileView *view);
+void CloseMapFileView(MapFileView *view);
@@ -0,0 +1,66 @@
+// min_heap.c
+
+#include "min_heap.h"
+#include <stdlib.h>
+#include <string.h>
+
+bool PushHeap(Heap *heap, float key, int item)
+{
+    if (heap->count >= heap->capacity)
+    {
+        int newCapacity = heap->capacity > 0 ? heap->capacity * 2 : 1024;
+        HeapEntry *grown = realloc(heap->entries, newCapacity * sizeof(HeapEntry));
+        if (grown == NULL)
+            return false;
+        heap->entries = grown;
+        heap->capacity = newCapacity;
+    }
+
+    HeapEntry *entries = heap->entries;
+    int i = heap->count++;
+    while (i > 0)
+    {
+        int parent = (i - 1) / 4;
+        if (entries[parent].key <= key)
+            break;
+        entries[i] = entries[parent];
+        i = parent;
+    }
+    entries[i] = (HeapEntry){key, item};
+    return true;
+}
+
+int PopHeap(Heap *heap)
+{
+    HeapEntry *entries = heap->entries;
+    int top = entries[0].item;
+    HeapEntry last = entries[--heap->count];
+    int count = heap->count;
+
+    int i = 0;
+    for (;;)
+    {
+        int first = i * 4 + 1;
+        if (first >= count)
+            break;
+        int end = first + 4 < count ? first + 4 : count;
+        int child = first;
+        for (int c = first + 1; c < end; c++)
+        {
+            if (entries[c].key < entries[child].key)
+                child = c;
+        }
+        if (last.key <= entries[child].key)
+            break;
+        entries[i] = entries[child];
+        i = child;
+    }
+    entries[i] = last;
+    return top;
+}
+
+void FreeHeap(Heap *heap)
+{
+    free(heap->entries);
+    memset(heap, 0, sizeof(Heap));
+}
@@ -0,0 +1,24 @@
+// min_heap.h
+
+#pragma once
+
+#include <stdbool.h>
+
+typedef struct HeapEntry
+{
+    float key;
+    int item;
+} HeapEntry;
+
+// 4-ary min-heap of (key, item) for the Dijkstra and A* searches: a node's children share a
+// cache line. Zero-initialize one to start empty; set count to 0 to reuse it.
+typedef struct Heap
+{
+    HeapEntry *entries;
+    int count;
+    int capacity;
+} Heap;
+
+bool PushHeap(Heap *heap, float key, int item); // False if the heap could not grow
+int PopHeap(Heap *heap);                        // Item with the lowest key; entries[0] before the pop
+void FreeHeap(Heap *heap);
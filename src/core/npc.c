@@ -5,10 +5,37 @@
 #include "raymath.h"
 #include "asset_manager.h"
 #include <stdio.h>
+#include <string.h>
 #include <math.h>
 #include "debug.h"
+#include "npc_store.h"
 
 int npcCount = 0;
+bool npcUseSpatialGrid = true;
+bool npcCollideWithTiles = true;
+bool npcAllowSleep = true;
+
+// Store UpdateNPCs and UpdateNPC tick the NPC arrays through
+static NPCStore npcArrayStore;
+static bool npcArrayStoreReady = false;
+
+// Finds unitType's clip for one state: the name with its last "_n" replaced by suffix
+static AnimationClipId FindStateClip(AssetManager *manager, const char *unitType, const char *suffix)
+{
+    char baseName[64];
+    snprintf(baseName, sizeof(baseName), "%s", unitType);
+    char *underscorePos = strrchr(baseName, '_');
+    if (underscorePos != NULL)
+    {
+        *underscorePos = '\0';
+    }
+
+    char animationName[64];
+    snprintf(animationName, sizeof(animationName), "%s%s", baseName, suffix);
+    AnimationClipId clipId = FindAnimationId(manager, animationName);
+    AnimationClip *animation = GetAnimationById(manager, clipId);
+    return animation && animation->frameCount > 0 ? clipId : INVALID_ASSET_ID;
+}
 
 /**
  * @brief Initializes an NPC with the given position, speed, and initial animation.
@@ -29,6 +56,9 @@ void InitNPC(NPC *npc, AssetManager *manager, Vector2 position, float speed, con
     npc->strength = 10;
     npc->defense = 5;
     npc->unitType = initialAnimationName;
+    npc->idleClip = FindStateClip(manager, initialAnimationName, "_1");
+    npc->walkClip = FindStateClip(manager, initialAnimationName, "_2");
+    npc->attackClip = FindStateClip(manager, initialAnimationName, "_3");
 
     npc->isCollidable = true;
     npc->drawName = false;
@@ -37,134 +67,65 @@ void InitNPC(NPC *npc, AssetManager *manager, Vector2 position, float speed, con
     npc->collisionRadius = 30.0f; // Set collision radius (adjust as necessary)
     npc->separationForce = 50.0f; // Set separation force strength (adjust as needed)
 
-    Animation initialAnimation = GetAnimation(manager, initialAnimationName);
-    if (initialAnimation.frameCount > 0)
+    AnimationClipId clipId = FindAnimationId(manager, initialAnimationName);
+    AnimationClip *initialAnimation = GetAnimationById(manager, clipId);
+    if (initialAnimation && initialAnimation->frameCount > 0)
     {
-        npc->animation = initialAnimation;
-        npc->animation.currentFrame = 0;
-        npc->animation.elapsedTime = 0.0f;
+        npc->animation = CreateAnimationPlayer(clipId, false); // Plays while walking
         // Initialize bounding box
         npc->boundingBox = (Rectangle){
-            position.x - initialAnimation.frameWidth / 8,
-            position.y - initialAnimation.frameHeight / 8,
-            initialAnimation.frameWidth / 4,
-            initialAnimation.frameHeight / 4};
+            position.x - initialAnimation->frameWidth / 8,
+            position.y - initialAnimation->frameHeight / 8,
+            initialAnimation->frameWidth / 4,
+            initialAnimation->frameHeight / 4};
     }
     else
     {
         fprintf(stderr, "Error: Animation '%s' not found or invalid.\n", initialAnimationName);
-        npc->animation = (Animation){0};
+        npc->animation = INVALID_ANIMATION_PLAYER;
     }
 }
 
-void UpdateNPC(NPC *npc, NPC npcs[], float deltaTime)
+// Refills the array store from npcs and runs one UpdateNPCStore tick on it
+static bool TickNPCArray(NPC npcs[], int count, float deltaTime)
 {
-    Vector2 separation = {0.0f, 0.0f};
-    int neighbors = 0;
-
-    // Calculate separation force from nearby NPCs
-    for (int i = 0; i < npcCount; i++)
+    if (!npcArrayStoreReady)
     {
-        if (&npcs[i] != npc) // Ensure we’re not calculating separation against itself
-        {
-            float distance = Vector2Distance(npc->position, npcs[i].position);
-            if (distance < npc->collisionRadius * 2.0f) // Check if within collision radius
-            {
-                Vector2 away = Vector2Subtract(npc->position, npcs[i].position);
-                away = Vector2Scale(Vector2Normalize(away), 1.0f / (distance + 0.01f)); // Weight by inverse distance
-                separation = Vector2Add(separation, away);
-                neighbors++;
-            }
-        }
+        InitNPCStore(&npcArrayStore);
+        npcArrayStoreReady = true;
     }
-
-    // Update bounding box
-    npc->boundingBox = (Rectangle){
-        npc->position.x - npc->animation.frameWidth / 8,
-        npc->position.y - npc->animation.frameHeight / 8,
-        npc->animation.frameWidth / 4,
-        npc->animation.frameHeight / 4};
-
-    // Apply separation force if there are nearby NPCs
-    if (neighbors > 0)
-    {
-        separation = Vector2Scale(separation, npc->separationForce); // Scale by separation force
-        npc->position = Vector2Add(npc->position, Vector2Scale(separation, deltaTime));
-    }
-
-    switch (npc->state)
+    // The NPCs own their animation players, so empty the store without ClearNPCStore
+    npcArrayStore.count = 0;
+    npcArrayStore.asleepCount = 0;
+    for (int i = 0; i < count; i++)
     {
-    case NPC_IDLE:
-        // Idle behavior (e.g., stand still)
-        break;
-    case NPC_WALKING:
-    {
-        Vector2 direction = Vector2Subtract(npc->targetPosition, npc->position);
-        float distance = Vector2Length(direction);
-
-        if (distance > 1.0f)
-        { // Threshold to stop moving
-            Vector2 directionNormalized = Vector2Scale(direction, 1.0f / distance);
-            Vector2 movement = Vector2Scale(directionNormalized, npc->speed * deltaTime);
-
-            if (Vector2Length(movement) > distance)
-            {
-                npc->position = npc->targetPosition;
-                SetNPCState(npc, NPC_IDLE); // Change to idle when target reached
-            }
-            else
-            {
-                npc->position = Vector2Add(npc->position, movement);
-            }
-
-            UpdateAnimation(&npc->animation); // Update animation while moving
-        }
-        else
+        if (AddNPCToStore(&npcArrayStore, &npcs[i]) < 0)
         {
-            SetNPCState(npc, NPC_IDLE); // Change to idle if close enough to stop
+            fprintf(stderr, "Error: Failed to update %d NPCs.\n", count);
+            return false;
         }
-        break;
-    }
-    case NPC_TALKING:
-        // Implement talking behavior
-        break;
-    case NPC_ATTACKING:
-        // Implement attacking behavior
-        break;
-    case NPC_BUILDING:
-        
-        break;
-    case NPC_DEAD:
-        // Implement dead behavior
-        break;
-    default:
-        break;
     }
+    UpdateNPCStore(&npcArrayStore, deltaTime);
+    return true;
 }
 
-/**
- * @brief Updates the NPC's current animation based on elapsed time.
- *
- * @param animation Pointer to the Animation to update.
- */
-void UpdateAnimation(Animation *animation)
+void UpdateNPCs(NPC npcs[], int count, float deltaTime)
 {
-    if (animation->frameCount <= 0)
-        return; // Safety check
-
-    animation->elapsedTime += GetFrameTime();
-
-    if (animation->elapsedTime >= animation->frameTime)
+    if (!TickNPCArray(npcs, count, deltaTime))
+        return;
+    for (int i = 0; i < count; i++)
     {
-        animation->currentFrame++;
-        if (animation->currentFrame >= animation->frameCount)
-        {
-            animation->currentFrame = 0;
-        }
-        animation->elapsedTime = 0.0f;
+        CopyNPCFromStore(&npcArrayStore, i, &npcs[i]);
     }
 }
 
+void UpdateNPC(NPC *npc, NPC npcs[], int count, float deltaTime)
+{
+    if (!TickNPCArray(npcs, count, deltaTime))
+        return;
+    CopyNPCFromStore(&npcArrayStore, (int)(npc - npcs), npc);
+}
+
 /**
  * @brief Draws the NPC on the screen, including its current animation frame and optional name.
  *
@@ -172,6 +133,10 @@ void UpdateAnimation(Animation *animation)
  */
 void DrawNPC(NPC *npc)
 {
+    AnimationClip *clip = GetPlayerClip(&manager, npc->animation);
+    int frameWidth = clip ? clip->frameWidth : 0;
+    int frameHeight = clip ? clip->frameHeight : 0;
+
     // If selected, draw a smaller selection circle
     if (npc->isSelected)
     {
@@ -179,20 +144,19 @@ void DrawNPC(NPC *npc)
         {
             DrawEllipseLines(
                 npc->position.x,                                  // Center X
-                npc->position.y + npc->animation.frameHeight / 5, // Center Y (slightly below the NPC)
-                npc->animation.frameWidth / 6 + offset,           // Horizontal radius
-                npc->animation.frameHeight / 12 + offset,         // Vertical radius
+                npc->position.y + frameHeight / 5, // Center Y (slightly below the NPC)
+                frameWidth / 6 + offset,           // Horizontal radius
+                frameHeight / 12 + offset,         // Vertical radius
                 GREEN                                             // Color
             );
         } // Draw 3 ellipses with offset for thicker line
     }
     // Draw the current frame of the animation at the NPC's position
-    if (npc->animation.frameCount > 0 && npc->animation.texture.id != 0)
+    if (clip && clip->frameCount > 0 && clip->texture.id != 0)
     { // Check if animation is valid
-        Rectangle frame = npc->animation.frames[npc->animation.currentFrame];
-        // Center the texture on the NPC's position
-        Vector2 drawPosition = Vector2Subtract(npc->position, (Vector2){frame.width / 2, frame.height / 2});
-        DrawTextureRec(npc->animation.texture, frame, drawPosition, WHITE);
+        // Center the frame's cell on the NPC's position
+        Vector2 drawPosition = Vector2Subtract(npc->position, (Vector2){frameWidth / 2.0f, frameHeight / 2.0f});
+        DrawAnimationPlayer(&manager, npc->animation, drawPosition, WHITE);
     }
 
     // Draw collision radius for debugging
@@ -202,11 +166,11 @@ void DrawNPC(NPC *npc)
     }
 
     // Optionally draw the NPC's name above it
-    if (npc->drawName && strlen(npc->animation.name) > 0)
+    if (npc->drawName && clip && strlen(clip->name) > 0)
     {
-        int textWidth = MeasureText(npc->animation.name, 10);
+        int textWidth = MeasureText(clip->name, 10);
         Vector2 textPosition = {npc->position.x - textWidth / 2, npc->position.y - 25};
-        DrawText(npc->animation.name, textPosition.x, textPosition.y, 10, RAYWHITE);
+        DrawText(clip->name, textPosition.x, textPosition.y, 10, RAYWHITE);
     }
 
     if (npc->isSelected && DEBUG)
@@ -227,119 +191,31 @@ void SetNPCState(NPC *npc, NPCState newState)
     {
         npc->state = newState;
 
-        // Define the suffix based on the state
-        const char *suffix;
+        // Switch the player to the state's clip; only walking animates, as before
+        AnimationClipId clipId;
         switch (npc->state)
         {
         case NPC_IDLE:
-            suffix = "_1"; // _1 for idle
+            clipId = npc->idleClip;
             break;
         case NPC_WALKING:
-            suffix = "_2"; // _2 for walking
+            clipId = npc->walkClip;
             break;
         case NPC_ATTACKING:
-            suffix = "_3"; // _3 for attacking
+            clipId = npc->attackClip;
             break;
         default:
             return;
         }
 
-        // Create a base name by removing any existing suffix
-        char baseName[64];
-        snprintf(baseName, sizeof(baseName), "%s", npc->unitType);
-
-        // Remove any existing suffix by finding the last underscore and truncating
-        char *underscorePos = strrchr(baseName, '_');
-        if (underscorePos != NULL)
-        {
-            *underscorePos = '\0'; // Truncate at last underscore
-        }
-
-        // Construct the animation name with the new suffix
-        char animationName[64];
-        snprintf(animationName, sizeof(animationName), "%s%s", baseName, suffix);
-
-        // Retrieve and assign the animation
-        Animation animation = GetAnimation(&manager, animationName);
-        if (animation.frameCount > 0)
+        if (clipId != INVALID_ASSET_ID)
         {
-            npc->animation = animation;
-            npc->animation.currentFrame = 0;
-            npc->animation.elapsedTime = 0.0f;
+            PlayAnimationClip(npc->animation, clipId);
+            SetAnimationPlaying(npc->animation, npc->state == NPC_WALKING);
         }
         else
         {
-            fprintf(stderr, "Error: Animation '%s' not found or invalid.\n", animationName);
-        }
-    }
-}
-
-/**
- * @brief Processes mouse input to handle NPC selection and movement.
- *
- * @param npcs Array of NPCs.
- * @param npcCount Number of NPCs in the array.
- * @param mousePosition Current mouse position.
- * @param mousePressed Boolean indicating if the mouse was pressed.
- */
-void HandleNPCMouseInput(NPC *npcs, int npcCount, Vector2 mousePosition, bool mousePressed)
-{
-    bool clickedOnNPC = false;
-
-    if (IsMouseButtonPressed(MOUSE_BUTTON_RIGHT))
-    {
-        // Deselect all NPCs on right-click
-        for (int i = 0; i < npcCount; i++)
-        {
-            npcs[i].isSelected = false;
-        }
-    }
-    else if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT))
-    {
-        // Check if Shift is held down
-        bool shiftHeld = IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT);
-        
-        // Iterate in reverse to prioritize topmost NPCs if overlapping
-        for (int i = npcCount - 1; i >= 0; i--)
-        {
-            Animation currentAnimation = npcs[i].animation;
-            float radius = currentAnimation.frameWidth / 4; // Assuming circular NPCs
-
-            if (CheckCollisionPointRec(mousePosition, npcs[i].boundingBox))
-            {
-                clickedOnNPC = true;
-                
-                // If Shift is held, add to selection; otherwise, select just this NPC
-                if (shiftHeld)
-                {
-                    npcs[i].isSelected = true;
-                }
-                else
-                {
-                    // Deselect all others and select only this NPC
-                    for (int j = 0; j < npcCount; j++)
-                    {
-                        if (i != j)
-                            npcs[j].isSelected = false;
-                    }
-                    npcs[i].isSelected = true;
-                }
-                break;
-            }
-        }
-
-        // If clicked on empty space, set target position for selected NPCs
-        if (!clickedOnNPC)
-        {
-            for (int i = 0; i < npcCount; i++)
-            {
-                if (npcs[i].isSelected)
-                {
-                    npcs[i].targetPosition = mousePosition;
-                    // Change state to walking to trigger movement
-                    SetNPCState(&npcs[i], NPC_WALKING);
-                }
-            }
+            fprintf(stderr, "Error: '%s' has no valid animation for state %d.\n", npc->unitType, (int)npc->state);
         }
     }
 }
@@ -4,6 +4,7 @@
 
 #include "raylib.h"
 #include "asset_manager.h"
+#include "animation_player.h"
 #include <stdbool.h>
 
 // Enumeration for NPC states
@@ -30,8 +31,11 @@ typedef struct NPC
     bool drawName;
     bool isSelected;
         Rectangle boundingBox; // Add this for bounding box
-    Animation animation;
+    AnimationPlayerId animation; // Playback of the current clip; ticked by TickAnimationPlayers
     const char *unitType;  // To hold the type, e.g., "Warrior" or "Archer"
+    AnimationClipId idleClip;   // unitType's _1 clip, resolved once by InitNPC; INVALID_ASSET_ID if missing
+    AnimationClipId walkClip;   // unitType's _2 clip
+    AnimationClipId attackClip; // unitType's _3 clip
     float collisionRadius; // Radius for selection and collision detection
     float separationForce; // Force applied to separate NPCs
 } NPC;
@@ -39,6 +43,9 @@ typedef struct NPC
 // Assuming you have a maximum number of NPCs
 #define MAX_NPCS 4000
 extern int npcCount;
+extern bool npcUseSpatialGrid; // Separation through a spatial hash grid (default) or all pairs
+extern bool npcCollideWithTiles; // NPCStore movement stops at collidable tiles (default) or ignores them
+extern bool npcAllowSleep;       // NPCStore skips NPCs that stand idle and alone (default) or updates them all
 
 // Function Prototypes
 
@@ -54,19 +61,29 @@ extern int npcCount;
 void InitNPC(NPC *npc, AssetManager *manager, Vector2 position, float speed, const char *initialAnimationName);
 
 /**
- * @brief Updates the NPC's logic based on its current state and the elapsed time.
+ * @brief Updates one NPC of an array for one tick. The whole array is copied into an NPCStore
+ * and ticked by UpdateNPCStore, but only npc is copied back, so the others keep their state.
+ * Every call costs a full tick; use UpdateNPCs to update a whole array.
  *
- * @param npc Pointer to the NPC to update.
+ * @param npc Pointer to the NPC to update; must point into npcs.
+ * @param npcs Array of NPCs the separation force is computed from.
+ * @param count Number of NPCs in the array.
  * @param deltaTime Time elapsed since the last frame (in seconds).
  */
-void UpdateNPC(NPC *npc, NPC npcs[], float deltaTime);
+void UpdateNPC(NPC *npc, NPC npcs[], int count, float deltaTime);
 
 /**
- * @brief Updates the NPC's current animation based on elapsed time.
+ * @brief Updates every NPC in the array for one tick: copies them into an NPCStore, runs
+ * UpdateNPCStore on it and copies the results back. The array gets the store's separation, tile
+ * collision and movement, including its npcUseSpatialGrid and npcCollideWithTiles flags. Each
+ * call copies the NPCs in afresh and wakes them, so none of them ever sleeps, and they walk
+ * straight to their targetPosition rather than along flow fields or routes.
  *
- * @param animation Pointer to the Animation to update.
+ * @param npcs Array of NPCs.
+ * @param count Number of NPCs in the array.
+ * @param deltaTime Time elapsed since the last frame (in seconds).
  */
-void UpdateAnimation(Animation *animation);
+void UpdateNPCs(NPC npcs[], int count, float deltaTime);
 
 /**
  * @brief Draws the NPC on the screen, including its current animation frame and optional name.
@@ -82,13 +99,3 @@ void DrawNPC(NPC *npc);
  * @param newState The new state to assign to the NPC.
  */
 void SetNPCState(NPC *npc, NPCState newState);
-
-/**
- * @brief Processes mouse input to handle NPC selection and movement.
- *
- * @param npcs Array of NPCs.
- * @param npcCount Number of NPCs in the array.
- * @param mousePosition Current mouse position.
- * @param mousePressed Boolean indicating if the mouse was pressed.
- */
-void HandleNPCMouseInput(NPC *npcs, int npcCount, Vector2 mousePosition, bool mousePressed);
\ No newline at end of file
@@ -0,0 +1,1172 @@
+// npc_store.c
+
+#include "npc_store.h"
+#include "animation_player.h"
+#include "pick_index.h"
+#include "tile_placement_data.h"
+#include <pthread.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)) && !defined(NPC_KERNEL_NO_SIMD)
+#define NPC_KERNEL_HAS_SSE2 1
+#include <emmintrin.h>
+#if defined(__GNUC__)
+#define NPC_KERNEL_HAS_AVX2 1 // Compiled with a target attribute, selected at runtime
+#include <immintrin.h>
+#endif
+#endif
+
+// Sums the separation push on the NPC at (x, y) from `count` candidate positions closer than
+// sqrt(range2). The NPC itself may be among the candidates: zero distance adds nothing.
+typedef void (*SeparationFunc)(float x, float y, float range2, const float *candidateX, const float *candidateY,
+                               int count, float *separationX, float *separationY);
+// Applies separation and walks NPCs [begin, end) towards their targets, writing the new positions
+// to nextX/nextY and refreshing their boxes. Writes the NPCs that stopped walking to arrivals,
+// in index order, and returns how many.
+typedef int (*MoveFunc)(NPCStore *store, int begin, int end, float deltaTime, float *nextX, float *nextY, int *arrivals);
+
+static SeparationFunc sumSeparation;
+static MoveFunc moveNPCs;
+static NPCKernelPath activePath;
+static pthread_once_t kernelInitOnce = PTHREAD_ONCE_INIT;
+
+void InitNPCStore(NPCStore *store)
+{
+    memset(store, 0, sizeof(NPCStore));
+    InitSpatialGrid(&store->grid, 60.0f);
+}
+
+void FreeNPCStore(NPCStore *store)
+{
+    SetNPCStoreThreadCount(store, 1);
+    for (int i = 0; i < store->count; i++)
+    {
+        ReleaseFlowField(store->flowField[i]);
+    }
+    for (int i = 0; i < store->capacity; i++)
+    {
+        FreeTilePath(&store->route[i]);
+    }
+    free(store->positionX);
+    free(store->positionY);
+    free(store->previousPositionX);
+    free(store->previousPositionY);
+    free(store->targetX);
+    free(store->targetY);
+    free(store->orderX);
+    free(store->orderY);
+    free(store->flowField);
+    free(store->route);
+    free(store->routeStep);
+    free(store->speed);
+    free(store->collisionRadius);
+    free(store->separationForce);
+    free(store->state);
+    free(store->separationX);
+    free(store->separationY);
+    free(store->quietTicks);
+    free(store->asleep);
+    free(store->boxX);
+    free(store->boxY);
+    free(store->boxOffsetX);
+    free(store->boxOffsetY);
+    free(store->boxWidth);
+    free(store->boxHeight);
+    free(store->cold);
+    for (int w = 0; w < MAX_POOL_WORKERS; w++)
+    {
+        free(store->scratch[w].candidateX);
+        free(store->scratch[w].candidateY);
+        free(store->scratch[w].candidateIndex);
+        free(store->scratch[w].wake);
+    }
+    free(store->arrivals);
+    FreeSpatialGrid(&store->grid);
+    memset(store, 0, sizeof(NPCStore));
+}
+
+void ClearNPCStore(NPCStore *store)
+{
+    for (int i = 0; i < store->count; i++)
+    {
+        ReleaseAnimationPlayer(store->cold[i].animation);
+        ReleaseFlowField(store->flowField[i]);
+        store->route[i].count = 0;
+    }
+    store->count = 0;
+    store->asleepCount = 0;
+}
+
+static bool GrowField(void **field, size_t size, int capacity)
+{
+    void *grown = realloc(*field, capacity * size);
+    if (grown == NULL)
+        return false;
+    *field = grown;
+    return true;
+}
+
+// Routes own their tile arrays; new slots start empty and keep their arrays once used
+static bool GrowRoutes(NPCStore *store, int capacity)
+{
+    if (!GrowField((void **)&store->route, sizeof(TilePath), capacity))
+        return false;
+    memset(&store->route[store->capacity], 0, (capacity - store->capacity) * sizeof(TilePath));
+    return true;
+}
+
+// Arrays that fail to grow keep their old size, which is still valid for store->capacity
+static bool ReserveNPCStore(NPCStore *store, int capacity)
+{
+    if (capacity <= store->capacity)
+        return true;
+    int newCapacity = store->capacity > 0 ? store->capacity * 2 : 64;
+    while (newCapacity < capacity)
+        newCapacity *= 2;
+
+    bool grown = GrowField((void **)&store->positionX, sizeof(float), newCapacity) &&
+                 GrowField((void **)&store->positionY, sizeof(float), newCapacity) &&
+                 GrowField((void **)&store->previousPositionX, sizeof(float), newCapacity) &&
+                 GrowField((void **)&store->previousPositionY, sizeof(float), newCapacity) &&
+                 GrowField((void **)&store->targetX, sizeof(float), newCapacity) &&
+                 GrowField((void **)&store->targetY, sizeof(float), newCapacity) &&
+                 GrowField((void **)&store->orderX, sizeof(float), newCapacity) &&
+                 GrowField((void **)&store->orderY, sizeof(float), newCapacity) &&
+                 GrowField((void **)&store->flowField, sizeof(FlowFieldId), newCapacity) &&
+                 GrowRoutes(store, newCapacity) &&
+                 GrowField((void **)&store->routeStep, sizeof(int), newCapacity) &&
+                 GrowField((void **)&store->speed, sizeof(float), newCapacity) &&
+                 GrowField((void **)&store->collisionRadius, sizeof(float), newCapacity) &&
+                 GrowField((void **)&store->separationForce, sizeof(float), newCapacity) &&
+                 GrowField((void **)&store->state, sizeof(int), newCapacity) &&
+                 GrowField((void **)&store->separationX, sizeof(float), newCapacity) &&
+                 GrowField((void **)&store->separationY, sizeof(float), newCapacity) &&
+                 GrowField((void **)&store->quietTicks, sizeof(int), newCapacity) &&
+                 GrowField((void **)&store->asleep, sizeof(unsigned char), newCapacity) &&
+                 GrowField((void **)&store->boxX, sizeof(float), newCapacity) &&
+                 GrowField((void **)&store->boxY, sizeof(float), newCapacity) &&
+                 GrowField((void **)&store->boxOffsetX, sizeof(float), newCapacity) &&
+                 GrowField((void **)&store->boxOffsetY, sizeof(float), newCapacity) &&
+                 GrowField((void **)&store->boxWidth, sizeof(float), newCapacity) &&
+                 GrowField((void **)&store->boxHeight, sizeof(float), newCapacity) &&
+                 GrowField((void **)&store->cold, sizeof(NPCColdData), newCapacity) &&
+                 GrowField((void **)&store->arrivals, sizeof(int), newCapacity);
+    if (!grown)
+    {
+        fprintf(stderr, "Failed to grow NPC store to %d NPCs.\n", newCapacity);
+        return false;
+    }
+    store->capacity = newCapacity;
+    return true;
+}
+
+// Box size and offset follow the current clip, as InitNPC and UpdateNPC compute them
+static void RefreshStoreNPCBox(NPCStore *store, int index)
+{
+    AnimationClip *clip = GetPlayerClip(&manager, store->cold[index].animation);
+    int frameWidth = clip ? clip->frameWidth : 0;
+    int frameHeight = clip ? clip->frameHeight : 0;
+    store->boxOffsetX[index] = frameWidth / 8;
+    store->boxOffsetY[index] = frameHeight / 8;
+    store->boxWidth[index] = frameWidth / 4;
+    store->boxHeight[index] = frameHeight / 4;
+    store->boxX[index] = store->positionX[index] - store->boxOffsetX[index];
+    store->boxY[index] = store->positionY[index] - store->boxOffsetY[index];
+}
+
+int AddNPCToStore(NPCStore *store, const NPC *npc)
+{
+    if (!ReserveNPCStore(store, store->count + 1))
+        return -1;
+    int index = store->count++;
+    store->flowField[index] = INVALID_FLOW_FIELD;
+    store->route[index].count = 0;
+    store->asleep[index] = 0;
+    CopyNPCToStore(store, index, npc);
+    return index;
+}
+
+void CopyNPCFromStore(const NPCStore *store, int index, NPC *npc)
+{
+    const NPCColdData *cold = &store->cold[index];
+    npc->position = (Vector2){store->positionX[index], store->positionY[index]};
+    npc->targetPosition = (Vector2){store->orderX[index], store->orderY[index]};
+    npc->speed = store->speed[index];
+    npc->health = cold->health;
+    npc->strength = cold->strength;
+    npc->defense = cold->defense;
+    npc->state = (NPCState)store->state[index];
+    npc->isCollidable = cold->isCollidable;
+    npc->drawName = cold->drawName;
+    npc->isSelected = cold->isSelected;
+    npc->boundingBox = GetStoreNPCBoundingBox(store, index);
+    npc->animation = cold->animation;
+    npc->unitType = cold->unitType;
+    npc->idleClip = cold->idleClip;
+    npc->walkClip = cold->walkClip;
+    npc->attackClip = cold->attackClip;
+    npc->collisionRadius = store->collisionRadius[index];
+    npc->separationForce = store->separationForce[index];
+}
+
+void CopyNPCToStore(NPCStore *store, int index, const NPC *npc)
+{
+    store->positionX[index] = npc->position.x;
+    store->positionY[index] = npc->position.y;
+    store->previousPositionX[index] = npc->position.x;
+    store->previousPositionY[index] = npc->position.y;
+    store->targetX[index] = npc->targetPosition.x;
+    store->targetY[index] = npc->targetPosition.y;
+    if (store->orderX[index] != npc->targetPosition.x || store->orderY[index] != npc->targetPosition.y)
+    {
+        ReleaseFlowField(store->flowField[index]); // A new destination: walk straight to it
+        store->flowField[index] = INVALID_FLOW_FIELD;
+        store->route[index].count = 0;
+    }
+    store->orderX[index] = npc->targetPosition.x;
+    store->orderY[index] = npc->targetPosition.y;
+    store->speed[index] = npc->speed;
+    store->collisionRadius[index] = npc->collisionRadius;
+    store->separationForce[index] = npc->separationForce;
+    store->state[index] = npc->state;
+    store->separationX[index] = 0.0f;
+    store->separationY[index] = 0.0f;
+    store->cold[index] = (NPCColdData){npc->health, npc->strength, npc->defense, npc->unitType,
+                                       npc->animation, npc->idleClip, npc->walkClip, npc->attackClip,
+                                       npc->isCollidable, npc->drawName, npc->isSelected};
+    RefreshStoreNPCBox(store, index);
+    WakeStoreNPC(store, index);
+}
+
+void SetStoreNPCState(NPCStore *store, int index, NPCState newState)
+{
+    // State changes are rare; go through the NPC facade so the clip lookup stays in one place
+    NPC npc;
+    CopyNPCFromStore(store, index, &npc);
+    SetNPCState(&npc, newState);
+    store->state[index] = npc.state;
+    RefreshStoreNPCBox(store, index);
+    WakeStoreNPC(store, index);
+}
+
+// quietTicks 0 also makes the NPC wake its neighbours at the start of the next tick, which
+// covers one that was placed or moved by hand next to sleepers
+void WakeStoreNPC(NPCStore *store, int index)
+{
+    store->quietTicks[index] = 0;
+    if (!store->asleep[index])
+        return;
+    store->asleep[index] = 0;
+    store->asleepCount--;
+    store->wokenCount++;
+}
+
+NPCStoreStats GetNPCStoreStats(const NPCStore *store)
+{
+    return store->stats;
+}
+
+Rectangle GetStoreNPCBoundingBox(const NPCStore *store, int index)
+{
+    return (Rectangle){store->boxX[index], store->boxY[index], store->boxWidth[index], store->boxHeight[index]};
+}
+
+static void SumSeparationScalar(float x, float y, float range2, const float *candidateX, const float *candidateY,
+                                int count, float *separationX, float *separationY)
+{
+    float sumX = 0.0f, sumY = 0.0f;
+    for (int j = 0; j < count; j++)
+    {
+        float dx = x - candidateX[j];
+        float dy = y - candidateY[j];
+        float distance2 = dx * dx + dy * dy;
+        if (distance2 > 0.0f && distance2 < range2)
+        {
+            // Unit vector away from the other NPC, weighted by inverse distance
+            float distance = sqrtf(distance2);
+            float weight = 1.0f / (distance * (distance + 0.01f));
+            sumX += dx * weight;
+            sumY += dy * weight;
+        }
+    }
+    *separationX = sumX;
+    *separationY = sumY;
+}
+
+static int MoveNPCsScalar(NPCStore *store, int begin, int end, float deltaTime, float *nextX, float *nextY, int *arrivals)
+{
+    int arrived = 0;
+    for (int i = begin; i < end; i++)
+    {
+        float x = store->positionX[i] + store->separationX[i] * store->separationForce[i] * deltaTime;
+        float y = store->positionY[i] + store->separationY[i] * store->separationForce[i] * deltaTime;
+
+        if (store->state[i] == NPC_WALKING)
+        {
+            float dx = store->targetX[i] - x;
+            float dy = store->targetY[i] - y;
+            float distance = sqrtf(dx * dx + dy * dy);
+            float step = store->speed[i] * deltaTime;
+            if (distance > 1.0f && step > distance) // Would overshoot: land on the target
+            {
+                x = store->targetX[i];
+                y = store->targetY[i];
+                arrivals[arrived++] = i;
+            }
+            else if (distance > 1.0f)
+            {
+                float inverse = 1.0f / distance;
+                x += dx * inverse * step;
+                y += dy * inverse * step;
+            }
+            else
+            {
+                arrivals[arrived++] = i; // Close enough to stop
+            }
+        }
+
+        nextX[i] = x;
+        nextY[i] = y;
+        store->boxX[i] = x - store->boxOffsetX[i];
+        store->boxY[i] = y - store->boxOffsetY[i];
+    }
+    return arrived;
+}
+
+// The vector kernels do the same IEEE operations in the same order per NPC as the scalar ones,
+// so movement is bit-identical across paths; separation sums lanes in a different order.
+#if defined(NPC_KERNEL_HAS_SSE2)
+static inline __m128 SelectSSE2(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static void SumSeparationSSE2(float x, float y, float range2, const float *candidateX, const float *candidateY,
+                              int count, float *separationX, float *separationY)
+{
+    const __m128 x4 = _mm_set1_ps(x), y4 = _mm_set1_ps(y);
+    const __m128 range4 = _mm_set1_ps(range2);
+    const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), bias = _mm_set1_ps(0.01f);
+    __m128 sumX = zero, sumY = zero;
+
+    int j = 0;
+    for (; j + 4 <= count; j += 4)
+    {
+        __m128 dx = _mm_sub_ps(x4, _mm_loadu_ps(candidateX + j));
+        __m128 dy = _mm_sub_ps(y4, _mm_loadu_ps(candidateY + j));
+        __m128 distance2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+        __m128 inside = _mm_and_ps(_mm_cmpgt_ps(distance2, zero), _mm_cmplt_ps(distance2, range4));
+        __m128 distance = _mm_sqrt_ps(distance2);
+        __m128 weight = _mm_and_ps(inside, _mm_div_ps(one, _mm_mul_ps(distance, _mm_add_ps(distance, bias))));
+        sumX = _mm_add_ps(sumX, _mm_mul_ps(dx, weight));
+        sumY = _mm_add_ps(sumY, _mm_mul_ps(dy, weight));
+    }
+
+    float lanesX[4], lanesY[4], tailX, tailY;
+    _mm_storeu_ps(lanesX, sumX);
+    _mm_storeu_ps(lanesY, sumY);
+    SumSeparationScalar(x, y, range2, candidateX + j, candidateY + j, count - j, &tailX, &tailY);
+    *separationX = (lanesX[0] + lanesX[1]) + (lanesX[2] + lanesX[3]) + tailX;
+    *separationY = (lanesY[0] + lanesY[1]) + (lanesY[2] + lanesY[3]) + tailY;
+}
+
+static int MoveNPCsSSE2(NPCStore *store, int begin, int end, float deltaTime, float *nextX, float *nextY, int *arrivals)
+{
+    const __m128 delta = _mm_set1_ps(deltaTime), one = _mm_set1_ps(1.0f);
+    const __m128i walkingState = _mm_set1_epi32(NPC_WALKING);
+    int arrived = 0;
+
+    int i = begin;
+    for (; i + 4 <= end; i += 4)
+    {
+        __m128 force = _mm_loadu_ps(store->separationForce + i);
+        __m128 x = _mm_add_ps(_mm_loadu_ps(store->positionX + i),
+                              _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(store->separationX + i), force), delta));
+        __m128 y = _mm_add_ps(_mm_loadu_ps(store->positionY + i),
+                              _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(store->separationY + i), force), delta));
+
+        __m128 walking = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(store->state + i)), walkingState));
+        __m128 targetX = _mm_loadu_ps(store->targetX + i);
+        __m128 targetY = _mm_loadu_ps(store->targetY + i);
+        __m128 dx = _mm_sub_ps(targetX, x);
+        __m128 dy = _mm_sub_ps(targetY, y);
+        __m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+        __m128 step = _mm_mul_ps(_mm_loadu_ps(store->speed + i), delta);
+
+        __m128 far = _mm_and_ps(walking, _mm_cmpgt_ps(distance, one));
+        __m128 overshoot = _mm_and_ps(far, _mm_cmpgt_ps(step, distance));
+        __m128 moving = _mm_andnot_ps(overshoot, far);
+        __m128 inverse = _mm_div_ps(one, distance); // Inf/NaN lanes are never selected
+        x = SelectSSE2(moving, _mm_add_ps(x, _mm_mul_ps(_mm_mul_ps(dx, inverse), step)), x);
+        y = SelectSSE2(moving, _mm_add_ps(y, _mm_mul_ps(_mm_mul_ps(dy, inverse), step)), y);
+        x = SelectSSE2(overshoot, targetX, x);
+        y = SelectSSE2(overshoot, targetY, y);
+
+        int stopped = _mm_movemask_ps(_mm_or_ps(overshoot, _mm_andnot_ps(far, walking)));
+        while (stopped)
+        {
+            arrivals[arrived++] = i + __builtin_ctz(stopped);
+            stopped &= stopped - 1;
+        }
+
+        _mm_storeu_ps(nextX + i, x);
+        _mm_storeu_ps(nextY + i, y);
+        _mm_storeu_ps(store->boxX + i, _mm_sub_ps(x, _mm_loadu_ps(store->boxOffsetX + i)));
+        _mm_storeu_ps(store->boxY + i, _mm_sub_ps(y, _mm_loadu_ps(store->boxOffsetY + i)));
+    }
+    return arrived + MoveNPCsScalar(store, i, end, deltaTime, nextX, nextY, arrivals + arrived);
+}
+#endif
+
+#if defined(NPC_KERNEL_HAS_AVX2)
+__attribute__((target("avx2"))) static void SumSeparationAVX2(float x, float y, float range2, const float *candidateX,
+                                                              const float *candidateY, int count, float *separationX,
+                                                              float *separationY)
+{
+    const __m256 x8 = _mm256_set1_ps(x), y8 = _mm256_set1_ps(y);
+    const __m256 range8 = _mm256_set1_ps(range2);
+    const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f), bias = _mm256_set1_ps(0.01f);
+    __m256 sumX = zero, sumY = zero;
+
+    int j = 0;
+    for (; j + 8 <= count; j += 8)
+    {
+        __m256 dx = _mm256_sub_ps(x8, _mm256_loadu_ps(candidateX + j));
+        __m256 dy = _mm256_sub_ps(y8, _mm256_loadu_ps(candidateY + j));
+        __m256 distance2 = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+        __m256 inside = _mm256_and_ps(_mm256_cmp_ps(distance2, zero, _CMP_GT_OQ), _mm256_cmp_ps(distance2, range8, _CMP_LT_OQ));
+        __m256 distance = _mm256_sqrt_ps(distance2);
+        __m256 weight = _mm256_and_ps(inside, _mm256_div_ps(one, _mm256_mul_ps(distance, _mm256_add_ps(distance, bias))));
+        sumX = _mm256_add_ps(sumX, _mm256_mul_ps(dx, weight));
+        sumY = _mm256_add_ps(sumY, _mm256_mul_ps(dy, weight));
+    }
+
+    float lanesX[8], lanesY[8], tailX, tailY;
+    _mm256_storeu_ps(lanesX, sumX);
+    _mm256_storeu_ps(lanesY, sumY);
+    SumSeparationSSE2(x, y, range2, candidateX + j, candidateY + j, count - j, &tailX, &tailY);
+    *separationX = ((lanesX[0] + lanesX[1]) + (lanesX[2] + lanesX[3])) + ((lanesX[4] + lanesX[5]) + (lanesX[6] + lanesX[7])) + tailX;
+    *separationY = ((lanesY[0] + lanesY[1]) + (lanesY[2] + lanesY[3])) + ((lanesY[4] + lanesY[5]) + (lanesY[6] + lanesY[7])) + tailY;
+}
+
+__attribute__((target("avx2"))) static int MoveNPCsAVX2(NPCStore *store, int begin, int end, float deltaTime, float *nextX, float *nextY, int *arrivals)
+{
+    const __m256 delta = _mm256_set1_ps(deltaTime), one = _mm256_set1_ps(1.0f);
+    const __m256i walkingState = _mm256_set1_epi32(NPC_WALKING);
+    int arrived = 0;
+
+    int i = begin;
+    for (; i + 8 <= end; i += 8)
+    {
+        __m256 force = _mm256_loadu_ps(store->separationForce + i);
+        __m256 x = _mm256_add_ps(_mm256_loadu_ps(store->positionX + i),
+                                 _mm256_mul_ps(_mm256_mul_ps(_mm256_loadu_ps(store->separationX + i), force), delta));
+        __m256 y = _mm256_add_ps(_mm256_loadu_ps(store->positionY + i),
+                                 _mm256_mul_ps(_mm256_mul_ps(_mm256_loadu_ps(store->separationY + i), force), delta));
+
+        __m256 walking = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(store->state + i)), walkingState));
+        __m256 targetX = _mm256_loadu_ps(store->targetX + i);
+        __m256 targetY = _mm256_loadu_ps(store->targetY + i);
+        __m256 dx = _mm256_sub_ps(targetX, x);
+        __m256 dy = _mm256_sub_ps(targetY, y);
+        __m256 distance = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+        __m256 step = _mm256_mul_ps(_mm256_loadu_ps(store->speed + i), delta);
+
+        __m256 far = _mm256_and_ps(walking, _mm256_cmp_ps(distance, one, _CMP_GT_OQ));
+        __m256 overshoot = _mm256_and_ps(far, _mm256_cmp_ps(step, distance, _CMP_GT_OQ));
+        __m256 moving = _mm256_andnot_ps(overshoot, far);
+        __m256 inverse = _mm256_div_ps(one, distance);
+        x = _mm256_blendv_ps(x, _mm256_add_ps(x, _mm256_mul_ps(_mm256_mul_ps(dx, inverse), step)), moving);
+        y = _mm256_blendv_ps(y, _mm256_add_ps(y, _mm256_mul_ps(_mm256_mul_ps(dy, inverse), step)), moving);
+        x = _mm256_blendv_ps(x, targetX, overshoot);
+        y = _mm256_blendv_ps(y, targetY, overshoot);
+
+        int stopped = _mm256_movemask_ps(_mm256_or_ps(overshoot, _mm256_andnot_ps(far, walking)));
+        while (stopped)
+        {
+            arrivals[arrived++] = i + __builtin_ctz(stopped);
+            stopped &= stopped - 1;
+        }
+
+        _mm256_storeu_ps(nextX + i, x);
+        _mm256_storeu_ps(nextY + i, y);
+        _mm256_storeu_ps(store->boxX + i, _mm256_sub_ps(x, _mm256_loadu_ps(store->boxOffsetX + i)));
+        _mm256_storeu_ps(store->boxY + i, _mm256_sub_ps(y, _mm256_loadu_ps(store->boxOffsetY + i)));
+    }
+    return arrived + MoveNPCsSSE2(store, i, end, deltaTime, nextX, nextY, arrivals + arrived);
+}
+#endif
+
+static bool IsPathSupported(NPCKernelPath path)
+{
+    switch (path)
+    {
+    case NPC_KERNEL_SCALAR:
+        return true;
+#if defined(NPC_KERNEL_HAS_SSE2)
+    case NPC_KERNEL_SSE2:
+        return true;
+#endif
+#if defined(NPC_KERNEL_HAS_AVX2)
+    case NPC_KERNEL_AVX2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+static void SelectPath(NPCKernelPath path)
+{
+    activePath = path;
+    switch (path)
+    {
+#if defined(NPC_KERNEL_HAS_AVX2)
+    case NPC_KERNEL_AVX2:
+        sumSeparation = SumSeparationAVX2;
+        moveNPCs = MoveNPCsAVX2;
+        break;
+#endif
+#if defined(NPC_KERNEL_HAS_SSE2)
+    case NPC_KERNEL_SSE2:
+        sumSeparation = SumSeparationSSE2;
+        moveNPCs = MoveNPCsSSE2;
+        break;
+#endif
+    default:
+        activePath = NPC_KERNEL_SCALAR;
+        sumSeparation = SumSeparationScalar;
+        moveNPCs = MoveNPCsScalar;
+        break;
+    }
+}
+
+static void SelectBestPath(void)
+{
+    if (IsPathSupported(NPC_KERNEL_AVX2))
+        SelectPath(NPC_KERNEL_AVX2);
+    else if (IsPathSupported(NPC_KERNEL_SSE2))
+        SelectPath(NPC_KERNEL_SSE2);
+    else
+        SelectPath(NPC_KERNEL_SCALAR);
+}
+
+static void EnsureKernelPath(void)
+{
+    pthread_once(&kernelInitOnce, SelectBestPath);
+}
+
+NPCKernelPath GetNPCKernelPath(void)
+{
+    EnsureKernelPath();
+    return activePath;
+}
+
+// Not thread-safe against a running update; call it between ticks
+bool SetNPCKernelPath(NPCKernelPath path)
+{
+    EnsureKernelPath();
+    if (path == NPC_KERNEL_AUTO)
+    {
+        SelectBestPath();
+        return true;
+    }
+    if (!IsPathSupported(path))
+        return false;
+    SelectPath(path);
+    return true;
+}
+
+const char *GetNPCKernelPathName(NPCKernelPath path)
+{
+    switch (path)
+    {
+    case NPC_KERNEL_SCALAR:
+        return "scalar";
+    case NPC_KERNEL_SSE2:
+        return "SSE2";
+    case NPC_KERNEL_AVX2:
+        return "AVX2";
+    default:
+        return "auto";
+    }
+}
+
+int SetNPCStoreThreadCount(NPCStore *store, int threadCount)
+{
+    if (store->pool)
+    {
+        FreeWorkerPool(store->pool);
+        free(store->pool);
+        store->pool = NULL;
+    }
+    if (threadCount <= 1)
+        return 1;
+
+    store->pool = malloc(sizeof(WorkerPool));
+    if (store->pool == NULL)
+        return 1;
+    return InitWorkerPool(store->pool, threadCount);
+}
+
+int GetNPCStoreThreadCount(const NPCStore *store)
+{
+    return store->pool ? store->pool->workerCount : 1;
+}
+
+static bool ReserveWorkerScratch(NPCWorkerScratch *scratch, int count)
+{
+    if (count <= scratch->capacity)
+        return true;
+    if (!GrowField((void **)&scratch->candidateX, sizeof(float), count) ||
+        !GrowField((void **)&scratch->candidateY, sizeof(float), count) ||
+        !GrowField((void **)&scratch->candidateIndex, sizeof(int), count))
+    {
+        fprintf(stderr, "Failed to allocate NPC candidate buffers for %d NPCs.\n", count);
+        return false;
+    }
+    scratch->capacity = count;
+    return true;
+}
+
+static bool ReserveWakeList(NPCWorkerScratch *scratch, int count)
+{
+    if (count <= scratch->wakeCapacity)
+        return true;
+    if (!GrowField((void **)&scratch->wake, sizeof(int), count))
+    {
+        fprintf(stderr, "Failed to allocate NPC wake list for %d NPCs.\n", count);
+        return false;
+    }
+    scratch->wakeCapacity = count;
+    return true;
+}
+
+// Copies the positions of every NPC in the 3x3 cells around (cellX, cellY) into the candidate
+// arrays. Each NPC is in exactly one cell, so there are never more candidates than NPCs.
+static int GatherCandidates(const NPCStore *store, NPCWorkerScratch *scratch, int cellX, int cellY)
+{
+    const SpatialGrid *grid = &store->grid;
+    int candidates = 0;
+    for (int y = cellY - 1; y <= cellY + 1; y++)
+    {
+        for (int x = cellX - 1; x <= cellX + 1; x++)
+        {
+            int begin, end;
+            GetSpatialGridBucket(grid, x, y, &begin, &end);
+            for (int e = begin; e < end; e++)
+            {
+                const SpatialGridEntry *entry = &grid->entries[e];
+                if (entry->cellX == x && entry->cellY == y) // Buckets can hold other cells too
+                {
+                    scratch->candidateX[candidates] = store->positionX[entry->index];
+                    scratch->candidateY[candidates] = store->positionY[entry->index];
+                    scratch->candidateIndex[candidates] = entry->index;
+                    candidates++;
+                }
+            }
+        }
+    }
+    return candidates;
+}
+
+typedef struct NPCUpdateJob
+{
+    NPCStore *store;
+    float deltaTime;
+    bool useGrid;
+    bool allowSleep;
+} NPCUpdateJob;
+
+static void GetWorkerRange(int count, int worker, int workerCount, int *begin, int *end)
+{
+    *begin = (int)((long long)count * worker / workerCount);
+    *end = (int)((long long)count * (worker + 1) / workerCount);
+}
+
+static bool IsInSeparationRange(const NPCStore *store, int index, int other)
+{
+    float dx = store->positionX[index] - store->positionX[other];
+    float dy = store->positionY[index] - store->positionY[other];
+    float distance2 = dx * dx + dy * dy;
+    float range = store->collisionRadius[index] * 2.0f;
+    return distance2 > 0.0f && distance2 < range * range;
+}
+
+// A sleeper fell asleep with nobody in its separation range, so anyone in range now moved last
+// tick or was woken, placed or ordered since: its quietTicks is 0. Such a mover lists the
+// sleepers among its candidates that it is in range of, and they are woken after this pass.
+static void ListSleepersNear(NPCStore *store, NPCWorkerScratch *scratch, int mover, const int *candidates, int count)
+{
+    if (store->quietTicks[mover] != 0)
+        return;
+    for (int c = 0; c < count; c++)
+    {
+        int other = candidates ? candidates[c] : c;
+        if (!store->asleep[other] || !IsInSeparationRange(store, other, mover))
+            continue;
+        if (scratch->wakeCount == scratch->wakeCapacity)
+        {
+            scratch->wakeOverflow = true; // Several movers near the same sleepers; check them all instead
+            return;
+        }
+        scratch->wake[scratch->wakeCount++] = other;
+    }
+}
+
+// True if any NPC is within this one's separation range, so its push may not stay zero
+static bool HasNeighbourInRange(const NPCStore *store, bool useGrid, int index)
+{
+    if (!useGrid)
+    {
+        for (int other = 0; other < store->count; other++)
+        {
+            if (IsInSeparationRange(store, index, other))
+                return true;
+        }
+        return false;
+    }
+    int cellX, cellY;
+    GetSpatialGridCell(&store->grid, (Vector2){store->positionX[index], store->positionY[index]}, &cellX, &cellY);
+    for (int cy = cellY - 1; cy <= cellY + 1; cy++)
+    {
+        for (int cx = cellX - 1; cx <= cellX + 1; cx++)
+        {
+            int begin, end;
+            GetSpatialGridBucket(&store->grid, cx, cy, &begin, &end);
+            for (int e = begin; e < end; e++)
+            {
+                const SpatialGridEntry *entry = &store->grid.entries[e];
+                if (entry->cellX == cx && entry->cellY == cy && IsInSeparationRange(store, index, entry->index))
+                    return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Pass 1: separation for one worker's range of awake NPCs. With the grid, the range is over grid
+// entries in bucket order, so NPCs sharing a cell are visited back to back and share one
+// gathered candidate list; a candidate list depends only on the cell, not on where a range starts.
+static void SeparationJob(void *data, int worker, int workerCount)
+{
+    const NPCUpdateJob *job = data;
+    NPCStore *store = job->store;
+    NPCWorkerScratch *scratch = &store->scratch[worker];
+    int begin, end;
+    GetWorkerRange(store->count, worker, workerCount, &begin, &end);
+    scratch->wakeCount = 0;
+    scratch->wakeOverflow = false;
+
+    if (!job->useGrid)
+    {
+        for (int i = begin; i < end; i++)
+        {
+            if (store->asleep[i])
+                continue;
+            float range = store->collisionRadius[i] * 2.0f;
+            sumSeparation(store->positionX[i], store->positionY[i], range * range, store->positionX, store->positionY,
+                          store->count, &store->separationX[i], &store->separationY[i]);
+            if (store->asleepCount > 0)
+                ListSleepersNear(store, scratch, i, NULL, store->count);
+        }
+        return;
+    }
+
+    int candidates = 0;
+    bool gathered = false;
+    int lastCellX = 0, lastCellY = 0;
+    for (int e = begin; e < end; e++)
+    {
+        const SpatialGridEntry *entry = &store->grid.entries[e];
+        int i = entry->index;
+        if (store->asleep[i])
+            continue;
+        if (!gathered || entry->cellX != lastCellX || entry->cellY != lastCellY)
+        {
+            candidates = GatherCandidates(store, scratch, entry->cellX, entry->cellY);
+            gathered = true;
+            lastCellX = entry->cellX;
+            lastCellY = entry->cellY;
+        }
+
+        float range = store->collisionRadius[i] * 2.0f;
+        sumSeparation(store->positionX[i], store->positionY[i], range * range, scratch->candidateX,
+                      scratch->candidateY, candidates, &store->separationX[i], &store->separationY[i]);
+        if (store->asleepCount > 0)
+            ListSleepersNear(store, scratch, i, scratch->candidateIndex, candidates);
+    }
+}
+
+// Points NPCs on a route at its next tile, advancing once they stand in it
+static bool SteerAlongRoute(NPCStore *store, int i, int cellX, int cellY, int *nextX, int *nextY)
+{
+    const TilePath *route = &store->route[i];
+    int step = store->routeStep[i];
+    // Separation may push the NPC one tile ahead of its step; skip to where it is
+    while (step < route->count - 1 && ((route->x[step] == cellX && route->y[step] == cellY) ||
+                                        (route->x[step + 1] == cellX && route->y[step + 1] == cellY)))
+        step++;
+    store->routeStep[i] = step;
+    if (step >= route->count - 1)
+        return false; // The last tile holds the order itself
+    *nextX = route->x[step];
+    *nextY = route->y[step];
+    return true;
+}
+
+// Points NPCs following a flow field or a route at the centre of the next tile on their path,
+// or at the order itself once they stand in its tile (or somewhere the field has no path from)
+static void SteerNPCs(NPCStore *store, int begin, int end)
+{
+    for (int i = begin; i < end; i++)
+    {
+        bool hasRoute = store->route[i].count > 0;
+        if ((!hasRoute && store->flowField[i] == INVALID_FLOW_FIELD) || store->state[i] != NPC_WALKING)
+            continue;
+        const FlowField *field = GetFlowField(store->flowField[i]);
+        int cellX = (int)floorf(store->positionX[i] / tileSize);
+        int cellY = (int)floorf(store->positionY[i] / tileSize);
+        int nextX, nextY;
+        bool stepping = hasRoute ? SteerAlongRoute(store, i, cellX, cellY, &nextX, &nextY)
+                                 : field && GetFlowFieldStep(field, cellX, cellY, &nextX, &nextY);
+        if (stepping)
+        {
+            store->targetX[i] = (nextX + 0.5f) * tileSize;
+            store->targetY[i] = (nextY + 0.5f) * tileSize;
+        }
+        else
+        {
+            store->targetX[i] = store->orderX[i];
+            store->targetY[i] = store->orderY[i];
+        }
+    }
+}
+
+// Sweeps each moved NPC's box from its tick-start position against tileCollisionMap and keeps
+// only the motion it can make. Each test reads a few bitmap words, and open ground costs one.
+static void CollideNPCsWithTiles(NPCStore *store, int begin, int end, float *nextX, float *nextY)
+{
+    for (int i = begin; i < end; i++)
+    {
+        Vector2 motion = {nextX[i] - store->positionX[i], nextY[i] - store->positionY[i]};
+        if (motion.x == 0.0f && motion.y == 0.0f)
+            continue;
+        Rectangle box = {store->positionX[i] - store->boxOffsetX[i], store->positionY[i] - store->boxOffsetY[i],
+                         store->boxWidth[i], store->boxHeight[i]};
+        Vector2 moved = SlideCollisionMapRec(&tileCollisionMap, box, motion);
+        if (moved.x == motion.x && moved.y == motion.y)
+            continue;
+        nextX[i] = store->positionX[i] + moved.x;
+        nextY[i] = store->positionY[i] + moved.y;
+        store->boxX[i] = nextX[i] - store->boxOffsetX[i];
+        store->boxY[i] = nextY[i] - store->boxOffsetY[i];
+    }
+}
+
+// Counts the ticks each awake NPC stands idle with no push, and puts it to sleep after
+// NPC_SLEEP_TICKS of them if nobody is in its range (pushes can cancel out)
+static int UpdateNPCSleep(NPCStore *store, int begin, int end, const NPCUpdateJob *job)
+{
+    int fellAsleep = 0;
+    for (int i = begin; i < end; i++)
+    {
+        if (store->asleep[i])
+            continue;
+        // An NPC that stopped this tick still moved, and must list the sleepers it reached next tick
+        bool quiet = store->state[i] == NPC_IDLE && store->separationX[i] == 0.0f && store->separationY[i] == 0.0f &&
+                     store->previousPositionX[i] == store->positionX[i] && store->previousPositionY[i] == store->positionY[i];
+        store->quietTicks[i] = quiet ? store->quietTicks[i] + 1 : 0;
+        if (job->allowSleep && store->quietTicks[i] >= NPC_SLEEP_TICKS && !HasNeighbourInRange(store, job->useGrid, i))
+        {
+            store->asleep[i] = 1;
+            fellAsleep++;
+        }
+    }
+    return fellAsleep;
+}
+
+// Pass 2: movement for one worker's range of NPC indices, into the other position buffer. The
+// kernel runs over each stretch of awake NPCs; sleepers just keep their positions.
+static void MoveJob(void *data, int worker, int workerCount)
+{
+    const NPCUpdateJob *job = data;
+    NPCStore *store = job->store;
+    int begin, end;
+    GetWorkerRange(store->count, worker, workerCount, &begin, &end);
+    SteerNPCs(store, begin, end);
+    int arrived = 0;
+    for (int run = begin; run < end;)
+    {
+        int runEnd = run + 1;
+        while (runEnd < end && store->asleep[runEnd] == store->asleep[run])
+            runEnd++;
+        if (store->asleep[run])
+        {
+            memcpy(store->previousPositionX + run, store->positionX + run, (runEnd - run) * sizeof(float));
+            memcpy(store->previousPositionY + run, store->positionY + run, (runEnd - run) * sizeof(float));
+        }
+        else
+        {
+            arrived += moveNPCs(store, run, runEnd, job->deltaTime, store->previousPositionX, store->previousPositionY,
+                                store->arrivals + begin + arrived);
+        }
+        run = runEnd;
+    }
+    store->scratch[worker].arrived = arrived;
+    if (npcCollideWithTiles && tileCollisionMap.blockedCount > 0)
+        CollideNPCsWithTiles(store, begin, end, store->previousPositionX, store->previousPositionY);
+    store->scratch[worker].fellAsleep = UpdateNPCSleep(store, begin, end, job);
+}
+
+static void RunNPCJob(NPCStore *store, WorkerJob job, NPCUpdateJob *data, int workerCount)
+{
+    if (workerCount > 1)
+        RunWorkerPool(store->pool, job, data);
+    else
+        job(data, 0, 1);
+}
+
+// Builds the grid over the tick-start positions; false if it could not be allocated
+static bool BuildStoreGrid(NPCStore *store)
+{
+    float maxRadius = 1.0f;
+    for (int i = 0; i < store->count; i++)
+    {
+        if (store->collisionRadius[i] > maxRadius)
+            maxRadius = store->collisionRadius[i];
+    }
+    if (store->grid.cellSize != maxRadius * 2.0f)
+    {
+        FreeSpatialGrid(&store->grid);
+        InitSpatialGrid(&store->grid, maxRadius * 2.0f);
+    }
+    BuildSpatialGridXY(&store->grid, store->positionX, store->positionY, store->count);
+    return store->grid.count == store->count;
+}
+
+// Wakes the sleepers the separation pass listed and sums the push they skipped, so the tick
+// goes on exactly as if they had never slept
+static void WakeNPCInTick(NPCStore *store, bool useGrid, int index)
+{
+    WakeStoreNPC(store, index);
+    float range = store->collisionRadius[index] * 2.0f;
+    if (!useGrid)
+    {
+        sumSeparation(store->positionX[index], store->positionY[index], range * range, store->positionX,
+                      store->positionY, store->count, &store->separationX[index], &store->separationY[index]);
+        return;
+    }
+    NPCWorkerScratch *scratch = &store->scratch[0]; // The workers are done with it
+    int cellX, cellY;
+    GetSpatialGridCell(&store->grid, (Vector2){store->positionX[index], store->positionY[index]}, &cellX, &cellY);
+    int candidates = GatherCandidates(store, scratch, cellX, cellY);
+    sumSeparation(store->positionX[index], store->positionY[index], range * range, scratch->candidateX,
+                  scratch->candidateY, candidates, &store->separationX[index], &store->separationY[index]);
+}
+
+static void WakeListedSleepers(NPCStore *store, bool useGrid, int workerCount)
+{
+    bool overflow = false;
+    for (int w = 0; w < workerCount; w++)
+    {
+        NPCWorkerScratch *scratch = &store->scratch[w];
+        overflow = overflow || scratch->wakeOverflow;
+        for (int n = 0; n < scratch->wakeCount; n++)
+        {
+            if (store->asleep[scratch->wake[n]])
+                WakeNPCInTick(store, useGrid, scratch->wake[n]);
+        }
+    }
+    for (int i = 0; i < store->count && overflow; i++)
+    {
+        if (store->asleep[i] && HasNeighbourInRange(store, useGrid, i))
+            WakeNPCInTick(store, useGrid, i);
+    }
+}
+
+void UpdateNPCStore(NPCStore *store, float deltaTime)
+{
+    EnsureKernelPath();
+    if (store->count == 0)
+    {
+        memset(&store->stats, 0, sizeof(NPCStoreStats));
+        return;
+    }
+
+    RefreshFlowFields(); // Workers only read fields, so tile edits are picked up here, between ticks
+
+    int workerCount = store->count >= NPC_PARALLEL_MIN_COUNT ? GetNPCStoreThreadCount(store) : 1;
+    NPCUpdateJob job = {.store = store, .deltaTime = deltaTime, .useGrid = npcUseSpatialGrid, .allowSleep = false};
+    if (job.useGrid)
+    {
+        for (int w = 0; w < workerCount && job.useGrid; w++)
+        {
+            job.useGrid = ReserveWorkerScratch(&store->scratch[w], store->count);
+        }
+        job.useGrid = job.useGrid && BuildStoreGrid(store); // All pairs if allocation failed
+    }
+    bool canSleep = npcAllowSleep;
+    for (int w = 0; w < workerCount && canSleep; w++)
+    {
+        canSleep = ReserveWakeList(&store->scratch[w], store->count);
+    }
+    for (int i = 0; i < store->count && !canSleep && store->asleepCount > 0; i++)
+    {
+        WakeStoreNPC(store, i);
+    }
+
+    // Every push is computed from tick-start positions before anyone moves, and movement writes
+    // the other buffer, so no NPC's result depends on NPC order or on which worker ran it
+    RunNPCJob(store, SeparationJob, &job, workerCount);
+    WakeListedSleepers(store, job.useGrid, workerCount);
+    job.allowSleep = canSleep;
+    RunNPCJob(store, MoveJob, &job, workerCount);
+
+    float *swap = store->positionX;
+    store->positionX = store->previousPositionX;
+    store->previousPositionX = swap;
+    swap = store->positionY;
+    store->positionY = store->previousPositionY;
+    store->previousPositionY = swap;
+
+    int fellAsleep = 0;
+    for (int w = 0; w < workerCount; w++)
+    {
+        fellAsleep += store->scratch[w].fellAsleep;
+    }
+    store->asleepCount += fellAsleep;
+
+    // Animation players are not thread-safe; switch clips here, in NPC index order
+    for (int w = 0; w < workerCount; w++)
+    {
+        int begin, end;
+        GetWorkerRange(store->count, w, workerCount, &begin, &end);
+        for (int a = 0; a < store->scratch[w].arrived; a++)
+        {
+            int i = store->arrivals[begin + a];
+            if (store->targetX[i] != store->orderX[i] || store->targetY[i] != store->orderY[i])
+                continue; // Reached a tile on the way; still walking, steering picks the next one
+            ReleaseFlowField(store->flowField[i]);
+            store->flowField[i] = INVALID_FLOW_FIELD;
+            store->route[i].count = 0;
+            SetStoreNPCState(store, i, NPC_IDLE);
+        }
+    }
+
+    store->stats = (NPCStoreStats){store->count - store->asleepCount, store->asleepCount, store->wokenCount, fellAsleep};
+    store->wokenCount = 0;
+}
+
+void DrawNPCStore(const NPCStore *store, float alpha)
+{
+    for (int i = 0; i < store->count; i++)
+    {
+        NPC npc;
+        CopyNPCFromStore(store, i, &npc);
+        float x = store->previousPositionX[i] + (store->positionX[i] - store->previousPositionX[i]) * alpha;
+        float y = store->previousPositionY[i] + (store->positionY[i] - store->previousPositionY[i]) * alpha;
+        npc.boundingBox.x += x - npc.position.x;
+        npc.boundingBox.y += y - npc.position.y;
+        npc.position = (Vector2){x, y};
+        DrawNPC(&npc);
+    }
+}
+
+/**
+ * @brief Processes mouse input to handle NPC selection and movement.
+ *
+ * @param store NPCs to select and command.
+ * @param picks Pick index built from the store this frame.
+ * @param mousePosition Current mouse position.
+ * @param mousePressed Boolean indicating if the mouse was pressed.
+ */
+void HandleNPCMouseInput(NPCStore *store, PickIndex *picks, Vector2 mousePosition, bool mousePressed)
+{
+    if (IsMouseButtonPressed(MOUSE_BUTTON_RIGHT))
+    {
+        // Deselect all NPCs on right-click
+        for (int i = 0; i < store->count; i++)
+        {
+            store->cold[i].isSelected = false;
+        }
+    }
+    else if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT))
+    {
+        // Check if Shift is held down
+        bool shiftHeld = IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT);
+
+        // Prioritize the topmost NPC if several overlap
+        int i = PickTopmost(picks, mousePosition, PICK_NPC);
+        if (i >= 0)
+        {
+            // If Shift is held, add to selection; otherwise, select just this NPC
+            if (!shiftHeld)
+            {
+                // Deselect all others and select only this NPC
+                for (int j = 0; j < store->count; j++)
+                {
+                    store->cold[j].isSelected = false;
+                }
+            }
+            store->cold[i].isSelected = true;
+        }
+        else
+        {
+            // If clicked on empty space, set target position for selected NPCs
+            MoveSelectedNPCs(store, mousePosition);
+        }
+    }
+}
+
+int MoveSelectedNPCs(NPCStore *store, Vector2 target)
+{
+    int selected = 0, single = -1;
+    for (int i = 0; i < store->count; i++)
+    {
+        if (store->cold[i].isSelected)
+        {
+            selected++;
+            single = i;
+        }
+    }
+    if (selected == 0)
+        return 0;
+
+    int goalX = (int)floorf(target.x / tileSize), goalY = (int)floorf(target.y / tileSize);
+    FlowFieldId field = INVALID_FLOW_FIELD;
+    if (selected > 1)
+        field = AcquireFlowField(goalX, goalY);
+
+    int ordered = 0;
+    for (int i = 0; i < store->count; i++)
+    {
+        if (store->cold[i].isSelected)
+        {
+            if (ordered > 0)
+                RetainFlowField(field); // The first NPC takes the reference Acquire returned
+            ReleaseFlowField(store->flowField[i]);
+            store->flowField[i] = field;
+            store->route[i].count = 0;
+            store->routeStep[i] = 1;
+            if (i == single && selected == 1)
+            {
+                // Keeps the route empty if there is no path, like a field-less group order
+                FindTilePath((int)floorf(store->positionX[i] / tileSize), (int)floorf(store->positionY[i] / tileSize),
+                             goalX, goalY, &store->route[i]);
+            }
+            store->orderX[i] = target.x;
+            store->orderY[i] = target.y;
+            store->targetX[i] = target.x;
+            store->targetY[i] = target.y;
+            // Change state to walking to trigger movement
+            SetStoreNPCState(store, i, NPC_WALKING);
+            ordered++;
+        }
+    }
+    return ordered;
+}
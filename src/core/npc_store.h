@@ -0,0 +1,181 @@
+// npc_store.h
+
+#pragma once
+
+#include "raylib.h"
+#include "npc.h"
+#include "flow_field.h"
+#include "path_graph.h"
+#include "spatial_grid.h"
+#include "worker_pool.h"
+#include <stdbool.h>
+
+typedef struct PickIndex PickIndex; // pick_index.h
+
+// Implementations of the NPC update kernels. The best one the CPU supports is picked on first
+// use; SetNPCKernelPath exists so benchmarks can compare them.
+typedef enum NPCKernelPath
+{
+    NPC_KERNEL_AUTO,
+    NPC_KERNEL_SCALAR,
+    NPC_KERNEL_SSE2,
+    NPC_KERNEL_AVX2
+} NPCKernelPath;
+
+// Below this many NPCs a tick is too short to be worth waking the workers
+#define NPC_PARALLEL_MIN_COUNT 512
+// Ticks an NPC must stand idle with no separation push before it falls asleep
+#define NPC_SLEEP_TICKS 30
+
+// Fields the update never reads; one entry per NPC
+typedef struct NPCColdData
+{
+    float health;
+    int strength;
+    int defense;
+    const char *unitType;
+    AnimationPlayerId animation;
+    AnimationClipId idleClip;
+    AnimationClipId walkClip;
+    AnimationClipId attackClip;
+    bool isCollidable;
+    bool drawName;
+    bool isSelected;
+} NPCColdData;
+
+// Per-worker state of one UpdateNPCStore
+typedef struct NPCWorkerScratch
+{
+    float *candidateX; // Positions of the NPCs in the 3x3 cells around the current cell
+    float *candidateY;
+    int *candidateIndex;
+    int capacity;
+    int arrived; // Entries this worker wrote to arrivals, starting at its range
+    int fellAsleep;
+    int *wake; // Sleepers this worker's movers came within range of; may repeat
+    int wakeCapacity;
+    int wakeCount;
+    bool wakeOverflow; // The list filled up; every sleeper gets checked instead
+} NPCWorkerScratch;
+
+// Sleep counts of the last UpdateNPCStore
+typedef struct NPCStoreStats
+{
+    int awake;
+    int asleep;
+    int woken;      // Sleepers woken by a moving neighbour, an order, a spawn or WakeStoreNPC
+    int fellAsleep;
+} NPCStoreStats;
+
+// Structure-of-arrays NPC storage. Every per-tick field is its own contiguous array, so the
+// kernels stream 4 bytes per NPC per field instead of striding over whole NPC structs; the
+// rest lives in `cold`. NPC index i is the same in every array. The NPC struct stays the
+// per-unit view: InitNPC one, AddNPCToStore it, and CopyNPCFromStore to read one back.
+typedef struct NPCStore
+{
+    int count;
+    int capacity;
+
+    // Hot: read or written by UpdateNPCStore every tick. A tick reads only positionX/Y and
+    // writes the new positions into previousPositionX/Y, then swaps the two, so after a tick
+    // previousPositionX/Y hold the positions at its start.
+    float *positionX;
+    float *positionY;
+    float *previousPositionX;
+    float *previousPositionY;
+    float *targetX; // Where the NPC is walking this tick: the order itself, or the next tile on its flow field
+    float *targetY;
+    float *orderX;  // Where the NPC was ordered to
+    float *orderY;
+    FlowFieldId *flowField; // Field the NPC follows to its order, INVALID_FLOW_FIELD to walk straight
+    TilePath *route;        // Tiles to the order when the NPC was ordered alone; count 0 otherwise
+    int *routeStep;         // Next tile of route to walk to
+    float *speed;
+    float *collisionRadius;
+    float *separationForce;
+    int *state;         // NPCState
+    float *separationX; // Separation pushes summed from tick-start positions
+    float *separationY;
+    int *quietTicks;        // Ticks in a row the NPC stood idle with no push; 0 if it moved or was woken
+    unsigned char *asleep;  // Skipped by separation and movement until woken
+
+    // Bounding box: origin refreshed every tick from position - offset, size set by the clip
+    float *boxX;
+    float *boxY;
+    float *boxOffsetX;
+    float *boxOffsetY;
+    float *boxWidth;
+    float *boxHeight;
+
+    NPCColdData *cold;
+
+    // Per-tick scratch
+    SpatialGrid grid;
+    int *arrivals; // NPCs that reached their target this tick; each worker fills its own range
+    NPCWorkerScratch scratch[MAX_POOL_WORKERS];
+    WorkerPool *pool; // NULL while the store updates on the calling thread only
+    NPCStoreStats stats;
+    int asleepCount;
+    int wokenCount; // Since the last tick's stats
+} NPCStore;
+
+void InitNPCStore(NPCStore *store);
+void FreeNPCStore(NPCStore *store);
+void ClearNPCStore(NPCStore *store); // Removes all NPCs and releases their animation players
+
+// Splits UpdateNPCStore over threadCount workers (1 = the calling thread only). Each worker owns
+// a fixed range of NPCs and every NPC's result depends only on the tick-start positions, so the
+// world state after a tick is bit-identical for any thread count.
+int SetNPCStoreThreadCount(NPCStore *store, int threadCount);
+int GetNPCStoreThreadCount(const NPCStore *store);
+
+// Appends an NPC set up by InitNPC. Returns its index, or -1 if the store is full.
+int AddNPCToStore(NPCStore *store, const NPC *npc);
+void CopyNPCFromStore(const NPCStore *store, int index, NPC *npc);
+void CopyNPCToStore(NPCStore *store, int index, const NPC *npc);
+
+void SetStoreNPCState(NPCStore *store, int index, NPCState newState); // Also wakes the NPC
+// Wakes a sleeping NPC; call after changing one by hand, e.g. damaging it. Orders, spawns and
+// CopyNPCToStore wake NPCs themselves.
+void WakeStoreNPC(NPCStore *store, int index);
+NPCStoreStats GetNPCStoreStats(const NPCStore *store);
+Rectangle GetStoreNPCBoundingBox(const NPCStore *store, int index);
+
+/**
+ * @brief Updates every NPC in the store for one tick. Separation is summed from the positions
+ * at the start of the tick (through the spatial grid unless npcUseSpatialGrid is off), then
+ * one vectorized pass applies it, walks towards targets into the other position buffer and
+ * refreshes bounding boxes. Boxes that would enter a collidable tile then slide along it
+ * (unless npcCollideWithTiles is off). Both passes run on the store's workers.
+ *
+ * NPCs idle with no push and nobody in range for NPC_SLEEP_TICKS fall asleep (unless
+ * npcAllowSleep is off) and both passes skip them. Only an NPC that moved can then come near a
+ * sleeper; separation lists the sleepers each mover reaches and they are woken before anyone
+ * moves, so the world evolves exactly as if nobody slept.
+ *
+ * @param store NPCs to update.
+ * @param deltaTime Time elapsed since the last frame (in seconds).
+ */
+void UpdateNPCStore(NPCStore *store, float deltaTime);
+// Draws every NPC at previous + (current - previous) * alpha, so rendering between two fixed
+// ticks moves smoothly; alpha = 1 draws the current positions
+void DrawNPCStore(const NPCStore *store, float alpha);
+
+/**
+ * @brief Processes mouse input to handle NPC selection and movement.
+ *
+ * @param store NPCs to select and command.
+ * @param picks Pick index built from the store this frame.
+ * @param mousePosition Current mouse position.
+ * @param mousePressed Boolean indicating if the mouse was pressed.
+ */
+void HandleNPCMouseInput(NPCStore *store, PickIndex *picks, Vector2 mousePosition, bool mousePressed);
+// Sends every selected NPC walking to target, as a click on empty ground does; returns how many.
+// Several NPCs share one flow field to the target's tile, so an order costs one Dijkstra pass
+// however many it moves; a single NPC follows a hierarchical A* path instead, which costs far
+// less than a whole-map field. They walk straight if the target is off the map or collidable.
+int MoveSelectedNPCs(NPCStore *store, Vector2 target);
+
+NPCKernelPath GetNPCKernelPath(void);
+bool SetNPCKernelPath(NPCKernelPath path); // False if the CPU lacks the requested path
+const char *GetNPCKernelPathName(NPCKernelPath path);
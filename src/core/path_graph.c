@@ -0,0 +1,1254 @@
+// path_graph.c
+
+#include "path_graph.h"
+#include "map.h"
+#include "min_heap.h"
+#include "sim_clock.h"
+#include "tile_placement_data.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PATH_UNREACHABLE 1e30f
+#define PATH_DIAGONAL_LENGTH 1.41421356f
+
+static const int stepX[8] = {1, 1, 0, -1, -1, -1, 0, 1};
+static const int stepY[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+
+typedef struct PathEdge
+{
+    int to;
+    float cost;
+    int pathStart;  // Tiles of the edge in clusterPaths, both ends included; 0 length if not stored
+    int pathLength;
+    bool reversed;  // Stored from `to` back to this node
+} PathEdge;
+
+// One side of a transition. Every node belongs to exactly one cluster and one border.
+typedef struct PathNode
+{
+    int x;
+    int y;
+    int cluster; // -1 while the slot is free
+    int twin;    // Node on the other side of the border
+    float twinCost;
+    PathEdge *edges; // To the other nodes of the cluster
+    int edgeCount;
+    int edgeCapacity;
+} PathNode;
+
+// Abstract search state of one node, side by side so relaxing a node touches one cache line
+typedef struct SearchNode
+{
+    float cost;
+    float estimate; // Remaining-cost estimate, set when the node is first opened
+    int parent;
+    unsigned int openStamp;
+    unsigned int closedStamp;
+    unsigned int goalLinkStamp;
+    float goalLinkCost;
+} SearchNode;
+
+typedef struct IntList
+{
+    int *items;
+    int count;
+    int capacity;
+} IntList;
+
+typedef struct LocalList
+{
+    unsigned short *items; // Tile indices within a cluster
+    int count;
+    int capacity;
+} LocalList;
+
+static bool graphBuilt = false;
+static int graphWidth = 0;
+static int graphHeight = 0;
+static unsigned int graphRevision = 0;
+static int **graphTerrain = NULL; // map.tiles the costs were read from
+static int graphTerrainWidth = 0;
+static int graphTerrainHeight = 0;
+
+static int clustersX = 0;
+static int clustersY = 0;
+static float *tileCost = NULL; // Per tile; 0 = blocked
+static PathNode *nodes = NULL;
+static int nodeCount = 0; // Slots, free ones included
+static int nodeCapacity = 0;
+static IntList freeNodes;
+static IntList *clusterNodes = NULL;
+static IntList *eastBorders = NULL;  // Transition node pairs between a cluster and the one east of it
+static IntList *southBorders = NULL; // ... and the one south of it
+static LocalList *clusterPaths = NULL; // Tiles of each cluster's edges as local indices, so refining a hop is a copy
+static unsigned char *dirtyClusters = NULL;
+static IntList dirtyList;
+static PathGraphStats stats;
+
+// Search state. One search runs at a time: a cluster search over local tile indices, or the
+// abstract search over node ids plus one virtual goal node.
+#define PATH_PADDED_SIZE (PATH_CLUSTER_SIZE + 2)
+static float paddedCost[PATH_PADDED_SIZE * PATH_PADDED_SIZE]; // Tile costs of the searched cluster in a ring of blocked tiles
+static float localCost[PATH_CLUSTER_SIZE * PATH_CLUSTER_SIZE];
+static int localParent[PATH_CLUSTER_SIZE * PATH_CLUSTER_SIZE];
+static unsigned char localClosed[PATH_CLUSTER_SIZE * PATH_CLUSTER_SIZE];
+static unsigned char localTargets[PATH_CLUSTER_SIZE * PATH_CLUSTER_SIZE]; // Nodes on each tile a search without a goal waits for
+static int localTargetCount = 0; // ... in all; 0 searches the whole cluster
+static float goalTreeCost[PATH_CLUSTER_SIZE * PATH_CLUSTER_SIZE]; // The abstract search's cluster search from the goal
+static int goalTreeParent[PATH_CLUSTER_SIZE * PATH_CLUSTER_SIZE];
+static SearchNode *search = NULL;
+static int searchCapacity = 0;
+static unsigned int searchStamp = 0;
+
+static float *landmarkCost = NULL; // Abstract cost from each landmark to every node, a node's costs side by side
+static float goalLandmarkCost[PATH_LANDMARK_COUNT]; // ... and to the goal of the current query
+static unsigned int *landmarkPending = NULL; // A bit per landmark whose lowered cost the node has yet to pass on
+static unsigned int landmarkLowering = 0; // A bit per landmark any node has pending
+static Heap loweringList; // Nodes with landmarks pending, by their lowest pending cost
+static float landmarkCap[PATH_LANDMARK_COUNT]; // What the current query caps each landmark's costs at
+static int landmarkCapacity = 0;
+static bool landmarksValid = false;
+
+static Heap openList; // Shared by the cluster, landmark and abstract searches
+
+static bool PushInt(IntList *list, int value)
+{
+    if (list->count >= list->capacity)
+    {
+        int newCapacity = list->capacity > 0 ? list->capacity * 2 : 8;
+        int *grown = realloc(list->items, newCapacity * sizeof(int));
+        if (grown == NULL)
+            return false;
+        list->items = grown;
+        list->capacity = newCapacity;
+    }
+    list->items[list->count++] = value;
+    return true;
+}
+
+static void RemoveInt(IntList *list, int value)
+{
+    for (int i = 0; i < list->count; i++)
+    {
+        if (list->items[i] == value)
+        {
+            list->items[i] = list->items[--list->count];
+            return;
+        }
+    }
+}
+
+float GetTileTravelCost(int x, int y)
+{
+    if (x < 0 || y < 0 || x >= mapTilesX || y >= mapTilesY)
+        return 0.0f;
+    if (IsCollisionCellBlocked(&tileCollisionMap, x, y))
+        return 0.0f;
+    if (map.tiles == NULL || x >= map.width || y >= map.height)
+        return PATH_TERRAIN_COST;
+    switch (map.tiles[y][x])
+    {
+    case WATER:
+        return PATH_WATER_COST;
+    case MOUNTAIN:
+        return PATH_MOUNTAIN_COST;
+    default:
+        return PATH_TERRAIN_COST;
+    }
+}
+
+// Octile distance; every tile costs at least PATH_TERRAIN_COST, so it never overestimates
+static float EstimateCost(int x, int y, int goalX, int goalY)
+{
+    int dx = abs(x - goalX), dy = abs(y - goalY);
+    int diagonal = dx < dy ? dx : dy;
+    return ((dx + dy) + (PATH_DIAGONAL_LENGTH - 2.0f) * diagonal) * PATH_TERRAIN_COST;
+}
+
+static int GetTileCluster(int x, int y)
+{
+    return (y / PATH_CLUSTER_SIZE) * clustersX + x / PATH_CLUSTER_SIZE;
+}
+
+static void GetClusterBounds(int cluster, int *x0, int *y0, int *x1, int *y1)
+{
+    *x0 = (cluster % clustersX) * PATH_CLUSTER_SIZE;
+    *y0 = (cluster / clustersX) * PATH_CLUSTER_SIZE;
+    *x1 = *x0 + PATH_CLUSTER_SIZE < graphWidth ? *x0 + PATH_CLUSTER_SIZE : graphWidth;
+    *y1 = *y0 + PATH_CLUSTER_SIZE < graphHeight ? *y0 + PATH_CLUSTER_SIZE : graphHeight;
+}
+
+static int GetLocalIndex(int cluster, int x, int y)
+{
+    return (y - (cluster / clustersX) * PATH_CLUSTER_SIZE) * PATH_CLUSTER_SIZE + x - (cluster % clustersX) * PATH_CLUSTER_SIZE;
+}
+
+// Dijkstra, or A* when a goal is given, over the tiles of one cluster. Diagonal steps may not
+// cut the corner of a blocked tile. Fills localCost/localParent; true if the goal was reached.
+// Without a goal the search stops once it has closed the tiles of localTargetCount nodes.
+static bool SearchCluster(int cluster, int startX, int startY, int goalX, int goalY)
+{
+    int x0, y0, x1, y1;
+    GetClusterBounds(cluster, &x0, &y0, &x1, &y1);
+    for (int i = 0; i < PATH_CLUSTER_SIZE * PATH_CLUSTER_SIZE; i++)
+    {
+        localCost[i] = PATH_UNREACHABLE;
+    }
+    memset(localClosed, 0, sizeof(localClosed));
+    // Steps then need no bounds checks: the ring, and tiles past a map edge cluster, block
+    memset(paddedCost, 0, sizeof(paddedCost));
+    for (int y = y0; y < y1; y++)
+    {
+        float *row = &paddedCost[(y - y0 + 1) * PATH_PADDED_SIZE + 1];
+        memcpy(row, &tileCost[y * graphWidth + x0], (x1 - x0) * sizeof(float));
+    }
+
+    bool hasGoal = goalX >= 0;
+    int start = GetLocalIndex(cluster, startX, startY);
+    int goal = hasGoal ? GetLocalIndex(cluster, goalX, goalY) : -1;
+    localCost[start] = 0.0f;
+    localParent[start] = -1;
+    openList.count = 0;
+    PushHeap(&openList, hasGoal ? EstimateCost(startX, startY, goalX, goalY) : 0.0f, start);
+    int targetsLeft = hasGoal ? 0 : localTargetCount;
+    while (openList.count > 0)
+    {
+        int local = PopHeap(&openList);
+        if (localClosed[local])
+            continue;
+        localClosed[local] = 1;
+        if (local == goal)
+            return true;
+        if (targetsLeft > 0 && (targetsLeft -= localTargets[local]) <= 0)
+            return false;
+
+        int x = local % PATH_CLUSTER_SIZE, y = local / PATH_CLUSTER_SIZE;
+        const float *padded = &paddedCost[(y + 1) * PATH_PADDED_SIZE + x + 1];
+        float cost = *padded;
+        for (int d = 0; d < 8; d++)
+        {
+            float nextCost = padded[stepY[d] * PATH_PADDED_SIZE + stepX[d]];
+            if (nextCost <= 0.0f)
+                continue;
+            if ((d & 1) && (padded[stepX[d]] <= 0.0f || padded[stepY[d] * PATH_PADDED_SIZE] <= 0.0f))
+                continue;
+
+            int next = local + stepY[d] * PATH_CLUSTER_SIZE + stepX[d];
+            float total = localCost[local] + ((d & 1) ? PATH_DIAGONAL_LENGTH : 1.0f) * (cost + nextCost) * 0.5f;
+            if (total < localCost[next])
+            {
+                localCost[next] = total;
+                localParent[next] = local;
+                float estimate = hasGoal ? EstimateCost(x0 + x + stepX[d], y0 + y + stepY[d], goalX, goalY) : 0.0f;
+                PushHeap(&openList, total + estimate, next);
+            }
+        }
+    }
+    return false;
+}
+
+static int AddNode(int x, int y, int cluster)
+{
+    int id;
+    if (freeNodes.count > 0)
+    {
+        id = freeNodes.items[--freeNodes.count];
+    }
+    else
+    {
+        if (nodeCount >= nodeCapacity)
+        {
+            int newCapacity = nodeCapacity > 0 ? nodeCapacity * 2 : 1024;
+            PathNode *grown = realloc(nodes, newCapacity * sizeof(PathNode));
+            if (grown == NULL)
+                return -1;
+            nodes = grown;
+            nodeCapacity = newCapacity;
+        }
+        id = nodeCount++;
+        memset(&nodes[id], 0, sizeof(PathNode));
+    }
+    PathNode *node = &nodes[id];
+    node->x = x;
+    node->y = y;
+    node->cluster = cluster;
+    node->twin = -1;
+    node->twinCost = 0.0f;
+    node->edgeCount = 0;
+    for (int k = 0; id < landmarkCapacity && k < PATH_LANDMARK_COUNT; k++)
+    {
+        landmarkCost[id * PATH_LANDMARK_COUNT + k] = PATH_UNREACHABLE;
+    }
+    if (!PushInt(&clusterNodes[cluster], id))
+    {
+        node->cluster = -1;
+        PushInt(&freeNodes, id);
+        return -1;
+    }
+    stats.nodes++;
+    return id;
+}
+
+static void FreeNode(int id)
+{
+    PathNode *node = &nodes[id];
+    RemoveInt(&clusterNodes[node->cluster], id);
+    stats.edges -= node->edgeCount;
+    node->edgeCount = 0; // Keeps the edge array for whoever reuses the slot
+    node->cluster = -1;
+    PushInt(&freeNodes, id);
+    stats.nodes--;
+}
+
+static void AddTransition(IntList *border, int cluster, int other, int x, int y, int otherX, int otherY)
+{
+    int a = AddNode(x, y, cluster);
+    if (a < 0)
+        return;
+    int b = AddNode(otherX, otherY, other);
+    if (b < 0)
+    {
+        FreeNode(a);
+        return;
+    }
+    float cost = (tileCost[y * graphWidth + x] + tileCost[otherY * graphWidth + otherX]) * 0.5f;
+    nodes[a].twin = b;
+    nodes[a].twinCost = cost;
+    nodes[b].twin = a;
+    nodes[b].twinCost = cost;
+    PushInt(border, a);
+    PushInt(border, b);
+}
+
+// Re-cuts the transitions between a cluster and its east (or south) neighbour. Nodes of the
+// old transitions are freed; the caller recomputes the edges of both clusters.
+static void BuildBorder(int cluster, bool east)
+{
+    IntList *border = east ? &eastBorders[cluster] : &southBorders[cluster];
+    for (int i = 0; i < border->count; i++)
+    {
+        FreeNode(border->items[i]);
+    }
+    border->count = 0;
+
+    int x0, y0, x1, y1;
+    GetClusterBounds(cluster, &x0, &y0, &x1, &y1);
+    int other = east ? cluster + 1 : cluster + clustersX;
+    int length = east ? y1 - y0 : x1 - x0;
+    int runStart = -1;
+    for (int i = 0; i <= length; i++)
+    {
+        bool open = false;
+        if (i < length)
+        {
+            int x = east ? x1 - 1 : x0 + i, y = east ? y0 + i : y1 - 1;
+            open = tileCost[y * graphWidth + x] > 0.0f && tileCost[(east ? y : y + 1) * graphWidth + (east ? x + 1 : x)] > 0.0f;
+        }
+        if (open && runStart < 0)
+        {
+            runStart = i;
+        }
+        else if (!open && runStart >= 0)
+        {
+            int runEnd = i - 1;
+            int picks[2] = {runStart, runEnd};
+            int pickCount = 2;
+            if (runEnd - runStart + 1 < PATH_ENTRANCE_SPLIT)
+            {
+                picks[0] = (runStart + runEnd) / 2;
+                pickCount = 1;
+            }
+            for (int p = 0; p < pickCount; p++)
+            {
+                if (east)
+                    AddTransition(border, cluster, other, x1 - 1, y0 + picks[p], x1, y0 + picks[p]);
+                else
+                    AddTransition(border, cluster, other, x0 + picks[p], y1 - 1, x0 + picks[p], y1);
+            }
+            runStart = -1;
+        }
+    }
+}
+
+static void AddEdge(int from, int to, float cost, int pathStart, int pathLength, bool reversed)
+{
+    PathNode *node = &nodes[from];
+    if (node->edgeCount >= node->edgeCapacity)
+    {
+        int newCapacity = node->edgeCapacity > 0 ? node->edgeCapacity * 2 : 8;
+        PathEdge *grown = realloc(node->edges, newCapacity * sizeof(PathEdge));
+        if (grown == NULL)
+            return;
+        node->edges = grown;
+        node->edgeCapacity = newCapacity;
+    }
+    node->edges[node->edgeCount++] = (PathEdge){to, cost, pathStart, pathLength, reversed};
+    stats.edges++;
+}
+
+static bool PushLocal(LocalList *list, unsigned short value)
+{
+    if (list->count >= list->capacity)
+    {
+        int newCapacity = list->capacity > 0 ? list->capacity * 2 : 256;
+        unsigned short *grown = realloc(list->items, newCapacity * sizeof(unsigned short));
+        if (grown == NULL)
+            return false;
+        list->items = grown;
+        list->capacity = newCapacity;
+    }
+    list->items[list->count++] = value;
+    return true;
+}
+
+// Drops the edge to `to`; its stored tiles stay in clusterPaths until the cluster is rebuilt
+static void RemoveEdge(int from, int to)
+{
+    PathNode *node = &nodes[from];
+    for (int e = 0; e < node->edgeCount; e++)
+    {
+        if (node->edges[e].to == to)
+        {
+            node->edges[e] = node->edges[--node->edgeCount];
+            stats.edges--;
+            return;
+        }
+    }
+}
+
+// Joins every pair of entrance nodes in the cluster that can reach each other inside it.
+// Step costs are symmetric, so one search from each node fills both directions, and one
+// stored tile list serves both. An edge that costs no less than going through a third node of
+// the cluster is then dropped: the abstract search finds the same costs with fewer edges.
+static void BuildClusterEdges(int cluster)
+{
+    static float *pairCost = NULL; // Between each two of the cluster's nodes, by list position
+    static int pairCapacity = 0;
+    const IntList *list = &clusterNodes[cluster];
+    LocalList *paths = &clusterPaths[cluster];
+    int count = list->count;
+    paths->count = 0;
+    for (int i = 0; i < count; i++)
+    {
+        stats.edges -= nodes[list->items[i]].edgeCount;
+        nodes[list->items[i]].edgeCount = 0;
+    }
+    if (count * count > pairCapacity)
+    {
+        float *grown = realloc(pairCost, count * count * sizeof(float));
+        if (grown)
+        {
+            pairCost = grown;
+            pairCapacity = count * count;
+        }
+    }
+    bool prune = count * count <= pairCapacity;
+
+    for (int i = 0; i < count; i++)
+    {
+        localTargets[GetLocalIndex(cluster, nodes[list->items[i]].x, nodes[list->items[i]].y)]++;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        // Only the nodes after this one are left to reach
+        int from = list->items[i];
+        localTargets[GetLocalIndex(cluster, nodes[from].x, nodes[from].y)]--;
+        localTargetCount = count - 1 - i;
+        if (localTargetCount > 0)
+            SearchCluster(cluster, nodes[from].x, nodes[from].y, -1, -1);
+        localTargetCount = 0;
+        for (int j = i + 1; j < count; j++)
+        {
+            int to = list->items[j];
+            int target = GetLocalIndex(cluster, nodes[to].x, nodes[to].y);
+            float cost = localCost[target];
+            if (prune)
+                pairCost[i * count + j] = pairCost[j * count + i] = cost;
+            if (cost < PATH_UNREACHABLE)
+            {
+                int start = paths->count;
+                bool stored = true;
+                for (int local = target; local >= 0 && stored; local = localParent[local])
+                {
+                    stored = PushLocal(paths, (unsigned short)local);
+                }
+                int length = stored ? paths->count - start : 0;
+                AddEdge(from, to, cost, start, length, true);
+                AddEdge(to, from, cost, start, length, false);
+            }
+        }
+    }
+
+    // A dropped edge's detour runs over edges between strictly closer nodes, so dropping can
+    // never leave a pair without a route; two nodes on one corner tile are 0 apart and skipped
+    for (int i = 0; prune && i < count; i++)
+    {
+        for (int j = i + 1; j < count; j++)
+        {
+            float cost = pairCost[i * count + j];
+            if (cost >= PATH_UNREACHABLE)
+                continue;
+            for (int k = 0; k < count; k++)
+            {
+                if (k == i || k == j)
+                    continue;
+                float first = pairCost[i * count + k], second = pairCost[k * count + j];
+                if (first > 0.0f && second > 0.0f && first + second <= cost)
+                {
+                    RemoveEdge(list->items[i], list->items[j]);
+                    RemoveEdge(list->items[j], list->items[i]);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+static void FreeGraph(void)
+{
+    for (int i = 0; i < nodeCount; i++)
+    {
+        free(nodes[i].edges);
+    }
+    free(nodes);
+    nodes = NULL;
+    nodeCount = nodeCapacity = 0;
+    free(freeNodes.items);
+    memset(&freeNodes, 0, sizeof(IntList));
+    for (int c = 0; clusterNodes != NULL && c < clustersX * clustersY; c++)
+    {
+        free(clusterNodes[c].items);
+        free(eastBorders[c].items);
+        free(southBorders[c].items);
+        free(clusterPaths[c].items);
+    }
+    free(clusterNodes);
+    free(eastBorders);
+    free(southBorders);
+    free(clusterPaths);
+    clusterNodes = eastBorders = southBorders = NULL;
+    clusterPaths = NULL;
+    free(dirtyClusters);
+    dirtyClusters = NULL;
+    free(dirtyList.items);
+    memset(&dirtyList, 0, sizeof(IntList));
+    free(tileCost);
+    tileCost = NULL;
+    free(landmarkCost);
+    landmarkCost = NULL;
+    free(landmarkPending);
+    landmarkPending = NULL;
+    FreeHeap(&loweringList);
+    landmarkLowering = 0;
+    landmarkCapacity = 0;
+    landmarksValid = false;
+    clustersX = clustersY = 0;
+    graphBuilt = false;
+    stats.clusters = stats.nodes = stats.edges = 0;
+}
+
+static void BuildLandmarks(void);
+static void LowerLandmarks(int budget);
+
+static bool BuildGraph(void)
+{
+    double startTime = GetMonotonicSeconds();
+    FreeGraph();
+    graphWidth = mapTilesX;
+    graphHeight = mapTilesY;
+    graphRevision = tileCollisionRevision;
+    graphTerrain = map.tiles;
+    graphTerrainWidth = map.width;
+    graphTerrainHeight = map.height;
+    clustersX = (graphWidth + PATH_CLUSTER_SIZE - 1) / PATH_CLUSTER_SIZE;
+    clustersY = (graphHeight + PATH_CLUSTER_SIZE - 1) / PATH_CLUSTER_SIZE;
+    int clusterCount = clustersX * clustersY;
+
+    tileCost = malloc((graphWidth * graphHeight > 0 ? graphWidth * graphHeight : 1) * sizeof(float));
+    clusterNodes = calloc(clusterCount > 0 ? clusterCount : 1, sizeof(IntList));
+    eastBorders = calloc(clusterCount > 0 ? clusterCount : 1, sizeof(IntList));
+    southBorders = calloc(clusterCount > 0 ? clusterCount : 1, sizeof(IntList));
+    clusterPaths = calloc(clusterCount > 0 ? clusterCount : 1, sizeof(LocalList));
+    dirtyClusters = calloc(clusterCount > 0 ? clusterCount : 1, 1);
+    if (!tileCost || !clusterNodes || !eastBorders || !southBorders || !clusterPaths || !dirtyClusters)
+    {
+        fprintf(stderr, "Failed to allocate path graph for %dx%d tiles.\n", graphWidth, graphHeight);
+        if (!clusterNodes || !eastBorders || !southBorders || !clusterPaths)
+            clustersX = clustersY = 0; // Nothing per-cluster to free
+        FreeGraph();
+        return false;
+    }
+
+    for (int y = 0; y < graphHeight; y++)
+    {
+        for (int x = 0; x < graphWidth; x++)
+        {
+            tileCost[y * graphWidth + x] = GetTileTravelCost(x, y);
+        }
+    }
+    for (int c = 0; c < clusterCount; c++)
+    {
+        if (c % clustersX < clustersX - 1)
+            BuildBorder(c, true);
+        if (c / clustersX < clustersY - 1)
+            BuildBorder(c, false);
+    }
+    for (int c = 0; c < clusterCount; c++)
+    {
+        BuildClusterEdges(c);
+    }
+    BuildLandmarks();
+
+    graphBuilt = true;
+    stats.clusters = clusterCount;
+    stats.fullBuilds++;
+    stats.buildSeconds += GetMonotonicSeconds() - startTime;
+    return true;
+}
+
+static void MarkClusterDirty(int cluster)
+{
+    if (!dirtyClusters[cluster])
+    {
+        dirtyClusters[cluster] = 1;
+        PushInt(&dirtyList, cluster);
+    }
+}
+
+// A tile on a cluster's edge changes the transitions of that border, and so the nodes of the
+// cluster across it too
+static void PatchTile(int x, int y)
+{
+    if (x >= graphWidth || y >= graphHeight)
+        return;
+    float cost = GetTileTravelCost(x, y);
+    float oldCost = tileCost[y * graphWidth + x];
+    if (cost == oldCost)
+        return;
+    tileCost[y * graphWidth + x] = cost;
+
+    int cluster = GetTileCluster(x, y);
+    int x0, y0, x1, y1;
+    GetClusterBounds(cluster, &x0, &y0, &x1, &y1);
+    MarkClusterDirty(cluster);
+    if (x == x0 && x0 > 0)
+    {
+        BuildBorder(cluster - 1, true);
+        MarkClusterDirty(cluster - 1);
+    }
+    if (x == x1 - 1 && x1 < graphWidth)
+    {
+        BuildBorder(cluster, true);
+        MarkClusterDirty(cluster + 1);
+    }
+    if (y == y0 && y0 > 0)
+    {
+        BuildBorder(cluster - clustersX, false);
+        MarkClusterDirty(cluster - clustersX);
+    }
+    if (y == y1 - 1 && y1 < graphHeight)
+    {
+        BuildBorder(cluster, false);
+        MarkClusterDirty(cluster + clustersX);
+    }
+}
+
+void UpdatePathGraph(void)
+{
+    bool sameMap = graphBuilt && graphWidth == mapTilesX && graphHeight == mapTilesY && graphTerrain == map.tiles &&
+                   graphTerrainWidth == map.width && graphTerrainHeight == map.height;
+    if (sameMap && graphRevision == tileCollisionRevision)
+    {
+        if (landmarkLowering != 0)
+        {
+            double startTime = GetMonotonicSeconds();
+            LowerLandmarks(PATH_LANDMARK_QUERY_BUDGET);
+            stats.patchSeconds += GetMonotonicSeconds() - startTime;
+        }
+        return;
+    }
+
+    // Patch only if every revision since the build names a single cell
+    int x, y;
+    for (unsigned int r = graphRevision + 1; sameMap && r != tileCollisionRevision + 1; r++)
+    {
+        sameMap = GetTileCollisionChange(r, &x, &y);
+    }
+    if (!sameMap)
+    {
+        BuildGraph();
+        return;
+    }
+
+    double startTime = GetMonotonicSeconds();
+    for (unsigned int r = graphRevision + 1; r != tileCollisionRevision + 1; r++)
+    {
+        GetTileCollisionChange(r, &x, &y);
+        PatchTile(x, y);
+    }
+    for (int i = 0; i < dirtyList.count; i++)
+    {
+        BuildClusterEdges(dirtyList.items[i]);
+        dirtyClusters[dirtyList.items[i]] = 0;
+    }
+    stats.patchedClusters += dirtyList.count;
+    LowerLandmarks(PATH_LANDMARK_BUDGET);
+    dirtyList.count = 0;
+    graphRevision = tileCollisionRevision;
+    stats.patchSeconds += GetMonotonicSeconds() - startTime;
+}
+
+static bool AppendTile(TilePath *path, int x, int y)
+{
+    if (path->count >= path->capacity)
+    {
+        int newCapacity = path->capacity > 0 ? path->capacity * 2 : 64;
+        int *grownX = realloc(path->x, newCapacity * sizeof(int));
+        if (grownX)
+            path->x = grownX;
+        int *grownY = realloc(path->y, newCapacity * sizeof(int));
+        if (grownY)
+            path->y = grownY;
+        if (!grownX || !grownY)
+            return false;
+        path->capacity = newCapacity;
+    }
+    path->x[path->count] = x;
+    path->y[path->count] = y;
+    path->count++;
+    return true;
+}
+
+// Appends the tiles after the path's last one to (goalX, goalY), from a SearchCluster that
+// started at that last tile
+static bool AppendSearchedPath(TilePath *path, int cluster, int goalX, int goalY)
+{
+    int fromX = path->x[path->count - 1], fromY = path->y[path->count - 1];
+    if (localCost[GetLocalIndex(cluster, goalX, goalY)] >= PATH_UNREACHABLE)
+        return false;
+
+    int x0 = (cluster % clustersX) * PATH_CLUSTER_SIZE, y0 = (cluster / clustersX) * PATH_CLUSTER_SIZE;
+    int start = GetLocalIndex(cluster, fromX, fromY);
+    int goal = GetLocalIndex(cluster, goalX, goalY);
+    int steps = 0;
+    for (int local = goal; local != start; local = localParent[local])
+    {
+        steps++;
+    }
+    int last = path->count + steps - 1;
+    for (int i = 0; i < steps; i++)
+    {
+        if (!AppendTile(path, 0, 0))
+            return false;
+    }
+    for (int local = goal, i = last; local != start; local = localParent[local], i--)
+    {
+        path->x[i] = x0 + local % PATH_CLUSTER_SIZE;
+        path->y[i] = y0 + local / PATH_CLUSTER_SIZE;
+    }
+    path->cost += localCost[goal];
+    return true;
+}
+
+// Searches from the path's last tile to (goalX, goalY) inside one cluster and appends the
+// tiles after the first
+static bool AppendClusterPath(TilePath *path, int cluster, int goalX, int goalY)
+{
+    int fromX = path->x[path->count - 1], fromY = path->y[path->count - 1];
+    return SearchCluster(cluster, fromX, fromY, goalX, goalY) && AppendSearchedPath(path, cluster, goalX, goalY);
+}
+
+// Appends the tiles after the path's last one to the goal, following the goal cluster's
+// search from the goal that FindAbstractPath kept
+static bool AppendGoalTreePath(TilePath *path, int cluster)
+{
+    int x0 = (cluster % clustersX) * PATH_CLUSTER_SIZE, y0 = (cluster / clustersX) * PATH_CLUSTER_SIZE;
+    int from = GetLocalIndex(cluster, path->x[path->count - 1], path->y[path->count - 1]);
+    if (goalTreeCost[from] >= PATH_UNREACHABLE)
+        return false;
+    for (int local = goalTreeParent[from]; local >= 0; local = goalTreeParent[local])
+    {
+        if (!AppendTile(path, x0 + local % PATH_CLUSTER_SIZE, y0 + local / PATH_CLUSTER_SIZE))
+            return false;
+    }
+    path->cost += goalTreeCost[from];
+    return true;
+}
+
+// Appends the stored tiles of the edge between two nodes of one cluster, or searches for them
+// if they could not be stored
+static bool AppendEdgePath(TilePath *path, int from, int to)
+{
+    const PathNode *node = &nodes[from];
+    int cluster = node->cluster;
+    for (int e = 0; e < node->edgeCount; e++)
+    {
+        const PathEdge *edge = &node->edges[e];
+        if (edge->to != to || edge->pathLength == 0)
+            continue;
+        int x0 = (cluster % clustersX) * PATH_CLUSTER_SIZE, y0 = (cluster / clustersX) * PATH_CLUSTER_SIZE;
+        const unsigned short *tiles = clusterPaths[cluster].items + edge->pathStart;
+        for (int i = 1; i < edge->pathLength; i++)
+        {
+            int local = tiles[edge->reversed ? edge->pathLength - 1 - i : i];
+            if (!AppendTile(path, x0 + local % PATH_CLUSTER_SIZE, y0 + local / PATH_CLUSTER_SIZE))
+                return false;
+        }
+        path->cost += edge->cost;
+        return true;
+    }
+    return AppendClusterPath(path, cluster, nodes[to].x, nodes[to].y);
+}
+
+static bool ReserveSearch(void)
+{
+    if (searchCapacity >= nodeCount + 1)
+        return true;
+    int capacity = nodeCapacity + 1;
+    SearchNode *grown = realloc(search, capacity * sizeof(SearchNode));
+    if (grown == NULL)
+        return false;
+    search = grown;
+    // Stamps start unset; later searches only need a fresh stamp value
+    memset(search + searchCapacity, 0, (capacity - searchCapacity) * sizeof(SearchNode));
+    searchCapacity = capacity;
+    return true;
+}
+
+static bool NextSearchStamp(void)
+{
+    if (!ReserveSearch())
+        return false;
+    if (++searchStamp == 0)
+    {
+        for (int i = 0; i < searchCapacity; i++)
+        {
+            search[i].openStamp = search[i].closedStamp = search[i].goalLinkStamp = 0;
+        }
+        searchStamp = 1;
+    }
+    return true;
+}
+
+// Costs are symmetric, so by the triangle inequality the remaining cost from a node is at
+// least the difference of its landmark cost and the goal's, for every landmark
+static float EstimateNodeCost(int id, int goalX, int goalY)
+{
+    float estimate = EstimateCost(nodes[id].x, nodes[id].y, goalX, goalY);
+    if (!landmarksValid || id >= landmarkCapacity)
+        return estimate;
+    const float *row = landmarkCost + id * PATH_LANDMARK_COUNT;
+    for (int k = 0; k < PATH_LANDMARK_COUNT; k++)
+    {
+        float toGoal = goalLandmarkCost[k];
+        float toNode = row[k] < landmarkCap[k] ? row[k] : landmarkCap[k];
+        if (toGoal < PATH_UNREACHABLE && toNode < PATH_UNREACHABLE && fabsf(toGoal - toNode) > estimate)
+            estimate = fabsf(toGoal - toNode);
+    }
+    return estimate;
+}
+
+// Grows the tables to every node slot; new slots start unreached
+static bool ReserveLandmarks(void)
+{
+    if (landmarkCapacity >= nodeCapacity)
+        return true;
+    float *grown = realloc(landmarkCost, (size_t)nodeCapacity * PATH_LANDMARK_COUNT * sizeof(float));
+    if (grown)
+        landmarkCost = grown;
+    unsigned int *pending = realloc(landmarkPending, nodeCapacity * sizeof(unsigned int));
+    if (pending)
+        landmarkPending = pending;
+    if (!grown || !pending)
+        return false;
+    for (int i = landmarkCapacity * PATH_LANDMARK_COUNT; i < nodeCapacity * PATH_LANDMARK_COUNT; i++)
+    {
+        landmarkCost[i] = PATH_UNREACHABLE;
+    }
+    memset(landmarkPending + landmarkCapacity, 0, (nodeCapacity - landmarkCapacity) * sizeof(unsigned int));
+    landmarkCapacity = nodeCapacity;
+    return true;
+}
+
+// Dijkstra over the whole abstract graph from the live node nearest each of
+// PATH_LANDMARK_COUNT points spread evenly around the map edge
+static void BuildLandmarks(void)
+{
+    landmarksValid = false;
+    if (nodeCount - freeNodes.count <= 0 || !ReserveLandmarks())
+        return;
+
+    for (int i = 0; i < nodeCount * PATH_LANDMARK_COUNT; i++)
+    {
+        landmarkCost[i] = PATH_UNREACHABLE;
+    }
+    memset(landmarkPending, 0, nodeCount * sizeof(unsigned int));
+    landmarkLowering = 0;
+    loweringList.count = 0;
+    stats.landmarkQueued = 0;
+    for (int k = 0; k < PATH_LANDMARK_COUNT; k++)
+    {
+        // Clockwise from the top-left corner: along the top, right, bottom and left sides
+        float along = 4.0f * k / PATH_LANDMARK_COUNT;
+        int side = (int)along;
+        float t = along - side;
+        float u = side == 0 ? t : side == 1 ? 1.0f : side == 2 ? 1.0f - t : 0.0f;
+        float v = side == 0 ? 0.0f : side == 1 ? t : side == 2 ? 1.0f : 1.0f - t;
+        int targetX = (int)(u * (graphWidth - 1)), targetY = (int)(v * (graphHeight - 1));
+        int landmark = -1;
+        float nearest = PATH_UNREACHABLE;
+        for (int id = 0; id < nodeCount; id++)
+        {
+            float distance = EstimateCost(nodes[id].x, nodes[id].y, targetX, targetY);
+            if (nodes[id].cluster >= 0 && distance < nearest)
+            {
+                nearest = distance;
+                landmark = id;
+            }
+        }
+        if (!NextSearchStamp())
+            return;
+
+        float *cost = landmarkCost + k;
+        cost[landmark * PATH_LANDMARK_COUNT] = 0.0f;
+        openList.count = 0;
+        PushHeap(&openList, 0.0f, landmark);
+        while (openList.count > 0)
+        {
+            int id = PopHeap(&openList);
+            if (search[id].closedStamp == searchStamp)
+                continue;
+            search[id].closedStamp = searchStamp;
+            const PathNode *node = &nodes[id];
+            float from = cost[id * PATH_LANDMARK_COUNT];
+            if (node->twin >= 0 && from + node->twinCost < cost[node->twin * PATH_LANDMARK_COUNT])
+            {
+                cost[node->twin * PATH_LANDMARK_COUNT] = from + node->twinCost;
+                PushHeap(&openList, from + node->twinCost, node->twin);
+            }
+            for (int e = 0; e < node->edgeCount; e++)
+            {
+                int to = node->edges[e].to;
+                if (from + node->edges[e].cost < cost[to * PATH_LANDMARK_COUNT])
+                {
+                    cost[to * PATH_LANDMARK_COUNT] = from + node->edges[e].cost;
+                    PushHeap(&openList, from + node->edges[e].cost, to);
+                }
+            }
+        }
+    }
+    landmarksValid = true;
+    stats.landmarkBuilds++;
+}
+
+// Lowers each landmark cost of `to`, among the landmarks in `mask`, that is more than `cost`
+// above the one of `from`; returns a bit per landmark that was
+static unsigned int LowerLandmarkRow(int from, int to, float cost, unsigned int mask)
+{
+    const float *fromRow = landmarkCost + from * PATH_LANDMARK_COUNT;
+    float *toRow = landmarkCost + to * PATH_LANDMARK_COUNT;
+    unsigned int lowered = 0;
+    for (int k = 0; k < PATH_LANDMARK_COUNT; k++)
+    {
+        float via = fromRow[k] + cost;
+        bool lower = (mask >> k & 1) && via < toRow[k];
+        lowered |= (unsigned int)lower << k;
+        toRow[k] = lower ? via : toRow[k];
+    }
+    return lowered;
+}
+
+// Lowers the neighbours of one node through its edges for the landmarks in `mask`, and queues
+// the ones that dropped by their lowest pending cost
+static bool LowerFromNode(int id, unsigned int mask)
+{
+    const PathNode *node = &nodes[id];
+    for (int e = -1; e < node->edgeCount; e++)
+    {
+        int to = e < 0 ? node->twin : node->edges[e].to;
+        if (to < 0)
+            continue;
+        unsigned int lowered = LowerLandmarkRow(id, to, e < 0 ? node->twinCost : node->edges[e].cost, mask);
+        if (lowered == 0)
+            continue;
+        landmarkPending[to] |= lowered;
+        landmarkLowering |= lowered;
+        const float *row = landmarkCost + to * PATH_LANDMARK_COUNT;
+        float key = PATH_UNREACHABLE;
+        for (int k = 0; k < PATH_LANDMARK_COUNT; k++)
+        {
+            key = (landmarkPending[to] >> k & 1) && row[k] < key ? row[k] : key;
+        }
+        if (!PushHeap(&loweringList, key, to))
+            return false;
+    }
+    return true;
+}
+
+// Patches keep the tables instead of rebuilding them. The estimate stays admissible as long as
+// no edge is cheaper than the difference of its two ends' landmark costs. Edges outside the
+// dirty clusters kept their costs and dearer edges only loosen that, so lowering costs
+// outward from the dirty clusters' nodes until nothing drops restores it, and gives the nodes
+// the patch added their first costs.
+//
+// A gap opened in a long wall can lower a landmark's costs across most of the map, so each
+// call passes on at most `budget` nodes, cheapest first, and leaves the rest queued for the
+// next patch or query. Until the queue drains a query caps the landmarks still lowering at
+// the lowest queued cost: every edge left to fix starts at or above it, so capped it joins two
+// equal costs.
+static void LowerLandmarks(int budget)
+{
+    if (!landmarksValid)
+    {
+        BuildLandmarks();
+        return;
+    }
+    if (!ReserveLandmarks())
+    {
+        landmarksValid = false;
+        return;
+    }
+
+    bool lowered = true;
+    for (int i = 0; lowered && i < dirtyList.count; i++)
+    {
+        const IntList *list = &clusterNodes[dirtyList.items[i]];
+        for (int n = 0; lowered && n < list->count; n++)
+        {
+            lowered = LowerFromNode(list->items[n], ~0u);
+        }
+    }
+    int passed = 0;
+    while (lowered && loweringList.count > 0 && passed < budget)
+    {
+        int id = PopHeap(&loweringList);
+        unsigned int mask = landmarkPending[id];
+        landmarkPending[id] = 0;
+        if (mask == 0 || nodes[id].cluster < 0)
+            continue; // Passed on under an earlier, higher key, or removed by a patch
+        lowered = LowerFromNode(id, mask);
+        passed++;
+    }
+    if (!lowered)
+    {
+        BuildLandmarks();
+        return;
+    }
+    while (loweringList.count > 0 && landmarkPending[loweringList.entries[0].item] == 0)
+    {
+        PopHeap(&loweringList);
+    }
+    if (loweringList.count == 0)
+        landmarkLowering = 0;
+    stats.landmarkLowered += passed;
+    stats.landmarkQueued = loweringList.count;
+}
+
+// Reopens closed nodes on a cheaper route: landmark estimates mixed with straight-line ones
+// are admissible but not always consistent
+static void RelaxNode(int node, int parent, float cost, int goalX, int goalY)
+{
+    if (search[node].openStamp == searchStamp)
+    {
+        if (search[node].cost <= cost)
+            return;
+    }
+    else
+    {
+        search[node].openStamp = searchStamp;
+        search[node].estimate = node < nodeCount ? EstimateNodeCost(node, goalX, goalY) : 0.0f;
+    }
+    search[node].closedStamp = 0;
+    search[node].cost = cost;
+    search[node].parent = parent;
+    PushHeap(&openList, cost + search[node].estimate, node);
+}
+
+// A* over the entrance nodes. The start's cluster seeds the open list with the cost to each of
+// its nodes; the goal's cluster links its nodes to a virtual goal node at id nodeCount.
+static bool FindAbstractPath(int startX, int startY, int goalX, int goalY, IntList *hops)
+{
+    if (!NextSearchStamp())
+        return false;
+
+    int goalCluster = GetTileCluster(goalX, goalY);
+    SearchCluster(goalCluster, goalX, goalY, -1, -1);
+    memcpy(goalTreeCost, localCost, sizeof(localCost));
+    memcpy(goalTreeParent, localParent, sizeof(localParent));
+    const IntList *goalNodes = &clusterNodes[goalCluster];
+    for (int i = 0; i < goalNodes->count; i++)
+    {
+        int id = goalNodes->items[i];
+        float cost = localCost[GetLocalIndex(goalCluster, nodes[id].x, nodes[id].y)];
+        if (cost < PATH_UNREACHABLE)
+        {
+            search[id].goalLinkStamp = searchStamp;
+            search[id].goalLinkCost = cost;
+        }
+    }
+    float lowest = loweringList.count > 0 ? loweringList.entries[0].key : PATH_UNREACHABLE;
+    for (int k = 0; landmarksValid && k < PATH_LANDMARK_COUNT; k++)
+    {
+        landmarkCap[k] = landmarkLowering >> k & 1 ? lowest : PATH_UNREACHABLE;
+        goalLandmarkCost[k] = PATH_UNREACHABLE;
+        for (int i = 0; i < goalNodes->count; i++)
+        {
+            int id = goalNodes->items[i];
+            if (search[id].goalLinkStamp != searchStamp)
+                continue;
+            float cost = id < landmarkCapacity ? landmarkCost[id * PATH_LANDMARK_COUNT + k] : PATH_UNREACHABLE;
+            cost = cost < landmarkCap[k] ? cost : landmarkCap[k];
+            if (cost >= PATH_UNREACHABLE)
+            {
+                goalLandmarkCost[k] = PATH_UNREACHABLE; // Unknown entry point: no bound from this landmark
+                break;
+            }
+            if (cost + search[id].goalLinkCost < goalLandmarkCost[k])
+                goalLandmarkCost[k] = cost + search[id].goalLinkCost;
+        }
+    }
+
+    int startCluster = GetTileCluster(startX, startY);
+    SearchCluster(startCluster, startX, startY, -1, -1);
+    const IntList *startNodes = &clusterNodes[startCluster];
+    int startNode = -1;
+    for (int i = 0; i < startNodes->count; i++)
+    {
+        int id = startNodes->items[i];
+        float cost = localCost[GetLocalIndex(startCluster, nodes[id].x, nodes[id].y)];
+        if (cost < PATH_UNREACHABLE)
+        {
+            search[id].openStamp = searchStamp;
+            search[id].cost = cost;
+            search[id].parent = -1;
+            startNode = id;
+        }
+    }
+
+    // No edge joins a node a landmark reaches to one it does not, so a landmark that reaches
+    // only one end proves there is no path, without searching everything the start reaches.
+    // Not while the landmark is still lowering: its costs may not have spread that far yet.
+    for (int k = 0; landmarksValid && startNode >= 0 && startNode < landmarkCapacity && k < PATH_LANDMARK_COUNT; k++)
+    {
+        bool startReached = landmarkCost[startNode * PATH_LANDMARK_COUNT + k] < PATH_UNREACHABLE;
+        if (!(landmarkLowering >> k & 1) && startReached != (goalLandmarkCost[k] < PATH_UNREACHABLE))
+            return false;
+    }
+    openList.count = 0; // SearchCluster shares the heap; seed only after it is done
+    for (int i = 0; i < startNodes->count; i++)
+    {
+        int id = startNodes->items[i];
+        if (search[id].openStamp == searchStamp)
+        {
+            search[id].estimate = EstimateNodeCost(id, goalX, goalY);
+            PushHeap(&openList, search[id].cost + search[id].estimate, id);
+        }
+    }
+
+    int goalNode = nodeCount;
+    while (openList.count > 0)
+    {
+        int id = PopHeap(&openList);
+        if (search[id].closedStamp == searchStamp)
+            continue;
+        search[id].closedStamp = searchStamp;
+        if (id == goalNode)
+            break;
+
+        const PathNode *node = &nodes[id];
+        float cost = search[id].cost;
+        if (node->twin >= 0)
+            RelaxNode(node->twin, id, cost + node->twinCost, goalX, goalY);
+        for (int e = 0; e < node->edgeCount; e++)
+        {
+            RelaxNode(node->edges[e].to, id, cost + node->edges[e].cost, goalX, goalY);
+        }
+        if (search[id].goalLinkStamp == searchStamp)
+            RelaxNode(goalNode, id, cost + search[id].goalLinkCost, goalX, goalY);
+    }
+    if (search[goalNode].closedStamp != searchStamp)
+        return false;
+
+    hops->count = 0;
+    for (int id = search[goalNode].parent; id >= 0; id = search[id].parent)
+    {
+        if (!PushInt(hops, id))
+            return false;
+    }
+    for (int i = 0, j = hops->count - 1; i < j; i++, j--)
+    {
+        int swap = hops->items[i];
+        hops->items[i] = hops->items[j];
+        hops->items[j] = swap;
+    }
+    return true;
+}
+
+bool FindTilePath(int startX, int startY, int goalX, int goalY, TilePath *path)
+{
+    static IntList hops;
+    double startTime = GetMonotonicSeconds();
+    path->count = 0;
+    path->cost = 0.0f;
+    UpdatePathGraph();
+    stats.queries++;
+    if (!graphBuilt || GetTileTravelCost(startX, startY) <= 0.0f || GetTileTravelCost(goalX, goalY) <= 0.0f ||
+        !AppendTile(path, startX, startY))
+    {
+        stats.querySeconds += GetMonotonicSeconds() - startTime;
+        return false;
+    }
+
+    int startCluster = GetTileCluster(startX, startY);
+    int goalCluster = GetTileCluster(goalX, goalY);
+    bool found = startCluster == goalCluster && AppendClusterPath(path, goalCluster, goalX, goalY);
+    if (!found && FindAbstractPath(startX, startY, goalX, goalY, &hops))
+    {
+        // Refine: twins are one step apart, other consecutive hops share a cluster. The abstract
+        // search ended with the start cluster's search from the start and kept the goal's.
+        found = true;
+        for (int i = 0; i < hops.count && found; i++)
+        {
+            const PathNode *node = &nodes[hops.items[i]];
+            if (i > 0 && nodes[hops.items[i - 1]].twin == hops.items[i])
+            {
+                found = AppendTile(path, node->x, node->y);
+                path->cost += node->twinCost;
+            }
+            else
+            {
+                found = i > 0 ? AppendEdgePath(path, hops.items[i - 1], hops.items[i])
+                              : AppendSearchedPath(path, node->cluster, node->x, node->y);
+            }
+        }
+        found = found && AppendGoalTreePath(path, goalCluster);
+    }
+    if (!found)
+        path->count = 0;
+    stats.querySeconds += GetMonotonicSeconds() - startTime;
+    return found;
+}
+
+void FreeTilePath(TilePath *path)
+{
+    free(path->x);
+    free(path->y);
+    memset(path, 0, sizeof(TilePath));
+}
+
+void ResetPathGraph(void)
+{
+    FreeGraph();
+    free(search);
+    search = NULL;
+    searchCapacity = 0;
+    searchStamp = 0;
+    FreeHeap(&openList);
+}
+
+PathGraphStats GetPathGraphStats(void)
+{
+    return stats;
+}
@@ -0,0 +1,60 @@
+// path_graph.h
+
+#pragma once
+
+#include <stdbool.h>
+
+#define PATH_CLUSTER_SIZE 32    // Cluster side in tiles; at most 256
+#define PATH_ENTRANCE_SPLIT 6   // Entrances at least this wide get a transition at each end, narrower ones one in the middle
+#define PATH_LANDMARK_COUNT 16  // Entrance nodes on the map edge the A* heuristic measures from; at most 32
+#define PATH_LANDMARK_BUDGET 1024 // Nodes each patch passes lowered landmark costs on from; the rest wait
+#define PATH_LANDMARK_QUERY_BUDGET 256 // ... and each query, while any wait
+#define PATH_TERRAIN_COST 1.0f  // Per-tile travel cost of each map.h terrain type
+#define PATH_MOUNTAIN_COST 3.0f
+#define PATH_WATER_COST 5.0f
+
+// Tiles from start to goal, both included
+typedef struct TilePath
+{
+    int *x;
+    int *y;
+    int count;
+    int capacity;
+    float cost;
+} TilePath;
+
+typedef struct PathGraphStats
+{
+    int clusters;
+    int nodes;          // Entrance nodes, two per transition
+    int edges;          // Intra-cluster edges
+    int fullBuilds;
+    int patchedClusters; // Clusters whose edges were recomputed after a tile edit
+    int landmarkBuilds;  // Landmark cost tables recomputed from scratch
+    int landmarkLowered; // Nodes patches and queries passed lowered landmark costs on from, instead
+    int landmarkQueued;  // Queue entries of nodes still waiting to pass them on
+    int queries;
+    double buildSeconds;
+    double patchSeconds; // Includes passing lowered landmark costs on, also the share queries do
+    double querySeconds;
+} PathGraphStats;
+
+// Hierarchical A* (HPA*) over tileStore. The map is cut into PATH_CLUSTER_SIZE clusters;
+// each open stretch of a cluster border becomes one or two transitions, and the entrance nodes
+// of a cluster are joined by their costs within it. A query searches that abstract graph, then
+// refines each hop with a search bounded to one cluster. The abstract A* is guided by landmark
+// distances (ALT): costs from a few edge nodes to every node, which bound the remaining cost
+// far tighter than straight-line distance once walls force detours. Collidable tiles block; other tiles
+// cost PATH_*_COST by their map.h terrain, and a step costs its length times the mean cost of
+// the two tiles. Edits through PushTile and PopTile re-cut only the borders
+// and edges of the clusters they touch; loading or resizing the map rebuilds the graph.
+//
+// Paths stay inside a cluster when start and goal share one and a path exists there, and
+// otherwise run through transitions, so they can be slightly longer than the true optimum.
+bool FindTilePath(int startX, int startY, int goalX, int goalY, TilePath *path);
+void FreeTilePath(TilePath *path);
+
+void UpdatePathGraph(void); // Builds or patches the graph to match tileStore; FindTilePath calls it
+void ResetPathGraph(void);  // Frees the graph; call after editing map.tiles in place
+float GetTileTravelCost(int x, int y); // 0 if the tile is collidable or off the map
+PathGraphStats GetPathGraphStats(void);
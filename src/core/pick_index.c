@@ -0,0 +1,186 @@
+// pick_index.c
+
+#include "pick_index.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum PickShapeType
+{
+    PICK_SHAPE_POINT,
+    PICK_SHAPE_RECT,
+    PICK_SHAPE_CIRCLE
+} PickShapeType;
+
+typedef struct PickShape
+{
+    PickShapeType type;
+    Rectangle bounds; // Covers the whole shape
+    Vector2 point;    // Point or circle centre
+    float radius;
+} PickShape;
+
+void InitPickIndex(PickIndex *index)
+{
+    memset(index, 0, sizeof(PickIndex));
+    InitSpatialGrid(&index->grid, PICK_CELL_SIZE);
+}
+
+void FreePickIndex(PickIndex *index)
+{
+    FreeSpatialGrid(&index->grid);
+    free(index->boxes);
+    free(index->centers);
+    free(index->items);
+    free(index->hits);
+    memset(index, 0, sizeof(PickIndex));
+    InitSpatialGrid(&index->grid, PICK_CELL_SIZE);
+}
+
+static bool ReservePickIndex(PickIndex *index, int count)
+{
+    if (count <= index->capacity)
+        return true;
+    int capacity = index->capacity > 0 ? index->capacity : 64;
+    while (capacity < count)
+        capacity *= 2;
+    Rectangle *boxes = realloc(index->boxes, capacity * sizeof(Rectangle));
+    if (boxes)
+        index->boxes = boxes;
+    Vector2 *centers = realloc(index->centers, capacity * sizeof(Vector2));
+    if (centers)
+        index->centers = centers;
+    PickHit *items = realloc(index->items, capacity * sizeof(PickHit));
+    if (items)
+        index->items = items;
+    PickHit *hits = realloc(index->hits, capacity * sizeof(PickHit));
+    if (hits)
+        index->hits = hits;
+    if (!boxes || !centers || !items || !hits)
+    {
+        fprintf(stderr, "Failed to allocate pick index for %d items.\n", count);
+        return false;
+    }
+    index->capacity = capacity;
+    return true;
+}
+
+static void AddPickItem(PickIndex *index, PickKind kind, int item, Rectangle box)
+{
+    int i = index->count++;
+    index->boxes[i] = box;
+    index->centers[i] = (Vector2){box.x + box.width * 0.5f, box.y + box.height * 0.5f};
+    index->items[i] = (PickHit){kind, item};
+    index->reachX = fmaxf(index->reachX, box.width * 0.5f);
+    index->reachY = fmaxf(index->reachY, box.height * 0.5f);
+}
+
+bool BuildPickIndex(PickIndex *index, const NPCStore *npcs, const Building *buildings, int buildingCount)
+{
+    index->count = 0;
+    index->reachX = index->reachY = 0.0f;
+    index->gridValid = false;
+    if (!ReservePickIndex(index, npcs->count + buildingCount))
+        return false;
+
+    for (int i = 0; i < npcs->count; i++)
+    {
+        AddPickItem(index, PICK_NPC, i, GetStoreNPCBoundingBox(npcs, i));
+    }
+    for (int i = 0; i < buildingCount; i++)
+    {
+        AddPickItem(index, PICK_BUILDING, i, buildings[i].collisionBox);
+    }
+    BuildSpatialGrid(&index->grid, index->centers, index->count, sizeof(Vector2));
+    index->gridValid = index->grid.count == index->count;
+    return true;
+}
+
+static bool PickShapeHitsBox(const PickShape *shape, Rectangle box)
+{
+    switch (shape->type)
+    {
+    case PICK_SHAPE_POINT:
+        return CheckCollisionPointRec(shape->point, box);
+    case PICK_SHAPE_RECT:
+        return CheckCollisionRecs(shape->bounds, box);
+    default:
+        return CheckCollisionCircleRec(shape->point, shape->radius, box);
+    }
+}
+
+static void TestPickItem(PickIndex *index, const PickShape *shape, int kinds, int item, int *found)
+{
+    if ((index->items[item].kind & kinds) && PickShapeHitsBox(shape, index->boxes[item]))
+        index->hits[(*found)++] = index->items[item];
+}
+
+// A box can only touch the shape if its centre lies within reach of the shape's bounds
+static int RunPickQuery(PickIndex *index, const PickShape *shape, int kinds, const PickHit **hits)
+{
+    *hits = index->hits;
+    int found = 0;
+    Rectangle bounds = shape->bounds;
+    int x0, y0, x1, y1;
+    GetSpatialGridCell(&index->grid, (Vector2){bounds.x - index->reachX, bounds.y - index->reachY}, &x0, &y0);
+    GetSpatialGridCell(&index->grid,
+                       (Vector2){bounds.x + bounds.width + index->reachX, bounds.y + bounds.height + index->reachY}, &x1, &y1);
+
+    // Past one cell per item, walking the cells costs more than testing every item
+    if (!index->gridValid || (double)(x1 - x0 + 1) * (y1 - y0 + 1) > index->count)
+    {
+        for (int i = 0; i < index->count; i++)
+        {
+            TestPickItem(index, shape, kinds, i, &found);
+        }
+        return found;
+    }
+
+    for (int cellY = y0; cellY <= y1; cellY++)
+    {
+        for (int cellX = x0; cellX <= x1; cellX++)
+        {
+            int begin, end;
+            GetSpatialGridBucket(&index->grid, cellX, cellY, &begin, &end);
+            for (int e = begin; e < end; e++)
+            {
+                const SpatialGridEntry *entry = &index->grid.entries[e];
+                if (entry->cellX == cellX && entry->cellY == cellY)
+                    TestPickItem(index, shape, kinds, entry->index, &found);
+            }
+        }
+    }
+    return found;
+}
+
+int QueryPickPoint(PickIndex *index, Vector2 point, int kinds, const PickHit **hits)
+{
+    PickShape shape = {PICK_SHAPE_POINT, {point.x, point.y, 0.0f, 0.0f}, point, 0.0f};
+    return RunPickQuery(index, &shape, kinds, hits);
+}
+
+int QueryPickRect(PickIndex *index, Rectangle rect, int kinds, const PickHit **hits)
+{
+    PickShape shape = {PICK_SHAPE_RECT, rect, {rect.x, rect.y}, 0.0f};
+    return RunPickQuery(index, &shape, kinds, hits);
+}
+
+int QueryPickRadius(PickIndex *index, Vector2 center, float radius, int kinds, const PickHit **hits)
+{
+    PickShape shape = {PICK_SHAPE_CIRCLE, {center.x - radius, center.y - radius, radius * 2.0f, radius * 2.0f}, center, radius};
+    return RunPickQuery(index, &shape, kinds, hits);
+}
+
+int PickTopmost(PickIndex *index, Vector2 point, PickKind kind)
+{
+    const PickHit *hits;
+    int count = QueryPickPoint(index, point, kind, &hits);
+    int topmost = -1;
+    for (int i = 0; i < count; i++)
+    {
+        if (hits[i].index > topmost)
+            topmost = hits[i].index;
+    }
+    return topmost;
+}
@@ -0,0 +1,56 @@
+// pick_index.h
+
+#pragma once
+
+#include "raylib.h"
+#include "spatial_grid.h"
+#include "npc_store.h"
+#include "buildings.h"
+#include <stdbool.h>
+
+#define PICK_CELL_SIZE 128.0f // About two NPC boxes; buildings span a few cells
+
+// Bit flags, so queries can ask for several kinds at once
+typedef enum PickKind
+{
+    PICK_NPC = 1 << 0,
+    PICK_BUILDING = 1 << 1,
+    PICK_ANY = PICK_NPC | PICK_BUILDING
+} PickKind;
+
+typedef struct PickHit
+{
+    PickKind kind;
+    int index; // Into the NPC store or the building array
+} PickHit;
+
+// Broadphase for mouse picking and box selection over NPC bounding boxes and building
+// collision boxes. A loose grid: every box is filed in the SpatialGrid cell holding its centre,
+// and a query widens its area by the largest half-size of any box, so it visits only the cells
+// around it however many items there are. Built from scratch once per frame.
+typedef struct PickIndex
+{
+    SpatialGrid grid;
+    Rectangle *boxes; // Item i's box; NPCs first, then buildings
+    Vector2 *centers;
+    PickHit *items;
+    PickHit *hits; // Results of the last query
+    int count;
+    int capacity;
+    float reachX; // Largest half-width and half-height of any box
+    float reachY;
+    bool gridValid; // False if the grid could not be allocated; queries then scan every item
+} PickIndex;
+
+void InitPickIndex(PickIndex *index);
+void FreePickIndex(PickIndex *index);
+bool BuildPickIndex(PickIndex *index, const NPCStore *npcs, const Building *buildings, int buildingCount);
+
+// Items of the kinds in `kinds` whose box contains the point, overlaps the rectangle (as
+// CheckCollisionRecs) or overlaps the circle. Each returns how many and points *hits at them,
+// in no particular order; they stay valid until the next query or build.
+int QueryPickPoint(PickIndex *index, Vector2 point, int kinds, const PickHit **hits);
+int QueryPickRect(PickIndex *index, Rectangle rect, int kinds, const PickHit **hits);
+int QueryPickRadius(PickIndex *index, Vector2 center, float radius, int kinds, const PickHit **hits);
+// Index of the item of this kind under the point that is drawn last, so on top; -1 if none
+int PickTopmost(PickIndex *index, Vector2 point, PickKind kind);
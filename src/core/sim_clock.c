@@ -0,0 +1,64 @@
+// sim_clock.c
+
+#include "sim_clock.h"
+#include <string.h>
+#include <time.h>
+
+void InitSimClock(SimClock *clock, int ticksPerSecond)
+{
+    memset(clock, 0, sizeof(SimClock));
+    clock->timeScale = 1.0f;
+    SetSimClockRate(clock, ticksPerSecond);
+}
+
+void SetSimClockRate(SimClock *clock, int ticksPerSecond)
+{
+    clock->tickSeconds = 1.0f / (ticksPerSecond > 0 ? ticksPerSecond : SIM_TICKS_PER_SECOND);
+    if (clock->accumulator >= clock->tickSeconds)
+        clock->accumulator = 0.0;
+    clock->alpha = (float)(clock->accumulator / clock->tickSeconds);
+}
+
+void SetSimClockTimeScale(SimClock *clock, float timeScale)
+{
+    clock->timeScale = timeScale > 0.0f ? timeScale : 0.0f;
+}
+
+void SetSimClockPaused(SimClock *clock, bool paused)
+{
+    clock->paused = paused;
+}
+
+float GetSimClockFrameTime(const SimClock *clock, float frameSeconds)
+{
+    if (clock->paused)
+        return 0.0f;
+    if (frameSeconds > SIM_MAX_FRAME_SECONDS)
+        frameSeconds = SIM_MAX_FRAME_SECONDS;
+    return frameSeconds * clock->timeScale;
+}
+
+int AdvanceSimClock(SimClock *clock, float frameSeconds)
+{
+    // Paused keeps alpha where it was, so interpolated positions hold still too
+    clock->accumulator += GetSimClockFrameTime(clock, frameSeconds);
+
+    int ticks = (int)(clock->accumulator / clock->tickSeconds);
+    clock->accumulator -= ticks * (double)clock->tickSeconds;
+    if (ticks > SIM_MAX_TICKS_PER_FRAME)
+    {
+        // The simulation cannot keep up; slow down rather than fall further behind every frame
+        clock->droppedSeconds += (ticks - SIM_MAX_TICKS_PER_FRAME) * (double)clock->tickSeconds;
+        ticks = SIM_MAX_TICKS_PER_FRAME;
+    }
+    clock->tickCount += ticks;
+    clock->alpha = (float)(clock->accumulator / clock->tickSeconds);
+    return ticks;
+}
+
+double GetMonotonicSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
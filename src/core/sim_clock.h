@@ -0,0 +1,37 @@
+// sim_clock.h
+
+#pragma once
+
+#include <stdbool.h>
+
+#define SIM_TICKS_PER_SECOND 30
+#define SIM_MAX_TICKS_PER_FRAME 16 // More than this in one frame and the backlog is dropped
+#define SIM_MAX_FRAME_SECONDS 0.25f // Longer frames (a breakpoint, a window drag) count as this
+
+// Fixed-step simulation clock. Frames feed it real time, scaled by timeScale; it answers how
+// many fixed ticks to simulate this frame, and how far the renderer is between the last two
+// ticks. The simulation then behaves the same at any frame rate, and its cost follows the tick
+// rate rather than the frame rate.
+typedef struct SimClock
+{
+    float tickSeconds;    // Length of one tick
+    float timeScale;      // 1 = real time, 2 = fast-forward, ...
+    bool paused;
+    double accumulator;   // Scaled time not yet simulated, in [0, tickSeconds) after a frame
+    float alpha;          // accumulator / tickSeconds: how far rendering is past the last tick
+    long long tickCount;  // Ticks simulated since the clock was reset
+    double droppedSeconds; // Scaled time discarded because a frame needed too many ticks
+} SimClock;
+
+void InitSimClock(SimClock *clock, int ticksPerSecond);
+void SetSimClockRate(SimClock *clock, int ticksPerSecond);
+void SetSimClockTimeScale(SimClock *clock, float timeScale);
+void SetSimClockPaused(SimClock *clock, bool paused);
+
+// Adds one frame of real time and returns how many ticks to run before rendering it
+int AdvanceSimClock(SimClock *clock, float frameSeconds);
+// Scaled time the rest of the frame should advance cosmetic state (animations) by
+float GetSimClockFrameTime(const SimClock *clock, float frameSeconds);
+
+// Seconds on a monotonic clock, for timing work; only differences between calls are meaningful
+double GetMonotonicSeconds(void);
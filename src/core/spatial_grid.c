@@ -0,0 +1,142 @@
+// spatial_grid.c
+
+#include "spatial_grid.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void InitSpatialGrid(SpatialGrid *grid, float cellSize)
+{
+    memset(grid, 0, sizeof(SpatialGrid));
+    grid->cellSize = cellSize > 0.0f ? cellSize : 1.0f;
+    grid->inverseCellSize = 1.0f / grid->cellSize;
+}
+
+void FreeSpatialGrid(SpatialGrid *grid)
+{
+    free(grid->bucketStart);
+    free(grid->entries);
+    free(grid->scratch);
+    memset(grid, 0, sizeof(SpatialGrid));
+}
+
+static unsigned int HashCell(int cellX, int cellY)
+{
+    return (unsigned int)cellX * 73856093u ^ (unsigned int)cellY * 19349663u;
+}
+
+static bool ReserveSpatialGrid(SpatialGrid *grid, int count)
+{
+    int bucketCount = 16;
+    while (bucketCount < count * 2)
+        bucketCount *= 2;
+
+    if (count > grid->entryCapacity)
+    {
+        SpatialGridEntry *entries = realloc(grid->entries, count * sizeof(SpatialGridEntry));
+        if (entries)
+            grid->entries = entries;
+        SpatialGridEntry *scratch = realloc(grid->scratch, count * sizeof(SpatialGridEntry));
+        if (scratch)
+            grid->scratch = scratch;
+        if (!entries || !scratch)
+            return false;
+        grid->entryCapacity = count;
+    }
+    if (bucketCount + 1 > grid->bucketCapacity)
+    {
+        int *bucketStart = realloc(grid->bucketStart, (bucketCount + 1) * sizeof(int));
+        if (!bucketStart)
+            return false;
+        grid->bucketStart = bucketStart;
+        grid->bucketCapacity = bucketCount + 1;
+    }
+    grid->bucketCount = bucketCount;
+    return true;
+}
+
+void GetSpatialGridCell(const SpatialGrid *grid, Vector2 position, int *cellX, int *cellY)
+{
+    *cellX = (int)floorf(position.x * grid->inverseCellSize);
+    *cellY = (int)floorf(position.y * grid->inverseCellSize);
+}
+
+// Counting sort of the cells in grid->scratch by bucket. Running sum turns counts into bucket
+// ends; filling backwards leaves them as bucket starts and keeps each bucket in ascending item order.
+static void SortSpatialGrid(SpatialGrid *grid, int count)
+{
+    unsigned int mask = (unsigned int)grid->bucketCount - 1;
+    int *bucketStart = grid->bucketStart;
+    memset(bucketStart, 0, (grid->bucketCount + 1) * sizeof(int));
+    for (int i = 0; i < count; i++)
+    {
+        const SpatialGridEntry *cell = &grid->scratch[i];
+        bucketStart[HashCell(cell->cellX, cell->cellY) & mask]++;
+    }
+    for (int b = 1; b <= grid->bucketCount; b++)
+    {
+        bucketStart[b] += bucketStart[b - 1];
+    }
+    for (int i = count - 1; i >= 0; i--)
+    {
+        const SpatialGridEntry *cell = &grid->scratch[i];
+        grid->entries[--bucketStart[HashCell(cell->cellX, cell->cellY) & mask]] = *cell;
+    }
+    bucketStart[grid->bucketCount] = count;
+    grid->count = count;
+}
+
+static bool PrepareSpatialGrid(SpatialGrid *grid, int count)
+{
+    grid->count = 0;
+    if (count <= 0)
+        return false;
+    if (!ReserveSpatialGrid(grid, count))
+    {
+        fprintf(stderr, "Failed to allocate spatial grid for %d items.\n", count);
+        return false;
+    }
+    return true;
+}
+
+void BuildSpatialGrid(SpatialGrid *grid, const Vector2 *positions, int count, size_t stride)
+{
+    if (!PrepareSpatialGrid(grid, count))
+        return;
+
+    const char *item = (const char *)positions;
+    for (int i = 0; i < count; i++, item += stride)
+    {
+        SpatialGridEntry *cell = &grid->scratch[i];
+        cell->index = i;
+        GetSpatialGridCell(grid, *(const Vector2 *)item, &cell->cellX, &cell->cellY);
+    }
+    SortSpatialGrid(grid, count);
+}
+
+void BuildSpatialGridXY(SpatialGrid *grid, const float *x, const float *y, int count)
+{
+    if (!PrepareSpatialGrid(grid, count))
+        return;
+
+    for (int i = 0; i < count; i++)
+    {
+        SpatialGridEntry *cell = &grid->scratch[i];
+        cell->index = i;
+        GetSpatialGridCell(grid, (Vector2){x[i], y[i]}, &cell->cellX, &cell->cellY);
+    }
+    SortSpatialGrid(grid, count);
+}
+
+void GetSpatialGridBucket(const SpatialGrid *grid, int cellX, int cellY, int *begin, int *end)
+{
+    if (grid->count == 0)
+    {
+        *begin = *end = 0;
+        return;
+    }
+    unsigned int bucket = HashCell(cellX, cellY) & ((unsigned int)grid->bucketCount - 1);
+    *begin = grid->bucketStart[bucket];
+    *end = grid->bucketStart[bucket + 1];
+}
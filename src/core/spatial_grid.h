@@ -0,0 +1,44 @@
+// spatial_grid.h
+
+#pragma once
+
+#include "raylib.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct SpatialGridEntry
+{
+    int index; // Index of the item in the array the grid was built from
+    int cellX;
+    int cellY;
+} SpatialGridEntry;
+
+// Uniform grid over an unbounded world: cell (x, y) hashes into one of bucketCount buckets, and
+// BuildSpatialGrid counting-sorts the items by bucket so each bucket's entries are contiguous.
+// Items closer than cellSize are always in the same or adjacent cells, so a radius query with
+// radius <= cellSize only needs the 3x3 cells around the query point.
+typedef struct SpatialGrid
+{
+    float cellSize;
+    float inverseCellSize;
+    int count;              // Items in the last build
+    int bucketCount;        // Power of two, at least twice the item count
+    int *bucketStart;       // bucketCount + 1 offsets into entries
+    SpatialGridEntry *entries; // Sorted by bucket
+    SpatialGridEntry *scratch; // Unsorted cells, used while building
+    int entryCapacity;
+    int bucketCapacity;
+} SpatialGrid;
+
+void InitSpatialGrid(SpatialGrid *grid, float cellSize);
+void FreeSpatialGrid(SpatialGrid *grid);
+
+// positions points at the first item's Vector2 and successive items are stride bytes apart, so
+// both arrays of structs (stride = sizeof(NPC)) and plain Vector2 arrays can be indexed
+void BuildSpatialGrid(SpatialGrid *grid, const Vector2 *positions, int count, size_t stride);
+// Same for positions held as separate x and y arrays
+void BuildSpatialGridXY(SpatialGrid *grid, const float *x, const float *y, int count);
+
+void GetSpatialGridCell(const SpatialGrid *grid, Vector2 position, int *cellX, int *cellY);
+// Entries [*begin, *end) share the cell's bucket; check entry cellX/cellY to skip other cells
+void GetSpatialGridBucket(const SpatialGrid *grid, int cellX, int cellY, int *begin, int *end);
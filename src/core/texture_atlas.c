@@ -0,0 +1,304 @@
+// texture_atlas.c
+
+#include "texture_atlas.h"
+#include "alpha_scan.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void InitTextureAtlas(TextureAtlas *atlas)
+{
+    atlas->pages = NULL;
+    atlas->pageCount = 0;
+    atlas->regionCount = 0;
+}
+
+// Shrinks rect to the smallest rectangle holding every visible (alpha > 0) pixel.
+// A fully transparent rect is returned unchanged.
+Rectangle TrimTransparentBorder(Image image, Rectangle rect)
+{
+    int left = (int)rect.x, top = (int)rect.y;
+    int right = (int)(rect.x + rect.width), bottom = (int)(rect.y + rect.height);
+
+    while (top < bottom && IsRegionTransparent(image, (Rectangle){left, top, right - left, 1}))
+        top++;
+    if (top == bottom)
+        return rect;
+    while (IsRegionTransparent(image, (Rectangle){left, bottom - 1, right - left, 1}))
+        bottom--;
+    while (IsRegionTransparent(image, (Rectangle){left, top, 1, bottom - top}))
+        left++;
+    while (IsRegionTransparent(image, (Rectangle){right - 1, top, 1, bottom - top}))
+        right--;
+
+    return (Rectangle){left, top, right - left, bottom - top};
+}
+
+// Lowest y at which a width x height box fits with its left edge on node index, or -1
+static int SkylineFit(const AtlasSkylineNode *nodes, int count, int index, int width, int height)
+{
+    if (nodes[index].x + width > ATLAS_PAGE_SIZE)
+        return -1;
+
+    int y = nodes[index].y;
+    int widthLeft = width;
+    for (int i = index; widthLeft > 0; i++)
+    {
+        if (i >= count)
+            return -1;
+        if (nodes[i].y > y)
+            y = nodes[i].y;
+        if (y + height > ATLAS_PAGE_SIZE)
+            return -1;
+        widthLeft -= nodes[i].width;
+    }
+    return y;
+}
+
+// Raises the skyline over [x, x + width) to y. nodes must have room for count + 1 entries.
+static int SkylineAdd(AtlasSkylineNode *nodes, int count, int index, int x, int y, int width)
+{
+    memmove(&nodes[index + 1], &nodes[index], (count - index) * sizeof(AtlasSkylineNode));
+    nodes[index] = (AtlasSkylineNode){x, y, width};
+    count++;
+
+    // Cut the nodes now hidden under the new one
+    for (int i = index + 1; i < count; i++)
+    {
+        int overlap = nodes[index].x + nodes[index].width - nodes[i].x;
+        if (overlap <= 0)
+            break;
+        nodes[i].x += overlap;
+        nodes[i].width -= overlap;
+        if (nodes[i].width > 0)
+            break;
+        memmove(&nodes[i], &nodes[i + 1], (count - i - 1) * sizeof(AtlasSkylineNode));
+        count--;
+        i--;
+    }
+
+    // Merge neighbours at the same height
+    for (int i = 0; i < count - 1; i++)
+    {
+        if (nodes[i].y == nodes[i + 1].y)
+        {
+            nodes[i].width += nodes[i + 1].width;
+            memmove(&nodes[i + 1], &nodes[i + 2], (count - i - 2) * sizeof(AtlasSkylineNode));
+            count--;
+            i--;
+        }
+    }
+    return count;
+}
+
+// Bottom-left placement of one padded box; returns false if the page is full
+static bool SkylinePlace(AtlasSkylineNode *nodes, int *count, int width, int height, int *outX, int *outY)
+{
+    int bestIndex = -1, bestX = 0, bestY = ATLAS_PAGE_SIZE + 1;
+    for (int i = 0; i < *count; i++)
+    {
+        int y = SkylineFit(nodes, *count, i, width, height);
+        if (y >= 0 && (y < bestY || (y == bestY && nodes[i].x < bestX)))
+        {
+            bestIndex = i;
+            bestX = nodes[i].x;
+            bestY = y;
+        }
+    }
+    if (bestIndex < 0)
+        return false;
+
+    *count = SkylineAdd(nodes, *count, bestIndex, bestX, bestY + height, width);
+    *outX = bestX;
+    *outY = bestY;
+    return true;
+}
+
+static AtlasPage *AddAtlasPage(TextureAtlas *atlas)
+{
+    AtlasPage *pages = realloc(atlas->pages, (atlas->pageCount + 1) * sizeof(AtlasPage));
+    if (!pages)
+        return NULL;
+    atlas->pages = pages;
+
+    AtlasPage *page = &atlas->pages[atlas->pageCount];
+    memset(page, 0, sizeof(AtlasPage));
+    page->image.data = calloc((size_t)ATLAS_PAGE_SIZE * ATLAS_PAGE_SIZE, 4);
+    page->skyline = malloc(sizeof(AtlasSkylineNode));
+    if (!page->image.data || !page->skyline)
+    {
+        free(page->image.data);
+        free(page->skyline);
+        return NULL;
+    }
+    page->image.width = ATLAS_PAGE_SIZE;
+    page->image.height = ATLAS_PAGE_SIZE;
+    page->image.mipmaps = 1;
+    page->image.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+    page->skyline[0] = (AtlasSkylineNode){0, 0, ATLAS_PAGE_SIZE};
+    page->skylineCount = 1;
+    page->open = true;
+    atlas->pageCount++;
+    return page;
+}
+
+// Stable insertion sort of indices by descending height; groups are a few dozen rects at most
+static void SortByHeight(int *order, int count, const Rectangle *rects)
+{
+    for (int i = 1; i < count; i++)
+    {
+        int index = order[i];
+        int j = i - 1;
+        while (j >= 0 && rects[order[j]].height < rects[index].height)
+        {
+            order[j + 1] = order[j];
+            j--;
+        }
+        order[j + 1] = index;
+    }
+}
+
+// Places every rect of a group on one page (all frames of an animation share a texture).
+// Works on a copy of the skyline so a group that does not fit leaves the page untouched.
+static bool TryPackOnPage(AtlasPage *page, const Rectangle *rects, const int *order, int count, AtlasRegion *regions)
+{
+    AtlasSkylineNode *nodes = malloc((page->skylineCount + count + 1) * sizeof(AtlasSkylineNode));
+    if (!nodes)
+        return false;
+    memcpy(nodes, page->skyline, page->skylineCount * sizeof(AtlasSkylineNode));
+    int nodeCount = page->skylineCount;
+
+    for (int n = 0; n < count; n++)
+    {
+        const Rectangle *rect = &rects[order[n]];
+        int x, y;
+        if (!SkylinePlace(nodes, &nodeCount, (int)rect->width + ATLAS_PADDING, (int)rect->height + ATLAS_PADDING, &x, &y))
+        {
+            free(nodes);
+            return false;
+        }
+        regions[order[n]].source = (Rectangle){x, y, rect->width, rect->height};
+    }
+
+    free(page->skyline);
+    page->skyline = nodes;
+    page->skylineCount = nodeCount;
+    return true;
+}
+
+static void BlitRegion(AtlasPage *page, Image image, Rectangle from, Rectangle to)
+{
+    const unsigned char *src = image.data;
+    unsigned char *dst = page->image.data;
+    size_t rowBytes = (size_t)from.width * 4;
+    for (int row = 0; row < (int)from.height; row++)
+    {
+        memcpy(dst + (((size_t)to.y + row) * ATLAS_PAGE_SIZE + (size_t)to.x) * 4,
+               src + (((size_t)from.y + row) * image.width + (size_t)from.x) * 4, rowBytes);
+    }
+    page->usedPixels += (long long)from.width * from.height;
+}
+
+// Packs count rectangles of an RGBA8 image onto a single open page, optionally trimming
+// transparent borders first. Returns false if the group cannot fit on an empty page; the
+// caller then keeps the image as a texture of its own.
+bool AtlasPackGroup(TextureAtlas *atlas, Image image, const Rectangle *rects, int count, bool trim, AtlasRegion *regions)
+{
+    if (image.data == NULL || image.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 || count <= 0)
+        return false;
+
+    Rectangle *packed = malloc(count * sizeof(Rectangle));
+    int *order = malloc(count * sizeof(int));
+    if (!packed || !order)
+    {
+        free(packed);
+        free(order);
+        return false;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        Rectangle rect = rects[i];
+        if (rect.x < 0 || rect.y < 0 || rect.x + rect.width > image.width || rect.y + rect.height > image.height ||
+            rect.width + ATLAS_PADDING > ATLAS_PAGE_SIZE || rect.height + ATLAS_PADDING > ATLAS_PAGE_SIZE)
+        {
+            free(packed);
+            free(order);
+            return false;
+        }
+        packed[i] = trim ? TrimTransparentBorder(image, rect) : rect;
+        regions[i].offset = (Vector2){packed[i].x - rect.x, packed[i].y - rect.y};
+        order[i] = i;
+    }
+    SortByHeight(order, count, packed); // Tallest first packs tighter
+
+    // First fit over the open pages, then a fresh page
+    int pageIndex = -1;
+    for (int p = 0; p < atlas->pageCount && pageIndex < 0; p++)
+    {
+        if (atlas->pages[p].open && TryPackOnPage(&atlas->pages[p], packed, order, count, regions))
+            pageIndex = p;
+    }
+    if (pageIndex < 0)
+    {
+        AtlasPage *page = AddAtlasPage(atlas);
+        if (page && TryPackOnPage(page, packed, order, count, regions))
+            pageIndex = atlas->pageCount - 1;
+    }
+
+    if (pageIndex >= 0)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            regions[i].page = pageIndex;
+            BlitRegion(&atlas->pages[pageIndex], image, packed[i], regions[i].source);
+        }
+        atlas->regionCount += count;
+    }
+
+    free(packed);
+    free(order);
+    return pageIndex >= 0;
+}
+
+// Uploads every open page and releases its CPU copy. Returns the number of pages uploaded.
+int UploadAtlasPages(TextureAtlas *atlas, AssetLoadReport *report)
+{
+    int uploaded = 0;
+    for (int p = 0; p < atlas->pageCount; p++)
+    {
+        AtlasPage *page = &atlas->pages[p];
+        if (!page->open)
+            continue;
+
+        char pageName[32];
+        snprintf(pageName, sizeof(pageName), "atlas page %d", p);
+        AssetLoadRecord *record = report ? BeginAssetLoadRecord(report, pageName, ASSET_KIND_NONE, page->image, 0.0) : NULL;
+        page->texture = UploadAssetTexture(page->image, record);
+
+        printf("Atlas page %d: %.1f%% used\n", p, 100.0 * page->usedPixels / ((double)ATLAS_PAGE_SIZE * ATLAS_PAGE_SIZE));
+        UnloadImage(page->image);
+        page->image.data = NULL;
+        free(page->skyline);
+        page->skyline = NULL;
+        page->skylineCount = 0;
+        page->open = false;
+        uploaded++;
+    }
+    return uploaded;
+}
+
+void UnloadTextureAtlas(TextureAtlas *atlas)
+{
+    for (int p = 0; p < atlas->pageCount; p++)
+    {
+        AtlasPage *page = &atlas->pages[p];
+        if (page->texture.id != 0)
+            UnloadTexture(page->texture);
+        if (page->image.data != NULL)
+            UnloadImage(page->image);
+        free(page->skyline);
+    }
+    free(atlas->pages);
+    InitTextureAtlas(atlas);
+}
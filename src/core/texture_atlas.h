@@ -0,0 +1,53 @@
+// texture_atlas.h
+
+#pragma once
+
+#include "raylib.h"
+#include <stdbool.h>
+#include "asset_loader.h"
+
+#ifndef ATLAS_PAGE_SIZE
+#define ATLAS_PAGE_SIZE 4096 // Width and height of every atlas page in pixels; raise it where GPUs allow
+#endif
+#define ATLAS_PADDING 2      // Empty pixels kept right of and below each region
+
+// One horizontal segment of a page's skyline: everything below y in [x, x + width) is used
+typedef struct AtlasSkylineNode
+{
+    int x;
+    int y;
+    int width;
+} AtlasSkylineNode;
+
+typedef struct AtlasPage
+{
+    Image image;     // RGBA8 pixels while the page is open; freed once uploaded
+    Texture2D texture;
+    AtlasSkylineNode *skyline;
+    int skylineCount;
+    long long usedPixels; // Pixels covered by packed regions, without padding
+    bool open;            // Still accepting regions; false after upload
+} AtlasPage;
+
+// Pages of packed sprites, animation frames and tiles. Regions are packed on the CPU with a
+// bottom-left skyline packer and each page is uploaded once when the load finishes.
+typedef struct TextureAtlas
+{
+    AtlasPage *pages;
+    int pageCount;
+    int regionCount;
+} TextureAtlas;
+
+// Where a packed rectangle ended up
+typedef struct AtlasRegion
+{
+    int page;         // Index into atlas->pages
+    Rectangle source; // Rectangle on the page
+    Vector2 offset;   // Top-left of the trimmed pixels within the original rectangle
+} AtlasRegion;
+
+void InitTextureAtlas(TextureAtlas *atlas);
+bool AtlasPackGroup(TextureAtlas *atlas, Image image, const Rectangle *rects, int count, bool trim, AtlasRegion *regions);
+Rectangle TrimTransparentBorder(Image image, Rectangle rect);
+int UploadAtlasPages(TextureAtlas *atlas, AssetLoadReport *report);
+void UnloadTextureAtlas(TextureAtlas *atlas);
@@ -1,6 +1,8 @@
 // tile_placement_data.c
 
 #include "tile_placement_data.h"
+#include "asset_manager.h"
+#include "map_file.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <dirent.h>
@@ -21,24 +23,48 @@ int selectedAnimationIndex = 0;
 Rectangle saveButton = {10, 10, 100, 30};
 Rectangle loadButton = {120, 10, 100, 30};
 
-TileStack **placedTiles = NULL;
+TileStore tileStore = {0};
+unsigned int tileCollisionRevision = 0;
+CollisionMap tileCollisionMap = {0};
 
 // Track the current allocated size
 int allocatedTilesX = 0;
 int allocatedTilesY = 0;
 
-#include <stdint.h>
+// The cell each recent collision revision changed; x = -1 for whole-map changes
+#define TILE_COLLISION_LOG_SIZE 1024
+typedef struct TileCollisionChange
+{
+    unsigned int revision;
+    int x;
+    int y;
+} TileCollisionChange;
+static TileCollisionChange collisionLog[TILE_COLLISION_LOG_SIZE];
+
+static void RecordCollisionChange(int x, int y)
+{
+    tileCollisionRevision++;
+    collisionLog[tileCollisionRevision % TILE_COLLISION_LOG_SIZE] = (TileCollisionChange){tileCollisionRevision, x, y};
+}
 
-uint32_t htonl(uint32_t hostlong) {
-    return ((hostlong & 0x000000FF) << 24) |
-           ((hostlong & 0x0000FF00) << 8)  |
-           ((hostlong & 0x00FF0000) >> 8)  |
-           ((hostlong & 0xFF000000) >> 24);
+// A cell blocks while any tile in its stack is collidable, whatever order they were pushed in
+static void RefreshCollisionCell(int x, int y)
+{
+    TileSpan span = GetTileSpan(x, y);
+    bool blocked = false;
+    for (int i = 0; i < span.count && !blocked; i++)
+        blocked = IsTileEntryCollidable(span.entries[i]);
+    SetCollisionCell(&tileCollisionMap, x, y, blocked);
 }
 
-uint32_t ntohl(uint32_t netlong) {
-    // Since the operation is symmetric, it's identical to htonl
-    return htonl(netlong);
+bool GetTileCollisionChange(unsigned int revision, int *x, int *y)
+{
+    const TileCollisionChange *change = &collisionLog[revision % TILE_COLLISION_LOG_SIZE];
+    if (change->revision != revision || change->x < 0)
+        return false;
+    *x = change->x;
+    *y = change->y;
+    return true;
 }
 
 void InitTileData(int newMapWidth, int newMapHeight, int screenWidth, int screenHeight)
@@ -48,161 +74,228 @@ void InitTileData(int newMapWidth, int newMapHeight, int screenWidth, int screen
     screenTilesX = screenWidth / tileSize;
     screenTilesY = screenHeight / tileSize;
 
-    if (placedTiles != NULL)
+    if (tileStore.cells != NULL)
         FreeTileData();
+    RecordCollisionChange(-1, -1);
 
     // Initialize allocated size to map size
     allocatedTilesX = mapTilesX;
     allocatedTilesY = mapTilesY;
 
-    placedTiles = (TileStack **)malloc(allocatedTilesY * sizeof(TileStack *));
-    if (!placedTiles)
+    if (!InitTileStore(&tileStore, allocatedTilesX, allocatedTilesY) ||
+        !InitCollisionMap(&tileCollisionMap, allocatedTilesX, allocatedTilesY, tileSize))
     {
-        fprintf(stderr, "Failed to allocate memory for placedTiles.\n");
+        fprintf(stderr, "Failed to allocate memory for the tile store.\n");
         exit(EXIT_FAILURE);
     }
-
-    for (int i = 0; i < allocatedTilesY; i++)
-    {
-        placedTiles[i] = (TileStack *)malloc(allocatedTilesX * sizeof(TileStack));
-        if (!placedTiles[i])
-        {
-            fprintf(stderr, "Failed to allocate memory for placedTiles[%d].\n", i);
-            exit(EXIT_FAILURE);
-        }
-        for (int j = 0; j < allocatedTilesX; j++)
-        {
-            placedTiles[i][j].tiles = NULL;
-            placedTiles[i][j].isCollidable = NULL;
-            placedTiles[i][j].count = 0;
-            placedTiles[i][j].capacity = 0;
-        }
-    }
 }
 
 void FreeTileData()
 {
-    if (placedTiles != NULL)
+    if (tileStore.cells != NULL)
     {
-        for (int i = 0; i < allocatedTilesY; i++)
-        {
-            if (placedTiles[i] != NULL)
-            {
-                for (int j = 0; j < allocatedTilesX; j++)
-                {
-                    // Free tiles array
-                    if (placedTiles[i][j].tiles != NULL)
-                    {
-                        free(placedTiles[i][j].tiles);
-                        placedTiles[i][j].tiles = NULL;
-                    }
-
-                    // Free isCollidable array
-                    if (placedTiles[i][j].isCollidable != NULL)
-                    {
-                        free(placedTiles[i][j].isCollidable);
-                        placedTiles[i][j].isCollidable = NULL;
-                    }
-
-                    // Reset count and capacity
-                    placedTiles[i][j].count = 0;
-                    placedTiles[i][j].capacity = 0;
-                }
-                free(placedTiles[i]);
-                placedTiles[i] = NULL;
-            }
-        }
-        free(placedTiles);
-        placedTiles = NULL;
+        FreeTileStore(&tileStore);
+        FreeCollisionMap(&tileCollisionMap);
         allocatedTilesX = 0;
         allocatedTilesY = 0;
+        RecordCollisionChange(-1, -1);
     }
 }
 
-void SaveTilePlacement(const char *filename) {
+// Every loaded asset's name by handle, so the file names each ref's source as it is now
+static bool BuildAssetNameTable(MapNameTable *table)
+{
+    memset(table, 0, sizeof(MapNameTable));
+    int counts[TILE_REF_KINDS] = {manager.tilemapCount, manager.spriteCount, manager.animationCount};
+    for (int kind = 0; kind < TILE_REF_KINDS; kind++)
+    {
+        table->names[kind] = malloc((counts[kind] > 0 ? counts[kind] : 1) * sizeof(const char *));
+        if (table->names[kind] == NULL)
+            return false;
+        table->counts[kind] = counts[kind];
+    }
+    for (int i = 0; i < manager.tilemapCount; i++)
+        table->names[TILE_REF_TILE][i] = manager.tilemap[i].name;
+    for (int i = 0; i < manager.spriteCount; i++)
+        table->names[TILE_REF_SPRITE][i] = manager.sprites[i].name;
+    for (int i = 0; i < manager.animationCount; i++)
+        table->names[TILE_REF_ANIMATION][i] = manager.animations[i].name;
+    return true;
+}
+
+void SaveTilePlacement(const char *filename)
+{
+    MapNameTable names;
+    size_t size;
+    unsigned char *image = BuildAssetNameTable(&names) ? EncodeMapFile(&tileStore, &names, &size) : NULL;
+    FreeMapNameTable(&names);
+    if (!image)
+        return;
+
     FILE *file = fopen(filename, "wb");
-    if (!file) {
+    if (!file)
+    {
         fprintf(stderr, "Failed to open file for saving: %s\n", filename);
+        free(image);
+        return;
+    }
+    bool written = fwrite(image, 1, size, file) == size;
+    written = fclose(file) == 0 && written;
+    free(image);
+    if (!written)
+    {
+        fprintf(stderr, "Failed to write map file: %s\n", filename);
         return;
     }
+    printf("Map saved to %s successfully.\n", filename);
+}
 
-    // Write metadata
-    int version = 1; // File format version
-    version = htonl(version);
-    fwrite(&version, sizeof(int), 1, file);
-
-    int dimensions[2] = { htonl(mapTilesX), htonl(mapTilesY) };
-    fwrite(dimensions, sizeof(int), 2, file);
-
-    for (int y = 0; y < mapTilesY; y++) {
-        for (int x = 0; x < mapTilesX; x++) {
-            TileStack *stack = &placedTiles[y][x];
-            int count = htonl(stack->count);
-            fwrite(&count, sizeof(int), 1, file);
-
-            for (int i = 0; i < stack->count; i++) {
-                int tile = htonl(stack->tiles[i]);
-                bool collidable = stack->isCollidable[i];
-                fwrite(&tile, sizeof(int), 1, file);
-                fwrite(&collidable, sizeof(bool), 1, file);
-            }
-        }
+bool ResolveLegacyTile(int tile, TileRef *ref)
+{
+    int tilemapIndex = tile / 1000;
+    int index = tile % 1000;
+    if (tilemapIndex >= manager.tilemapCount)
+        return false;
+    if (index < manager.tilemap[tilemapIndex].totalTiles)
+    {
+        *ref = MakeTileRef(TILE_REF_TILE, tilemapIndex, index);
+        return true;
     }
+    index -= manager.tilemap[tilemapIndex].totalTiles;
+    if (index < manager.spriteCount)
+    {
+        *ref = MakeTileRef(TILE_REF_SPRITE, index, 0);
+        return true;
+    }
+    index -= manager.spriteCount;
+    if (index < manager.animationCount)
+    {
+        *ref = MakeTileRef(TILE_REF_ANIMATION, index, 0);
+        return true;
+    }
+    return false;
+}
 
-    fclose(file);
-    printf("Map saved to %s successfully.\n", filename);
+static bool ResolveLegacyTileRef(TileRef *ref, void *context)
+{
+    (void)context;
+    return ResolveLegacyTile((int)*ref, ref);
 }
 
-void LoadTilePlacement(const char *filename) {
-    FILE *file = fopen(filename, "rb");
-    if (!file) {
-        fprintf(stderr, "Failed to open file for loading: %s\n", filename);
-        return;
+// Current handle of each source number of a version 4 file, or -1 if no asset has its name
+typedef struct TileSourceMap
+{
+    int *handles[TILE_REF_KINDS];
+    int counts[TILE_REF_KINDS];
+} TileSourceMap;
+
+static int FindAssetHandle(TileRefKind kind, const char *name)
+{
+    if (kind == TILE_REF_SPRITE)
+        return FindSpriteId(&manager, name);
+    if (kind == TILE_REF_ANIMATION)
+        return FindAnimationId(&manager, name);
+    for (int i = 0; i < manager.tilemapCount; i++)
+    {
+        if (strcmp(manager.tilemap[i].name, name) == 0)
+            return i;
     }
+    return -1;
+}
 
-    int version;
-    fread(&version, sizeof(int), 1, file);
-    version = ntohl(version);
+static bool MapTileSource(TileRef *ref, void *context)
+{
+    const TileSourceMap *sources = context;
+    TileRefKind kind = GetTileRefKind(*ref);
+    int source = GetTileRefSource(*ref);
+    if (kind >= TILE_REF_KINDS || source >= sources->counts[kind] || sources->handles[kind][source] < 0)
+        return false;
+    *ref = MakeTileRef(kind, sources->handles[kind][source], GetTileRefIndex(*ref));
+    return true;
+}
 
-    if (version != 1) {
-        fprintf(stderr, "Unsupported file version: %d\n", version);
-        fclose(file);
+// Points the refs tileStore was loaded with at the assets loaded now: by name for version 4
+// files, through ResolveLegacyTile for older ones. Touches each palette stack once, and none
+// if every name still has the handle it was saved with.
+static bool ResolveLoadedTiles(int version, const MapNameTable *names, long long *dropped)
+{
+    *dropped = 0;
+    if (version < 4)
+        return RemapTileStore(&tileStore, ResolveLegacyTileRef, NULL, dropped);
+
+    TileSourceMap sources = {0};
+    bool allocated = true, unchanged = true;
+    for (int kind = 0; kind < TILE_REF_KINDS; kind++)
+    {
+        sources.counts[kind] = names->counts[kind];
+        sources.handles[kind] = malloc((names->counts[kind] > 0 ? names->counts[kind] : 1) * sizeof(int));
+        allocated = allocated && sources.handles[kind] != NULL;
+        for (int i = 0; sources.handles[kind] != NULL && i < names->counts[kind]; i++)
+        {
+            sources.handles[kind][i] = FindAssetHandle((TileRefKind)kind, names->names[kind][i]);
+            unchanged = unchanged && sources.handles[kind][i] == i;
+        }
+    }
+    bool resolved = allocated && (unchanged || RemapTileStore(&tileStore, MapTileSource, &sources, dropped));
+    for (int kind = 0; kind < TILE_REF_KINDS; kind++)
+        free(sources.handles[kind]);
+    return resolved;
+}
+
+void LoadTilePlacement(const char *filename)
+{
+    MapFileView view;
+    if (!OpenMapFileView(filename, &view))
+    {
+        fprintf(stderr, "Failed to open file for loading: %s\n", filename);
         return;
     }
 
-    int dimensions[2];
-    fread(dimensions, sizeof(int), 2, file);
-    mapTilesX = ntohl(dimensions[0]);
-    mapTilesY = ntohl(dimensions[1]);
+    int version, width, height;
+    if (!ReadMapFileInfo(view.data, view.size, &version, &width, &height))
+    {
+        fprintf(stderr, "Unsupported or corrupt map file: %s\n", filename);
+        CloseMapFileView(&view);
+        return;
+    }
 
     FreeTileData();
-    InitTileData(mapTilesX, mapTilesY, screenTilesX * tileSize, screenTilesY * tileSize);
-
-    for (int y = 0; y < mapTilesY; y++) {
-        for (int x = 0; x < mapTilesX; x++) {
-            TileStack *stack = &placedTiles[y][x];
-
-            int count;
-            fread(&count, sizeof(int), 1, file);
-            count = ntohl(count);
-
-            if (count > 0) {
-                stack->tiles = (int *)malloc(count * sizeof(int));
-                stack->isCollidable = (bool *)malloc(count * sizeof(bool));
-                stack->capacity = count;
-                stack->count = count;
-
-                for (int i = 0; i < count; i++) {
-                    fread(&stack->tiles[i], sizeof(int), 1, file);
-                    stack->tiles[i] = ntohl(stack->tiles[i]);
-                    fread(&stack->isCollidable[i], sizeof(bool), 1, file);
-                }
-            }
-        }
+    InitTileData(width, height, screenTilesX * tileSize, screenTilesY * tileSize);
+    MapNameTable names;
+    bool decoded = DecodeMapFile(view.data, view.size, &tileStore, &names);
+    CloseMapFileView(&view);
+    long long dropped = 0;
+    bool resolved = decoded && ResolveLoadedTiles(version, &names, &dropped);
+    FreeMapNameTable(&names);
+    if (!resolved)
+    {
+        // Leave an empty map of the right size rather than a partly loaded one
+        fprintf(stderr, decoded ? "Out of memory resolving map tiles: %s\n" : "Corrupt map file: %s\n", filename);
+        InitTileData(width, height, screenTilesX * tileSize, screenTilesY * tileSize);
+        return;
     }
+    if (dropped > 0)
+        fprintf(stderr, "%lld placed tiles of %s show assets that are not loaded; dropped.\n", dropped, filename);
 
-    fclose(file);
-    printf("Map loaded from %s successfully.\n", filename);
+    // Whether a cell blocks depends only on its stack, so decide once per palette entry
+    bool *blocking = calloc(tileStore.stackCount, sizeof(bool));
+    for (int i = 0; blocking != NULL && i < tileStore.stackCount; i++)
+    {
+        TileSpan span = GetPaletteSpan(&tileStore, i);
+        for (int t = 0; t < span.count && !blocking[i]; t++)
+            blocking[i] = IsTileEntryCollidable(span.entries[t]);
+    }
+    for (int y = 0; y < mapTilesY; y++)
+    {
+        for (int x = 0; x < mapTilesX; x++)
+        {
+            if (blocking ? blocking[tileStore.cells[(size_t)y * mapTilesX + x]] : GetTileSpan(x, y).count > 0)
+                RefreshCollisionCell(x, y);
+        }
+    }
+    free(blocking);
+    RecordCollisionChange(-1, -1);
+    printf("Map loaded from %s (version %d) successfully.\n", filename, version);
 }
 
 // Comparator function for sorting file names alphabetically
@@ -260,30 +353,35 @@ void LoadFirstMapInDirectory(const char *directory)
 }
 
 
-void PushTileToStack(TileStack *stack, int tileIndex, bool isCollidable)
+void PushTile(int x, int y, TileRef ref, bool isCollidable)
 {
-    if (stack->count >= stack->capacity)
+    if (!PushStoreTile(&tileStore, x, y, ref | (isCollidable ? TILE_ENTRY_COLLIDABLE : 0)))
     {
-        int newCapacity = (stack->capacity == 0) ? 4 : stack->capacity * 2;
-        int *newTiles = (int *)realloc(stack->tiles, newCapacity * sizeof(int));
-        if (!newTiles)
-        {
-            fprintf(stderr, "Failed to realloc tiles in PushTileToStack.\n");
-            exit(EXIT_FAILURE);
-        }
-        stack->tiles = newTiles;
-
-        bool *newCollidable = (bool *)realloc(stack->isCollidable, newCapacity * sizeof(bool));
-        if (!newCollidable)
-        {
-            fprintf(stderr, "Failed to realloc isCollidable in PushTileToStack.\n");
-            exit(EXIT_FAILURE);
-        }
-        stack->isCollidable = newCollidable;
+        fprintf(stderr, "Tile (%d, %d) not placed: the cell or the map's tile palette is full.\n", x, y);
+        return;
+    }
+    if (isCollidable)
+    {
+        RefreshCollisionCell(x, y);
+        RecordCollisionChange(x, y);
+    }
+}
 
-        stack->capacity = newCapacity;
+bool PopTile(int x, int y)
+{
+    TileSpan span = GetTileSpan(x, y);
+    if (span.count <= 0)
+        return false;
+    bool wasCollidable = IsTileEntryCollidable(span.entries[span.count - 1]);
+    if (!PopStoreTile(&tileStore, x, y))
+    {
+        fprintf(stderr, "Tile (%d, %d) not removed: the map's tile palette is full.\n", x, y);
+        return false;
+    }
+    if (wasCollidable)
+    {
+        RefreshCollisionCell(x, y);
+        RecordCollisionChange(x, y);
     }
-    stack->tiles[stack->count] = tileIndex;
-    stack->isCollidable[stack->count] = isCollidable;
-    stack->count++;
+    return true;
 }
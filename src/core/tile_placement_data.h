@@ -4,13 +4,8 @@
 
 #include <stdbool.h>
 #include "raylib.h" // For Rectangle
-
-typedef struct {
-    int *tiles;             // Array of tile indices
-    bool *isCollidable;     // Array of collidability states
-    int count;              // Number of tiles
-    int capacity;           // Capacity of the tiles array
-} TileStack;
+#include "collision_map.h"
+#include "tile_store.h"
 
 // Function Declarations
 void InitTileData(int mapWidth, int mapHeight, int screenWidth, int screenHeight);
@@ -18,7 +13,16 @@ void FreeTileData();
 void SaveTilePlacement(const char *filename);
 void LoadTilePlacement(const char *filename);
 void LoadFirstMapInDirectory(const char *directory);
-void PushTileToStack(TileStack *stack, int tileIndex, bool isCollidable);
+// Adds a tile on top of cell (x, y); ignored once the cell holds TILE_STACK_MAX tiles or the
+// map TILE_PALETTE_MAX distinct stacks
+void PushTile(int x, int y, TileRef ref, bool isCollidable);
+bool PopTile(int x, int y); // Removes the top tile; false if the cell was empty
+// What a tile of a version 1 to 3 map, tilemapIndex * 1000 + i, shows with the assets loaded
+// now: tile i of the tilemap, or past its tiles a sprite, then an animation. False if none.
+bool ResolveLegacyTile(int tile, TileRef *ref);
+// Cell that collision revision `revision` changed, so caches can patch instead of rebuilding.
+// False if that revision replaced the whole map or is too old to be remembered.
+bool GetTileCollisionChange(unsigned int revision, int *x, int *y);
 
 // External Variables
 extern const int tileSize;
@@ -34,4 +38,15 @@ extern int selectedAnimationIndex;
 extern Rectangle saveButton;
 extern Rectangle loadButton;
 
-extern TileStack **placedTiles;
+// Tiles placed on the map, mapTilesX x mapTilesY cells
+extern TileStore tileStore;
+// Bumped whenever a cell may have become collidable or walkable (map init/load, collidable
+// tiles pushed or popped), so caches built from collision data know to rebuild
+extern unsigned int tileCollisionRevision;
+// Collidable cells of tileStore, kept in step by init, load, push and pop
+extern CollisionMap tileCollisionMap;
+
+static inline TileSpan GetTileSpan(int x, int y)
+{
+    return GetStoreTileSpan(&tileStore, x, y);
+}
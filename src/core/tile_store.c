@@ -0,0 +1,336 @@
+// tile_store.c
+
+#include "tile_store.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TILE_STORE_MIN_ENTRIES 256
+
+static uint32_t HashEntries(const uint32_t *entries, int count)
+{
+    uint32_t hash = 2166136261u ^ (uint32_t)count;
+    for (int i = 0; i < count; i++)
+        hash = (hash ^ entries[i]) * 16777619u;
+    // FNV only carries low bits upwards; the slot index is taken from the low bits
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6Bu;
+    return hash ^ hash >> 13;
+}
+
+static int FindStack(const TileStore *store, uint32_t hash, const uint32_t *entries, int count)
+{
+    if (store->slotCount == 0)
+        return -1;
+    uint32_t mask = (uint32_t)store->slotCount - 1;
+    for (uint32_t slot = hash & mask; store->slots[slot] != 0; slot = (slot + 1) & mask)
+    {
+        int index = (int)store->slots[slot] - 1;
+        const TilePaletteStack *stack = &store->stacks[index];
+        if (stack->hash == hash && stack->count == (uint32_t)count &&
+            (count == 0 || memcmp(store->entries + stack->start, entries, count * sizeof(uint32_t)) == 0))
+            return index;
+    }
+    return -1;
+}
+
+static void InsertSlot(TileStore *store, int index)
+{
+    uint32_t mask = (uint32_t)store->slotCount - 1;
+    uint32_t slot = store->stacks[index].hash & mask;
+    while (store->slots[slot] != 0)
+        slot = (slot + 1) & mask;
+    store->slots[slot] = (uint32_t)index + 1;
+}
+
+// Linear probing without tombstones: later entries of the probe run move back into the gap
+// unless their own home slot lies between the gap and them
+static void RemoveSlot(TileStore *store, int index)
+{
+    uint32_t mask = (uint32_t)store->slotCount - 1;
+    uint32_t gap = store->stacks[index].hash & mask;
+    while (store->slots[gap] != (uint32_t)index + 1)
+        gap = (gap + 1) & mask;
+    for (uint32_t next = (gap + 1) & mask; store->slots[next] != 0; next = (next + 1) & mask)
+    {
+        uint32_t home = store->stacks[store->slots[next] - 1].hash & mask;
+        if (((next - home) & mask) >= ((next - gap) & mask))
+        {
+            store->slots[gap] = store->slots[next];
+            gap = next;
+        }
+    }
+    store->slots[gap] = 0;
+}
+
+static bool ResizeSlots(TileStore *store, int slotCount)
+{
+    uint32_t *slots = calloc(slotCount, sizeof(uint32_t));
+    if (slots == NULL)
+        return false;
+    free(store->slots);
+    store->slots = slots;
+    store->slotCount = slotCount;
+    for (int i = 0; i < store->stackCount; i++)
+    {
+        if (store->stacks[i].refs != TILE_STACK_FREED)
+            InsertSlot(store, i);
+    }
+    return true;
+}
+
+// Copies the stacks in use into a fresh entries array with room for extra more
+static bool CompactEntries(TileStore *store, size_t extra)
+{
+    size_t capacity = TILE_STORE_MIN_ENTRIES;
+    while (capacity < (store->liveEntries + extra) * 2)
+        capacity *= 2;
+    uint32_t *entries = malloc(capacity * sizeof(uint32_t));
+    if (entries == NULL)
+        return false;
+    size_t next = 0;
+    for (int i = 0; i < store->stackCount; i++)
+    {
+        TilePaletteStack *stack = &store->stacks[i];
+        if (stack->refs == TILE_STACK_FREED)
+            continue;
+        if (stack->count > 0)
+            memcpy(entries + next, store->entries + stack->start, stack->count * sizeof(uint32_t));
+        stack->start = (uint32_t)next;
+        next += stack->count;
+    }
+    free(store->entries);
+    store->entries = entries;
+    store->entryCount = next;
+    store->entryCapacity = capacity;
+    return true;
+}
+
+// Room for extra entries after entryCount. Once freed stacks' stale entries are as many as
+// the live ones, they are dropped instead of the array growing. Moves every span.
+static bool ReserveEntries(TileStore *store, size_t extra)
+{
+    if (store->entryCount + extra <= store->entryCapacity)
+        return true;
+    if (store->entryCount - store->liveEntries >= store->liveEntries)
+        return CompactEntries(store, extra);
+    size_t capacity = store->entryCapacity > 0 ? store->entryCapacity * 2 : TILE_STORE_MIN_ENTRIES;
+    while (capacity < store->entryCount + extra)
+        capacity *= 2;
+    if (capacity > UINT32_MAX)
+        return false;
+    uint32_t *entries = realloc(store->entries, capacity * sizeof(uint32_t));
+    if (entries == NULL)
+        return false;
+    store->entries = entries;
+    store->entryCapacity = capacity;
+    return true;
+}
+
+// A free palette index, growing the palette and its hash if needed; -1 if it is full
+static int AllocateStack(TileStore *store)
+{
+    if (store->freeCount > 0)
+        return store->freeStacks[--store->freeCount];
+    if (store->stackCount >= TILE_PALETTE_MAX)
+        return -1;
+    if (store->stackCount >= store->stackCapacity)
+    {
+        int capacity = store->stackCapacity > 0 ? store->stackCapacity * 2 : 64;
+        TilePaletteStack *stacks = realloc(store->stacks, capacity * sizeof(TilePaletteStack));
+        if (stacks)
+            store->stacks = stacks;
+        uint16_t *freeStacks = realloc(store->freeStacks, capacity * sizeof(uint16_t));
+        if (freeStacks)
+            store->freeStacks = freeStacks;
+        if (!stacks || !freeStacks)
+            return -1;
+        store->stackCapacity = capacity;
+    }
+    if ((store->stackCount + 1) * 2 > store->slotCount && !ResizeSlots(store, store->slotCount > 0 ? store->slotCount * 2 : 128))
+        return -1;
+    return store->stackCount++;
+}
+
+// Interns the count entries just written after entryCount: keeps them as a new stack unless
+// the palette already holds the same one
+static int InternTailStack(TileStore *store, int count)
+{
+    const uint32_t *tail = store->entries + store->entryCount;
+    uint32_t hash = HashEntries(tail, count);
+    int index = FindStack(store, hash, tail, count);
+    if (index >= 0)
+        return index;
+    if ((index = AllocateStack(store)) < 0)
+        return -1;
+    store->stacks[index] = (TilePaletteStack){(uint32_t)store->entryCount, (uint32_t)count, 0, hash};
+    store->entryCount += count;
+    store->liveEntries += count;
+    InsertSlot(store, index);
+    return index;
+}
+
+static void FreeStack(TileStore *store, int index)
+{
+    RemoveSlot(store, index);
+    store->liveEntries -= store->stacks[index].count;
+    store->stacks[index].refs = TILE_STACK_FREED;
+    store->freeStacks[store->freeCount++] = (uint16_t)index;
+}
+
+bool InitTileStore(TileStore *store, int width, int height)
+{
+    memset(store, 0, sizeof(TileStore));
+    store->width = width;
+    store->height = height;
+    size_t cellCount = (size_t)width * height;
+    // All zero, so every cell starts on the empty stack
+    store->cells = calloc(cellCount > 0 ? cellCount : 1, sizeof(uint16_t));
+    if (store->cells == NULL || !ReserveEntries(store, 0) || InternTailStack(store, 0) != 0)
+    {
+        fprintf(stderr, "Failed to allocate tile store for %dx%d tiles.\n", width, height);
+        FreeTileStore(store);
+        return false;
+    }
+    store->stacks[0].refs = (uint32_t)cellCount;
+    return true;
+}
+
+void FreeTileStore(TileStore *store)
+{
+    free(store->cells);
+    free(store->stacks);
+    free(store->freeStacks);
+    free(store->entries);
+    free(store->slots);
+    memset(store, 0, sizeof(TileStore));
+}
+
+int InternTileStack(TileStore *store, const uint32_t *entries, int count)
+{
+    if (count < 0 || count > TILE_STACK_MAX || !ReserveEntries(store, count))
+        return -1;
+    if (count > 0)
+        memcpy(store->entries + store->entryCount, entries, count * sizeof(uint32_t));
+    return InternTailStack(store, count);
+}
+
+void RecountTileStoreRefs(TileStore *store)
+{
+    for (int i = 0; i < store->stackCount; i++)
+    {
+        if (store->stacks[i].refs != TILE_STACK_FREED)
+            store->stacks[i].refs = 0;
+    }
+    size_t cellCount = (size_t)store->width * store->height;
+    for (size_t cell = 0; cell < cellCount; cell++)
+        store->stacks[store->cells[cell]].refs++;
+    for (int i = 1; i < store->stackCount; i++)
+    {
+        if (store->stacks[i].refs == 0)
+            FreeStack(store, i);
+    }
+}
+
+// Moves cell (x, y) over to stack, freeing the stack it leaves if no other cell holds it
+static void SetStoreCell(TileStore *store, int x, int y, int stack)
+{
+    uint16_t *cell = &store->cells[(size_t)y * store->width + x];
+    int previous = *cell;
+    store->stacks[stack].refs++;
+    *cell = (uint16_t)stack;
+    if (--store->stacks[previous].refs == 0 && previous != 0)
+        FreeStack(store, previous);
+}
+
+bool PushStoreTile(TileStore *store, int x, int y, uint32_t entry)
+{
+    int count = GetStoreTileSpan(store, x, y).count;
+    if (count >= TILE_STACK_MAX || !ReserveEntries(store, count + 1))
+        return false;
+    TileSpan span = GetStoreTileSpan(store, x, y); // Reserving may have moved it
+    uint32_t *tail = store->entries + store->entryCount;
+    if (count > 0)
+        memcpy(tail, span.entries, count * sizeof(uint32_t));
+    tail[count] = entry;
+    int stack = InternTailStack(store, count + 1);
+    if (stack < 0)
+        return false;
+    SetStoreCell(store, x, y, stack);
+    return true;
+}
+
+bool PopStoreTile(TileStore *store, int x, int y)
+{
+    int count = GetStoreTileSpan(store, x, y).count;
+    if (count <= 0 || !ReserveEntries(store, count - 1))
+        return false;
+    TileSpan span = GetStoreTileSpan(store, x, y);
+    if (count > 1)
+        memcpy(store->entries + store->entryCount, span.entries, (count - 1) * sizeof(uint32_t));
+    int stack = InternTailStack(store, count - 1);
+    if (stack < 0)
+        return false;
+    SetStoreCell(store, x, y, stack);
+    return true;
+}
+
+bool RemapTileStore(TileStore *store, TileRefMap map, void *context, long long *dropped)
+{
+    // A fresh palette, so remapped stacks never match an old stack that is still unmapped
+    TileStore fresh;
+    uint16_t *stackMap = malloc(store->stackCount * sizeof(uint16_t));
+    uint32_t *scratch = malloc(TILE_STACK_MAX * sizeof(uint32_t));
+    bool remapped = stackMap != NULL && scratch != NULL && InitTileStore(&fresh, 0, 0);
+    *dropped = 0;
+    for (int i = 0; remapped && i < store->stackCount; i++)
+    {
+        if (store->stacks[i].refs == TILE_STACK_FREED)
+            continue;
+        TileSpan span = GetPaletteSpan(store, i);
+        int count = 0;
+        for (int t = 0; t < span.count; t++)
+        {
+            TileRef ref = GetTileEntryRef(span.entries[t]);
+            if (map(&ref, context))
+                scratch[count++] = ref | (span.entries[t] & TILE_ENTRY_COLLIDABLE);
+        }
+        *dropped += (long long)(span.count - count) * store->stacks[i].refs;
+        int stack = InternTileStack(&fresh, scratch, count);
+        remapped = stack >= 0;
+        stackMap[i] = (uint16_t)stack;
+    }
+    if (remapped)
+    {
+        size_t cellCount = (size_t)store->width * store->height;
+        for (size_t cell = 0; cell < cellCount; cell++)
+            store->cells[cell] = stackMap[store->cells[cell]];
+        // Keep the cells, take the fresh palette
+        uint16_t *cells = store->cells;
+        int width = store->width, height = store->height;
+        free(fresh.cells);
+        free(store->stacks);
+        free(store->freeStacks);
+        free(store->entries);
+        free(store->slots);
+        *store = fresh;
+        store->cells = cells;
+        store->width = width;
+        store->height = height;
+        RecountTileStoreRefs(store);
+    }
+    else if (stackMap != NULL && scratch != NULL)
+    {
+        FreeTileStore(&fresh);
+    }
+    free(stackMap);
+    free(scratch);
+    return remapped;
+}
+
+size_t GetTileStoreBytes(const TileStore *store)
+{
+    return (size_t)store->width * store->height * sizeof(uint16_t) +
+           (size_t)store->stackCapacity * (sizeof(TilePaletteStack) + sizeof(uint16_t)) +
+           store->entryCapacity * sizeof(uint32_t) + (size_t)store->slotCount * sizeof(uint32_t);
+}
@@ -0,0 +1,132 @@
+// tile_store.h
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TILE_ENTRY_COLLIDABLE 0x80000000u // Top bit of a store entry; the rest is its TileRef
+#define TILE_STACK_MAX 65535              // Tiles one cell can hold
+#define TILE_PALETTE_MAX 65536            // Distinct stacks one store can hold; cells keep 16-bit indices
+#define TILE_STACK_FREED UINT32_MAX       // refs of a palette stack whose index is free for reuse
+
+// What a placed tile shows, packed below TILE_ENTRY_COLLIDABLE: kind in bits 29-30, source
+// (tilemap, sprite or animation handle) in bits 16-28, and the tile within a tilemap in bits
+// 0-15. Sources are the asset manager's current handles; map files name them instead.
+typedef uint32_t TileRef;
+
+typedef enum TileRefKind
+{
+    TILE_REF_TILE,
+    TILE_REF_SPRITE,
+    TILE_REF_ANIMATION,
+    TILE_REF_KINDS
+} TileRefKind;
+
+#define TILE_REF_KIND_SHIFT 29
+#define TILE_REF_SOURCE_SHIFT 16
+#define TILE_REF_MAX_SOURCES 8192 // Per kind
+#define TILE_REF_MAX_INDEX 65536
+
+// A cell's tiles, bottom first, as packed entries. Valid until the store is next edited.
+typedef struct TileSpan
+{
+    const uint32_t *entries;
+    int count;
+} TileSpan;
+
+// One distinct stack of the palette: entries[start] up to entries[start + count]
+typedef struct TilePaletteStack
+{
+    uint32_t start;
+    uint32_t count;
+    uint32_t refs; // Cells holding it, or TILE_STACK_FREED
+    uint32_t hash;
+} TilePaletteStack;
+
+// Tiles of every cell of a map, hash-consed: each distinct stack (tiles and collision flags)
+// is stored once in a palette, and a cell holds only its 16-bit palette index, so a map of
+// mostly identical cells costs two bytes a cell. Palette stacks are never changed in place;
+// an edit interns the cell's new stack, which finds an existing copy or appends one, and
+// moves the cell over to it. Index 0 is always the empty stack.
+typedef struct TileStore
+{
+    int width;
+    int height;
+    uint16_t *cells; // Row by row
+    TilePaletteStack *stacks;
+    int stackCount; // Indices handed out, freed ones included
+    int stackCapacity;
+    uint16_t *freeStacks; // Freed indices, reused before stackCount grows
+    int freeCount;
+    uint32_t *entries; // Every stack's tiles, plus stale ones of freed stacks
+    size_t entryCount;
+    size_t entryCapacity;
+    size_t liveEntries; // Held by stacks in use
+    uint32_t *slots;    // Open-addressed index of the stacks in use: index + 1, or 0 if empty
+    int slotCount;      // Power of two, at least twice stackCount
+} TileStore;
+
+bool InitTileStore(TileStore *store, int width, int height);
+void FreeTileStore(TileStore *store);
+// Palette index of the stack holding these entries, added with no cells if it is new; -1 if
+// the palette is full or out of memory
+int InternTileStack(TileStore *store, const uint32_t *entries, int count);
+// Counts the cells holding each stack and frees the stacks none hold; for loaders, which
+// write cells directly
+void RecountTileStoreRefs(TileStore *store);
+// Adds an entry on top of / removes the top entry of cell (x, y) by interning its new stack.
+// False if the palette is full (push) or the cell is empty (pop); the cell is then unchanged.
+bool PushStoreTile(TileStore *store, int x, int y, uint32_t entry);
+bool PopStoreTile(TileStore *store, int x, int y);
+// Rewrites the TileRef of every entry of every stack in use through map, which may change it
+// or return false to drop the tile, and re-interns the results, so stacks that become equal
+// merge. Collision flags are kept. Sets *dropped to the tiles dropped across all cells. False
+// if memory ran out; the store is then unchanged.
+typedef bool (*TileRefMap)(TileRef *ref, void *context);
+bool RemapTileStore(TileStore *store, TileRefMap map, void *context, long long *dropped);
+// Bytes the store holds on the heap
+size_t GetTileStoreBytes(const TileStore *store);
+
+static inline TileRef MakeTileRef(TileRefKind kind, int source, int index)
+{
+    return (TileRef)kind << TILE_REF_KIND_SHIFT | (TileRef)source << TILE_REF_SOURCE_SHIFT | (TileRef)index;
+}
+
+static inline TileRefKind GetTileRefKind(TileRef ref)
+{
+    return (TileRefKind)(ref >> TILE_REF_KIND_SHIFT & 3);
+}
+
+static inline int GetTileRefSource(TileRef ref)
+{
+    return (int)(ref >> TILE_REF_SOURCE_SHIFT & (TILE_REF_MAX_SOURCES - 1));
+}
+
+static inline int GetTileRefIndex(TileRef ref)
+{
+    return (int)(ref & (TILE_REF_MAX_INDEX - 1));
+}
+
+static inline TileRef GetTileEntryRef(uint32_t entry)
+{
+    return entry & ~TILE_ENTRY_COLLIDABLE;
+}
+
+static inline bool IsTileEntryCollidable(uint32_t entry)
+{
+    return (entry & TILE_ENTRY_COLLIDABLE) != 0;
+}
+
+static inline TileSpan GetPaletteSpan(const TileStore *store, int stack)
+{
+    const TilePaletteStack *palette = &store->stacks[stack];
+    return (TileSpan){store->entries + palette->start, (int)palette->count};
+}
+
+// Tiles of cell (x, y), which must be on the map
+static inline TileSpan GetStoreTileSpan(const TileStore *store, int x, int y)
+{
+    return GetPaletteSpan(store, store->cells[(size_t)y * store->width + x]);
+}
@@ -1,68 +1,160 @@
 #include <stdlib.h>
+#include <string.h>
 #include "tilemap.h"
 #include "asset_manager.h"
 #include <math.h>
 
-// Load the tilemap from a file and cut it into tiles
-void LoadTilemap(const char *filePath, int tileSize) {
-    // Load the tilemap texture as an image
-    Texture2D tilemapTexture = LoadTexture(filePath);
-    Image tilemapImage = LoadImageFromTexture(tilemapTexture);
-
-    // Calculate tile count based on image size and tile size
-    int tileCountX = tilemapImage.width / tileSize;
-    int tileCountY = tilemapImage.height / tileSize;
-    int totalTiles = tileCountX * tileCountY;
-
-    // Allocate memory for the tiles array
-    Texture2D *tiles = (Texture2D *)malloc(totalTiles * sizeof(Texture2D));
-
-    // Cut the tilemap into tiles and store them in the asset manager
-    for (int y = 0; y < tileCountY; y++) {
-        for (int x = 0; x < tileCountX; x++) {
-            Rectangle srcRect = { x * tileSize, y * tileSize, tileSize, tileSize };
+// Cut an image of the given size into tileSize x tileSize source rectangles, row by row
+Rectangle *SliceTilemap(int imageWidth, int imageHeight, int tileSize, int *tileCountX, int *tileCountY)
+{
+    *tileCountX = imageWidth / tileSize;
+    *tileCountY = imageHeight / tileSize;
 
-            if (srcRect.x + srcRect.width <= tilemapImage.width &&
-                srcRect.y + srcRect.height <= tilemapImage.height) {
-                
-                Image tileImage = ImageCopy(tilemapImage);
-                ImageCrop(&tileImage, srcRect);
+    Rectangle *rects = (Rectangle *)malloc((*tileCountX) * (*tileCountY) * sizeof(Rectangle));
+    if (!rects)
+    {
+        return NULL;
+    }
 
-                Texture2D tileTexture = LoadTextureFromImage(tileImage);
-                if (tileTexture.id != 0) {
-                    tiles[y * tileCountX + x] = tileTexture; // Store the texture
+    for (int y = 0; y < *tileCountY; y++)
+    {
+        for (int x = 0; x < *tileCountX; x++)
+        {
+            rects[y * (*tileCountX) + x] = (Rectangle){x * tileSize, y * tileSize, tileSize, tileSize};
+        }
+    }
+    return rects;
+}
 
-                    // Create a unique name for this tile (e.g., "tile_X_Y")
-                    char tileName[64];
-                    snprintf(tileName, sizeof(tileName), "tile_%d_%d", x, y);
+// Build a tilemap from an already decoded image and its tile rectangles: the sheet is
+// uploaded once and tiles are drawn from it by source rectangle. record may be NULL.
+void LoadTilemapFromImage(const char *name, Image tilemapImage, const Rectangle *tileRects, int tileCountX, int tileCountY,
+                          AssetLoadRecord *record)
+{
+    if (manager.tilemapCount >= MAX_TILEMAPS)
+    {
+        printf("Max tilemaps loaded!\n");
+        return;
+    }
 
-                    // Add the tile to the asset manager
-                    Sprite tileSprite = { .texture = tileTexture };
+    int totalTiles = tileCountX * tileCountY;
+    Rectangle *rects = (Rectangle *)malloc((totalTiles > 0 ? totalTiles : 1) * sizeof(Rectangle));
+    if (!rects)
+    {
+        return;
+    }
+    memcpy(rects, tileRects, totalTiles * sizeof(Rectangle));
 
-                }
+    // Prepare the new tilemap to store in the asset manager
+    Tilemap newTilemap;
+    newTilemap.texture = (Texture2D){0};
+    newTilemap.atlasPage = -1;
 
-                UnloadImage(tileImage);
-            }
+    // Tiles are packed untrimmed so they keep lining up on the grid. A sheet with no tiles (all
+    // blank) has no region to take the page from, so it keeps its own texture.
+    AtlasRegion *regions = manager.atlasBuilding && totalTiles > 0 ? malloc(totalTiles * sizeof(AtlasRegion)) : NULL;
+    if (regions && AtlasPackGroup(&manager.atlas, tilemapImage, tileRects, totalTiles, false, regions))
+    {
+        for (int i = 0; i < totalTiles; i++)
+        {
+            rects[i] = regions[i].source;
         }
+        newTilemap.atlasPage = regions[0].page; // Texture assigned by FinishAssetAtlas
+    }
+    else
+    {
+        newTilemap.texture = UploadAssetTexture(tilemapImage, record);
     }
+    free(regions);
 
-    // Prepare the new tilemap to store in the asset manager
-    Tilemap newTilemap;
-    newTilemap.tiles = tiles; // Assign the allocated tiles array
+    newTilemap.tileRects = rects;
     newTilemap.tileCountX = tileCountX;
     newTilemap.tileCountY = tileCountY;
     newTilemap.totalTiles = totalTiles;
     newTilemap.currentTileIndex = 0;
+    strncpy(newTilemap.name, name ? name : "", sizeof(newTilemap.name) - 1);
+    newTilemap.name[sizeof(newTilemap.name) - 1] = '\0';
 
     // Add the tilemap to the asset manager
     manager.tilemap[manager.tilemapCount++] = newTilemap; // Increment tilemapCount after assignment
+}
 
+// Load the tilemap from a file and slice it into tile rectangles
+void LoadTilemap(const char *filePath, int tileSize) {
+    DecodedAsset asset;
+    if (!DecodeAssetFileAs(filePath, ASSET_KIND_NONE, &asset))
+    {
+        printf("Failed to load tilemap: %s\n", filePath);
+        return;
+    }
+
+    // Calculate tile rectangles based on image size and tile size
+    int tileCountX, tileCountY;
+    Rectangle *tileRects = SliceTilemap(asset.image.width, asset.image.height, tileSize, &tileCountX, &tileCountY);
+    if (tileRects)
+    {
+        AssetLoadRecord *record = BeginAssetLoadRecord(&manager.loadReport, filePath, ASSET_KIND_TILEMAP, asset.image,
+                                                       asset.decodeSeconds);
+        LoadTilemapFromImage(asset.name, asset.image, tileRects, tileCountX, tileCountY, record);
+        free(tileRects);
+    }
 
     // Clean up
-    UnloadImage(tilemapImage);
-    UnloadTexture(tilemapTexture);
+    FreeDecodedAsset(&asset);
+}
+
+
+// Hot reload: point the tilemap registered under name at a fresh upload of the sheet. It keeps its
+// index, so placed tiles (TileRefs of that source) draw the new art. Unknown names are added.
+void ReloadTilemapFromImage(const char *name, Image tilemapImage, const Rectangle *tileRects, int tileCountX, int tileCountY,
+                            AssetLoadRecord *record)
+{
+    Tilemap *tilemap = NULL;
+    for (int i = 0; i < manager.tilemapCount; i++)
+    {
+        if (strcmp(manager.tilemap[i].name, name) == 0)
+        {
+            tilemap = &manager.tilemap[i];
+            break;
+        }
+    }
+    if (tilemap == NULL)
+    {
+        LoadTilemapFromImage(name, tilemapImage, tileRects, tileCountX, tileCountY, record);
+        return;
+    }
+
+    int totalTiles = tileCountX * tileCountY;
+    Rectangle *rects = (Rectangle *)malloc((totalTiles > 0 ? totalTiles : 1) * sizeof(Rectangle));
+    if (!rects)
+    {
+        return;
+    }
+    memcpy(rects, tileRects, totalTiles * sizeof(Rectangle));
+
+    if (tilemap->atlasPage < 0)
+        UnloadTexture(tilemap->texture); // Its atlas region, if any, is simply left unused
+    free(tilemap->tileRects);
+
+    tilemap->texture = UploadAssetTexture(tilemapImage, record);
+    tilemap->atlasPage = -1;
+    tilemap->tileRects = rects;
+    tilemap->tileCountX = tileCountX;
+    tilemap->tileCountY = tileCountY;
+    tilemap->totalTiles = totalTiles;
+    if (tilemap->currentTileIndex >= totalTiles)
+        tilemap->currentTileIndex = 0;
 }
 
+// Draw one tile. Consecutive tiles from the same tilemap share a texture, so raylib batches them.
+void DrawTilemapTile(const Tilemap *tilemap, int tileIndex, Vector2 position, Color tint)
+{
+    if (tileIndex < 0 || tileIndex >= tilemap->totalTiles)
+    {
+        return;
+    }
+    DrawTextureRec(tilemap->texture, tilemap->tileRects[tileIndex], position, tint);
+}
 
 // Update the tilemap (e.g., switch between tiles with arrow keys)
 void UpdateTilemap(Tilemap *tilemap)
@@ -85,12 +177,15 @@ void UpdateTilemap(Tilemap *tilemap)
     }
 }
 
-// Unload all textures in the tilemap and free memory
+// Unload every tilemap texture and free the rectangle tables
 void UnloadTilemap()
 {
-    for (int i = 0; i < manager.tilemap->totalTiles; i++)
+    for (int i = 0; i < manager.tilemapCount; i++)
     {
-        UnloadTexture(manager.tilemap->tiles[i]);
+        if (manager.tilemap[i].atlasPage < 0)
+            UnloadTexture(manager.tilemap[i].texture); // Atlas pages are released by UnloadAssets
+        free(manager.tilemap[i].tileRects);
+        manager.tilemap[i].tileRects = NULL;
     }
-    free(manager.tilemap->tiles);
-}
\ No newline at end of file
+    manager.tilemapCount = 0;
+}
@@ -1,16 +1,28 @@
 #pragma once
 #include "raylib.h"
+#include "asset_loader.h"
+
+#define TILEMAP_TILE_SIZE 64 // Tile size in pixels used to slice every *Tilemap*.png
 
 typedef struct Tilemap
 {
-    Texture2D *tiles;     // Array of tile textures
+    Texture2D texture;    // The whole tilemap sheet; every tile draws from it so draws batch
+    Rectangle *tileRects; // Source rectangle of each tile within texture
     int tileCountX;       // Number of tiles horizontally
     int tileCountY;       // Number of tiles vertically
     int totalTiles;       // Total number of tiles
     int currentTileIndex; // Currently selected tile index
+    int atlasPage;        // Atlas page holding the tiles, or -1 if the tilemap has its own texture
+    char name[64];        // Name parsed from the file name; hot reload finds the tilemap by it
 } Tilemap;
 
 // Function declarations
 void LoadTilemap(const char *filePath, int tileSize);
+void LoadTilemapFromImage(const char *name, Image tilemapImage, const Rectangle *tileRects, int tileCountX, int tileCountY,
+                          AssetLoadRecord *record);
+void ReloadTilemapFromImage(const char *name, Image tilemapImage, const Rectangle *tileRects, int tileCountX, int tileCountY,
+                            AssetLoadRecord *record);
+Rectangle *SliceTilemap(int imageWidth, int imageHeight, int tileSize, int *tileCountX, int *tileCountY);
+void DrawTilemapTile(const Tilemap *tilemap, int tileIndex, Vector2 position, Color tint);
 void UpdateTilemap(Tilemap *tilemap);
 void UnloadTilemap();
@@ -0,0 +1,118 @@
+// worker_pool.c
+
+#include "worker_pool.h"
+#include <stdio.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+static void *PoolThread(void *arg)
+{
+    WorkerSlot *slot = arg;
+    WorkerPool *pool = slot->pool;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;)
+    {
+        while (!pool->stopping && pool->generation == slot->seenGeneration)
+        {
+            pthread_cond_wait(&pool->start, &pool->lock);
+        }
+        if (pool->stopping)
+            break;
+        slot->seenGeneration = pool->generation;
+        WorkerJob job = pool->job;
+        void *data = pool->data;
+        pthread_mutex_unlock(&pool->lock);
+
+        job(data, slot->worker, pool->workerCount);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->running == 0)
+            pthread_cond_signal(&pool->done);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+int InitWorkerPool(WorkerPool *pool, int workerCount)
+{
+    memset(pool, 0, sizeof(WorkerPool));
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    pool->workerCount = 1;
+
+    if (workerCount > MAX_POOL_WORKERS)
+        workerCount = MAX_POOL_WORKERS;
+    for (int i = 1; i < workerCount; i++)
+    {
+        // Worker indices stay contiguous even if a thread fails to start
+        WorkerSlot *slot = &pool->slots[pool->workerCount];
+        *slot = (WorkerSlot){pool, pool->workerCount, 0};
+        if (pthread_create(&pool->threads[pool->workerCount], NULL, PoolThread, slot) != 0)
+        {
+            fprintf(stderr, "Failed to start worker thread %d; continuing with %d.\n", i, pool->workerCount);
+            break;
+        }
+        pool->workerCount++;
+    }
+    return pool->workerCount;
+}
+
+void FreeWorkerPool(WorkerPool *pool)
+{
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 1; i < pool->workerCount; i++)
+    {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->start);
+    pthread_mutex_destroy(&pool->lock);
+    memset(pool, 0, sizeof(WorkerPool));
+}
+
+void RunWorkerPool(WorkerPool *pool, WorkerJob job, void *data)
+{
+    if (pool->workerCount <= 1)
+    {
+        job(data, 0, 1);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->job = job;
+    pool->data = data;
+    pool->running = pool->workerCount - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    job(data, 0, pool->workerCount);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->running > 0)
+    {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+int GetDefaultWorkerCount(void)
+{
+#if defined(_WIN32)
+    int cpuCount = 4;
+#else
+    int cpuCount = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if (cpuCount < 1)
+        cpuCount = 1;
+    return cpuCount > MAX_POOL_WORKERS ? MAX_POOL_WORKERS : cpuCount;
+}
@@ -0,0 +1,47 @@
+// worker_pool.h
+
+#pragma once
+
+#include <pthread.h>
+#include <stdbool.h>
+
+#define MAX_POOL_WORKERS 16
+
+// Runs one job on every worker: worker is in [0, workerCount), and the calling thread is worker 0
+typedef void (*WorkerJob)(void *data, int worker, int workerCount);
+
+typedef struct WorkerPool WorkerPool;
+
+typedef struct WorkerSlot
+{
+    WorkerPool *pool;
+    int worker;
+    unsigned int seenGeneration;
+} WorkerSlot;
+
+// Persistent threads for work that is dispatched many times a second (a simulation tick), where
+// starting threads per dispatch would cost more than the work. Jobs split work by worker index,
+// so which thread runs a range never changes what the range computes.
+struct WorkerPool
+{
+    int workerCount; // Including the calling thread
+    pthread_t threads[MAX_POOL_WORKERS];
+    WorkerSlot slots[MAX_POOL_WORKERS];
+
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    unsigned int generation; // Bumped once per RunWorkerPool
+    int running;             // Threads still working on the current generation
+    bool stopping;
+    WorkerJob job;
+    void *data;
+};
+
+// Starts workerCount - 1 threads. Returns the worker count actually available (at least 1).
+int InitWorkerPool(WorkerPool *pool, int workerCount);
+void FreeWorkerPool(WorkerPool *pool);
+// Runs job on every worker and returns once all of them have finished
+void RunWorkerPool(WorkerPool *pool, WorkerJob job, void *data);
+
+int GetDefaultWorkerCount(void);
@@ -4,14 +4,17 @@
 #include <stdlib.h>
 #include <time.h>
 #include <string.h>
+#include <pthread.h>
 
 FILE *logFile;
+static pthread_mutex_t logLock = PTHREAD_MUTEX_INITIALIZER; // Asset loader threads log too
 
 void CustomTraceLog(int logType, const char *text, va_list args)
 {
     if (logFile == NULL)
         return;
 
+    pthread_mutex_lock(&logLock);
     time_t now = time(NULL);
     char *timeStr = ctime(&now);
     timeStr[strlen(timeStr) - 1] = '\0'; // Remove the newline character
@@ -19,6 +22,7 @@ void CustomTraceLog(int logType, const char *text, va_list args)
     fprintf(logFile, "%s [%d] ", timeStr, logType);
     vfprintf(logFile, text, args);
     fprintf(logFile, "\n");
+    pthread_mutex_unlock(&logLock);
 }
 
 int main(void)
@@ -42,6 +46,7 @@ int main(void)
         UpdateCurrentScene(deltaTime);
     }
 
+    UnloadSceneManager();
     CloseWindow();
     return 0;
 }
@@ -7,6 +7,7 @@
 #include <stdlib.h>
 #include <time.h>
 #include "asset_manager.h"
+#include "asset_registry.h"
 
 int currentAssetIndex = 0;     // Tracks the currently displayed asset
 bool displayingSprites = true; // Flag to determine if displaying sprites or animations
@@ -15,12 +16,17 @@ AssetManager manager;
 
 void InitDebugScene()
 {
-    InitAssetManager(&manager);
-    // Load all assets from the directory
-    LoadAssetsFromDirectory(&manager, ASSET_PATH);
+    // Load all assets from the baked pack, or from the directory if there is none; later scenes reuse them
+    AcquireAssets(ASSET_BUNDLE_GAME);
+    PrintAssetRegistryStats(stdout); // Loads stay at 1 per bundle however often scenes change
     // Load assets/shaders/set shader values, for the scene here, place objects
 }
 
+void UnloadDebugScene()
+{
+    ReleaseAssets(ASSET_BUNDLE_GAME);
+}
+
 void UpdateDebugScene(float deltaTime)
 {
     UpdateAnimations(&manager, deltaTime);
@@ -80,7 +86,7 @@ void RenderDebugScene()
     if (displayingSprites && currentAssetIndex < manager.spriteCount)
     {
         Sprite *sprite = &manager.sprites[currentAssetIndex];
-        DrawTexture(sprite->texture, 100, 100, RAYWHITE); // Draw sprite
+        DrawSprite(sprite, (Vector2){100, 100}, RAYWHITE); // Draw sprite
 
         // Draw the name above the sprite if the flag is set
         if (sprite->drawName)
@@ -90,8 +96,8 @@ void RenderDebugScene()
     }
     else if (!displayingSprites && currentAssetIndex < manager.animationCount)
     {
-        Animation *anim = &manager.animations[currentAssetIndex];
-        DrawTextureRec(anim->texture, anim->frames[anim->currentFrame], (Vector2){100, 100}, RAYWHITE); // Draw current animation frame
+        AnimationClip *anim = &manager.animations[currentAssetIndex];
+        DrawAnimationFrame(anim, GetSharedAnimationFrame(&manager, anim), (Vector2){100, 100}, RAYWHITE); // Draw current animation frame
 
         // Draw the name above the animation if the flag is set
         if (anim->drawName)
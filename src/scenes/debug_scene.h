@@ -8,3 +8,6 @@ void UpdateDebugScene(float deltaTime);
 
 // Renders the debug scene, drawing all game objects and UI elements
 void RenderDebugScene();
+
+// Releases the scene's hold on its assets
+void UnloadDebugScene();
@@ -153,5 +153,5 @@ void RenderMainMenuScene()
 
 void UnloadMainMenuScene()
 {
-    // No resources to unload for the main menu
+    UnloadFont(font);
 }
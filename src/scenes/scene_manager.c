@@ -4,6 +4,8 @@
 #include "tile_placement_scene.h"
 #include "test_map_scene.h"
 #include "main_menu_scene.h"
+#include "asset_registry.h"
+#include "asset_watch.h"
 
 static GameScene currentScene;
 
@@ -13,8 +15,31 @@ void InitSceneManager()
     InitMainMenuScene();
 }
 
+// Gives back what the scene's Init took; assets stay resident in the registry
+static void UnloadScene(GameScene scene)
+{
+    switch (scene)
+    {
+    case SCENE_DEBUG:
+        UnloadDebugScene();
+        break;
+    case SCENE_TILE_PLACEMENT:
+        UnloadTilePlacementScene();
+        break;
+    case SCENE_TEST:
+        UnloadTestMapScene();
+        break;
+    case SCENE_MAIN_MENU:
+        UnloadMainMenuScene();
+        break;
+    default:
+        break;
+    }
+}
+
 void ChangeScene(GameScene newScene)
 {
+    UnloadScene(currentScene);
     currentScene = newScene;
 
     switch (currentScene)
@@ -34,8 +59,17 @@ void ChangeScene(GameScene newScene)
     }
 }
 
+void UnloadSceneManager()
+{
+    UnloadScene(currentScene);
+    ShutdownAssetRegistry();
+}
+
 void UpdateCurrentScene(float deltaTime)
 {
+    // Rendering of the last frame has finished, so edited art can be swapped in now
+    ApplyAssetReloads(&manager);
+
     switch (currentScene)
     {
     case SCENE_DEBUG:
@@ -51,6 +85,12 @@ void UpdateCurrentScene(float deltaTime)
         UpdateMainMenuScene(deltaTime);
         break;
     }
+
+    // Escape returns to the menu (the exit key is KEY_DELETE)
+    if (currentScene != SCENE_MAIN_MENU && IsKeyPressed(KEY_ESCAPE))
+    {
+        ChangeScene(SCENE_MAIN_MENU);
+    }
 }
 
 void RenderCurrentScene()
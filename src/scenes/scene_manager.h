@@ -27,3 +27,4 @@ void InitSceneManager();
 void ChangeScene(GameScene newScene);
 void UpdateCurrentScene(float deltaTime);
 void RenderCurrentScene();
+void UnloadSceneManager();
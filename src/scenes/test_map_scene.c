@@ -7,12 +7,15 @@
 #include <stdlib.h>
 #include <time.h>
 #include "asset_manager.h"
+#include "asset_registry.h"
 #include "tile_placement_data.h"
-#include "npc.h"
+#include "npc_store.h"
+#include "pick_index.h"
 #include "raylib_utils.h"
 #include "buildings.h"
 #include "custom_cursor.h"
 #include "resources.h"
+#include "sim_clock.h"
 
 #define MAX_BUILDINGS 5
 
@@ -23,37 +26,22 @@ static bool isSelecting = false;     // Whether a selection box is active
 static Vector2 selectionStart;       // Start point of the drag
 static Vector2 selectionEnd;         // End point of the drag
 Resources playerResources;
+static SimClock simClock;            // Buildings and NPCs advance in fixed ticks of this clock
+static PickIndex pickIndex;          // NPC and building boxes for this frame's mouse input
 
 // Global variables for NPCs and buildings
-NPC npcs[MAX_NPCS];
+NPCStore npcs;
 
 Building buildings[MAX_BUILDINGS];
 int buildingCount = 0; // Current number of buildings
 
+// Reads only the bitmap words under the square, wherever it is on the map
 bool CheckCollisionWithTiles(Rectangle square)
 {
-    for (int y = 0; y < screenTilesY; y++)
-    {
-        for (int x = 0; x < screenTilesX; x++)
-        {
-            TileStack *stack = &placedTiles[y][x];
-            for (int i = 0; i < stack->count; i++)
-            {
-                if (stack->isCollidable[i])
-                {
-                    Rectangle tileRect = {x * tileSize, y * tileSize, tileSize, tileSize};
-                    if (CheckCollisionRecs(square, tileRect))
-                    {
-                        return true; // Collision detected
-                    }
-                }
-            }
-        }
-    }
-    return false; // No collision
+    return CheckCollisionMapRec(&tileCollisionMap, square);
 }
 
-void UpdateDragSelection(NPC *npcs, int npcCount)
+void UpdateDragSelection(NPCStore *npcs, PickIndex *picks)
 {
     Vector2 mousePosition = GetMousePosition();
 
@@ -79,16 +67,12 @@ void UpdateDragSelection(NPC *npcs, int npcCount)
             fabs(selectionEnd.x - selectionStart.x),
             fabs(selectionEnd.y - selectionStart.y)};
 
-        // Check which NPCs are within the selection box
-        for (int i = 0; i < npcCount; i++)
+        // Select the NPCs within the selection box
+        const PickHit *hits;
+        int count = QueryPickRect(picks, selectionBox, PICK_NPC, &hits);
+        for (int i = 0; i < count; i++)
         {
-            NPC *npc = &npcs[i];
-            Rectangle npcBoundingBox = npc->boundingBox;
-
-            if (CheckCollisionRecs(selectionBox, npcBoundingBox))
-            {
-                npc->isSelected = true;
-            }
+            npcs->cold[hits[i].index].isSelected = true;
         }
         isSelecting = false; // Reset selection box
     }
@@ -96,9 +80,8 @@ void UpdateDragSelection(NPC *npcs, int npcCount)
 
 void InitTestMapScene()
 {
-    InitAssetManager(&manager);
-    LoadAssetsFromDirectory(&manager, ASSET_PATH);
-    LoadNewAssets(&manager, "../assets/Tiny Swords (Update 010)/");
+    AcquireAssets(ASSET_BUNDLE_GAME);
+    AcquireAssets(ASSET_BUNDLE_NEW);
     int screenWidth = GetScreenWidth();
     int screenHeight = GetScreenHeight();
     InitCustomCursor(&manager);
@@ -115,12 +98,19 @@ void InitTestMapScene()
     playerResources.wood = 150; // Example values
     playerResources.gold = 200;
 
+    InitSimClock(&simClock, SIM_TICKS_PER_SECOND);
+    InitPickIndex(&pickIndex);
+
+    // Large armies update on every core; below NPC_PARALLEL_MIN_COUNT the store stays serial
+    SetNPCStoreThreadCount(&npcs, GetDefaultWorkerCount());
+
     // Initialize an NPC if there is room
-    if (npcCount < MAX_NPCS)
+    if (npcs.count < MAX_NPCS)
     {
-        InitNPC(&npcs[npcCount], &manager, (Vector2){300, 300}, 100.0f, "WarriorRed_1");
-        npcs[npcCount].drawName = true;
-        npcCount++;
+        NPC npc;
+        InitNPC(&npc, &manager, (Vector2){300, 300}, 100.0f, "WarriorRed_1");
+        npc.drawName = true;
+        AddNPCToStore(&npcs, &npc);
     }
 
     // Initialize a building if there is room
@@ -131,12 +121,27 @@ void InitTestMapScene()
     }
 }
 
+// P pauses, = and - double and halve the simulation speed (1/4x to 8x)
+static void UpdateSimControls(void)
+{
+    if (IsKeyPressed(KEY_P))
+        SetSimClockPaused(&simClock, !simClock.paused);
+    if (IsKeyPressed(KEY_EQUAL) && simClock.timeScale < 8.0f)
+        SetSimClockTimeScale(&simClock, simClock.timeScale * 2.0f);
+    if (IsKeyPressed(KEY_MINUS) && simClock.timeScale > 0.25f)
+        SetSimClockTimeScale(&simClock, simClock.timeScale * 0.5f);
+}
+
+// deltaTime is the real frame time. Input and the player's square run once per frame; the
+// simulation runs in fixed ticks of the scene's clock, scaled and paused by the sim controls.
 void UpdateTestMapScene(float deltaTime)
 {
     squareBounds = (Rectangle){squarePosition.x, squarePosition.y, 50, 50}; // Update square bounds
 
     UpdateAnimations(&manager, deltaTime);
-    UpdateCustomCursor(npcs, npcCount, buildings, buildingCount);
+    // Hover, clicks and drag selection all pick from one index of where things stand this frame
+    BuildPickIndex(&pickIndex, &npcs, buildings, buildingCount);
+    UpdateCustomCursor(&pickIndex);
 
     Vector2 newPosition = squarePosition;
     if (IsKeyDown(KEY_W))
@@ -160,24 +165,29 @@ void UpdateTestMapScene(float deltaTime)
 
     // Handle building selection
     // Check building clicks after NPCs for exclusive handling
-    HandleBuildingClick(buildings, buildingCount, npcs, npcCount, mousePosition, mousePressed);
-
-    // Update Buildings
-    for (int i = 0; i < buildingCount; i++)
-    {
-        UpdateBuilding(&buildings[i], npcs, &npcCount, &manager, deltaTime);
-    }
+    HandleBuildingClick(buildings, buildingCount, &npcs, &pickIndex, mousePosition, mousePressed);
 
     // Handle mouse input for NPC selection and movement
-    HandleNPCMouseInput(npcs, npcCount, mousePosition, mousePressed);
+    HandleNPCMouseInput(&npcs, &pickIndex, mousePosition, mousePressed);
+    UpdateDragSelection(&npcs, &pickIndex);
 
-    // Update NPCs
-    for (int i = 0; i < npcCount; i++)
+    UpdateSimControls();
+    int ticks = AdvanceSimClock(&simClock, deltaTime);
+    for (int tick = 0; tick < ticks; tick++)
     {
-        UpdateNPC(&npcs[i], npcs, deltaTime);
+        // Update Buildings
+        for (int i = 0; i < buildingCount; i++)
+        {
+            UpdateBuilding(&buildings[i], &npcs, &manager, simClock.tickSeconds);
+        }
+
+        // Update NPCs
+        UpdateNPCStore(&npcs, simClock.tickSeconds);
     }
 
-    UpdateDragSelection(npcs, npcCount);
+    // Advance every NPC and building animation in one pass; they follow sim speed but play
+    // per frame so they stay smooth between ticks
+    TickAnimationPlayers(&manager, GetSimClockFrameTime(&simClock, deltaTime));
 }
 
 void RenderTestMapScene()
@@ -185,38 +195,40 @@ void RenderTestMapScene()
     ClearBackground(GetColorFromHex("#47aaa9"));
 
     // Draw placed tiles and sprites on the grid
-    for (int y = 0; y < screenTilesY; y++)
+    for (int y = 0; y < screenTilesY && y < mapTilesY; y++)
     {
-        for (int x = 0; x < screenTilesX; x++)
+        for (int x = 0; x < screenTilesX && x < mapTilesX; x++)
         {
-            TileStack *stack = &placedTiles[y][x];
-            for (int i = 0; i < stack->count; i++)
+            TileSpan span = GetTileSpan(x, y);
+            for (int i = 0; i < span.count; i++)
             {
-                int tilemapIndex = stack->tiles[i] / 1000;
-                int tileIndex = stack->tiles[i] % 1000;
+                TileRef ref = GetTileEntryRef(span.entries[i]);
+                int tilemapIndex = GetTileRefSource(ref);
+                int tileIndex = GetTileRefIndex(ref);
 
-                if (tileIndex < manager.tilemap[tilemapIndex].totalTiles)
+                if (GetTileRefKind(ref) == TILE_REF_TILE && tilemapIndex < manager.tilemapCount &&
+                    tileIndex < manager.tilemap[tilemapIndex].totalTiles)
                 {
-                    DrawTexture(manager.tilemap[tilemapIndex].tiles[tileIndex], x * tileSize, y * tileSize, WHITE);
+                    DrawTilemapTile(&manager.tilemap[tilemapIndex], tileIndex, (Vector2){x * tileSize, y * tileSize}, WHITE);
                 }
             }
         }
     }
 
     // Draw sprites on top of the tiles
-    for (int y = 0; y < screenTilesY; y++)
+    for (int y = 0; y < screenTilesY && y < mapTilesY; y++)
     {
-        for (int x = 0; x < screenTilesX; x++)
+        for (int x = 0; x < screenTilesX && x < mapTilesX; x++)
         {
-            TileStack *stack = &placedTiles[y][x];
-            for (int i = 0; i < stack->count; i++)
+            TileSpan span = GetTileSpan(x, y);
+            for (int i = 0; i < span.count; i++)
             {
-                int tilemapIndex = stack->tiles[i] / 1000;
-                int tileIndex = stack->tiles[i] % 1000;
+                TileRef ref = GetTileEntryRef(span.entries[i]);
+                int spriteIndex = GetTileRefSource(ref);
 
-                if (tileIndex >= manager.tilemap[tilemapIndex].totalTiles)
+                if (GetTileRefKind(ref) == TILE_REF_SPRITE && spriteIndex < manager.spriteCount)
                 {
-                    DrawTexture(manager.sprites[tileIndex - manager.tilemap[tilemapIndex].totalTiles].texture, x * tileSize, y * tileSize, WHITE);
+                    DrawSprite(&manager.sprites[spriteIndex], (Vector2){x * tileSize, y * tileSize}, WHITE);
                 }
             }
         }
@@ -227,28 +239,23 @@ void RenderTestMapScene()
     {
         for (int x = 0; x < mapTilesX; x++)
         {
-            TileStack *stack = &placedTiles[y][x];
-            for (int i = 0; i < stack->count; i++)
+            TileSpan span = GetTileSpan(x, y);
+            for (int i = 0; i < span.count; i++)
             {
-                int tilemapIndex = stack->tiles[i] / 1000;
-                int tileIndex = stack->tiles[i] % 1000;
-                int animationIndex = tileIndex - manager.tilemap[tilemapIndex].totalTiles - manager.spriteCount;
+                TileRef ref = GetTileEntryRef(span.entries[i]);
+                int animationIndex = GetTileRefSource(ref);
 
-                if (animationIndex >= 0 && animationIndex < manager.animationCount)
+                if (GetTileRefKind(ref) == TILE_REF_ANIMATION && animationIndex < manager.animationCount)
                 {
-                    Animation *anim = &manager.animations[animationIndex];
-                    Rectangle currentFrame = anim->frames[anim->currentFrame];
-                    DrawTextureRec(anim->texture, currentFrame, (Vector2){x * tileSize, y * tileSize}, WHITE);
+                    AnimationClip *anim = &manager.animations[animationIndex];
+                    DrawAnimationFrame(anim, GetSharedAnimationFrame(&manager, anim), (Vector2){x * tileSize, y * tileSize}, WHITE);
                 }
             }
         }
     }
 
-    // Draw NPCs on top of the tiles
-    for (int i = 0; i < npcCount; i++)
-    {
-        DrawNPC(&npcs[i]);
-    }
+    // Draw NPCs on top of the tiles, between their last two tick positions
+    DrawNPCStore(&npcs, simClock.alpha);
 
     // Draw Buildings and selection UI
     for (int i = 0; i < buildingCount; i++)
@@ -262,6 +269,12 @@ void RenderTestMapScene()
 
     DrawResources(&playerResources, GetScreenWidth());
 
+    char simText[96];
+    NPCStoreStats npcStats = GetNPCStoreStats(&npcs);
+    snprintf(simText, sizeof(simText), "Sim %d Hz  x%g%s  NPCs %d awake, %d asleep", (int)(1.0f / simClock.tickSeconds + 0.5f),
+             simClock.timeScale, simClock.paused ? "  PAUSED" : "", npcStats.awake, npcStats.asleep);
+    DrawText(simText, 10, GetScreenHeight() - 30, 20, RAYWHITE);
+
     // Draw the controllable square
     DrawRectangle(squarePosition.x, squarePosition.y, 50, 50, BLUE);
 
@@ -280,3 +293,19 @@ void RenderTestMapScene()
 
     DrawCustomCursor();
 }
+
+void UnloadTestMapScene()
+{
+    // Units are recreated by the next Init; the assets they reference stay resident
+    FreeNPCStore(&npcs);
+    FreePickIndex(&pickIndex);
+    ResetFlowFields();
+    ResetPathGraph();
+    buildingCount = 0;
+    ResetAnimationPlayers();
+    isSelecting = false;
+    FreeTileData();
+    UnloadCustomCursor();
+    ReleaseAssets(ASSET_BUNDLE_NEW);
+    ReleaseAssets(ASSET_BUNDLE_GAME);
+}
@@ -7,4 +7,7 @@ void InitTestMapScene();
 void UpdateTestMapScene(float deltaTime);
 
 // Renders the debug scene, drawing all game objects and UI elements
-void RenderTestMapScene();
\ No newline at end of file
+void RenderTestMapScene();
+
+// Frees the scene's map and units and releases its assets
+void UnloadTestMapScene();
@@ -3,6 +3,7 @@
 #include "tile_placement_scene.h"
 #include "tilemap.h"
 #include "asset_manager.h"
+#include "asset_registry.h"
 #include <stdlib.h>
 #include <dirent.h>
 #include "tile_placement_data.h"
@@ -12,7 +13,6 @@
 
 // External Variables
 extern AssetManager manager;
-extern TileStack **placedTiles;
 extern Rectangle saveButton;
 extern Rectangle loadButton;
 extern int screenTilesX;
@@ -40,9 +40,8 @@ void UnloadTilePlacementScene();
 
 void InitTilePlacementScene()
 {
-    InitAssetManager(&manager);
-    LoadAssetsFromDirectory(&manager, ASSET_PATH);
-    LoadNewAssets(&manager, "../assets/Tiny Swords (Update 010)/");
+    AcquireAssets(ASSET_BUNDLE_GAME);
+    AcquireAssets(ASSET_BUNDLE_NEW);
     int screenWidth = GetScreenWidth();
     int screenHeight = GetScreenHeight();
 
@@ -56,7 +55,7 @@ void InitTilePlacementScene()
     camera.zoom = 1.0f;
 
     // Log tile information
-    if (manager.tilemap && manager.tilemap->tiles)
+    if (manager.tilemapCount > 0)
     {
         for (int i = 0; i < manager.tilemapCount; i++)
         {
@@ -67,7 +66,7 @@ void InitTilePlacementScene()
             }
             else
             {
-                printf("No tiles loaded in manager.tilemap[%d].tiles.\n", i);
+                printf("No tiles loaded in manager.tilemap[%d].\n", i);
             }
         }
     }
@@ -117,33 +116,37 @@ void UpdateTilePlacementScene(float deltaTime)
     {
         if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON))
         {
-            int tileIndex = -1;
+            bool placing = true;
+            TileRef ref = 0;
 
             if (selectedTileIndex >= 0 && selectedTileIndex < manager.tilemap[selectedTilemapIndex].totalTiles)
             {
-                tileIndex = (selectedTilemapIndex * 1000) + selectedTileIndex;
+                ref = MakeTileRef(TILE_REF_TILE, selectedTilemapIndex, selectedTileIndex);
             }
             else if (selectedSpriteIndex >= 0 && selectedSpriteIndex < manager.spriteCount)
             {
-                tileIndex = (selectedTilemapIndex * 1000) + manager.tilemap[selectedTilemapIndex].totalTiles + selectedSpriteIndex;
+                ref = MakeTileRef(TILE_REF_SPRITE, selectedSpriteIndex, 0);
             }
             else if (selectedAnimationIndex >= 0 && selectedAnimationIndex < manager.animationCount)
             {
-                tileIndex = (selectedTilemapIndex * 1000) + manager.tilemap[selectedTilemapIndex].totalTiles + manager.spriteCount + selectedAnimationIndex;
+                ref = MakeTileRef(TILE_REF_ANIMATION, selectedAnimationIndex, 0);
+            }
+            else
+            {
+                placing = false;
             }
 
-            if (tileIndex != -1)
+            if (placing)
             {
-                printf("Placing tile at (%d, %d) with tileIndex: %d\n", tileX, tileY, tileIndex);
-                PushTileToStack(&placedTiles[tileY][tileX], tileIndex, isTileCollidable);
+                printf("Placing tile at (%d, %d) with ref: 0x%08x\n", tileX, tileY, (unsigned int)ref);
+                PushTile(tileX, tileY, ref, isTileCollidable);
             }
         }
         if (IsMouseButtonPressed(MOUSE_RIGHT_BUTTON))
         {
             // Remove the top tile from the stack if it exists
-            if (placedTiles[tileY][tileX].count > 0)
+            if (PopTile(tileX, tileY))
             {
-                placedTiles[tileY][tileX].count--;
                 printf("Removed top tile from (%d, %d)\n", tileX, tileY);
             }
         }
@@ -228,21 +231,18 @@ void RenderTilePlacementScene()
     {
         for (int x = 0; x < mapTilesX; x++)
         {
-            TileStack *stack = &placedTiles[y][x];
-
-            for (int i = 0; i < stack->count; i++)
+            TileSpan span = GetTileSpan(x, y);
+            for (int i = 0; i < span.count; i++)
             {
-                int tilemapIndex = stack->tiles[i] / 1000;
-                int tileIndex = stack->tiles[i] % 1000;
+                TileRef ref = GetTileEntryRef(span.entries[i]);
+                int animationIndex = GetTileRefSource(ref);
 
-                int animationIndex = tileIndex - manager.tilemap[tilemapIndex].totalTiles - manager.spriteCount;
-                if (animationIndex >= 0 && animationIndex < manager.animationCount)
+                if (GetTileRefKind(ref) == TILE_REF_ANIMATION && animationIndex < manager.animationCount)
                 {
-                    Animation *anim = &manager.animations[animationIndex];
+                    AnimationClip *anim = &manager.animations[animationIndex];
                     if (strcmp(anim->name, "Foam_1") == 0)
                     { // Check if the animation is "Foam"
-                        Rectangle currentFrame = anim->frames[anim->currentFrame];
-                        DrawTextureRec(anim->texture, currentFrame, (Vector2){x * tileSize, y * tileSize}, WHITE);
+                        DrawAnimationFrame(anim, GetSharedAnimationFrame(&manager, anim), (Vector2){x * tileSize, y * tileSize}, WHITE);
                     }
                 }
             }
@@ -254,15 +254,17 @@ void RenderTilePlacementScene()
     {
         for (int x = 0; x < mapTilesX; x++)
         {
-            TileStack *stack = &placedTiles[y][x];
-            for (int i = 0; i < stack->count; i++)
+            TileSpan span = GetTileSpan(x, y);
+            for (int i = 0; i < span.count; i++)
             {
-                int tilemapIndex = stack->tiles[i] / 1000;
-                int tileIndex = stack->tiles[i] % 1000;
+                TileRef ref = GetTileEntryRef(span.entries[i]);
+                int tilemapIndex = GetTileRefSource(ref);
+                int tileIndex = GetTileRefIndex(ref);
 
-                if (tileIndex < manager.tilemap[tilemapIndex].totalTiles)
+                if (GetTileRefKind(ref) == TILE_REF_TILE && tilemapIndex < manager.tilemapCount &&
+                    tileIndex < manager.tilemap[tilemapIndex].totalTiles)
                 {
-                    DrawTexture(manager.tilemap[tilemapIndex].tiles[tileIndex], x * tileSize, y * tileSize, WHITE);
+                    DrawTilemapTile(&manager.tilemap[tilemapIndex], tileIndex, (Vector2){x * tileSize, y * tileSize}, WHITE);
                 }
             }
         }
@@ -273,17 +275,15 @@ void RenderTilePlacementScene()
     {
         for (int x = 0; x < mapTilesX; x++)
         {
-            TileStack *stack = &placedTiles[y][x];
-            for (int i = 0; i < stack->count; i++)
+            TileSpan span = GetTileSpan(x, y);
+            for (int i = 0; i < span.count; i++)
             {
-                int tilemapIndex = stack->tiles[i] / 1000;
-                int tileIndex = stack->tiles[i] % 1000;
+                TileRef ref = GetTileEntryRef(span.entries[i]);
+                int spriteIndex = GetTileRefSource(ref);
 
-                if (tileIndex >= manager.tilemap[tilemapIndex].totalTiles &&
-                    tileIndex < manager.tilemap[tilemapIndex].totalTiles + manager.spriteCount)
+                if (GetTileRefKind(ref) == TILE_REF_SPRITE && spriteIndex < manager.spriteCount)
                 {
-                    int spriteIndex = tileIndex - manager.tilemap[tilemapIndex].totalTiles;
-                    DrawTexture(manager.sprites[spriteIndex].texture, x * tileSize, y * tileSize, WHITE);
+                    DrawSprite(&manager.sprites[spriteIndex], (Vector2){x * tileSize, y * tileSize}, WHITE);
                 }
             }
         }
@@ -294,20 +294,18 @@ void RenderTilePlacementScene()
     {
         for (int x = 0; x < mapTilesX; x++)
         {
-            TileStack *stack = &placedTiles[y][x];
-            for (int i = 0; i < stack->count; i++)
+            TileSpan span = GetTileSpan(x, y);
+            for (int i = 0; i < span.count; i++)
             {
-                int tilemapIndex = stack->tiles[i] / 1000;
-                int tileIndex = stack->tiles[i] % 1000;
+                TileRef ref = GetTileEntryRef(span.entries[i]);
+                int animationIndex = GetTileRefSource(ref);
 
-                int animationIndex = tileIndex - manager.tilemap[tilemapIndex].totalTiles - manager.spriteCount;
-                if (animationIndex >= 0 && animationIndex < manager.animationCount)
+                if (GetTileRefKind(ref) == TILE_REF_ANIMATION && animationIndex < manager.animationCount)
                 {
-                    Animation *anim = &manager.animations[animationIndex];
+                    AnimationClip *anim = &manager.animations[animationIndex];
                     if (strcmp(anim->name, "Foam_1") != 0)
                     { // Skip "Foam" in this pass
-                        Rectangle currentFrame = anim->frames[anim->currentFrame];
-                        DrawTextureRec(anim->texture, currentFrame, (Vector2){x * tileSize, y * tileSize}, WHITE);
+                        DrawAnimationFrame(anim, GetSharedAnimationFrame(&manager, anim), (Vector2){x * tileSize, y * tileSize}, WHITE);
                     }
                 }
             }
@@ -331,22 +329,22 @@ void RenderTilePlacementScene()
     if (selectedTileIndex >= 0 && selectedTileIndex < manager.tilemap[selectedTilemapIndex].totalTiles)
     {
         // Display the selected tile from the currently selected tilemap
-        DrawTexture(manager.tilemap[selectedTilemapIndex].tiles[selectedTileIndex],
-                    worldMousePos.x - tileSize / 2,
-                    worldMousePos.y - tileSize / 2, Fade(WHITE, 0.5f)); // Apply transparency
+        DrawTilemapTile(&manager.tilemap[selectedTilemapIndex], selectedTileIndex,
+                        (Vector2){worldMousePos.x - tileSize / 2, worldMousePos.y - tileSize / 2},
+                        Fade(WHITE, 0.5f)); // Apply transparency
     }
     else if (selectedSpriteIndex >= 0 && selectedSpriteIndex < manager.spriteCount)
     {
         // Display the selected sprite
-        DrawTexture(manager.sprites[selectedSpriteIndex].texture,
-                    worldMousePos.x - tileSize / 2,
-                    worldMousePos.y - tileSize / 2, Fade(WHITE, 0.5f)); // Apply transparency
+        DrawSprite(&manager.sprites[selectedSpriteIndex],
+                   (Vector2){worldMousePos.x - tileSize / 2, worldMousePos.y - tileSize / 2},
+                   Fade(WHITE, 0.5f)); // Apply transparency
     }
     else if (selectedAnimationIndex >= 0)
     {
-        Animation *selectedAnim = &manager.animations[selectedAnimationIndex];
-        DrawTextureRec(selectedAnim->texture, selectedAnim->frames[selectedAnim->currentFrame],
-                       (Vector2){worldMousePos.x - tileSize / 2, worldMousePos.y - tileSize / 2}, Fade(WHITE, 0.5f)); // Apply transparency
+        AnimationClip *selectedAnim = &manager.animations[selectedAnimationIndex];
+        DrawAnimationFrame(selectedAnim, GetSharedAnimationFrame(&manager, selectedAnim), (Vector2){worldMousePos.x - tileSize / 2, worldMousePos.y - tileSize / 2},
+                           Fade(WHITE, 0.5f)); // Apply transparency
     }
 
     // End camera mode
@@ -367,9 +365,8 @@ void RenderTilePlacementScene()
     {
         int tileX = i % tileColumns;
         int tileY = i / tileColumns;
-        DrawTexture(manager.tilemap[selectedTilemapIndex].tiles[i],
-                    selectionGridX + tileX * tileSize,
-                    selectionGridY + tileY * tileSize, WHITE);
+        DrawTilemapTile(&manager.tilemap[selectedTilemapIndex], i,
+                        (Vector2){selectionGridX + tileX * tileSize, selectionGridY + tileY * tileSize}, WHITE);
     }
 
     if (showControls)
@@ -425,4 +422,6 @@ void RenderTilePlacementScene()
 void UnloadTilePlacementScene()
 {
     FreeTileData(); // Utilize the existing function to free all tile data
+    ReleaseAssets(ASSET_BUNDLE_NEW);
+    ReleaseAssets(ASSET_BUNDLE_GAME);
 }
\ No newline at end of file
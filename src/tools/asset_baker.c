@@ -0,0 +1,268 @@
+// asset_baker.c
+//
+// Offline asset baker. Does the expensive part of LoadAssetsFromDirectory once: walks
+// the asset tree, decodes every PNG, parses frame layouts from the file names, finds
+// blank frames and slices tilemaps, then writes a single pack for LoadAssetPack.
+//
+//   asset_baker [-z] [asset directory] [output pack]
+//
+// -z stores DEFLATE-compressed pixels (smaller file, slower load). Runs without a window.
+
+#include "asset_manager.h"
+#include "asset_loader.h"
+#include "asset_pack.h"
+#include "tilemap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+AssetManager manager;
+
+typedef struct BakedPayload
+{
+    unsigned char *data;
+    uint32_t size;
+    bool ownedByRaylib; // CompressData output must be released with MemFree
+} BakedPayload;
+
+typedef struct PackBuilder
+{
+    AssetPackEntry *entries;
+    BakedPayload *payloads;
+    int entryCount;
+    AssetPackRow *rows;
+    int rowCount;
+    Rectangle *rects;
+    int rectCount;
+    bool compress;
+    uint64_t pixelBytes;
+} PackBuilder;
+
+static double NowSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint32_t AddRow(PackBuilder *pack, const Rectangle *rects, int rectCount)
+{
+    pack->rows = realloc(pack->rows, (pack->rowCount + 1) * sizeof(AssetPackRow));
+    pack->rows[pack->rowCount] = (AssetPackRow){pack->rectCount, rectCount};
+
+    pack->rects = realloc(pack->rects, (pack->rectCount + rectCount + 1) * sizeof(Rectangle));
+    memcpy(&pack->rects[pack->rectCount], rects, rectCount * sizeof(Rectangle));
+    pack->rectCount += rectCount;
+    return pack->rowCount++;
+}
+
+// Pipeline handler: runs on the main thread in file order, so the table of contents is
+// deterministic no matter how many decode threads were used
+static void BakeDecodedAsset(DecodedAsset *asset, void *userData)
+{
+    PackBuilder *pack = userData;
+    if (asset->image.data == NULL)
+    {
+        fprintf(stderr, "Failed to decode %s, skipping.\n", asset->filePath);
+        return;
+    }
+
+    AssetPackEntry entry = {0};
+    memcpy(entry.name, asset->name, sizeof(entry.name));
+    entry.kind = asset->kind;
+    entry.width = asset->image.width;
+    entry.height = asset->image.height;
+    entry.firstRow = pack->rowCount;
+
+    if (asset->kind == ASSET_KIND_ANIMATION)
+    {
+        entry.framesPerRow = asset->framesPerRow;
+        entry.frameWidth = asset->frameWidth;
+        entry.frameHeight = asset->frameHeight;
+
+        // One row per sheet row, keeping blank rows so "<name>_<row>" numbering is preserved
+        const Rectangle *rowFrames = asset->frames;
+        for (int row = 0; row < asset->rows; row++)
+        {
+            AddRow(pack, rowFrames, asset->rowFrameCounts[row]);
+            rowFrames += asset->rowFrameCounts[row];
+        }
+        entry.rowCount = asset->rows;
+    }
+    else if (asset->kind == ASSET_KIND_TILEMAP)
+    {
+        entry.framesPerRow = asset->tileCountX;
+        entry.frameWidth = TILEMAP_TILE_SIZE;
+        entry.frameHeight = TILEMAP_TILE_SIZE;
+        AddRow(pack, asset->tileRects, asset->tileCountX * asset->tileCountY);
+        entry.rowCount = 1;
+    }
+
+    BakedPayload payload = {0};
+    entry.pixelSize = asset->image.width * asset->image.height * 4;
+    if (pack->compress)
+    {
+        int compressedSize = 0;
+        payload.data = CompressData(asset->image.data, entry.pixelSize, &compressedSize);
+        payload.size = compressedSize;
+        payload.ownedByRaylib = true;
+        entry.compressed = 1;
+    }
+    else
+    {
+        payload.data = asset->image.data; // Keep the decoded pixels; freed after writing
+        payload.size = entry.pixelSize;
+        asset->image.data = NULL;
+    }
+    entry.payloadSize = payload.size;
+
+    pack->entries = realloc(pack->entries, (pack->entryCount + 1) * sizeof(AssetPackEntry));
+    pack->payloads = realloc(pack->payloads, (pack->entryCount + 1) * sizeof(BakedPayload));
+    pack->entries[pack->entryCount] = entry;
+    pack->payloads[pack->entryCount] = payload;
+    pack->entryCount++;
+    pack->pixelBytes += entry.pixelSize;
+}
+
+static uint64_t AlignUp(uint64_t value)
+{
+    return (value + ASSET_PACK_ALIGNMENT - 1) & ~(uint64_t)(ASSET_PACK_ALIGNMENT - 1);
+}
+
+static void WritePadding(FILE *file, uint64_t *offset)
+{
+    static const unsigned char zeros[ASSET_PACK_ALIGNMENT] = {0};
+    uint64_t aligned = AlignUp(*offset);
+    fwrite(zeros, 1, aligned - *offset, file);
+    *offset = aligned;
+}
+
+static bool WritePack(PackBuilder *pack, const AssetSourceStamp *sources, const char *outputPath)
+{
+    AssetPackHeader header = {0};
+    header.magic = ASSET_PACK_MAGIC;
+    header.version = ASSET_PACK_VERSION;
+    header.sourceFileCount = sources->fileCount;
+    header.sourceBytes = sources->bytes;
+    header.sourceNewest = sources->newest;
+    header.entryCount = pack->entryCount;
+    header.rowCount = pack->rowCount;
+    header.rectCount = pack->rectCount;
+    header.entryOffset = AlignUp(sizeof(AssetPackHeader));
+    header.rowOffset = AlignUp(header.entryOffset + pack->entryCount * sizeof(AssetPackEntry));
+    header.rectOffset = AlignUp(header.rowOffset + pack->rowCount * sizeof(AssetPackRow));
+
+    uint64_t payloadOffset = AlignUp(header.rectOffset + pack->rectCount * sizeof(Rectangle));
+    for (int i = 0; i < pack->entryCount; i++)
+    {
+        pack->entries[i].payloadOffset = payloadOffset;
+        payloadOffset = AlignUp(payloadOffset + pack->entries[i].payloadSize);
+    }
+    header.fileSize = payloadOffset;
+
+    // Write next to the destination and rename, so a running game never sees half a pack
+    char tempPath[512];
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", outputPath);
+    FILE *file = fopen(tempPath, "wb");
+    if (!file)
+    {
+        fprintf(stderr, "Failed to open %s for writing.\n", tempPath);
+        return false;
+    }
+
+    uint64_t offset = 0;
+    fwrite(&header, sizeof(header), 1, file);
+    offset += sizeof(header);
+    WritePadding(file, &offset);
+    fwrite(pack->entries, sizeof(AssetPackEntry), pack->entryCount, file);
+    offset += pack->entryCount * sizeof(AssetPackEntry);
+    WritePadding(file, &offset);
+    fwrite(pack->rows, sizeof(AssetPackRow), pack->rowCount, file);
+    offset += pack->rowCount * sizeof(AssetPackRow);
+    WritePadding(file, &offset);
+    fwrite(pack->rects, sizeof(Rectangle), pack->rectCount, file);
+    offset += pack->rectCount * sizeof(Rectangle);
+    WritePadding(file, &offset);
+    for (int i = 0; i < pack->entryCount; i++)
+    {
+        fwrite(pack->payloads[i].data, 1, pack->payloads[i].size, file);
+        offset += pack->payloads[i].size;
+        WritePadding(file, &offset);
+    }
+
+    bool ok = !ferror(file) && offset == header.fileSize;
+    ok &= fclose(file) == 0;
+    if (!ok || rename(tempPath, outputPath) != 0)
+    {
+        fprintf(stderr, "Failed to write %s.\n", outputPath);
+        remove(tempPath);
+        return false;
+    }
+    return true;
+}
+
+static void FreePack(PackBuilder *pack)
+{
+    for (int i = 0; i < pack->entryCount; i++)
+    {
+        if (pack->payloads[i].ownedByRaylib)
+            MemFree(pack->payloads[i].data);
+        else
+            free(pack->payloads[i].data);
+    }
+    free(pack->entries);
+    free(pack->payloads);
+    free(pack->rows);
+    free(pack->rects);
+}
+
+int main(int argc, char **argv)
+{
+    bool compress = false;
+    const char *paths[2] = {ASSET_PATH, ASSET_PACK_PATH};
+    int pathCount = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-z") == 0)
+            compress = true;
+        else if (pathCount < 2)
+            paths[pathCount++] = argv[i];
+        else
+        {
+            fprintf(stderr, "Usage: %s [-z] [asset directory] [output pack]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    SetTraceLogLevel(LOG_WARNING);
+    double startTime = NowSeconds();
+
+    // Stamped before decoding, so art edited while baking makes the pack stale, not silently baked in
+    AssetSourceStamp sources;
+    StampAssetSources(paths[0], &sources);
+    char **filePaths;
+    int fileCount = CollectAssetFiles(paths[0], &filePaths);
+    if (fileCount == 0)
+    {
+        fprintf(stderr, "No assets found in %s.\n", paths[0]);
+        return 1;
+    }
+
+    PackBuilder pack = {0};
+    pack.compress = compress;
+    AssetDecodeStats stats = DecodeAssetFiles(filePaths, fileCount, GetDefaultLoaderThreadCount(), BakeDecodedAsset, &pack);
+    FreeAssetFileList(filePaths, fileCount);
+
+    bool ok = WritePack(&pack, &sources, paths[1]);
+    if (ok)
+    {
+        printf("Baked %d files (%d frame rows, %d rects) into %s\n", pack.entryCount, pack.rowCount, pack.rectCount, paths[1]);
+        printf("  pixels: %.1f MB raw, %s\n", pack.pixelBytes / (1024.0 * 1024.0), compress ? "DEFLATE-compressed" : "stored uncompressed");
+        printf("  decode + analysis: %.1f ms on %d threads, total: %.1f ms\n", stats.wallSeconds * 1000.0, stats.threadCount,
+               (NowSeconds() - startTime) * 1000.0);
+    }
+    FreePack(&pack);
+    return ok ? 0 : 1;
+}
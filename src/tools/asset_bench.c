@@ -0,0 +1,1226 @@
+// asset_bench.c
+//
+// Headless asset micro-benchmarks. Runs without a window or GPU.
+//
+//   asset_bench lookup [asset directory]              name lookup: linear strcmp scan vs AssetIndex
+//   asset_bench decode [asset directory] [threads]    CPU load stages on 1..threads decode threads
+//   asset_bench blank [asset directory]               blank-frame detection: IsFrameBlank as it was vs alpha_scan
+//   asset_bench tilemap [asset directory] [map file]  tilemap load and tile-pass batching: per-tile textures vs one sheet
+//   asset_bench atlas [asset directory]               atlas packing and draw batches as content variety grows
+//   asset_bench mapfile [largest map side]            map save/load/free time and file size: version 1 vs chunked version 4; exits 1 if a load differs
+//   asset_bench tilestore [largest side] [map file]   heap, load time and tile pass: per-cell stacks vs tile palette; exits 1 on a mismatch
+
+#include "asset_manager.h"
+#include "asset_loader.h"
+#include "alpha_scan.h"
+#include "map_file.h"
+#include "tile_placement_data.h"
+#include "texture_atlas.h"
+#include "worker_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+AssetManager manager;
+
+static volatile long long benchSink; // Keeps the optimizer from dropping lookups
+
+static double NowSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int CompareNames(const void *a, const void *b)
+{
+    return strcmp(*(const char **)a, *(const char **)b);
+}
+
+// Registers sprite and animation names the way LoadAssetsFromDirectory would, without
+// decoding any pixels (every animation row is assumed to contain frames)
+static void RegisterAssetNames(AssetManager *manager, const char *directory)
+{
+    DIR *dir = opendir(directory);
+    if (dir == NULL)
+    {
+        perror("Could not open assets directory");
+        return;
+    }
+
+    char **entries = NULL;
+    size_t entryCount = 0;
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL)
+    {
+        if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0 || strcmp(ent->d_name, "new") == 0)
+            continue;
+        entries = realloc(entries, sizeof(char *) * (entryCount + 1));
+        entries[entryCount++] = strdup(ent->d_name);
+    }
+    closedir(dir);
+    qsort(entries, entryCount, sizeof(char *), CompareNames);
+
+    for (size_t i = 0; i < entryCount; i++)
+    {
+        char filePath[512];
+        snprintf(filePath, sizeof(filePath), "%s/%s", directory, entries[i]);
+
+        struct stat pathStat;
+        stat(filePath, &pathStat);
+        if (S_ISDIR(pathStat.st_mode))
+        {
+            RegisterAssetNames(manager, filePath);
+        }
+        else if (strstr(entries[i], ".png") != NULL && strstr(entries[i], "Tilemap") == NULL)
+        {
+            char name[64] = {0};
+            int rows = 0, framesPerRow = 0, frameWidth = 0, frameHeight = 0;
+            ParseAnimationInfoFromFilename(filePath, name, &rows, &framesPerRow, &frameWidth, &frameHeight);
+
+            if (strstr(entries[i], "_") != NULL)
+            {
+                for (int row = 0; row < rows && manager->animationCount < MAX_ANIMATIONS; row++)
+                {
+                    AnimationClip *animation = &manager->animations[manager->animationCount];
+                    snprintf(animation->name, sizeof(animation->name), "%s_%d", name, row + 1);
+                    animation->frameCount = framesPerRow;
+                    AssetIndexInsert(&manager->index, ASSET_KIND_ANIMATION, manager->animationCount, animation->name);
+                    manager->animationCount++;
+                }
+            }
+            else if (manager->spriteCount < MAX_SPRITES)
+            {
+                Sprite *sprite = &manager->sprites[manager->spriteCount];
+                strncpy(sprite->name, name, sizeof(sprite->name));
+                AssetIndexInsert(&manager->index, ASSET_KIND_SPRITE, manager->spriteCount, sprite->name);
+                manager->spriteCount++;
+            }
+        }
+        free(entries[i]);
+    }
+    free(entries);
+}
+
+// The lookup GetSprite/GetAnimation used before the index existed
+static Sprite LinearGetSprite(AssetManager *manager, const char *name)
+{
+    for (int i = 0; i < manager->spriteCount; i++)
+    {
+        if (strcmp(manager->sprites[i].name, name) == 0)
+            return manager->sprites[i];
+    }
+    return (Sprite){0};
+}
+
+static AnimationClip LinearGetAnimation(AssetManager *manager, const char *name)
+{
+    for (int i = 0; i < manager->animationCount; i++)
+    {
+        if (strcmp(manager->animations[i].name, name) == 0)
+            return manager->animations[i];
+    }
+    return (AnimationClip){0};
+}
+
+static void RunLookupBench(const char *directory)
+{
+    InitAssetManager(&manager);
+    RegisterAssetNames(&manager, directory);
+    printf("Registered %d sprites and %d animations from %s\n", manager.spriteCount, manager.animationCount, directory);
+    if (manager.spriteCount + manager.animationCount == 0)
+        return;
+
+    // Query every registered name once per round, alternating kinds like the game does
+    int queryCount = manager.spriteCount + manager.animationCount;
+    const char **queries = malloc(queryCount * sizeof(char *));
+    bool *isSprite = malloc(queryCount * sizeof(bool));
+    AssetId *resolved = malloc(queryCount * sizeof(AssetId));
+    for (int i = 0; i < queryCount; i++)
+    {
+        isSprite[i] = i < manager.spriteCount;
+        queries[i] = isSprite[i] ? manager.sprites[i].name : manager.animations[i - manager.spriteCount].name;
+    }
+
+    const int rounds = 2000;
+    long long lookups = (long long)rounds * queryCount;
+
+    double start = NowSeconds();
+    for (int r = 0; r < rounds; r++)
+    {
+        for (int i = 0; i < queryCount; i++)
+        {
+            if (isSprite[i])
+                benchSink += LinearGetSprite(&manager, queries[i]).name[0];
+            else
+                benchSink += LinearGetAnimation(&manager, queries[i]).frameCount;
+        }
+    }
+    double linearTime = NowSeconds() - start;
+
+    start = NowSeconds();
+    for (int r = 0; r < rounds; r++)
+    {
+        for (int i = 0; i < queryCount; i++)
+        {
+            if (isSprite[i])
+                benchSink += GetSpriteById(&manager, FindSpriteId(&manager, queries[i]))->name[0];
+            else
+                benchSink += GetAnimationById(&manager, FindAnimationId(&manager, queries[i]))->frameCount;
+        }
+    }
+    double hashedTime = NowSeconds() - start;
+
+    // Handles resolved once up front; the steady-state cost on hot paths
+    for (int i = 0; i < queryCount; i++)
+    {
+        resolved[i] = isSprite[i] ? FindSpriteId(&manager, queries[i]) : FindAnimationId(&manager, queries[i]);
+    }
+    start = NowSeconds();
+    for (int r = 0; r < rounds; r++)
+    {
+        for (int i = 0; i < queryCount; i++)
+        {
+            if (isSprite[i])
+                benchSink += GetSpriteById(&manager, resolved[i])->name[0];
+            else
+                benchSink += GetAnimationById(&manager, resolved[i])->frameCount;
+        }
+    }
+    double handleTime = NowSeconds() - start;
+
+    printf("%-26s %14s %12s\n", "method", "lookups/s", "ns/lookup");
+    printf("%-26s %14.0f %12.1f\n", "linear strcmp scan", lookups / linearTime, linearTime * 1e9 / lookups);
+    printf("%-26s %14.0f %12.1f\n", "hash index by name", lookups / hashedTime, hashedTime * 1e9 / lookups);
+    printf("%-26s %14.0f %12.1f\n", "pre-resolved AssetId", lookups / handleTime, handleTime * 1e9 / lookups);
+    printf("Speedup (name lookup): %.1fx\n", linearTime / hashedTime);
+    PrintAssetIndexStats(&manager.index);
+
+    free(queries);
+    free(isSprite);
+    free(resolved);
+}
+
+static void RunDecodeBench(const char *directory, int maxThreads)
+{
+    SetTraceLogLevel(LOG_WARNING);
+    printf("%-8s %12s %12s %10s %14s\n", "threads", "wall ms", "cpu ms", "speedup", "MB/s decoded");
+
+    double baseline = 0.0;
+    for (int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        AssetDecodeStats stats = DecodeAssetsHeadless(directory, threads);
+        if (threads == 1)
+            baseline = stats.wallSeconds;
+        printf("%-8d %12.1f %12.1f %9.2fx %14.1f\n", stats.threadCount, stats.wallSeconds * 1000.0,
+               stats.decodeSeconds * 1000.0, baseline / stats.wallSeconds,
+               stats.pixelBytes / (1024.0 * 1024.0) / stats.wallSeconds);
+        if (threads * 2 > maxThreads && threads != maxThreads)
+            threads = maxThreads / 2; // Always finish on maxThreads itself
+    }
+}
+
+// IsFrameBlank as it was before alpha_scan: a sub-image and a Color array per frame
+static bool LegacyIsFrameBlank(Image fullImage, Rectangle frame)
+{
+    Image frameImage = ImageFromImage(fullImage, frame);
+    Color *pixels = LoadImageColors(frameImage);
+    int totalPixels = frameImage.width * frameImage.height;
+
+    bool isBlank = true;
+    for (int i = 0; i < totalPixels; i++)
+    {
+        if (pixels[i].a > 0)
+        {
+            isBlank = false;
+            break;
+        }
+    }
+    UnloadImageColors(pixels);
+    UnloadImage(frameImage);
+    return isBlank;
+}
+
+typedef struct BenchSheet
+{
+    Image image;
+    int rows, framesPerRow, frameWidth, frameHeight;
+} BenchSheet;
+
+static void RunBlankBench(const char *directory)
+{
+    SetTraceLogLevel(LOG_WARNING);
+
+    // Decode every animation sheet up front so only the scan is timed
+    char **filePaths;
+    int fileCount = CollectAssetFiles(directory, &filePaths);
+    BenchSheet *sheets = calloc(fileCount > 0 ? fileCount : 1, sizeof(BenchSheet));
+    int sheetCount = 0, cellCount = 0, maxCells = 0;
+    long long sheetBytes = 0;
+    for (int i = 0; i < fileCount; i++)
+    {
+        if (ClassifyAssetFile(filePaths[i]) != ASSET_KIND_ANIMATION)
+            continue;
+        BenchSheet sheet = {0};
+        char name[64];
+        ParseAnimationInfoFromFilename(filePaths[i], name, &sheet.rows, &sheet.framesPerRow, &sheet.frameWidth, &sheet.frameHeight);
+        if (sheet.rows <= 0 || sheet.framesPerRow <= 0 || sheet.frameWidth <= 0 || sheet.frameHeight <= 0)
+            continue;
+        sheet.image = LoadImage(filePaths[i]);
+        if (sheet.image.data == NULL)
+            continue;
+        ImageFormat(&sheet.image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+        // Like the loader, only cells that fit inside the image are considered
+        if (sheet.framesPerRow * sheet.frameWidth > sheet.image.width)
+            sheet.framesPerRow = sheet.image.width / sheet.frameWidth;
+        if (sheet.rows * sheet.frameHeight > sheet.image.height)
+            sheet.rows = sheet.image.height / sheet.frameHeight;
+
+        int cells = sheet.rows * sheet.framesPerRow;
+        cellCount += cells;
+        maxCells = cells > maxCells ? cells : maxCells;
+        sheetBytes += (long long)sheet.image.width * sheet.image.height * 4;
+        sheets[sheetCount++] = sheet;
+    }
+    FreeAssetFileList(filePaths, fileCount);
+    printf("%d animation sheets, %d frame cells, %.1f MB of pixels\n", sheetCount, cellCount, sheetBytes / (1024.0 * 1024.0));
+    if (cellCount == 0)
+    {
+        free(sheets);
+        return;
+    }
+
+    // Reference answers from the original implementation
+    bool *reference = malloc(cellCount * sizeof(bool));
+    int *coverage = malloc(maxCells * sizeof(int));
+    double start = NowSeconds();
+    for (int s = 0, cell = 0; s < sheetCount; s++)
+    {
+        BenchSheet *sheet = &sheets[s];
+        for (int row = 0; row < sheet->rows; row++)
+            for (int x = 0; x < sheet->framesPerRow; x++)
+                reference[cell++] = LegacyIsFrameBlank(sheet->image, (Rectangle){x * sheet->frameWidth, row * sheet->frameHeight,
+                                                                                sheet->frameWidth, sheet->frameHeight});
+    }
+    double legacyTime = NowSeconds() - start;
+
+    printf("%-34s %10s %10s %10s %10s\n", "method", "ms/pass", "ns/cell", "GB/s", "mismatch");
+    printf("%-34s %10.2f %10.1f %10.2f %10s\n", "IsFrameBlank (sub-image + colors)", legacyTime * 1000.0,
+           legacyTime * 1e9 / cellCount, sheetBytes / legacyTime / 1e9, "-");
+
+    const int rounds = 20;
+    AlphaScanPath paths[] = {ALPHA_SCAN_SCALAR, ALPHA_SCAN_SSE2, ALPHA_SCAN_AVX2};
+    for (int p = 0; p < (int)(sizeof(paths) / sizeof(paths[0])); p++)
+    {
+        if (!SetAlphaScanPath(paths[p]))
+        {
+            printf("%-34s %10s\n", GetAlphaScanPathName(paths[p]), "unsupported on this CPU");
+            continue;
+        }
+
+        // Per-cell early-exit test, as IsFrameBlank now does it
+        int mismatches = 0;
+        start = NowSeconds();
+        for (int r = 0; r < rounds; r++)
+        {
+            for (int s = 0, cell = 0; s < sheetCount; s++)
+            {
+                BenchSheet *sheet = &sheets[s];
+                for (int row = 0; row < sheet->rows; row++)
+                    for (int x = 0; x < sheet->framesPerRow; x++, cell++)
+                    {
+                        bool blank = IsRegionTransparent(sheet->image, (Rectangle){x * sheet->frameWidth, row * sheet->frameHeight,
+                                                                                   sheet->frameWidth, sheet->frameHeight});
+                        mismatches += blank != reference[cell];
+                    }
+            }
+        }
+        double transparentTime = (NowSeconds() - start) / rounds;
+
+        // Full per-cell coverage in one pass over the sheet, as the loader does it
+        int coverageMismatches = 0;
+        start = NowSeconds();
+        for (int r = 0; r < rounds; r++)
+        {
+            for (int s = 0, cell = 0; s < sheetCount; s++)
+            {
+                BenchSheet *sheet = &sheets[s];
+                ScanSheetCoverage(sheet->image, sheet->frameWidth, sheet->frameHeight, sheet->framesPerRow, sheet->rows, coverage);
+                for (int i = 0; i < sheet->rows * sheet->framesPerRow; i++, cell++)
+                {
+                    coverageMismatches += (coverage[i] == 0) != reference[cell];
+                    benchSink += coverage[i];
+                }
+            }
+        }
+        double coverageTime = (NowSeconds() - start) / rounds;
+
+        char label[64];
+        snprintf(label, sizeof(label), "%s IsRegionTransparent", GetAlphaScanPathName(paths[p]));
+        printf("%-34s %10.2f %10.1f %10.2f %10d\n", label, transparentTime * 1000.0, transparentTime * 1e9 / cellCount,
+               sheetBytes / transparentTime / 1e9, mismatches / rounds);
+        snprintf(label, sizeof(label), "%s ScanSheetCoverage", GetAlphaScanPathName(paths[p]));
+        printf("%-34s %10.2f %10.1f %10.2f %10d\n", label, coverageTime * 1000.0, coverageTime * 1e9 / cellCount,
+               sheetBytes / coverageTime / 1e9, coverageMismatches / rounds);
+        printf("  speedup vs IsFrameBlank: %.1fx (early exit), %.1fx (coverage)\n", legacyTime / transparentTime,
+               legacyTime / coverageTime);
+    }
+    SetAlphaScanPath(ALPHA_SCAN_AUTO);
+
+    for (int s = 0; s < sheetCount; s++)
+    {
+        UnloadImage(sheets[s].image);
+    }
+    free(sheets);
+    free(reference);
+    free(coverage);
+}
+
+// raylib flushes its batch when the bound texture changes or the quad buffer fills
+#define RLGL_BATCH_QUADS 8192
+
+typedef struct BatchCounter
+{
+    unsigned int textureId;
+    int quads;
+    int batches;
+    int draws;
+} BatchCounter;
+
+static void CountDraw(BatchCounter *counter, unsigned int textureId)
+{
+    if (counter->draws == 0 || textureId != counter->textureId || counter->quads == RLGL_BATCH_QUADS)
+    {
+        counter->batches++;
+        counter->quads = 0;
+        counter->textureId = textureId;
+    }
+    counter->quads++;
+    counter->draws++;
+}
+
+// Decodes every asset of one kind (ASSET_KIND_NONE for all) without touching the GPU
+static int DecodeAllAssets(const char *directory, AssetKind kind, DecodedAsset **assets)
+{
+    char **filePaths;
+    int fileCount = CollectAssetFiles(directory, &filePaths);
+    *assets = calloc(fileCount > 0 ? fileCount : 1, sizeof(DecodedAsset));
+    int count = 0;
+    for (int i = 0; i < fileCount; i++)
+    {
+        AssetKind fileKind = ClassifyAssetFile(filePaths[i]);
+        if ((kind == ASSET_KIND_NONE || fileKind == kind) && DecodeAssetFile(filePaths[i], &(*assets)[count]))
+        {
+            (*assets)[count].filePath = NULL; // The path list is freed below
+            count++;
+        }
+    }
+    FreeAssetFileList(filePaths, fileCount);
+    return count;
+}
+
+// The bench has no GL context, so texture ids are synthetic: what matters for batching is
+// only which draws share a texture
+static void RunTilemapBench(const char *directory, const char *mapPath)
+{
+    SetTraceLogLevel(LOG_WARNING);
+
+    DecodedAsset *tilemaps;
+    int tilemapCount = DecodeAllAssets(directory, ASSET_KIND_TILEMAP, &tilemaps);
+    if (tilemapCount == 0)
+    {
+        printf("No tilemaps found in %s\n", directory);
+        free(tilemaps);
+        return;
+    }
+
+    // Before: a full ImageCopy + ImageCrop (and an upload) for every tile
+    unsigned int **legacyTileIds = malloc(tilemapCount * sizeof(unsigned int *));
+    unsigned int nextTextureId = 1;
+    double start = NowSeconds();
+    for (int t = 0; t < tilemapCount; t++)
+    {
+        DecodedAsset *tilemap = &tilemaps[t];
+        int totalTiles = tilemap->tileCountX * tilemap->tileCountY;
+        legacyTileIds[t] = calloc(totalTiles > 0 ? totalTiles : 1, sizeof(unsigned int));
+        for (int i = 0; i < totalTiles; i++)
+        {
+            Image tileImage = ImageCopy(tilemap->image);
+            ImageCrop(&tileImage, tilemap->tileRects[i]);
+            legacyTileIds[t][i] = nextTextureId++;
+            UnloadImage(tileImage);
+        }
+    }
+    double legacyTime = NowSeconds() - start;
+    int legacyTextures = nextTextureId - 1;
+
+    // Sheet: one texture per tilemap, tiles are rectangles on it (no CPU copies at all)
+    // Atlas: every tilemap packed onto shared pages
+    TextureAtlas atlas;
+    InitTextureAtlas(&atlas);
+    int **atlasPages = malloc(tilemapCount * sizeof(int *));
+    start = NowSeconds();
+    for (int t = 0; t < tilemapCount; t++)
+    {
+        DecodedAsset *tilemap = &tilemaps[t];
+        int totalTiles = tilemap->tileCountX * tilemap->tileCountY;
+        AtlasRegion *regions = malloc((totalTiles > 0 ? totalTiles : 1) * sizeof(AtlasRegion));
+        atlasPages[t] = calloc(totalTiles > 0 ? totalTiles : 1, sizeof(int));
+        if (AtlasPackGroup(&atlas, tilemap->image, tilemap->tileRects, totalTiles, false, regions))
+        {
+            for (int i = 0; i < totalTiles; i++)
+                atlasPages[t][i] = regions[i].page;
+        }
+        else
+        {
+            for (int i = 0; i < totalTiles; i++)
+                atlasPages[t][i] = 1000 + t; // Kept as its own texture
+        }
+        free(regions);
+    }
+    double atlasTime = NowSeconds() - start;
+
+    // Replay the tile pass of RenderTilePlacementScene over a saved map, with the decoded
+    // tilemaps standing in for the loaded ones so its tiles resolve
+    for (int t = 0; t < tilemapCount && t < MAX_TILEMAPS; t++)
+    {
+        snprintf(manager.tilemap[t].name, sizeof(manager.tilemap[t].name), "%s", tilemaps[t].name);
+        manager.tilemap[t].totalTiles = tilemaps[t].tileCountX * tilemaps[t].tileCountY;
+    }
+    manager.tilemapCount = tilemapCount < MAX_TILEMAPS ? tilemapCount : MAX_TILEMAPS;
+    screenTilesX = screenTilesY = 0;
+    LoadTilePlacement(mapPath);
+    BatchCounter legacy = {0}, sheet = {0}, paged = {0};
+    if (tileStore.cells != NULL)
+    {
+        for (int y = 0; y < mapTilesY; y++)
+        {
+            for (int x = 0; x < mapTilesX; x++)
+            {
+                TileSpan span = GetTileSpan(x, y);
+                for (int i = 0; i < span.count; i++)
+                {
+                    TileRef ref = GetTileEntryRef(span.entries[i]);
+                    int tilemapIndex = GetTileRefSource(ref);
+                    int tileIndex = GetTileRefIndex(ref);
+                    if (GetTileRefKind(ref) != TILE_REF_TILE || tilemapIndex >= tilemapCount ||
+                        tileIndex >= tilemaps[tilemapIndex].tileCountX * tilemaps[tilemapIndex].tileCountY)
+                        continue;
+                    CountDraw(&legacy, legacyTileIds[tilemapIndex][tileIndex]);
+                    CountDraw(&sheet, tilemapIndex);
+                    CountDraw(&paged, atlasPages[tilemapIndex][tileIndex]);
+                }
+            }
+        }
+    }
+
+    // A full 256x256 map: one ground tile per cell, tilemap changing every 16x16 block
+    const int fullSize = 256, blockSize = 16;
+    BatchCounter fullLegacy = {0}, fullSheet = {0}, fullPaged = {0};
+    for (int y = 0; y < fullSize; y++)
+    {
+        for (int x = 0; x < fullSize; x++)
+        {
+            int tilemapIndex = ((y / blockSize) * 7 + (x / blockSize) * 3) % tilemapCount;
+            int totalTiles = tilemaps[tilemapIndex].tileCountX * tilemaps[tilemapIndex].tileCountY;
+            if (totalTiles == 0)
+                continue;
+            int tileIndex = (int)(((unsigned)(x * 73856093) ^ (unsigned)(y * 19349663)) % totalTiles);
+            CountDraw(&fullLegacy, legacyTileIds[tilemapIndex][tileIndex]);
+            CountDraw(&fullSheet, tilemapIndex);
+            CountDraw(&fullPaged, atlasPages[tilemapIndex][tileIndex]);
+        }
+    }
+
+    printf("%d tilemaps (CPU side only; uploads are not timed without a GL context)\n", tilemapCount);
+    printf("%-28s %10s %10s\n", "tilemap storage", "load ms", "textures");
+    printf("%-28s %10.2f %10d\n", "texture per tile (before)", legacyTime * 1000.0, legacyTextures);
+    printf("%-28s %10.2f %10d\n", "sheet + rect table", 0.0, tilemapCount);
+    printf("%-28s %10.2f %10d\n", "atlas pages", atlasTime * 1000.0, atlas.pageCount);
+    printf("%-34s %12s %12s %12s %12s\n", "map", "tile draws", "per tile", "per sheet", "atlas");
+    printf("%-34.34s %12d %12d %12d %12d\n", mapPath, sheet.draws, legacy.batches, sheet.batches, paged.batches);
+    printf("%-34s %12d %12d %12d %12d\n", "full 256x256, 16x16 blocks", fullSheet.draws, fullLegacy.batches,
+           fullSheet.batches, fullPaged.batches);
+
+    for (int t = 0; t < tilemapCount; t++)
+    {
+        free(legacyTileIds[t]);
+        free(atlasPages[t]);
+        FreeDecodedAsset(&tilemaps[t]);
+    }
+    free(legacyTileIds);
+    free(atlasPages);
+    free(tilemaps);
+    UnloadTextureAtlas(&atlas);
+    FreeTileData();
+    manager.tilemapCount = 0;
+}
+
+// One drawable: a sprite, an animation frame or a tile, with the texture it came from
+typedef struct BenchDrawable
+{
+    unsigned int textureId; // Per-file texture, as without an atlas
+    int atlasPage;
+} BenchDrawable;
+
+static void RunAtlasBench(const char *directory)
+{
+    SetTraceLogLevel(LOG_WARNING);
+
+    DecodedAsset *assets;
+    int assetCount = DecodeAllAssets(directory, ASSET_KIND_NONE, &assets);
+
+    // Pack everything the way the loader does: trimmed sprites and frames, untrimmed tiles
+    TextureAtlas atlas;
+    InitTextureAtlas(&atlas);
+    BenchDrawable *drawables = NULL;
+    int drawableCount = 0, standalone = 0;
+    long long sourcePixels = 0;
+    double start = NowSeconds();
+    for (int a = 0; a < assetCount; a++)
+    {
+        DecodedAsset *asset = &assets[a];
+        Rectangle whole = {0, 0, asset->image.width, asset->image.height};
+        const Rectangle *rects = &whole;
+        int count = 1;
+        if (asset->kind == ASSET_KIND_ANIMATION)
+        {
+            rects = asset->frames;
+            count = 0;
+            for (int row = 0; row < asset->rows; row++)
+                count += asset->rowFrameCounts[row];
+        }
+        else if (asset->kind == ASSET_KIND_TILEMAP)
+        {
+            rects = asset->tileRects;
+            count = asset->tileCountX * asset->tileCountY;
+        }
+        if (count <= 0)
+            continue;
+
+        AtlasRegion *regions = malloc(count * sizeof(AtlasRegion));
+        bool packed = AtlasPackGroup(&atlas, asset->image, rects, count, asset->kind != ASSET_KIND_TILEMAP, regions);
+        standalone += !packed;
+        drawables = realloc(drawables, (drawableCount + count) * sizeof(BenchDrawable));
+        for (int i = 0; i < count; i++)
+        {
+            drawables[drawableCount++] = (BenchDrawable){a + 1, packed ? regions[i].page : 1000 + a};
+            sourcePixels += (long long)rects[i].width * rects[i].height;
+        }
+        free(regions);
+    }
+    double packTime = NowSeconds() - start;
+
+    long long pagePixels = 0;
+    for (int p = 0; p < atlas.pageCount; p++)
+        pagePixels += atlas.pages[p].usedPixels;
+    printf("%d files -> %d regions on %d pages of %dx%d in %.1f ms (%d groups kept standalone)\n", assetCount,
+           atlas.regionCount, atlas.pageCount, ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE, packTime * 1000.0, standalone);
+    printf("  trimming kept %.1f%% of the source pixels; pages %.1f%% full\n", 100.0 * pagePixels / (double)sourcePixels,
+           atlas.pageCount ? 100.0 * pagePixels / ((double)atlas.pageCount * ATLAS_PAGE_SIZE * ATLAS_PAGE_SIZE) : 0.0);
+
+    // A frame of 5000 draws spread over a growing number of distinct drawables
+    if (drawableCount > 0)
+    {
+        printf("%-20s %12s %16s %14s\n", "distinct drawables", "draws", "batches before", "batches atlas");
+        const int draws = 5000;
+        for (int variety = 1;; variety *= 4)
+        {
+            if (variety > drawableCount)
+                variety = drawableCount;
+            BatchCounter before = {0}, after = {0};
+            unsigned int seed = 12345;
+            for (int d = 0; d < draws; d++)
+            {
+                seed = seed * 1103515245u + 12345u;
+                // Spread the chosen drawables evenly over the whole asset set
+                int index = (int)((long long)((seed >> 8) % variety) * drawableCount / variety);
+                CountDraw(&before, drawables[index].textureId);
+                CountDraw(&after, (unsigned int)drawables[index].atlasPage);
+            }
+            printf("%-20d %12d %16d %14d\n", variety, draws, before.batches, after.batches);
+            if (variety == drawableCount)
+                break;
+        }
+    }
+
+    for (int a = 0; a < assetCount; a++)
+        FreeDecodedAsset(&assets[a]);
+    free(assets);
+    free(drawables);
+    UnloadTextureAtlas(&atlas);
+}
+
+#define MAP_BENCH_FILE "map_bench.dat"
+#define BENCH_TILEMAPS 8
+#define BENCH_TILEMAP_TILES 64
+
+// Named tilemaps without textures, so map files' tiles resolve: the bench maps and
+// ../maps/map1.dat only use tiles of these
+static void RegisterBenchTilemaps(void)
+{
+    for (int t = 0; t < BENCH_TILEMAPS; t++)
+    {
+        snprintf(manager.tilemap[t].name, sizeof(manager.tilemap[t].name), "bench_tilemap_%d", t);
+        manager.tilemap[t].totalTiles = BENCH_TILEMAP_TILES;
+    }
+    manager.tilemapCount = BENCH_TILEMAPS;
+}
+
+// Grass, dirt, sand and stone patches 16 tiles across; 8% of cells carry a decoration on top,
+// and collidable walls with gaps run every 64 tiles
+static void BuildBenchMap(int side)
+{
+    InitTileData(side, side, 0, 0);
+    unsigned int seed = 12345;
+    for (int y = 0; y < side; y++)
+    {
+        for (int x = 0; x < side; x++)
+        {
+            PushTile(x, y, MakeTileRef(TILE_REF_TILE, 0, (x / 16 + y / 16) % 4), false);
+            seed = seed * 1103515245u + 12345u;
+            if ((seed >> 8) % 100 < 8)
+                PushTile(x, y, MakeTileRef(TILE_REF_TILE, 1, (int)((seed >> 16) % 20)), false);
+            if (x % 64 == 63 && y % 64 > 8)
+                PushTile(x, y, MakeTileRef(TILE_REF_TILE, 2, 5), true);
+        }
+    }
+}
+
+#define BENCH_HASH_START 1469598103934665603ull
+#define BENCH_HASH_STEP(hash, value) (((hash) ^ (value)) * 1099511628211ull)
+
+static unsigned long long HashPlacedTiles(void)
+{
+    unsigned long long hash = BENCH_HASH_START;
+    for (int y = 0; y < mapTilesY; y++)
+    {
+        for (int x = 0; x < mapTilesX; x++)
+        {
+            TileSpan span = GetTileSpan(x, y);
+            hash = BENCH_HASH_STEP(hash, (unsigned int)span.count);
+            for (int i = 0; i < span.count; i++)
+                hash = BENCH_HASH_STEP(hash, GetTileEntryRef(span.entries[i]) << 1 | IsTileEntryCollidable(span.entries[i]));
+        }
+    }
+    return hash;
+}
+
+// The tilemapIndex * 1000 + i value a ref had before TileRefs, as version 1 files hold it
+static int RefToLegacyTile(TileRef ref)
+{
+    int source = GetTileRefSource(ref);
+    switch (GetTileRefKind(ref))
+    {
+    case TILE_REF_TILE:
+        return source * 1000 + GetTileRefIndex(ref);
+    case TILE_REF_SPRITE:
+        return manager.tilemap[0].totalTiles + source;
+    default:
+        return manager.tilemap[0].totalTiles + manager.spriteCount + source;
+    }
+}
+
+// The per-cell stacks placedTiles held before the tile store: a row array of cells, each with
+// its own tile and collision arrays
+typedef struct LegacyStack
+{
+    int *tiles;
+    bool *isCollidable;
+    int count;
+    int capacity;
+} LegacyStack;
+
+static void PushLegacyTile(LegacyStack *stack, int tile, bool isCollidable)
+{
+    if (stack->count >= stack->capacity)
+    {
+        stack->capacity = stack->capacity == 0 ? 4 : stack->capacity * 2;
+        stack->tiles = realloc(stack->tiles, stack->capacity * sizeof(int));
+        stack->isCollidable = realloc(stack->isCollidable, stack->capacity * sizeof(bool));
+        if (!stack->tiles || !stack->isCollidable)
+        {
+            fprintf(stderr, "Failed to allocate a legacy tile stack.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    stack->tiles[stack->count] = tile;
+    stack->isCollidable[stack->count] = isCollidable;
+    stack->count++;
+}
+
+static LegacyStack **AllocateLegacyStacks(int width, int height)
+{
+    LegacyStack **stacks = malloc(height * sizeof(LegacyStack *));
+    for (int y = 0; y < height; y++)
+    {
+        if (!stacks || !(stacks[y] = calloc(width, sizeof(LegacyStack))))
+        {
+            fprintf(stderr, "Failed to allocate %dx%d legacy tile stacks.\n", width, height);
+            exit(EXIT_FAILURE);
+        }
+    }
+    return stacks;
+}
+
+static void FreeLegacyStacks(LegacyStack **stacks, int width, int height)
+{
+    for (int y = 0; stacks && y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            free(stacks[y][x].tiles);
+            free(stacks[y][x].isCollidable);
+        }
+        free(stacks[y]);
+    }
+    free(stacks);
+}
+
+// Hashed as HashPlacedTiles hashes the refs the stacks' tiles resolve to
+static unsigned long long HashLegacyStacks(LegacyStack **stacks, int width, int height)
+{
+    unsigned long long hash = BENCH_HASH_START;
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            const LegacyStack *stack = &stacks[y][x];
+            hash = BENCH_HASH_STEP(hash, (unsigned int)stack->count);
+            for (int i = 0; i < stack->count; i++)
+            {
+                TileRef ref;
+                if (!ResolveLegacyTile(stack->tiles[i], &ref))
+                    ref = UINT32_MAX >> 1;
+                hash = BENCH_HASH_STEP(hash, ref << 1 | stack->isCollidable[i]);
+            }
+        }
+    }
+    return hash;
+}
+
+static unsigned int LegacyHtonl(unsigned int value)
+{
+    return (value & 0xFF) << 24 | (value & 0xFF00) << 8 | (value & 0xFF0000) >> 8 | value >> 24;
+}
+
+// SaveTilePlacement as it was before format version 2: one fwrite per value
+static void LegacySaveMap(const char *path)
+{
+    FILE *file = fopen(path, "wb");
+    if (!file)
+        return;
+    int header[3] = {LegacyHtonl(1), LegacyHtonl(mapTilesX), LegacyHtonl(mapTilesY)};
+    fwrite(&header[0], sizeof(int), 1, file);
+    fwrite(&header[1], sizeof(int), 2, file);
+    for (int y = 0; y < mapTilesY; y++)
+    {
+        for (int x = 0; x < mapTilesX; x++)
+        {
+            TileSpan span = GetTileSpan(x, y);
+            int count = LegacyHtonl(span.count);
+            fwrite(&count, sizeof(int), 1, file);
+            for (int i = 0; i < span.count; i++)
+            {
+                int tile = LegacyHtonl(RefToLegacyTile(GetTileEntryRef(span.entries[i])));
+                bool collidable = IsTileEntryCollidable(span.entries[i]);
+                fwrite(&tile, sizeof(int), 1, file);
+                fwrite(&collidable, sizeof(bool), 1, file);
+            }
+        }
+    }
+    fclose(file);
+}
+
+// LoadTilePlacement as it was before format version 2: one fread per value into per-cell stacks
+static LegacyStack **LegacyLoadMap(const char *path, int *width, int *height)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return NULL;
+    int header[3];
+    fread(header, sizeof(int), 3, file);
+    *width = LegacyHtonl(header[1]);
+    *height = LegacyHtonl(header[2]);
+    LegacyStack **stacks = AllocateLegacyStacks(*width, *height);
+    for (int y = 0; y < *height; y++)
+    {
+        for (int x = 0; x < *width; x++)
+        {
+            LegacyStack *stack = &stacks[y][x];
+            int count;
+            fread(&count, sizeof(int), 1, file);
+            count = LegacyHtonl(count);
+            if (count <= 0)
+                continue;
+            stack->tiles = malloc(count * sizeof(int));
+            stack->isCollidable = malloc(count * sizeof(bool));
+            stack->count = stack->capacity = count;
+            for (int i = 0; i < count; i++)
+            {
+                fread(&stack->tiles[i], sizeof(int), 1, file);
+                stack->tiles[i] = LegacyHtonl(stack->tiles[i]);
+                fread(&stack->isCollidable[i], sizeof(bool), 1, file);
+            }
+        }
+    }
+    fclose(file);
+    return stacks;
+}
+
+static long GetBenchFileSize(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return 0;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+// Pushes onto and pops one cell of a freshly loaded map; its neighbour shares the same palette
+// stack, so it must not see the push. True if it did not and the pop restored the map.
+static bool CheckTileEdit(unsigned long long expected)
+{
+    const TileRef marker = MakeTileRef(TILE_REF_ANIMATION, 0, 0);
+    TileSpan neighbour = GetTileSpan(1, 0);
+    int neighbourCount = neighbour.count;
+    PushTile(0, 0, marker, false);
+    neighbour = GetTileSpan(1, 0);
+    bool untouched = neighbour.count == neighbourCount &&
+                     (neighbourCount == 0 || GetTileEntryRef(neighbour.entries[neighbourCount - 1]) != marker);
+    PopTile(0, 0);
+    return untouched && HashPlacedTiles() == expected;
+}
+
+// Loads the saved map with the bench tilemaps registered in reverse, as another asset load
+// order would give them, so every tile has to move to its tilemap's new handle; saves it that
+// way and loads it back with the usual order. True if the tiles moved and came back.
+static bool CheckAssetReorder(unsigned long long expected)
+{
+    for (int t = 0; t < BENCH_TILEMAPS / 2; t++)
+    {
+        Tilemap swap = manager.tilemap[t];
+        manager.tilemap[t] = manager.tilemap[BENCH_TILEMAPS - 1 - t];
+        manager.tilemap[BENCH_TILEMAPS - 1 - t] = swap;
+    }
+    LoadTilePlacement(MAP_BENCH_FILE);
+    bool moved = HashPlacedTiles() != expected;
+    SaveTilePlacement(MAP_BENCH_FILE);
+    RegisterBenchTilemaps();
+    LoadTilePlacement(MAP_BENCH_FILE);
+    return moved && HashPlacedTiles() == expected;
+}
+
+// Save, load and free time and file size of the per-value version 1 code, version 1 files
+// through the buffered loader, and version 4; false if any load gives back a different map
+static bool RunMapFileBench(int maxSide)
+{
+    RegisterBenchTilemaps();
+    printf("Map files: %d-tile chunks, %d workers\n", MAP_CHUNK_SIZE, GetDefaultWorkerCount());
+    printf("%-11s %-24s %10s %10s %10s %12s\n", "map", "format", "save ms", "load ms", "free ms", "file KB");
+    bool identical = true;
+    for (int side = 256; side <= maxSide; side *= 4)
+    {
+        BuildBenchMap(side);
+        unsigned long long expected = HashPlacedTiles();
+        char label[32];
+        snprintf(label, sizeof(label), "%dx%d", side, side);
+
+        double start = NowSeconds();
+        LegacySaveMap(MAP_BENCH_FILE);
+        double saveTime = NowSeconds() - start;
+        long legacySize = GetBenchFileSize(MAP_BENCH_FILE);
+        int width = 0, height = 0;
+        start = NowSeconds();
+        LegacyStack **legacy = LegacyLoadMap(MAP_BENCH_FILE, &width, &height);
+        double loadTime = NowSeconds() - start;
+        identical = identical && legacy != NULL && HashLegacyStacks(legacy, width, height) == expected;
+        start = NowSeconds();
+        FreeLegacyStacks(legacy, width, height);
+        double freeTime = NowSeconds() - start;
+        printf("%-11s %-24s %10.1f %10.1f %10.2f %12.1f\n", label, "v1, stdio per value", saveTime * 1000.0,
+               loadTime * 1000.0, freeTime * 1000.0, legacySize / 1024.0);
+
+        start = NowSeconds();
+        LoadTilePlacement(MAP_BENCH_FILE);
+        loadTime = NowSeconds() - start;
+        identical = identical && HashPlacedTiles() == expected;
+        printf("%-11s %-24s %10s %10.1f %10s %12.1f\n", label, "v1, palette loader", "-", loadTime * 1000.0, "-",
+               legacySize / 1024.0);
+
+        start = NowSeconds();
+        SaveTilePlacement(MAP_BENCH_FILE);
+        saveTime = NowSeconds() - start;
+        long size = GetBenchFileSize(MAP_BENCH_FILE);
+        start = NowSeconds();
+        LoadTilePlacement(MAP_BENCH_FILE);
+        loadTime = NowSeconds() - start;
+        identical = identical && HashPlacedTiles() == expected && CheckTileEdit(expected) && CheckAssetReorder(expected);
+        start = NowSeconds();
+        FreeTileData();
+        freeTime = NowSeconds() - start;
+        printf("%-11s %-24s %10.1f %10.1f %10.2f %12.1f  (%.1f%% of v1)\n", label, "v4, palette", saveTime * 1000.0,
+               loadTime * 1000.0, freeTime * 1000.0, size / 1024.0, 100.0 * size / legacySize);
+    }
+    remove(MAP_BENCH_FILE);
+    printf("%s\n", identical ? "Every load gave back the saved map, with the tilemaps in either order."
+                             : "A load gave back a different map!");
+    return identical;
+}
+
+#define TILE_PASS_VIEW_X 60 // A 1920x1080 screen of 32-pixel tiles, with a tile of margin
+#define TILE_PASS_VIEW_Y 35
+#define TILE_PASS_VIEWS 4096
+
+// What a render pass does per tile short of drawing: split the tile into its tilemap and
+// index and look at the flag; a division and a modulo for legacy tiles, shifts for refs
+static inline void VisitPassTile(int tile, bool isCollidable, long long *sum)
+{
+    *sum += tile / 1000 + tile % 1000 + isCollidable;
+}
+
+static inline void VisitPassRef(uint32_t entry, long long *sum)
+{
+    TileRef ref = GetTileEntryRef(entry);
+    *sum += GetTileRefSource(ref) + GetTileRefIndex(ref) + IsTileEntryCollidable(entry);
+}
+
+static long long LegacyTilePass(LegacyStack **stacks, int x0, int y0, int x1, int y1)
+{
+    long long sum = 0;
+    for (int y = y0; y < y1; y++)
+    {
+        for (int x = x0; x < x1; x++)
+        {
+            const LegacyStack *stack = &stacks[y][x];
+            for (int i = 0; i < stack->count; i++)
+                VisitPassTile(stack->tiles[i], stack->isCollidable[i], &sum);
+        }
+    }
+    return sum;
+}
+
+static long long StoreTilePass(int x0, int y0, int x1, int y1)
+{
+    long long sum = 0;
+    for (int y = y0; y < y1; y++)
+    {
+        for (int x = x0; x < x1; x++)
+        {
+            TileSpan span = GetTileSpan(x, y);
+            for (int i = 0; i < span.count; i++)
+                VisitPassRef(span.entries[i], &sum);
+        }
+    }
+    return sum;
+}
+
+// Seconds per cell over a whole-map pass and over TILE_PASS_VIEWS screen-sized windows at
+// scattered camera positions; legacy NULL times the tile store
+static void TimeTilePasses(LegacyStack **legacy, double *fullTime, double *viewTime)
+{
+    double start = NowSeconds();
+    benchSink += legacy ? LegacyTilePass(legacy, 0, 0, mapTilesX, mapTilesY) : StoreTilePass(0, 0, mapTilesX, mapTilesY);
+    *fullTime = (NowSeconds() - start) / ((double)mapTilesX * mapTilesY);
+
+    unsigned int seed = 777;
+    long long cells = 0;
+    start = NowSeconds();
+    for (int view = 0; view < TILE_PASS_VIEWS; view++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        int x0 = (int)((seed >> 8) % (unsigned int)(mapTilesX > TILE_PASS_VIEW_X ? mapTilesX - TILE_PASS_VIEW_X + 1 : 1));
+        seed = seed * 1103515245u + 12345u;
+        int y0 = (int)((seed >> 8) % (unsigned int)(mapTilesY > TILE_PASS_VIEW_Y ? mapTilesY - TILE_PASS_VIEW_Y + 1 : 1));
+        int x1 = x0 + TILE_PASS_VIEW_X < mapTilesX ? x0 + TILE_PASS_VIEW_X : mapTilesX;
+        int y1 = y0 + TILE_PASS_VIEW_Y < mapTilesY ? y0 + TILE_PASS_VIEW_Y : mapTilesY;
+        benchSink += legacy ? LegacyTilePass(legacy, x0, y0, x1, y1) : StoreTilePass(x0, y0, x1, y1);
+        cells += (long long)(x1 - x0) * (y1 - y0);
+    }
+    *viewTime = (NowSeconds() - start) / cells;
+}
+
+// Pushes or pops `count` scattered tiles on both the store and the legacy stacks alike
+static void ApplyBenchEdits(LegacyStack **legacy, int count, unsigned int seed)
+{
+    for (int i = 0; i < count; i++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        int x = (int)((seed >> 8) % (unsigned int)mapTilesX);
+        seed = seed * 1103515245u + 12345u;
+        int y = (int)((seed >> 8) % (unsigned int)mapTilesY);
+        if ((seed >> 20) % 3 == 0 && legacy[y][x].count > 0)
+        {
+            PopTile(x, y);
+            legacy[y][x].count--;
+        }
+        else
+        {
+            TileRef ref = MakeTileRef(TILE_REF_TILE, 1, (int)((seed >> 12) % 20));
+            bool isCollidable = (seed >> 24) % 8 == 0;
+            PushTile(x, y, ref, isCollidable);
+            PushLegacyTile(&legacy[y][x], RefToLegacyTile(ref), isCollidable);
+        }
+    }
+}
+
+// Heap bytes in use where the C library reports them, else 0
+static size_t GetHeapInUse(void)
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+// Bytes per-cell stacks ask malloc for, not counting its own bookkeeping
+static size_t GetLegacyStackBytes(LegacyStack **stacks, int width, int height)
+{
+    size_t bytes = height * sizeof(LegacyStack *) + (size_t)width * height * sizeof(LegacyStack);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+            bytes += (size_t)stacks[y][x].capacity * (sizeof(int) + sizeof(bool));
+    }
+    return bytes;
+}
+
+static int CountPaletteStacks(void)
+{
+    return tileStore.stackCount - tileStore.freeCount;
+}
+
+// Heap, load time and tile-pass cost of the map in the tile store, held as per-cell stacks
+// loaded from a version 1 file and as the palette loaded from a version 4 file; then edits
+// both alike and checks they still agree, before and after a save and load
+static bool RunTileStoreCase(const char *label)
+{
+    unsigned long long expected = HashPlacedTiles();
+    int width = mapTilesX, height = mapTilesY;
+    long long tileCount = 0;
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+            tileCount += GetTileSpan(x, y).count;
+    }
+    LegacySaveMap(MAP_BENCH_FILE);
+    size_t heapBefore = GetHeapInUse();
+    double start = NowSeconds();
+    LegacyStack **legacy = LegacyLoadMap(MAP_BENCH_FILE, &width, &height);
+    double loadTime = NowSeconds() - start;
+    size_t legacyBytes = GetHeapInUse() - heapBefore;
+    if (legacy == NULL)
+        return false;
+    if (heapBefore == 0)
+        legacyBytes = GetLegacyStackBytes(legacy, width, height);
+    bool identical = HashLegacyStacks(legacy, width, height) == expected;
+    double fullTime, viewTime;
+    TimeTilePasses(legacy, &fullTime, &viewTime);
+    printf("%-12s %-26s %12.1f %10.1f %12.2f %12.2f\n", label, "per-cell stacks, v1 file", legacyBytes / 1024.0,
+           loadTime * 1000.0, fullTime * 1e9, viewTime * 1e9);
+    // What the packed layout before the palette held: an offset per cell and every tile
+    printf("%-12s %-26s %12.1f %10s %12s %12s\n", label, "packed entries per cell",
+           ((double)width * height + 1 + tileCount) * sizeof(uint32_t) / 1024.0, "-", "-", "-");
+
+    SaveTilePlacement(MAP_BENCH_FILE);
+    start = NowSeconds();
+    LoadTilePlacement(MAP_BENCH_FILE);
+    loadTime = NowSeconds() - start;
+    identical = identical && HashPlacedTiles() == expected;
+    TimeTilePasses(NULL, &fullTime, &viewTime);
+    printf("%-12s %-26s %12.1f %10.1f %12.2f %12.2f  (%d stacks)\n", label, "tile palette, v4 file",
+           GetTileStoreBytes(&tileStore) / 1024.0, loadTime * 1000.0, fullTime * 1e9, viewTime * 1e9,
+           CountPaletteStacks());
+
+    ApplyBenchEdits(legacy, width * height / 64 + 1, 4242);
+    expected = HashLegacyStacks(legacy, width, height);
+    identical = identical && HashPlacedTiles() == expected;
+    printf("%-12s %-26s %12.1f %10s %12s %12s  (%d stacks)\n", label, "palette, 1/64 cells edited",
+           GetTileStoreBytes(&tileStore) / 1024.0, "-", "-", "-", CountPaletteStacks());
+    SaveTilePlacement(MAP_BENCH_FILE);
+    LoadTilePlacement(MAP_BENCH_FILE);
+    identical = identical && HashPlacedTiles() == expected;
+
+    FreeLegacyStacks(legacy, width, height);
+    FreeTileData();
+    remove(MAP_BENCH_FILE);
+    return identical;
+}
+
+// The map file and generated maps of every size up to maxSide, through RunTileStoreCase;
+// false if the palette and the stacks ever disagree
+static bool RunTileStoreBench(int maxSide, const char *mapPath)
+{
+    RegisterBenchTilemaps();
+    printf("Tile stores: heap, load time and tile pass per cell (%dx%d views)\n", TILE_PASS_VIEW_X, TILE_PASS_VIEW_Y);
+    printf("%-12s %-26s %12s %10s %12s %12s\n", "map", "layout", "heap KB", "load ms", "full ns/cell", "view ns/cell");
+    bool identical = true;
+    LoadTilePlacement(mapPath);
+    if (tileStore.cells != NULL)
+        identical = RunTileStoreCase("map file");
+    for (int side = 256; side <= maxSide; side *= 4)
+    {
+        BuildBenchMap(side);
+        char label[32];
+        snprintf(label, sizeof(label), "%dx%d", side, side);
+        identical = RunTileStoreCase(label) && identical;
+    }
+    printf("%s\n", identical ? "The palette matched the stacks after every load and edit." : "The palette and the stacks differ!");
+    return identical;
+}
+
+int main(int argc, char **argv)
+{
+    const char *mode = argc > 1 ? argv[1] : "lookup";
+    const char *directory = argc > 2 ? argv[2] : ASSET_PATH;
+
+    if (strcmp(mode, "lookup") == 0)
+    {
+        RunLookupBench(directory);
+    }
+    else if (strcmp(mode, "decode") == 0)
+    {
+        int maxThreads = argc > 3 ? atoi(argv[3]) : GetDefaultLoaderThreadCount();
+        RunDecodeBench(directory, maxThreads > 0 ? maxThreads : 1);
+    }
+    else if (strcmp(mode, "blank") == 0)
+    {
+        RunBlankBench(directory);
+    }
+    else if (strcmp(mode, "tilemap") == 0)
+    {
+        RunTilemapBench(directory, argc > 3 ? argv[3] : "../maps/map1.dat");
+    }
+    else if (strcmp(mode, "atlas") == 0)
+    {
+        RunAtlasBench(directory);
+    }
+    else if (strcmp(mode, "mapfile") == 0)
+    {
+        int maxSide = argc > 2 ? atoi(argv[2]) : 4096;
+        if (!RunMapFileBench(maxSide >= 256 ? maxSide : 4096))
+            return 1;
+    }
+    else if (strcmp(mode, "tilestore") == 0)
+    {
+        int maxSide = argc > 2 ? atoi(argv[2]) : 4096;
+        if (!RunTileStoreBench(maxSide >= 256 ? maxSide : 4096, argc > 3 ? argv[3] : "../maps/map1.dat"))
+            return 1;
+    }
+    else
+    {
+        fprintf(stderr, "Usage: %s lookup|decode|blank|tilemap|atlas [asset directory] [threads|map file]\n"
+                        "       %s mapfile [largest map side]\n"
+                        "       %s tilestore [largest map side] [map file]\n", argv[0], argv[0], argv[0]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,1072 @@
+// npc_bench.c
+//
+// Headless NPC simulation benchmarks. Runs without a window or GPU.
+//
+//   npc_bench separation [max NPCs]   per-tick UpdateNPCs cost from 100 NPCs up: all-pairs loop vs spatial grid
+//   npc_bench soa [max NPCs]          NPC struct array vs NPCStore on the scalar, SSE2 and AVX2 kernels
+//   npc_bench threads [NPCs] [ticks]  world-state hash and tick cost on 1, 2, 4 and 8 threads; exits 1 if hashes differ
+//   npc_bench flow [units]            one group move order across a walled 256x256 tile map through shared flow fields
+//   npc_bench hpa [map tiles]         hierarchical A* query latency, path validity, and patched graph vs a fresh build
+//   npc_bench collision [NPCs]        collision bitmap queries vs per-stack scans, and NPC ticks with and without tile collision
+//   npc_bench pick [NPCs]             point, rect and radius picking through the pick index vs a linear scan of every box
+//   npc_bench sleep [NPCs] [ticks]    a mostly idle army with occasional orders, with and without sleeping NPCs; exits 1 if they differ
+
+#include "asset_manager.h"
+#include "animation_player.h"
+#include "npc.h"
+#include "npc_store.h"
+#include "flow_field.h"
+#include "map.h"
+#include "path_graph.h"
+#include "pick_index.h"
+#include "raymath.h"
+#include "spatial_grid.h"
+#include "tile_placement_data.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+AssetManager manager;
+
+#define BENCH_AREA_PER_NPC 2800.0f // World area per NPC; about 4 neighbours within separation range
+#define BENCH_TIME_BUDGET 1.0      // Seconds spent timing each mode at each size
+#define BENCH_MAX_TICKS 200
+#define BENCH_DRIFT_TICKS 3        // Ticks both separation modes run before their positions are compared
+
+static double NowSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static unsigned int benchRandomState = 12345u;
+
+static float RandomFloat(float max)
+{
+    benchRandomState = benchRandomState * 1664525u + 1013904223u;
+    return (benchRandomState >> 8) * (max / 16777216.0f);
+}
+
+// Clips InitNPC and SetNPCState look up; no pixels are needed
+static void RegisterBenchClips(void)
+{
+    InitAssetManager(&manager);
+    Rectangle frames[6];
+    for (int i = 0; i < 6; i++)
+    {
+        frames[i] = (Rectangle){i * 192.0f, 0, 192, 192};
+    }
+    AddAnimation(&manager, (Texture2D){0}, "Bench_1", frames, 6, 192, 192, 6);
+    AddAnimation(&manager, (Texture2D){0}, "Bench_2", frames, 6, 192, 192, 6);
+    AddAnimation(&manager, (Texture2D){0}, "Bench_3", frames, 6, 192, 192, 6);
+}
+
+// A spread-out crowd at constant density; half of it walks towards random targets
+static void SpawnCrowd(NPC *npcs, int count)
+{
+    float side = sqrtf(count * BENCH_AREA_PER_NPC);
+    benchRandomState = 12345u;
+    ResetAnimationPlayers();
+    for (int i = 0; i < count; i++)
+    {
+        InitNPC(&npcs[i], &manager, (Vector2){RandomFloat(side), RandomFloat(side)}, 100.0f, "Bench_1");
+        if (i % 2 == 0)
+        {
+            npcs[i].targetPosition = (Vector2){RandomFloat(side), RandomFloat(side)};
+            SetNPCState(&npcs[i], NPC_WALKING);
+        }
+    }
+}
+
+// The struct-array update NPCStore replaced: every NPC stays a whole NPC struct and separation
+// strides over them through a spatial grid. Kept only as the "struct" baseline of the soa bench.
+static SpatialGrid structGrid;
+static Vector2 *structTickPositions = NULL;
+static int structTickCapacity = 0;
+
+// Rebuilds structGrid from the NPCs' current positions. Cells are one separation diameter
+// wide, so every neighbour is in the 3x3 cells around an NPC.
+static void BuildStructGrid(const NPC *npcs, int count)
+{
+    float maxRadius = 1.0f;
+    for (int i = 0; i < count; i++)
+    {
+        if (npcs[i].collisionRadius > maxRadius)
+            maxRadius = npcs[i].collisionRadius;
+    }
+    if (structGrid.cellSize != maxRadius * 2.0f)
+    {
+        FreeSpatialGrid(&structGrid);
+        InitSpatialGrid(&structGrid, maxRadius * 2.0f);
+    }
+    BuildSpatialGrid(&structGrid, &npcs[0].position, count, sizeof(NPC));
+}
+
+static void UpdateStructNPC(NPC *npc, int index, float deltaTime)
+{
+    Vector2 position = structTickPositions[index];
+    Vector2 separation = {0.0f, 0.0f};
+    int neighbors = 0;
+    int cellX, cellY;
+    GetSpatialGridCell(&structGrid, position, &cellX, &cellY);
+    for (int y = cellY - 1; y <= cellY + 1; y++)
+    {
+        for (int x = cellX - 1; x <= cellX + 1; x++)
+        {
+            int begin, end;
+            GetSpatialGridBucket(&structGrid, x, y, &begin, &end);
+            for (int e = begin; e < end; e++)
+            {
+                const SpatialGridEntry *entry = &structGrid.entries[e];
+                if (entry->cellX != x || entry->cellY != y || entry->index == index)
+                    continue;
+                Vector2 other = structTickPositions[entry->index];
+                float distance = Vector2Distance(position, other);
+                if (distance < npc->collisionRadius * 2.0f)
+                {
+                    Vector2 away = Vector2Normalize(Vector2Subtract(position, other));
+                    separation = Vector2Add(separation, Vector2Scale(away, 1.0f / (distance + 0.01f)));
+                    neighbors++;
+                }
+            }
+        }
+    }
+
+    AnimationClip *clip = GetPlayerClip(&manager, npc->animation);
+    int frameWidth = clip ? clip->frameWidth : 0;
+    int frameHeight = clip ? clip->frameHeight : 0;
+    npc->boundingBox = (Rectangle){npc->position.x - frameWidth / 8, npc->position.y - frameHeight / 8,
+                                   frameWidth / 4, frameHeight / 4};
+
+    if (neighbors > 0)
+        npc->position = Vector2Add(npc->position, Vector2Scale(separation, npc->separationForce * deltaTime));
+
+    if (npc->state == NPC_WALKING)
+    {
+        Vector2 direction = Vector2Subtract(npc->targetPosition, npc->position);
+        float distance = Vector2Length(direction);
+        if (distance > 1.0f && npc->speed * deltaTime <= distance)
+        {
+            npc->position = Vector2Add(npc->position, Vector2Scale(direction, npc->speed * deltaTime / distance));
+        }
+        else
+        {
+            if (distance > 1.0f)
+                npc->position = npc->targetPosition;
+            SetNPCState(npc, NPC_IDLE);
+        }
+    }
+}
+
+static void UpdateStructNPCs(NPC npcs[], int count, float deltaTime)
+{
+    if (count > structTickCapacity)
+    {
+        Vector2 *grown = realloc(structTickPositions, count * sizeof(Vector2));
+        if (!grown)
+        {
+            fprintf(stderr, "Out of memory for %d NPCs.\n", count);
+            return;
+        }
+        structTickPositions = grown;
+        structTickCapacity = count;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        structTickPositions[i] = npcs[i].position;
+    }
+    BuildStructGrid(npcs, count);
+    for (int i = 0; i < count; i++)
+    {
+        UpdateStructNPC(&npcs[i], i, deltaTime);
+    }
+}
+
+// Average seconds per tick of update over up to BENCH_TIME_BUDGET
+static double TimeTicks(void (*update)(NPC npcs[], int count, float deltaTime), NPC *npcs, int count, int *ticksRun)
+{
+    int ticks = 0;
+    double start = NowSeconds();
+    double elapsed = 0.0;
+    while (ticks < BENCH_MAX_TICKS && (ticks < 3 || elapsed < BENCH_TIME_BUDGET))
+    {
+        update(npcs, count, 1.0f / 60.0f);
+        ticks++;
+        elapsed = NowSeconds() - start;
+    }
+    *ticksRun = ticks;
+    return elapsed / ticks;
+}
+
+static double TimeGridBuilds(NPC *npcs, int count)
+{
+    int builds = 0;
+    double start = NowSeconds();
+    while (builds < 100 && (builds < 3 || NowSeconds() - start < 0.1))
+    {
+        BuildStructGrid(npcs, count);
+        builds++;
+    }
+    return (NowSeconds() - start) / builds;
+}
+
+static void RunSeparationBench(int maxCount)
+{
+    static const int sizes[] = {100, 250, 500, 1000, 2000, 4000, 8000, 12000, 16000, 20000};
+    int sizeCount = sizeof(sizes) / sizeof(sizes[0]);
+
+    NPC *initial = malloc(maxCount * sizeof(NPC));
+    NPC *bruteForce = malloc(maxCount * sizeof(NPC));
+    NPC *grid = malloc(maxCount * sizeof(NPC));
+    if (!initial || !bruteForce || !grid)
+    {
+        fprintf(stderr, "Out of memory for %d NPCs.\n", maxCount);
+        free(initial);
+        free(bruteForce);
+        free(grid);
+        return;
+    }
+    RegisterBenchClips();
+
+    printf("NPC separation: per-tick UpdateNPCs cost, %.0f px^2 per NPC, collision radius 30\n", BENCH_AREA_PER_NPC);
+    printf("%7s %14s %12s %10s %12s %9s %12s\n", "NPCs", "all-pairs ms", "grid ms", "speedup", "grid build", "ticks", "max drift px");
+    for (int s = 0; s < sizeCount && sizes[s] <= maxCount; s++)
+    {
+        int count = sizes[s];
+        SpawnCrowd(initial, count);
+
+        // A few ticks from the same state: both modes must find the same neighbours every tick
+        memcpy(bruteForce, initial, count * sizeof(NPC));
+        memcpy(grid, initial, count * sizeof(NPC));
+        for (int tick = 0; tick < BENCH_DRIFT_TICKS; tick++)
+        {
+            npcUseSpatialGrid = false;
+            UpdateNPCs(bruteForce, count, 1.0f / 60.0f);
+            npcUseSpatialGrid = true;
+            UpdateNPCs(grid, count, 1.0f / 60.0f);
+        }
+        float drift = 0.0f;
+        for (int i = 0; i < count; i++)
+        {
+            drift = fmaxf(drift, fabsf(bruteForce[i].position.x - grid[i].position.x));
+            drift = fmaxf(drift, fabsf(bruteForce[i].position.y - grid[i].position.y));
+        }
+
+        int bruteTicks, gridTicks;
+        memcpy(bruteForce, initial, count * sizeof(NPC));
+        npcUseSpatialGrid = false;
+        double bruteSeconds = TimeTicks(UpdateNPCs, bruteForce, count, &bruteTicks);
+        memcpy(grid, initial, count * sizeof(NPC));
+        npcUseSpatialGrid = true;
+        double gridSeconds = TimeTicks(UpdateNPCs, grid, count, &gridTicks);
+        double buildSeconds = TimeGridBuilds(initial, count);
+
+        printf("%7d %14.3f %12.3f %9.1fx %10.3f ms %4d/%-4d %12.2g\n", count, bruteSeconds * 1000.0, gridSeconds * 1000.0,
+               bruteSeconds / gridSeconds, buildSeconds * 1000.0, bruteTicks, gridTicks, drift);
+    }
+
+    free(initial);
+    free(bruteForce);
+    free(grid);
+}
+
+// Average seconds per UpdateNPCStore tick over up to BENCH_TIME_BUDGET
+static double TimeStoreTicks(NPCStore *store, int *ticksRun)
+{
+    int ticks = 0;
+    double start = NowSeconds();
+    double elapsed = 0.0;
+    while (ticks < BENCH_MAX_TICKS && (ticks < 3 || elapsed < BENCH_TIME_BUDGET))
+    {
+        UpdateNPCStore(store, 1.0f / 60.0f);
+        ticks++;
+        elapsed = NowSeconds() - start;
+    }
+    *ticksRun = ticks;
+    return elapsed / ticks;
+}
+
+static void FillStore(NPCStore *store, const NPC *npcs, int count)
+{
+    store->count = 0;
+    for (int i = 0; i < count; i++)
+    {
+        AddNPCToStore(store, &npcs[i]);
+    }
+}
+
+static void RunSoABench(int maxCount)
+{
+    static const int sizes[] = {100, 1000, 4000, 10000, 20000};
+    int sizeCount = sizeof(sizes) / sizeof(sizes[0]);
+    NPCKernelPath paths[] = {NPC_KERNEL_SCALAR, NPC_KERNEL_SSE2, NPC_KERNEL_AVX2};
+    int pathCount = sizeof(paths) / sizeof(paths[0]);
+
+    NPC *initial = malloc(maxCount * sizeof(NPC));
+    NPC *array = malloc(maxCount * sizeof(NPC));
+    if (!initial || !array)
+    {
+        fprintf(stderr, "Out of memory for %d NPCs.\n", maxCount);
+        free(initial);
+        free(array);
+        return;
+    }
+    RegisterBenchClips();
+    npcUseSpatialGrid = true;
+
+    NPCStore store, reference;
+    InitNPCStore(&store);
+    InitNPCStore(&reference);
+
+    printf("NPC storage: per-tick update cost with the spatial grid, sizeof(NPC) = %zu bytes\n", sizeof(NPC));
+    printf("%7s %10s %10s %10s %10s %12s\n", "NPCs", "struct ms", "scalar ms", "SSE2 ms", "AVX2 ms", "max drift px");
+    for (int s = 0; s < sizeCount && sizes[s] <= maxCount; s++)
+    {
+        int count = sizes[s];
+        SpawnCrowd(initial, count);
+
+        int ticks;
+        memcpy(array, initial, count * sizeof(NPC));
+        double arraySeconds = TimeTicks(UpdateStructNPCs, array, count, &ticks);
+        printf("%7d %10.3f", count, arraySeconds * 1000.0);
+
+        // One tick on the scalar kernels is the reference the vector paths are compared to
+        SetNPCKernelPath(NPC_KERNEL_SCALAR);
+        FillStore(&reference, initial, count);
+        UpdateNPCStore(&reference, 1.0f / 60.0f);
+
+        float drift = 0.0f;
+        for (int p = 0; p < pathCount; p++)
+        {
+            if (!SetNPCKernelPath(paths[p]))
+            {
+                printf(" %10s", "n/a");
+                continue;
+            }
+            FillStore(&store, initial, count);
+            UpdateNPCStore(&store, 1.0f / 60.0f);
+            for (int i = 0; i < count; i++)
+            {
+                drift = fmaxf(drift, fabsf(store.positionX[i] - reference.positionX[i]));
+                drift = fmaxf(drift, fabsf(store.positionY[i] - reference.positionY[i]));
+            }
+
+            FillStore(&store, initial, count);
+            double storeSeconds = TimeStoreTicks(&store, &ticks);
+            printf(" %10.3f", storeSeconds * 1000.0);
+        }
+        printf(" %12.2g\n", drift);
+    }
+    SetNPCKernelPath(NPC_KERNEL_AUTO);
+
+    FreeNPCStore(&store);
+    FreeNPCStore(&reference);
+    free(initial);
+    free(array);
+}
+
+static uint64_t HashBytes(uint64_t hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ull; // FNV-1a
+    }
+    return hash;
+}
+
+// Everything a tick writes, bit for bit
+static uint64_t HashWorldState(const NPCStore *store)
+{
+    uint64_t hash = 14695981039346656037ull;
+    hash = HashBytes(hash, store->positionX, store->count * sizeof(float));
+    hash = HashBytes(hash, store->positionY, store->count * sizeof(float));
+    hash = HashBytes(hash, store->state, store->count * sizeof(int));
+    hash = HashBytes(hash, store->boxX, store->count * sizeof(float));
+    hash = HashBytes(hash, store->boxY, store->count * sizeof(float));
+    for (int i = 0; i < store->count; i++)
+    {
+        const AnimationPlayer *player = GetAnimationPlayer(store->cold[i].animation);
+        if (player)
+            hash = HashBytes(hash, &player->clip, sizeof(player->clip));
+    }
+    return hash;
+}
+
+static bool RunThreadBench(int count, int tickCount)
+{
+    static const int threadCounts[] = {1, 2, 4, 8};
+    int runCount = sizeof(threadCounts) / sizeof(threadCounts[0]);
+
+    NPC *initial = malloc(count * sizeof(NPC));
+    if (!initial)
+    {
+        fprintf(stderr, "Out of memory for %d NPCs.\n", count);
+        return false;
+    }
+    RegisterBenchClips();
+    npcUseSpatialGrid = true;
+
+    printf("NPC update: %d NPCs, %d ticks, %s kernels\n", count, tickCount, GetNPCKernelPathName(GetNPCKernelPath()));
+    printf("%8s %10s %9s %18s\n", "threads", "ms/tick", "speedup", "world hash");
+    uint64_t expected = 0;
+    double serialSeconds = 0.0;
+    bool identical = true;
+    for (int r = 0; r < runCount; r++)
+    {
+        SpawnCrowd(initial, count);
+        NPCStore store;
+        InitNPCStore(&store);
+        for (int i = 0; i < count; i++)
+        {
+            AddNPCToStore(&store, &initial[i]);
+        }
+        int threads = SetNPCStoreThreadCount(&store, threadCounts[r]);
+
+        double start = NowSeconds();
+        for (int t = 0; t < tickCount; t++)
+        {
+            UpdateNPCStore(&store, 1.0f / 60.0f);
+        }
+        double seconds = (NowSeconds() - start) / tickCount;
+        uint64_t hash = HashWorldState(&store);
+        FreeNPCStore(&store);
+
+        if (r == 0)
+        {
+            expected = hash;
+            serialSeconds = seconds;
+        }
+        identical = identical && hash == expected;
+        printf("%8d %10.3f %8.2fx   %016llx%s\n", threads, seconds * 1000.0, serialSeconds / seconds,
+               (unsigned long long)hash, hash == expected ? "" : "  MISMATCH");
+    }
+    printf("%s\n", identical ? "World state identical for every thread count." : "World state differs between thread counts!");
+
+    free(initial);
+    return identical;
+}
+
+#define FLOW_BENCH_GOAL_X 252
+#define FLOW_BENCH_GOAL_Y 128
+
+// Walls every 32 tiles with three gaps each, plus scattered rocks; units start on the left edge
+static void BuildBenchTileMap(int size)
+{
+    InitTileData(size, size, 0, 0);
+    for (int x = 32; x < mapTilesX; x += 32)
+    {
+        for (int y = 0; y < mapTilesY; y++)
+        {
+            bool gap = (y + x) % 96 < 6;
+            if (!gap)
+                PushTile(x, y, 0, true);
+        }
+    }
+    for (int n = 0; n < mapTilesX * mapTilesY / 10; n++)
+    {
+        int x = (int)RandomFloat((float)mapTilesX), y = (int)RandomFloat((float)mapTilesY);
+        bool nearGoal = abs(x - FLOW_BENCH_GOAL_X) < 2 && abs(y - FLOW_BENCH_GOAL_Y) < 2;
+        if (x > 8 && !nearGoal && GetTileSpan(x, y).count == 0)
+            PushTile(x, y, 0, true);
+    }
+}
+
+static void RunFlowBench(int count)
+{
+    RegisterBenchClips();
+    BuildBenchTileMap(256);
+    npcUseSpatialGrid = true;
+
+    NPCStore store;
+    InitNPCStore(&store);
+    for (int i = 0; i < count; i++)
+    {
+        NPC npc;
+        Vector2 position = {RandomFloat(8.0f * tileSize), RandomFloat((float)mapTilesY * tileSize)};
+        InitNPC(&npc, &manager, position, 400.0f, "Bench_1");
+        npc.isSelected = true;
+        AddNPCToStore(&store, &npc);
+    }
+    SetNPCStoreThreadCount(&store, GetDefaultWorkerCount());
+
+    Vector2 goal = {(FLOW_BENCH_GOAL_X + 0.5f) * tileSize, (FLOW_BENCH_GOAL_Y + 0.5f) * tileSize};
+    double start = NowSeconds();
+    int ordered = MoveSelectedNPCs(&store, goal);
+    double orderSeconds = NowSeconds() - start;
+    FlowFieldStats stats = GetFlowFieldStats();
+    printf("Flow fields: %dx%d tiles, %d units ordered in %.3f ms (%d field build, %.3f ms)\n", mapTilesX, mapTilesY,
+           ordered, orderSeconds * 1000.0, stats.builds, stats.buildSeconds * 1000.0);
+    printf("A search per unit would be about %d builds, %.1f ms\n", ordered, ordered * stats.buildSeconds * 1000.0);
+
+    start = NowSeconds();
+    MoveSelectedNPCs(&store, goal);
+    printf("Repeat order to the same tile: %.3f ms, %d new builds\n", (NowSeconds() - start) * 1000.0,
+           GetFlowFieldStats().builds - stats.builds);
+
+    // Close a gap in the first wall mid-walk; only the one live field is rebuilt
+    int tickCount = 0, arrived = 0;
+    start = NowSeconds();
+    for (; tickCount < 9000 && arrived < count; tickCount++)
+    {
+        if (tickCount == 60)
+            PushTile(32, 64, 0, true);
+        UpdateNPCStore(&store, 1.0f / 30.0f);
+        arrived = 0;
+        for (int i = 0; i < store.count; i++)
+        {
+            arrived += store.state[i] == NPC_IDLE;
+        }
+    }
+    double tickSeconds = (NowSeconds() - start) / (tickCount > 0 ? tickCount : 1);
+    stats = GetFlowFieldStats();
+    printf("%d of %d units arrived after %d ticks (%.3f ms/tick); %d builds, %d rebuilds, %d cache hits\n", arrived, count,
+           tickCount, tickSeconds * 1000.0, stats.builds, stats.rebuilds, stats.cacheHits);
+
+    FreeNPCStore(&store);
+    ResetFlowFields();
+    FreeTileData();
+}
+
+static int CompareDoubles(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void RandomOpenTile(int *x, int *y)
+{
+    do
+    {
+        *x = (int)RandomFloat((float)mapTilesX);
+        *y = (int)RandomFloat((float)mapTilesY);
+    } while (GetTileTravelCost(*x, *y) <= 0.0f);
+}
+
+// Every step is to an open neighbour without cutting a blocked corner, and the steps add up to
+// the reported cost
+static bool IsTilePathValid(const TilePath *path)
+{
+    float cost = 0.0f;
+    for (int i = 1; i < path->count; i++)
+    {
+        int x = path->x[i - 1], y = path->y[i - 1];
+        int dx = path->x[i] - x, dy = path->y[i] - y;
+        if (abs(dx) > 1 || abs(dy) > 1 || (dx == 0 && dy == 0) || GetTileTravelCost(x + dx, y + dy) <= 0.0f)
+            return false;
+        if (dx != 0 && dy != 0 && (GetTileTravelCost(x + dx, y) <= 0.0f || GetTileTravelCost(x, y + dy) <= 0.0f))
+            return false;
+        float length = (dx != 0 && dy != 0) ? 1.41421356f : 1.0f;
+        cost += length * (GetTileTravelCost(x, y) + GetTileTravelCost(x + dx, y + dy)) * 0.5f;
+    }
+    return fabsf(cost - path->cost) <= 1e-3f * (1.0f + cost);
+}
+
+#define HPA_BENCH_QUERIES 1000
+#define HPA_BENCH_EDITS 200
+
+// Sorts the samples in place and prints their mean, p50, p99 and max in ms
+static void PrintLatencies(double *seconds, int count)
+{
+    qsort(seconds, count, sizeof(double), CompareDoubles);
+    double total = 0.0;
+    for (int i = 0; i < count; i++)
+    {
+        total += seconds[i];
+    }
+    printf("ms mean %.3f, p50 %.3f, p99 %.3f, max %.3f\n", total / count * 1000.0, seconds[count / 2] * 1000.0,
+           seconds[count * 99 / 100] * 1000.0, seconds[count - 1] * 1000.0);
+}
+
+static bool RunPathGraphBench(int size)
+{
+    BuildBenchTileMap(size);
+    InitMap(&map, size, size); // Water and mountain bands for the terrain costs
+    UpdatePathGraph();
+    PathGraphStats stats = GetPathGraphStats();
+    printf("Path graph: %dx%d tiles, %d clusters, %d nodes, %d edges, built in %.1f ms\n", size, size, stats.clusters,
+           stats.nodes, stats.edges, stats.buildSeconds * 1000.0);
+
+    static int queryX[HPA_BENCH_QUERIES][2], queryY[HPA_BENCH_QUERIES][2];
+    static double latency[HPA_BENCH_QUERIES];
+    static double editLatency[HPA_BENCH_EDITS];
+    static float patchedCost[HPA_BENCH_QUERIES];
+    TilePath path = {0};
+    int found = 0, invalid = 0;
+    for (int q = 0; q < HPA_BENCH_QUERIES; q++)
+    {
+        RandomOpenTile(&queryX[q][0], &queryY[q][0]);
+        RandomOpenTile(&queryX[q][1], &queryY[q][1]);
+        double start = NowSeconds();
+        bool ok = FindTilePath(queryX[q][0], queryY[q][0], queryX[q][1], queryY[q][1], &path);
+        latency[q] = NowSeconds() - start;
+        found += ok;
+        invalid += ok && !IsTilePathValid(&path);
+    }
+    printf("%d random queries: %d found, %d invalid; ", HPA_BENCH_QUERIES, found, invalid);
+    PrintLatencies(latency, HPA_BENCH_QUERIES);
+
+    // Edit tiles one at a time as the editor does, then check the patched graph against a fresh one
+    stats = GetPathGraphStats();
+    for (int e = 0; e < HPA_BENCH_EDITS; e++)
+    {
+        int x = (int)RandomFloat((float)size), y = (int)RandomFloat((float)size);
+        if (GetTileSpan(x, y).count > 0)
+            PopTile(x, y);
+        else
+            PushTile(x, y, 0, true);
+        double start = NowSeconds();
+        UpdatePathGraph();
+        editLatency[e] = NowSeconds() - start;
+    }
+    PathGraphStats patched = GetPathGraphStats();
+    printf("%d tile edits: %d full builds, %d clusters patched, %d landmark rebuilds, %d nodes lowered, %d still "
+           "queued; ",
+           HPA_BENCH_EDITS, patched.fullBuilds - stats.fullBuilds, patched.patchedClusters - stats.patchedClusters,
+           patched.landmarkBuilds - stats.landmarkBuilds, patched.landmarkLowered - stats.landmarkLowered,
+           patched.landmarkQueued);
+    PrintLatencies(editLatency, HPA_BENCH_EDITS);
+
+    for (int q = 0; q < HPA_BENCH_QUERIES; q++)
+    {
+        double start = NowSeconds();
+        patchedCost[q] = FindTilePath(queryX[q][0], queryY[q][0], queryX[q][1], queryY[q][1], &path) ? path.cost : -1.0f;
+        latency[q] = NowSeconds() - start;
+    }
+    printf("Same queries after the edits: ");
+    PrintLatencies(latency, HPA_BENCH_QUERIES);
+    ResetPathGraph();
+    int mismatches = 0;
+    for (int q = 0; q < HPA_BENCH_QUERIES; q++)
+    {
+        float cost = FindTilePath(queryX[q][0], queryY[q][0], queryX[q][1], queryY[q][1], &path) ? path.cost : -1.0f;
+        mismatches += fabsf(cost - patchedCost[q]) > 1e-3f * (1.0f + fabsf(cost));
+    }
+    printf("Patched graph vs fresh build: %d of %d path costs differ\n", mismatches, HPA_BENCH_QUERIES);
+
+    FreeTilePath(&path);
+    ResetPathGraph();
+    FreeMap(&map);
+    memset(&map, 0, sizeof(Map));
+    FreeTileData();
+    return invalid == 0 && mismatches == 0;
+}
+
+#define COLLISION_BENCH_QUERIES 20000
+
+// What test_map_scene did before the bitmap: every layer of every stack on one screen of tiles
+static bool ScanStacksForCollision(Rectangle rec, int tilesX, int tilesY)
+{
+    for (int y = 0; y < tilesY; y++)
+    {
+        for (int x = 0; x < tilesX; x++)
+        {
+            TileSpan span = GetTileSpan(x, y);
+            for (int i = 0; i < span.count; i++)
+            {
+                Rectangle tile = {x * tileSize, y * tileSize, tileSize, tileSize};
+                if (IsTileEntryCollidable(span.entries[i]) && CheckCollisionRecs(rec, tile))
+                    return true;
+            }
+        }
+    }
+    return false;
+}
+
+static Rectangle RandomBenchRect(float maxX, float maxY)
+{
+    float width = 8.0f + RandomFloat(192.0f), height = 8.0f + RandomFloat(192.0f);
+    return (Rectangle){RandomFloat(maxX - width), RandomFloat(maxY - height), width, height};
+}
+
+// Rect and ray answers are checked against the stacks themselves, slides against the bitmap;
+// then NPCs walk straight across the walled map with tile collision off and on
+static bool RunCollisionBench(int count)
+{
+    RegisterBenchClips();
+    BuildBenchTileMap(256);
+    const int screenX = 30, screenY = 17; // 1920x1080 in tiles
+    float worldSize = (float)mapTilesX * tileSize;
+    static Rectangle rects[COLLISION_BENCH_QUERIES];
+    for (int q = 0; q < COLLISION_BENCH_QUERIES; q++)
+    {
+        rects[q] = RandomBenchRect(screenX * tileSize, screenY * tileSize);
+    }
+
+    int hits = 0, bitmapHits = 0, wrong = 0;
+    double start = NowSeconds();
+    for (int q = 0; q < COLLISION_BENCH_QUERIES; q++)
+    {
+        hits += ScanStacksForCollision(rects[q], screenX, screenY);
+    }
+    double scanSeconds = NowSeconds() - start;
+    start = NowSeconds();
+    for (int q = 0; q < COLLISION_BENCH_QUERIES; q++)
+    {
+        bitmapHits += CheckCollisionMapRec(&tileCollisionMap, rects[q]);
+    }
+    double bitmapSeconds = NowSeconds() - start;
+    for (int q = 0; q < COLLISION_BENCH_QUERIES; q++)
+    {
+        wrong += CheckCollisionMapRec(&tileCollisionMap, rects[q]) != ScanStacksForCollision(rects[q], screenX, screenY);
+    }
+    wrong += hits != bitmapHits;
+    printf("Rect overlap, %d queries on one screen (%d hit): stack scan %.3f us, bitmap %.3f us; %d disagree\n",
+           COLLISION_BENCH_QUERIES, bitmapHits, scanSeconds / COLLISION_BENCH_QUERIES * 1e6, bitmapSeconds / COLLISION_BENCH_QUERIES * 1e6,
+           wrong);
+
+    // A slide must never end overlapping a collidable tile it did not start in
+    int slides = 0, overlaps = 0;
+    start = NowSeconds();
+    for (int q = 0; q < COLLISION_BENCH_QUERIES; q++)
+    {
+        Rectangle rec = RandomBenchRect(worldSize, worldSize);
+        rec.width = rec.height = 48.0f;
+        if (CheckCollisionMapRec(&tileCollisionMap, rec))
+            continue;
+        Vector2 motion = {RandomFloat(400.0f) - 200.0f, RandomFloat(400.0f) - 200.0f};
+        Vector2 moved = SlideCollisionMapRec(&tileCollisionMap, rec, motion);
+        rec.x += moved.x;
+        rec.y += moved.y;
+        overlaps += CheckCollisionMapRec(&tileCollisionMap, rec);
+        slides++;
+    }
+    printf("Swept slides: %d boxes, %.3f us each, %d end inside a tile\n", slides,
+           (NowSeconds() - start) / (slides > 0 ? slides : 1) * 1e6, overlaps);
+
+    // A ray hit must be a collidable cell with nothing collidable on the way there
+    int rayHits = 0, badRays = 0;
+    start = NowSeconds();
+    double rayTime = 0.0;
+    for (int q = 0; q < COLLISION_BENCH_QUERIES / 10; q++)
+    {
+        Vector2 origin = {RandomFloat(worldSize), RandomFloat(worldSize)};
+        float angle = RandomFloat(6.2831853f);
+        Vector2 direction = {cosf(angle), sinf(angle)};
+        CollisionHit hit;
+        double rayStart = NowSeconds();
+        bool found = RaycastCollisionMap(&tileCollisionMap, origin, direction, 2000.0f, &hit);
+        rayTime += NowSeconds() - rayStart;
+        float end = found ? hit.time - 0.5f : 2000.0f;
+        for (float t = 0.0f; t < end; t += 0.25f)
+        {
+            int x = (int)floorf((origin.x + direction.x * t) / tileSize), y = (int)floorf((origin.y + direction.y * t) / tileSize);
+            if (x >= 0 && y >= 0 && x < mapTilesX && y < mapTilesY && GetTileSpan(x, y).count > 0)
+            {
+                badRays++;
+                break;
+            }
+        }
+        rayHits += found;
+        badRays += found && GetTileSpan(hit.cellX, hit.cellY).count == 0;
+    }
+    printf("Rays: %d of %d hit within 2000 units, %.3f us each, %d wrong\n", rayHits, COLLISION_BENCH_QUERIES / 10,
+           rayTime / (COLLISION_BENCH_QUERIES / 10) * 1e6, badRays);
+
+    // Walk every NPC straight for the right edge, into the walls
+    npcUseSpatialGrid = true;
+    bool collideSetting = npcCollideWithTiles;
+    NPCStore store;
+    InitNPCStore(&store);
+    SetNPCStoreThreadCount(&store, GetDefaultWorkerCount());
+    int stuck = 0;
+    for (int pass = 0; pass < 2; pass++)
+    {
+        ClearNPCStore(&store);
+        for (int i = 0; i < count; i++)
+        {
+            int x, y;
+            do
+            {
+                x = (int)RandomFloat((float)mapTilesX);
+                y = (int)RandomFloat((float)mapTilesY);
+            } while (GetTileSpan(x, y).count > 0);
+            NPC npc;
+            InitNPC(&npc, &manager, (Vector2){(x + 0.5f) * tileSize, (y + 0.5f) * tileSize}, 400.0f, "Bench_1");
+            int index = AddNPCToStore(&store, &npc);
+            store.orderX[index] = store.targetX[index] = worldSize - 1.0f;
+            store.orderY[index] = store.targetY[index] = npc.position.y;
+            SetStoreNPCState(&store, index, NPC_WALKING);
+        }
+        npcCollideWithTiles = pass == 1;
+        int ticks = 0;
+        double seconds = TimeStoreTicks(&store, &ticks);
+        int inside = 0;
+        for (int i = 0; i < store.count; i++)
+        {
+            inside += CheckCollisionMapRec(&tileCollisionMap, GetStoreNPCBoundingBox(&store, i));
+        }
+        if (pass == 1)
+            stuck = inside;
+        printf("%d NPCs, tile collision %s: %.3f ms/tick, %d boxes inside collidable tiles\n", count,
+               npcCollideWithTiles ? "on " : "off", seconds * 1000.0, inside);
+    }
+    npcCollideWithTiles = collideSetting;
+
+    FreeNPCStore(&store);
+    FreeTileData();
+    return wrong == 0 && overlaps == 0 && badRays == 0 && stuck == 0;
+}
+
+#define PICK_BENCH_QUERIES 10000
+#define PICK_BENCH_BUILDINGS 8
+
+// What every picking call site did before the index: test each box in turn
+static int PickLinear(const PickIndex *index, int shape, Rectangle rect, Vector2 point, float radius, PickHit *hits)
+{
+    int found = 0;
+    for (int i = 0; i < index->count; i++)
+    {
+        Rectangle box = index->boxes[i];
+        bool hit = shape == 0   ? CheckCollisionPointRec(point, box)
+                   : shape == 1 ? CheckCollisionRecs(rect, box)
+                                : CheckCollisionCircleRec(point, radius, box);
+        if (hit)
+            hits[found++] = index->items[i];
+    }
+    return found;
+}
+
+static int ComparePickHits(const void *a, const void *b)
+{
+    const PickHit *x = a, *y = b;
+    if (x->kind != y->kind)
+        return x->kind < y->kind ? -1 : 1;
+    return (x->index > y->index) - (x->index < y->index);
+}
+
+static bool RunPickBench(int count)
+{
+    RegisterBenchClips();
+    NPC *npcs = malloc(count * sizeof(NPC));
+    PickHit *expected = malloc((count + PICK_BENCH_BUILDINGS) * sizeof(PickHit));
+    PickHit *actual = malloc((count + PICK_BENCH_BUILDINGS) * sizeof(PickHit));
+    if (!npcs || !expected || !actual)
+    {
+        fprintf(stderr, "Out of memory for %d NPCs\n", count);
+        free(npcs);
+        free(expected);
+        free(actual);
+        return false;
+    }
+    SpawnCrowd(npcs, count);
+    NPCStore store;
+    InitNPCStore(&store);
+    FillStore(&store, npcs, count);
+    float side = sqrtf(count * BENCH_AREA_PER_NPC);
+    Building buildings[PICK_BENCH_BUILDINGS] = {0};
+    for (int i = 0; i < PICK_BENCH_BUILDINGS; i++)
+    {
+        buildings[i].collisionBox = (Rectangle){RandomFloat(side), RandomFloat(side), 256.0f, 320.0f};
+    }
+
+    PickIndex index;
+    InitPickIndex(&index);
+    double start = NowSeconds();
+    for (int n = 0; n < 100; n++)
+    {
+        BuildPickIndex(&index, &store, buildings, PICK_BENCH_BUILDINGS);
+    }
+    printf("Pick index over %d NPCs and %d buildings: %.3f ms per build\n", count, PICK_BENCH_BUILDINGS,
+           (NowSeconds() - start) / 100 * 1000.0);
+
+    static const char *shapeNames[] = {"point", "rect (drag box up to 600x400)", "radius 100"};
+    int mismatches = 0;
+    for (int shape = 0; shape < 3; shape++)
+    {
+        double linearSeconds = 0.0, indexSeconds = 0.0;
+        long long hitCount = 0;
+        for (int q = 0; q < PICK_BENCH_QUERIES; q++)
+        {
+            Vector2 point = {RandomFloat(side), RandomFloat(side)};
+            Rectangle rect = {point.x, point.y, RandomFloat(600.0f), RandomFloat(400.0f)};
+            float radius = 100.0f;
+
+            start = NowSeconds();
+            int linear = PickLinear(&index, shape, rect, point, radius, expected);
+            linearSeconds += NowSeconds() - start;
+
+            const PickHit *hits;
+            start = NowSeconds();
+            int found = shape == 0   ? QueryPickPoint(&index, point, PICK_ANY, &hits)
+                        : shape == 1 ? QueryPickRect(&index, rect, PICK_ANY, &hits)
+                                     : QueryPickRadius(&index, point, radius, PICK_ANY, &hits);
+            indexSeconds += NowSeconds() - start;
+            hitCount += found;
+
+            memcpy(actual, hits, found * sizeof(PickHit));
+            qsort(expected, linear, sizeof(PickHit), ComparePickHits);
+            qsort(actual, found, sizeof(PickHit), ComparePickHits);
+            mismatches += linear != found || memcmp(expected, actual, found * sizeof(PickHit)) != 0;
+        }
+        printf("%-30s linear %.3f us, index %.3f us (%.1fx), %.1f hits per query\n", shapeNames[shape],
+               linearSeconds / PICK_BENCH_QUERIES * 1e6, indexSeconds / PICK_BENCH_QUERIES * 1e6,
+               linearSeconds / (indexSeconds > 0.0 ? indexSeconds : 1e-9), (double)hitCount / PICK_BENCH_QUERIES);
+    }
+    printf("%d of %d queries differ from the linear scan\n", mismatches, PICK_BENCH_QUERIES * 3);
+
+    FreePickIndex(&index);
+    FreeNPCStore(&store);
+    free(npcs);
+    free(expected);
+    free(actual);
+    return mismatches == 0;
+}
+
+#define SLEEP_BENCH_ORDER_EVERY 60 // Ticks between orders
+#define SLEEP_BENCH_ORDER_SIZE 50
+#define SLEEP_BENCH_SPACING 4.0f   // Lattice spacing in collision radii; two is the separation range
+
+// An army camped on a jittered lattice, out of each other's separation range. Every tenth unit
+// walks off at first, then small groups are ordered around now and then.
+static void SpawnCamp(NPC *npcs, int count)
+{
+    int columns = (int)ceilf(sqrtf((float)count));
+    benchRandomState = 12345u;
+    ResetAnimationPlayers();
+    for (int i = 0; i < count; i++)
+    {
+        InitNPC(&npcs[i], &manager, (Vector2){0, 0}, 100.0f, "Bench_1");
+        float spacing = npcs[i].collisionRadius * SLEEP_BENCH_SPACING;
+        npcs[i].position = (Vector2){(i % columns + 0.5f) * spacing + RandomFloat(spacing * 0.2f),
+                                     (i / columns + 0.5f) * spacing + RandomFloat(spacing * 0.2f)};
+        npcs[i].targetPosition = npcs[i].position;
+        if (i % 10 == 0)
+        {
+            npcs[i].targetPosition = (Vector2){RandomFloat(columns * spacing), RandomFloat(columns * spacing)};
+            SetNPCState(&npcs[i], NPC_WALKING);
+        }
+    }
+}
+
+static bool RunSleepBench(int count, int tickCount)
+{
+    NPC *initial = malloc(count * sizeof(NPC));
+    if (!initial)
+    {
+        fprintf(stderr, "Out of memory for %d NPCs.\n", count);
+        return false;
+    }
+    RegisterBenchClips();
+    npcUseSpatialGrid = true;
+    bool sleepSetting = npcAllowSleep;
+
+    printf("Sleeping NPCs: %d NPCs, %d ticks, %d ordered every %d ticks\n", count, tickCount, SLEEP_BENCH_ORDER_SIZE,
+           SLEEP_BENCH_ORDER_EVERY);
+    printf("%6s %10s %10s %10s %18s\n", "sleep", "ms/tick", "awake", "asleep", "world hash");
+    uint64_t hashes[2];
+    double seconds[2];
+    for (int run = 0; run < 2; run++)
+    {
+        npcAllowSleep = run == 1;
+        SpawnCamp(initial, count);
+        float side = ceilf(sqrtf((float)count)) * initial[0].collisionRadius * SLEEP_BENCH_SPACING;
+        NPCStore store;
+        InitNPCStore(&store);
+        for (int i = 0; i < count; i++)
+        {
+            AddNPCToStore(&store, &initial[i]);
+        }
+        SetNPCStoreThreadCount(&store, GetDefaultWorkerCount());
+
+        long long awakeTotal = 0;
+        double start = NowSeconds();
+        for (int t = 0; t < tickCount; t++)
+        {
+            if (t > 0 && t % SLEEP_BENCH_ORDER_EVERY == 0)
+            {
+                Vector2 target = {RandomFloat(side), RandomFloat(side)};
+                for (int n = 0; n < SLEEP_BENCH_ORDER_SIZE; n++)
+                {
+                    int i = (int)RandomFloat((float)count);
+                    store.orderX[i] = store.targetX[i] = target.x + RandomFloat(200.0f);
+                    store.orderY[i] = store.targetY[i] = target.y + RandomFloat(200.0f);
+                    SetStoreNPCState(&store, i, NPC_WALKING);
+                }
+            }
+            UpdateNPCStore(&store, 1.0f / 60.0f);
+            awakeTotal += GetNPCStoreStats(&store).awake;
+        }
+        seconds[run] = (NowSeconds() - start) / tickCount;
+        hashes[run] = HashWorldState(&store);
+        NPCStoreStats stats = GetNPCStoreStats(&store);
+        printf("%6s %10.3f %10.0f %10d   %016llx\n", npcAllowSleep ? "on" : "off", seconds[run] * 1000.0,
+               (double)awakeTotal / tickCount, stats.asleep, (unsigned long long)hashes[run]);
+        FreeNPCStore(&store);
+    }
+    npcAllowSleep = sleepSetting;
+    printf("awake is the mean per tick, asleep the count after the last one; %.2fx faster with sleep, %s\n",
+           seconds[0] / seconds[1], hashes[0] == hashes[1] ? "same world state" : "world state differs!");
+
+    free(initial);
+    return hashes[0] == hashes[1];
+}
+
+int main(int argc, char **argv)
+{
+    const char *mode = argc > 1 ? argv[1] : "separation";
+
+    if (strcmp(mode, "separation") == 0)
+    {
+        int maxCount = argc > 2 ? atoi(argv[2]) : 20000;
+        RunSeparationBench(maxCount > 0 ? maxCount : 20000);
+    }
+    else if (strcmp(mode, "soa") == 0)
+    {
+        int maxCount = argc > 2 ? atoi(argv[2]) : 20000;
+        RunSoABench(maxCount > 0 ? maxCount : 20000);
+    }
+    else if (strcmp(mode, "threads") == 0)
+    {
+        int count = argc > 2 ? atoi(argv[2]) : 20000;
+        int ticks = argc > 3 ? atoi(argv[3]) : 300;
+        if (!RunThreadBench(count > 0 ? count : 20000, ticks > 0 ? ticks : 300))
+            return 1;
+    }
+    else if (strcmp(mode, "flow") == 0)
+    {
+        int count = argc > 2 ? atoi(argv[2]) : 1000;
+        RunFlowBench(count > 0 ? count : 1000);
+    }
+    else if (strcmp(mode, "hpa") == 0)
+    {
+        int size = argc > 2 ? atoi(argv[2]) : 1024;
+        if (!RunPathGraphBench(size >= PATH_CLUSTER_SIZE ? size : 1024))
+            return 1;
+    }
+    else if (strcmp(mode, "collision") == 0)
+    {
+        int count = argc > 2 ? atoi(argv[2]) : 10000;
+        if (!RunCollisionBench(count > 0 ? count : 10000))
+            return 1;
+    }
+    else if (strcmp(mode, "sleep") == 0)
+    {
+        int count = argc > 2 ? atoi(argv[2]) : 20000;
+        int ticks = argc > 3 ? atoi(argv[3]) : 600;
+        if (!RunSleepBench(count > 0 ? count : 20000, ticks > 0 ? ticks : 600))
+            return 1;
+    }
+    else if (strcmp(mode, "pick") == 0)
+    {
+        int count = argc > 2 ? atoi(argv[2]) : MAX_NPCS;
+        if (!RunPickBench(count > 0 ? count : MAX_NPCS))
+            return 1;
+    }
+    else
+    {
+        fprintf(stderr, "Usage: %s separation|soa [max NPCs]\n"
+                        "       %s threads [NPCs] [ticks]\n"
+                        "       %s flow [units]\n"
+                        "       %s hpa [map tiles]\n"
+                        "       %s collision [NPCs]\n"
+                        "       %s pick [NPCs]\n"
+                        "       %s sleep [NPCs] [ticks]\n", argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,289 @@
+// rpg_sim_bench.c
+//
+// Headless simulation benchmark: NPCs and buildings advanced on fixed ticks, with scripted
+// move and production orders, and no window or GPU. Prints one JSON object to stdout; log
+// lines from the game code go to stderr so the output can be piped straight into a file.
+//
+//   rpg_sim_bench [--npcs N] [--buildings N] [--ticks N] [--threads N] [--rate HZ]
+//                 [--order-every TICKS] [--order-size NPCS] [--produce-every TICKS] [--seed N]
+
+#include "asset_manager.h"
+#include "animation_player.h"
+#include "buildings.h"
+#include "npc_store.h"
+#include "sim_clock.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+AssetManager manager;
+
+#define BENCH_AREA_PER_NPC 2800.0f // World area per NPC; about 4 neighbours within separation range
+
+typedef struct SimBenchConfig
+{
+    int npcs;
+    int buildings;
+    int ticks;
+    int threads;
+    int rate;         // Ticks per simulated second
+    int orderEvery;   // Ticks between scripted move orders
+    int orderSize;    // NPCs selected for each move order
+    int produceEvery; // Ticks between production orders to every completed building
+    unsigned int seed;
+} SimBenchConfig;
+
+static double NowSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static unsigned int benchRandomState;
+
+static float RandomFloat(float max)
+{
+    benchRandomState = benchRandomState * 1664525u + 1013904223u;
+    return (benchRandomState >> 8) * (max / 16777216.0f);
+}
+
+static int RandomIndex(int count)
+{
+    int index = (int)RandomFloat((float)count);
+    return index < count ? index : count - 1;
+}
+
+// Clips InitNPC, SetNPCState and ProduceUnit look up; no pixels are needed
+static void RegisterBenchClips(void)
+{
+    InitAssetManager(&manager);
+    Rectangle frames[6];
+    for (int i = 0; i < 6; i++)
+    {
+        frames[i] = (Rectangle){i * 192.0f, 0, 192, 192};
+    }
+    AddAnimation(&manager, (Texture2D){0}, "Bench_1", frames, 6, 192, 192, 6);
+    AddAnimation(&manager, (Texture2D){0}, "Bench_2", frames, 6, 192, 192, 6);
+    AddAnimation(&manager, (Texture2D){0}, "Bench_3", frames, 6, 192, 192, 6);
+}
+
+static uint64_t HashBytes(uint64_t hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ull; // FNV-1a
+    }
+    return hash;
+}
+
+static uint64_t HashWorldState(const NPCStore *store, const Building *buildings, int buildingCount)
+{
+    uint64_t hash = 14695981039346656037ull;
+    hash = HashBytes(hash, store->positionX, store->count * sizeof(float));
+    hash = HashBytes(hash, store->positionY, store->count * sizeof(float));
+    hash = HashBytes(hash, store->state, store->count * sizeof(int));
+    for (int i = 0; i < buildingCount; i++)
+    {
+        hash = HashBytes(hash, &buildings[i].state, sizeof(buildings[i].state));
+        hash = HashBytes(hash, &buildings[i].buildProgress, sizeof(buildings[i].buildProgress));
+    }
+    return hash;
+}
+
+static int CompareDoubles(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of sorted values
+static double Percentile(const double *sorted, int count, double percent)
+{
+    int rank = (int)ceil(percent / 100.0 * count);
+    if (rank < 1)
+        rank = 1;
+    return sorted[rank - 1];
+}
+
+static bool ParseConfig(int argc, char **argv, SimBenchConfig *config)
+{
+    *config = (SimBenchConfig){2000, 4, 600, 1, SIM_TICKS_PER_SECOND, 15, 50, 60, 1};
+    for (int i = 1; i < argc; i++)
+    {
+        if (i + 1 >= argc)
+            return false;
+        const char *option = argv[i];
+        int value = atoi(argv[++i]);
+        if (strcmp(option, "--npcs") == 0 && value >= 0)
+            config->npcs = value;
+        else if (strcmp(option, "--buildings") == 0 && value >= 0)
+            config->buildings = value;
+        else if (strcmp(option, "--ticks") == 0 && value > 0)
+            config->ticks = value;
+        else if (strcmp(option, "--threads") == 0 && value > 0)
+            config->threads = value;
+        else if (strcmp(option, "--rate") == 0 && value > 0)
+            config->rate = value;
+        else if (strcmp(option, "--order-every") == 0 && value > 0)
+            config->orderEvery = value;
+        else if (strcmp(option, "--order-size") == 0 && value >= 0)
+            config->orderSize = value;
+        else if (strcmp(option, "--produce-every") == 0 && value > 0)
+            config->produceEvery = value;
+        else if (strcmp(option, "--seed") == 0)
+            config->seed = (unsigned int)value;
+        else
+            return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    SimBenchConfig config;
+    if (!ParseConfig(argc, argv, &config))
+    {
+        fprintf(stderr, "Usage: %s [--npcs N] [--buildings N] [--ticks N] [--threads N] [--rate HZ]\n"
+                        "       [--order-every TICKS] [--order-size NPCS] [--produce-every TICKS] [--seed N]\n",
+                argv[0]);
+        return 1;
+    }
+
+    // Spawn and limit messages are printf'd by the game code; keep stdout for the JSON
+    fflush(stdout);
+    int jsonFd = dup(STDOUT_FILENO);
+    dup2(STDERR_FILENO, STDOUT_FILENO);
+
+    RegisterBenchClips();
+    benchRandomState = config.seed;
+    float side = sqrtf((config.npcs > 0 ? config.npcs : 1) * BENCH_AREA_PER_NPC);
+    float tickSeconds = 1.0f / config.rate;
+
+    NPCStore store;
+    InitNPCStore(&store);
+    for (int i = 0; i < config.npcs; i++)
+    {
+        NPC npc;
+        InitNPC(&npc, &manager, (Vector2){RandomFloat(side), RandomFloat(side)}, 100.0f, "Bench_1");
+        AddNPCToStore(&store, &npc);
+    }
+    Building *buildings = calloc(config.buildings > 0 ? config.buildings : 1, sizeof(Building));
+    for (int i = 0; i < config.buildings; i++)
+    {
+        InitBuilding(&buildings[i], (Vector2){RandomFloat(side), RandomFloat(side)}, BUILDING_TOWER, &manager, 0);
+    }
+    int threads = SetNPCStoreThreadCount(&store, config.threads);
+
+    double *tickTimes = malloc(config.ticks * sizeof(double));
+    long long npcUpdates = 0;
+    long long npcsAwake = 0;
+    int moveOrders = 0, npcsOrdered = 0, productionOrders = 0;
+    int startCount = store.count;
+
+    double runStart = NowSeconds();
+    for (int tick = 0; tick < config.ticks; tick++)
+    {
+        double tickStart = NowSeconds();
+
+        // Scripted orders go through the same calls as the mouse and the building UI
+        if (tick % config.orderEvery == 0 && store.count > 0 && config.orderSize > 0)
+        {
+            for (int n = 0; n < config.orderSize; n++)
+            {
+                store.cold[RandomIndex(store.count)].isSelected = true;
+            }
+            npcsOrdered += MoveSelectedNPCs(&store, (Vector2){RandomFloat(side), RandomFloat(side)});
+            for (int i = 0; i < store.count; i++)
+            {
+                store.cold[i].isSelected = false;
+            }
+            moveOrders++;
+        }
+        if (tick % config.produceEvery == 0)
+        {
+            for (int i = 0; i < config.buildings; i++)
+            {
+                if (buildings[i].state == BUILDING_STATE_COMPLETED)
+                {
+                    buildings[i].unitTypeToSpawn = "Bench_1";
+                    productionOrders++;
+                }
+            }
+        }
+
+        for (int i = 0; i < config.buildings; i++)
+        {
+            UpdateBuilding(&buildings[i], &store, &manager, tickSeconds);
+        }
+        UpdateNPCStore(&store, tickSeconds);
+        TickAnimationPlayers(&manager, tickSeconds);
+
+        tickTimes[tick] = NowSeconds() - tickStart;
+        npcUpdates += store.count;
+        npcsAwake += GetNPCStoreStats(&store).awake;
+    }
+    double runSeconds = NowSeconds() - runStart;
+
+    uint64_t hash = HashWorldState(&store, buildings, config.buildings);
+    int endCount = store.count;
+    int completed = 0;
+    for (int i = 0; i < config.buildings; i++)
+    {
+        completed += buildings[i].state == BUILDING_STATE_COMPLETED;
+    }
+
+    qsort(tickTimes, config.ticks, sizeof(double), CompareDoubles);
+    double totalTickSeconds = 0.0;
+    for (int tick = 0; tick < config.ticks; tick++)
+    {
+        totalTickSeconds += tickTimes[tick];
+    }
+    FlowFieldStats flowStats = GetFlowFieldStats();
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage); // ru_maxrss is in kilobytes on Linux
+
+    fflush(stdout);
+    dup2(jsonFd, STDOUT_FILENO);
+    close(jsonFd);
+
+    printf("{\n");
+    printf("  \"config\": {\"npcs\": %d, \"buildings\": %d, \"ticks\": %d, \"threads\": %d, \"rate_hz\": %d, "
+           "\"order_every\": %d, \"order_size\": %d, \"produce_every\": %d, \"seed\": %u},\n",
+           config.npcs, config.buildings, config.ticks, threads, config.rate, config.orderEvery, config.orderSize,
+           config.produceEvery, config.seed);
+    printf("  \"kernel\": \"%s\",\n", GetNPCKernelPathName(GetNPCKernelPath()));
+    printf("  \"tick_ms\": {\"mean\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"max\": %.4f},\n",
+           totalTickSeconds / config.ticks * 1000.0, Percentile(tickTimes, config.ticks, 50.0) * 1000.0,
+           Percentile(tickTimes, config.ticks, 90.0) * 1000.0, Percentile(tickTimes, config.ticks, 99.0) * 1000.0,
+           tickTimes[config.ticks - 1] * 1000.0);
+    printf("  \"wall_seconds\": %.4f,\n", runSeconds);
+    printf("  \"npc_updates\": %lld,\n", npcUpdates);
+    printf("  \"npc_updates_per_second\": %.0f,\n", totalTickSeconds > 0.0 ? npcUpdates / totalTickSeconds : 0.0);
+    printf("  \"npcs_awake_mean\": %.1f,\n", (double)npcsAwake / config.ticks);
+    printf("  \"npcs_asleep_end\": %d,\n", GetNPCStoreStats(&store).asleep);
+    printf("  \"realtime_factor\": %.2f,\n", totalTickSeconds > 0.0 ? config.ticks * tickSeconds / totalTickSeconds : 0.0);
+    printf("  \"move_orders\": %d,\n", moveOrders);
+    printf("  \"npcs_ordered\": %d,\n", npcsOrdered);
+    printf("  \"production_orders\": %d,\n", productionOrders);
+    printf("  \"flow_field_builds\": %d,\n", flowStats.builds);
+    printf("  \"flow_field_build_ms\": %.4f,\n", flowStats.buildSeconds * 1000.0);
+    printf("  \"buildings_completed\": %d,\n", completed);
+    printf("  \"npcs_start\": %d,\n", startCount);
+    printf("  \"npcs_end\": %d,\n", endCount);
+    printf("  \"peak_rss_kb\": %ld,\n", usage.ru_maxrss);
+    printf("  \"world_hash\": \"%016llx\"\n", (unsigned long long)hash);
+    printf("}\n");
+
+    free(tickTimes);
+    free(buildings);
+    FreeNPCStore(&store);
+    ResetFlowFields();
+    return 0;
+}